@@ -10,6 +10,7 @@
 //   Date   *   Auteur   * Anomalie * Commentaire
 //------------------------------------------------------------------------------
 // 10/01/18 *   BPi      *          * Creation
+// 17/10/26 *            *          * Ajout des versions vectorielles (lots)
 //==============================================================================
 
 #ifndef _COM_CAL_SIN_COS_H_
@@ -18,6 +19,8 @@
 //==============================================================================
 // Inclusion ===================================================================
 //==============================================================================
+#include <stddef.h>
+
 typedef char c8;
 
 //typedef char s8;
@@ -86,4 +89,9 @@ typedef u8 tret;
 //================================
 DEFINE void fComCalSinCos(f32 theta, f32 *pSinVal, f32 *pCosVal);
 
+// Batch sin_cos / sin functions (AVX2 when the CPU supports it, scalar otherwise)
+//================================================================================
+DEFINE void fComCalSinCosBatch(const f32 *pTheta, f32 *pSinVal, f32 *pCosVal, size_t n);
+DEFINE void fComCalSinBatch(const f32 *pTheta, f32 *pSinVal, size_t n);
+
 #endif // _COM_CAL_SIN_COS_H_
@@ -15,8 +15,8 @@ typedef struct {
     char* DatSet;  // Data Set reference
     uint8_t* MACAddress; // MAC address for GOOSE communication
     uint32_t AppID;  // Application ID for GOOSE*
-    GooseReceiver receiver ;
-    GooseSubscriber subscriber ; // GOOSE subscriber instance
+    GooseReceiver receiver ;     // Receiver of the interface, shared with the other instances on it (not owned)
+    GooseSubscriber subscriber ; // GOOSE subscriber instance (owned by the receiver)
     bool enable_retransmission;  // Whether to enable message retransmission
     int max_retries;             // Maximum retransmission attempts
 } ThreadData;
@@ -0,0 +1,84 @@
+#ifndef GOOSE_LOADGEN_H
+#define GOOSE_LOADGEN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Load of a GOOSE load generator run.
+ */
+typedef struct
+{
+    int publishers;             // Virtual publishers derived from the GOOSE configuration
+    double event_rate_hz;       // State changes per second of each publisher, 0 for none
+    uint32_t burst_size;        // Publishers changing state together at each burst, 0 for no bursts
+    uint32_t burst_interval_ms; // Time between two bursts
+    int data_set_size;          // Entries in the data set of each publisher
+    uint32_t min_time_ms;       // Retransmission interval after a state change
+    uint32_t max_time_ms;       // Retransmission interval of a stable state
+    uint32_t duration_ms;       // Length of the run, 0 until Goose_LoadGen_stop()
+} GooseLoadProfile;
+
+/**
+ * @brief Statistics of the current (or last) load generator run.
+ *
+ * The slip is the delay between the time a message was due and the time it was handed to
+ * the send path; percentiles come from a log2 histogram (upper bound of the bucket).
+ */
+typedef struct
+{
+    bool running;
+    int publishers;
+    uint64_t elapsed_ms;
+    uint64_t sent;
+    uint64_t send_errors;
+    uint64_t state_changes;
+    uint64_t batches;          // Send calls, each with up to GOOSE_LOAD_BATCH frames
+    double msgs_per_s;         // Average since the start
+    double current_msgs_per_s; // Since the previous call of Goose_LoadGen_get_stats()
+    uint64_t slip_mean_ns;
+    uint64_t slip_p99_ns;
+    uint64_t slip_max_ns;
+} GooseLoadStats;
+
+/**
+ * @brief Fills a profile with the defaults (1 publisher, no events, 8 entries, minTime/maxTime
+ * GOOSE_MIN_TIME_MS/GOOSE_MAX_TIME_MS, no duration limit).
+ */
+void Goose_LoadGen_default_profile(GooseLoadProfile *profile);
+
+/**
+ * @brief Starts a load generator run, a running one is stopped first.
+ *
+ * Publisher i uses the configuration with AppID + i and "_<i>" appended to GoCBRef, DatSet and
+ * GoID (when there is more than one publisher). The publishers share one socket on the configured
+ * interface; a single timer wheel thread sends their messages in batches.
+ *
+ * @param config GoCBRef, DatSet, GoID, MACAddress, AppID and Interface of the first publisher.
+ * @param profile The load.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int Goose_LoadGen_start(const GOOSE_SimulationConfig *config, const GooseLoadProfile *profile);
+
+/**
+ * @brief Returns the statistics of the current (or last) run.
+ *
+ * @return SUCCESS (0) on success, FAIL (-1) if no run was started.
+ */
+int Goose_LoadGen_get_stats(GooseLoadStats *stats);
+
+/**
+ * @brief Stops the run and releases the publishers, the statistics stay available.
+ */
+void Goose_LoadGen_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,8 +1,62 @@
 #ifndef GOOSE_PUBLISHER_H
 #define GOOSE_PUBLISHER_H
 #include "parser.h"
+#include <stdint.h>
+#include <stdbool.h>
 
-void goose_publisher_send(GOOSE_SimulationConfig* config);
+// Default IEC 61850-8-1 retransmission times: after a state change the message is repeated
+// after minTime, the interval doubles after each repetition until it reaches maxTime
+#ifndef GOOSE_MIN_TIME_MS
+#define GOOSE_MIN_TIME_MS 4
+#endif
+#ifndef GOOSE_MAX_TIME_MS
+#define GOOSE_MAX_TIME_MS 1000
+#endif
+
+/**
+ * @brief Creates one GOOSE control block per configuration.
+ *
+ * Each control block publishes the data set stVal (BOOLEAN), q (BIT STRING) and t (UTC time),
+ * encoded once: publishing only patches stNum, sqNum and the timestamp of the pre-encoded frame.
+ *
+ * @param config GoCBRef, DatSet, GoID (optional), MACAddress, AppID and Interface of each control block.
+ * @param count Number of control blocks.
+ * @param min_time_ms Retransmission interval after a state change.
+ * @param max_time_ms Retransmission interval of a stable state.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int Goose_publisher_init(GOOSE_SimulationConfig *config, int count, uint32_t min_time_ms, uint32_t max_time_ms);
+
+/**
+ * @brief Sends the initial state of every control block and starts the retransmission thread.
+ *
+ * A single timer wheel thread drives the retransmissions of all control blocks.
+ *
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int Goose_publisher_start(void);
+
+/**
+ * @brief Changes the state (stVal) of a control block.
+ *
+ * The new state is sent immediately from the calling thread with a new stNum,
+ * then repeated after minTime, 2 x minTime, ... up to maxTime.
+ * Setting the current state again does nothing.
+ *
+ * @param index Index of the control block.
+ * @param state The new stVal.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int Goose_publisher_set_state(int index, bool state);
+
+/**
+ * @brief Returns the number of GOOSE messages sent by all control blocks.
+ */
+uint64_t Goose_publisher_get_sent_count(void);
+
+/**
+ * @brief Stops the retransmission thread and destroys the control blocks.
+ */
 void goose_publisher_cleanup(void);
 
 #endif
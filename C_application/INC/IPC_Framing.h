@@ -0,0 +1,58 @@
+#ifndef IPC_FRAMING_H
+#define IPC_FRAMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define IPC_FRAMER_INITIAL_CAPACITY 4096
+#define IPC_FRAMER_MAX_HEADER 4 // Length prefix: 32-bit big-endian payload size
+
+// How messages are delimited on a stream socket
+typedef enum {
+    IPC_FRAMING_JSON_STREAM,   // Back-to-back JSON objects, delimited by brace matching (legacy Node.js protocol)
+    IPC_FRAMING_NEWLINE,       // One JSON object per line ('\n', optional '\r' before it)
+    IPC_FRAMING_LENGTH_PREFIX  // 32-bit big-endian payload length followed by the payload
+} ipc_framing_e;
+
+// Receive-side framer of one stream connection.
+// Bytes are received directly into a growable buffer; [read_pos, write_pos) holds the pending bytes.
+// Consumed bytes are reclaimed by sliding the pending bytes back to the start of the buffer only
+// when the free space at the end runs out, so complete messages always stay contiguous and can be
+// handed to the parser without a copy.
+typedef struct {
+    ipc_framing_e mode;
+    char *data;
+    size_t capacity;
+    size_t max_message_size;
+    size_t read_pos;  // start of the message being assembled
+    size_t write_pos; // end of the received bytes
+    size_t scan_pos;  // next byte to scan: the scan resumes here after each receive
+    int depth;        // brace depth of the JSON object being scanned
+    bool in_string;
+    bool escape;
+} IpcFramer;
+
+// Initialize a framer, messages bigger than max_message_size are rejected
+int ipc_framer_init(IpcFramer *framer, ipc_framing_e mode, size_t max_message_size);
+// Release the framer buffer
+void ipc_framer_free(IpcFramer *framer);
+// Drop every pending byte and restart scanning (after a protocol error or a reconnection)
+void ipc_framer_reset(IpcFramer *framer);
+// Returns where the next received bytes must be written, with at least min_room bytes available.
+// *room is set to the space actually available. Returns NULL when the buffer cannot grow anymore.
+// Invalidates the messages previously returned by ipc_framer_next().
+char *ipc_framer_write_ptr(IpcFramer *framer, size_t min_room, size_t *room);
+// Account for length bytes written at the pointer returned by ipc_framer_write_ptr()
+void ipc_framer_commit(IpcFramer *framer, size_t length);
+// Extract the next complete message. Returns 1 and sets message/length when one is available
+// (not NUL-terminated, valid until the next ipc_framer_write_ptr() call), 0 when more bytes are
+// needed, FAIL when the message exceeds the size limit (the framer is reset).
+int ipc_framer_next(IpcFramer *framer, const char **message, size_t *length);
+// Build the header to send before a payload of the given length. Returns the header size (0 if none).
+size_t ipc_framer_header(ipc_framing_e mode, size_t length, uint8_t header[IPC_FRAMER_MAX_HEADER]);
+// Trailer to send after a payload (NULL if none)
+const char *ipc_framer_trailer(ipc_framing_e mode, size_t *length);
+// Framing mode name for logs
+const char *ipc_framing_to_string(ipc_framing_e mode);
+#endif // IPC_FRAMING_H
@@ -0,0 +1,151 @@
+#ifndef LATENCY_ENGINE_H
+#define LATENCY_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Log-linear histogram: values below 2^LATENCY_HISTOGRAM_SUB_BITS ns are counted exactly, above
+   each power of two is split into LATENCY_HISTOGRAM_HALF_COUNT buckets (relative error < 1/128) */
+#define LATENCY_HISTOGRAM_SUB_BITS 8
+#define LATENCY_HISTOGRAM_SUB_COUNT (1U << LATENCY_HISTOGRAM_SUB_BITS)
+#define LATENCY_HISTOGRAM_HALF_COUNT (LATENCY_HISTOGRAM_SUB_COUNT / 2)
+/* Largest value tracked: 2^40 ns (about 18 minutes), larger values land in the last bucket */
+#define LATENCY_HISTOGRAM_MAX_BITS 40
+#define LATENCY_HISTOGRAM_BUCKETS (LATENCY_HISTOGRAM_SUB_COUNT + (LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BITS) * LATENCY_HISTOGRAM_HALF_COUNT)
+
+/**
+ * @brief Trip latency statistics of one SV instance.
+ *
+ * A sample is the time between the SV frame that starts a fault phase and the
+ * first GOOSE state change (stNum change) received for the instance's goCbRef.
+ * Percentiles come from a log-linear histogram (relative error below 1 %).
+ */
+typedef struct
+{
+    uint64_t injections;         // Fault phases started
+    uint64_t samples;            // Fault phases answered by a GOOSE state change
+    uint64_t missed;             // Fault phases that ended without a state change
+    uint64_t spurious;           // State changes received while no fault was pending
+    uint64_t kernel_timestamped; // Samples measured with kernel TX and RX timestamps
+    uint32_t last_smp_cnt;       // smpCnt of the frame that started the last fault phase
+    uint64_t last_ns;
+    uint64_t min_ns;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} LatencyStats;
+
+/**
+ * @brief Allocates the measurement state of a number of instances.
+ *
+ * Releases the state of a previous run, must not be called while instances are publishing.
+ *
+ * @param instance_count Number of SV instances.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int Latency_init(int instance_count);
+
+/**
+ * @brief Releases the measurement state of every instance.
+ */
+void Latency_cleanup(void);
+
+/**
+ * @brief Returns the number of instances measured.
+ */
+int Latency_get_instance_count(void);
+
+/**
+ * @brief Current CLOCK_MONOTONIC time (ns), used when no kernel timestamp is available.
+ */
+uint64_t Latency_now_ns(void);
+
+/**
+ * @brief Records the SV frame that starts a fault phase.
+ *
+ * @param instance Index of the SV instance.
+ * @param smp_cnt smpCnt of the frame.
+ * @param tx_ns CLOCK_MONOTONIC time at which the frame is sent.
+ * @param tx_timestamp_pending true when a kernel transmit timestamp has been requested for the
+ * frame, it is then handed over with Latency_tx_timestamp().
+ */
+void Latency_fault_started(int instance, uint32_t smp_cnt, uint64_t tx_ns, bool tx_timestamp_pending);
+
+/**
+ * @brief Hands over the kernel transmit timestamp of the frame that started the fault phase.
+ *
+ * @param instance Index of the SV instance.
+ * @param tx_timestamp_ns Kernel transmit timestamp (ns since epoch), 0 if it could not be fetched.
+ */
+void Latency_tx_timestamp(int instance, uint64_t tx_timestamp_ns);
+
+/**
+ * @brief Records the end of a fault phase: a fault still unanswered counts as missed.
+ *
+ * @param instance Index of the SV instance.
+ */
+void Latency_fault_cleared(int instance);
+
+/**
+ * @brief Records a GOOSE message of the instance's control block.
+ *
+ * @param instance Index of the SV instance.
+ * @param st_num stNum of the message.
+ * @param rx_timestamp_ns Kernel receive timestamp (ns since epoch), 0 if not available.
+ * @param rx_ns CLOCK_MONOTONIC time at which the message is handled.
+ */
+void Latency_goose_received(int instance, uint32_t st_num, uint64_t rx_timestamp_ns, uint64_t rx_ns);
+
+/**
+ * @brief Returns the statistics of an instance.
+ *
+ * @param instance Index of the SV instance.
+ * @param stats Filled with the statistics.
+ * @return SUCCESS (0) on success, FAIL (-1) if the instance does not exist.
+ */
+int Latency_get_stats(int instance, LatencyStats *stats);
+
+/**
+ * @brief Clears the statistics of every instance (a pending fault is kept).
+ */
+void Latency_reset(void);
+
+/**
+ * @brief Histogram bucket of a latency.
+ *
+ * @param value_ns Latency (ns), values of 2^LATENCY_HISTOGRAM_MAX_BITS and above land in the last bucket.
+ * @return Index in [0, LATENCY_HISTOGRAM_BUCKETS).
+ */
+unsigned int Latency_histogram_index(uint64_t value_ns);
+
+/**
+ * @brief Largest latency (ns) counted in a histogram bucket.
+ */
+uint64_t Latency_histogram_bucket_value(unsigned int index);
+
+/**
+ * @brief Latency at a quantile of a histogram.
+ *
+ * @param histogram Bucket counts.
+ * @param bucket_count Number of buckets walked, the buckets above are empty.
+ * @param samples Sum of the bucket counts.
+ * @param min_ns Smallest latency recorded, the result is clamped to [min_ns, max_ns].
+ * @param max_ns Largest latency recorded.
+ * @param numerator Quantile numerator (e.g. 999 with 1000 for p99.9).
+ * @param denominator Quantile denominator.
+ * @return Upper value of the bucket holding the quantile, clamped to [min_ns, max_ns].
+ */
+uint64_t Latency_histogram_quantile(const uint64_t *histogram, unsigned int bucket_count, uint64_t samples,
+                                    uint64_t min_ns, uint64_t max_ns, uint64_t numerator, uint64_t denominator);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,27 +3,58 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <pthread.h>
+#include <stddef.h>
+#include <stdatomic.h>
 #include "State_Machine.h"
-#include <cjson/cJSON.h> 
+#include <cjson/cJSON.h>
 #include "parser.h" // For SV_SimulationConfig and GOOSE_SimulationConfig
-#define QUEUE_SIZE 16
-// Circular buffer (FIFO) that can store elements of any size.
+
+#define EVENT_QUEUE_DEFAULT_CAPACITY 256
+#define EVENT_QUEUE_CACHE_LINE 64
+
+// Bounded lock-free multi-producer / single-consumer event queue (FIFO).
+// Producers never block and never allocate: event_queue_push() can be called from a signal handler.
+// The consumer sleeps on an eventfd that is signalled by every push.
+
+typedef struct {
+    atomic_size_t sequence; // slot sequence number (Vyukov bounded queue)
+    state_event_e event;
+    char *requestId;        // owned by the queue while the event is queued
+    cJSON *data_obj;        // owned by the queue while the event is queued
+} EventQueueSlot;
+
+typedef struct {
+    uint64_t dropped;    // events rejected because the queue was full
+    size_t high_water;   // highest number of queued events seen
+    size_t capacity;
+} EventQueueStats;
 
 typedef struct {
-    state_event_e events[QUEUE_SIZE];
-    const char *requestIds[QUEUE_SIZE]; 
-    cJSON *data_objs[QUEUE_SIZE]; // Array to store cJSON objects associated with events
-    int head;
-    int tail;
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
-    int shutdown;
+    EventQueueSlot *slots;
+    size_t capacity; // power of two
+    size_t mask;
+    int wakeup_fd;   // eventfd, readable when events were pushed
+    _Alignas(EVENT_QUEUE_CACHE_LINE) atomic_size_t tail; // next slot claimed by a producer
+    _Alignas(EVENT_QUEUE_CACHE_LINE) atomic_size_t head; // next slot read by the consumer
+    _Alignas(EVENT_QUEUE_CACHE_LINE) atomic_uint_fast64_t dropped;
+    atomic_size_t high_water;
+    atomic_int shutdown;
 } EventQueue;
 
-// Initialize event queue
-int event_queue_init( EventQueue* event_queue);
-// Push event to queue
-int event_queue_push(state_event_e event,const char *requestId, EventQueue* event_queue, cJSON *data_obj);
+// Initialize event queue, capacity is rounded up to a power of two
+int event_queue_init(EventQueue* event_queue, size_t capacity);
+// Push event to queue. On SUCCESS the queue takes ownership of requestId and data_obj,
+// on FAIL (queue full or shutting down) they stay owned by the caller. Async-signal-safe.
+int event_queue_push(state_event_e event, char *requestId, EventQueue* event_queue, cJSON *data_obj);
+// Pop event from queue (single consumer), blocks until an event is available or the queue is shut down.
+// Ownership of requestId and data_obj is transferred to the caller (freed if the out pointer is NULL).
 int event_queue_pop(EventQueue* event_queue,state_event_e* event, const char **requestId, cJSON **data_obj_out);
-#endif // RING_BUFFER_H
\ No newline at end of file
+// Wake up the consumer and make event_queue_pop() fail once the queue is empty. Async-signal-safe.
+int event_queue_shutdown(EventQueue* event_queue);
+// Release the queue and the events still queued. No producer or consumer may use the queue anymore.
+void event_queue_destroy(EventQueue* event_queue);
+// File descriptor that becomes readable when events are pushed (for poll/epoll based consumers)
+int event_queue_get_fd(EventQueue* event_queue);
+// Drop and high-water counters
+void event_queue_get_stats(EventQueue* event_queue, EventQueueStats *stats);
+#endif // RING_BUFFER_H
@@ -0,0 +1,71 @@
+#ifndef SV_DDS_H
+#define SV_DDS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest number of values computed by one SV_Dds_compute() batch */
+#define SV_DDS_BATCH_MAX 64
+
+/**
+ * @brief One direct digital synthesis channel: a sine driven by a 64-bit phase accumulator.
+ *
+ * A turn is 2^64, so the phase wraps by itself and the frequency resolution is far below a
+ * microhertz. A frequency ramp is a constant change of the phase increment per sample.
+ */
+typedef struct
+{
+    uint64_t phase;     // Phase of the next sample
+    uint64_t step;      // Phase increment per sample (frequency)
+    int64_t step_delta; // Increment change per sample (frequency ramp), 0 for a fixed frequency
+    float amplitude;    // Peak value
+} SVDdsChannel;
+
+/**
+ * @brief Phase increment per sample of a frequency.
+ *
+ * @param frequency_hz Frequency, 0 <= frequency_hz < sample_rate_hz.
+ * @param sample_rate_hz Samples per second of the generated stream.
+ */
+uint64_t SV_Dds_step(double frequency_hz, double sample_rate_hz);
+
+/**
+ * @brief Change of the phase increment per sample of a frequency ramp (ROCOF).
+ */
+int64_t SV_Dds_step_delta(double rocof_hz_per_s, double sample_rate_hz);
+
+/**
+ * @brief Phase of an angle in degrees (any sign, taken modulo 360).
+ */
+uint64_t SV_Dds_angle(double degrees);
+
+/**
+ * @brief Advances a channel by one sample: phase and frequency.
+ */
+static inline void SV_Dds_advance(SVDdsChannel *channel)
+{
+    channel->phase += channel->step;
+    channel->step += (uint64_t)channel->step_delta;
+}
+
+/**
+ * @brief Computes the next samples of several channels in one batch, without advancing them.
+ *
+ * The phases are stepped as SV_Dds_advance() does and the sines are computed with the batch kernel
+ * of ComCalSinCos (AVX2 when available), the angle is resolved to 2^-24 turn.
+ *
+ * @param channels The channels.
+ * @param channel_count Number of channels.
+ * @param sample_count Number of samples of each channel, channel_count * sample_count <= SV_DDS_BATCH_MAX.
+ * @param values Filled with values[sample * channel_count + channel].
+ */
+void SV_Dds_compute(const SVDdsChannel *const *channels, int channel_count, int sample_count, float *values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef SV_FRAME_RING_H
+#define SV_FRAME_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SV_FRAME_RING_CACHE_LINE 64
+
+/* Largest frame a slot can hold (Ethernet frame without FCS) */
+#ifndef SV_FRAME_RING_MAX_FRAME_SIZE
+#define SV_FRAME_RING_MAX_FRAME_SIZE 1518
+#endif
+
+/**
+ * @brief A ready-to-send frame and what the transmit stage has to do with it.
+ */
+typedef struct
+{
+    int size;               // Frame size in bytes
+    uint32_t smp_cnt;       // smpCnt of the sample carried by the frame
+    int refr_tm_offset;     // Offset of the refrTm patched at transmission, -1 for none
+    bool fault_started;     // First frame of a fault phase: sent with a transmit timestamp request
+    bool fault_cleared;     // First frame after a fault phase
+    uint64_t sample_number; // Frames of the stream generated before this one (launch time)
+    int transition_phase;   // First frame of this scenario phase, -1 for none
+    int transition_play;    // Play of the scenario the phase belongs to
+    uint8_t frame[SV_FRAME_RING_MAX_FRAME_SIZE];
+} SVFrameSlot;
+
+/**
+ * @brief Bounded single-producer / single-consumer ring of frame slots.
+ *
+ * The producer fills a slot in place (SV_FrameRing_reserve() / SV_FrameRing_commit()), the consumer
+ * sends it in place (SV_FrameRing_peek() / SV_FrameRing_release()): frames are never copied between
+ * the stages. Lock-free, neither side ever blocks.
+ */
+typedef struct
+{
+    SVFrameSlot *slots;
+    uint32_t capacity; // power of two
+    uint32_t mask;
+    _Alignas(SV_FRAME_RING_CACHE_LINE) atomic_uint_fast32_t tail; // next slot filled by the producer
+    _Alignas(SV_FRAME_RING_CACHE_LINE) atomic_uint_fast32_t head; // next slot sent by the consumer
+    atomic_uint low_water; // lowest occupancy seen by the consumer, read by SV_FrameRing_low_water()
+} SVFrameRing;
+
+/**
+ * @brief Allocates the slots of a ring, the capacity is rounded up to a power of two.
+ *
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int SV_FrameRing_init(SVFrameRing *ring, uint32_t capacity);
+
+/**
+ * @brief Releases the slots. Neither stage may use the ring anymore.
+ */
+void SV_FrameRing_destroy(SVFrameRing *ring);
+
+/**
+ * @brief Producer: returns the next free slot, NULL if the ring is full.
+ */
+SVFrameSlot *SV_FrameRing_reserve(SVFrameRing *ring);
+
+/**
+ * @brief Producer: publishes the slot returned by SV_FrameRing_reserve() to the consumer.
+ */
+void SV_FrameRing_commit(SVFrameRing *ring);
+
+/**
+ * @brief Consumer: returns the oldest ready frame, NULL if the ring is empty.
+ */
+SVFrameSlot *SV_FrameRing_peek(SVFrameRing *ring);
+
+/**
+ * @brief Consumer: returns the index-th oldest ready frame (0: same as SV_FrameRing_peek()), NULL if not ready.
+ */
+SVFrameSlot *SV_FrameRing_peekAt(SVFrameRing *ring, uint32_t index);
+
+/**
+ * @brief Consumer: hands the oldest slot (returned by SV_FrameRing_peek()) back to the producer.
+ */
+void SV_FrameRing_release(SVFrameRing *ring);
+
+/**
+ * @brief Number of ready frames, callable from any thread.
+ */
+uint32_t SV_FrameRing_occupancy(SVFrameRing *ring);
+
+/**
+ * @brief Lowest number of ready frames the consumer has seen, callable from any thread.
+ */
+uint32_t SV_FrameRing_low_water(SVFrameRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -2,6 +2,7 @@
 #define SV_PUBLISHER_H
 
 #include <stdbool.h> // For bool type
+#include <stdint.h>
 #include "parser.h"
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +34,75 @@ bool SVPublisher_start();
  */
 void SVPublisher_stop();
 
+/**
+ * @brief Frame pipeline counters of one instance.
+ *
+ * A generator thread computes the frames ahead of time into a ring of ready-to-send frames,
+ * the publishing scheduler only sends them at their deadline.
+ */
+typedef struct
+{
+    uint32_t ring_capacity;  // Frames the ring holds
+    uint32_t ring_occupancy; // Frames ready right now
+    uint32_t ring_low_water; // Lowest occupancy seen at a deadline
+    uint64_t generated;      // Frames computed by the generator
+    uint64_t sent;           // Frames sent by the scheduler
+    uint64_t late_frames;    // Frames not ready at their deadline (sent at a later deadline)
+    uint64_t launch_errors;  // Launch time mode: frames dropped by the kernel for a missed launch time
+    uint64_t scenario_swaps; // Scenarios switched to by SVPublisher_swap_scenario()
+} SVPipelineStats;
+
+/**
+ * @brief Returns the frame pipeline counters of an instance.
+ *
+ * @param instance Index of the instance (order of SVPublisher_init()).
+ * @param stats Filled with the counters.
+ * @return SUCCESS (0) on success, FAIL (-1) if the instance does not exist.
+ */
+int SVPublisher_get_pipeline_stats(int instance, SVPipelineStats *stats);
+
+/* Phase transitions remembered per instance */
+#ifndef SV_TRANSITION_LOG_SIZE
+#define SV_TRANSITION_LOG_SIZE 16
+#endif
+
+/**
+ * @brief First frame of a scenario phase, as it was sent.
+ */
+typedef struct
+{
+    int phase;              // Phase entered (0-based)
+    int play;               // Play of the scenario (0-based)
+    uint32_t smp_cnt;       // smpCnt of the first frame of the phase
+    uint64_t sample_number; // Samples of the stream before that frame
+    uint64_t timestamp_ns;  // refrTm of that frame: transmission (or launch) time, ns since the epoch
+} SVPhaseTransition;
+
+/**
+ * @brief Returns the last phase transitions of an instance, oldest first.
+ *
+ * @param instance Index of the instance (order of SVPublisher_init()).
+ * @param transitions Filled with up to max_count transitions (at most SV_TRANSITION_LOG_SIZE are kept).
+ * @return Number of transitions returned, FAIL (-1) if the instance does not exist.
+ */
+int SVPublisher_get_transitions(int instance, SVPhaseTransition *transitions, int max_count);
+
+/**
+ * @brief Replaces the scenario of a running instance without interrupting its SV stream.
+ *
+ * The scenario is loaded here (through the scenario cache), then published to the generator, which
+ * switches to it at the next frame it computes: the new scenario starts at its first phase while
+ * smpCnt and the stream timing continue. Frames already in the ring keep the old scenario, so the
+ * switch reaches the wire SV_PIPELINE_RING_FRAMES frames later at most. A swap not applied yet is
+ * replaced by a newer one.
+ *
+ * @param instance Index of the instance, -1 for every instance.
+ * @param scenarioConfigFile Text, XML or compiled scenario.
+ * @return SUCCESS (0) on success, FAIL (-1) if the publisher is not running, the instance does not
+ * exist or the scenario cannot be loaded.
+ */
+int SVPublisher_swap_scenario(int instance, const char *scenarioConfigFile);
+
 #ifdef __cplusplus
 }
 #endif
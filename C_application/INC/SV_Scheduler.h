@@ -0,0 +1,70 @@
+#ifndef SV_SCHEDULER_H
+#define SV_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Periodic job executed by a scheduler thread at each deadline.
+ *
+ * @param context The context pointer given to SV_Scheduler_add().
+ * @param deadline_ns The absolute CLOCK_MONOTONIC deadline (ns) this call was scheduled for.
+ */
+typedef void (*sv_scheduler_job_t)(void *context, uint64_t deadline_ns);
+
+/**
+ * @brief Prepares the scheduler with a number of worker threads.
+ *
+ * Each worker thread runs with SCHED_FIFO at the given priority (falls back to the
+ * default policy when the process lacks the privilege) and is pinned to one of the CPUs
+ * allowed by the affinity mask of the process, in turn.
+ * Jobs are distributed round-robin over the worker threads.
+ *
+ * @param nb_threads Number of worker threads (>= 1).
+ * @param priority SCHED_FIFO priority of the worker threads.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int SV_Scheduler_init(int nb_threads, int priority);
+
+/**
+ * @brief Registers a periodic job. Must be called before SV_Scheduler_start().
+ *
+ * The first call happens at start time + offset_ns, then every period_ns.
+ *
+ * @param job The function called at each deadline.
+ * @param context Opaque pointer handed to the job.
+ * @param period_ns Period of the job in nanoseconds.
+ * @param offset_ns Phase offset of the first deadline relative to the start time.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int SV_Scheduler_add(sv_scheduler_job_t job, void *context, uint64_t period_ns, uint64_t offset_ns);
+
+/**
+ * @brief Starts the worker threads. All jobs share the same start time.
+ *
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int SV_Scheduler_start(void);
+
+/**
+ * @brief Stops and joins the worker threads and removes all registered jobs.
+ *
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int SV_Scheduler_stop(void);
+
+/**
+ * @brief Returns the number of deadlines that were skipped because a job was late
+ * by more than one period (summed over all jobs).
+ */
+uint64_t SV_Scheduler_get_overruns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* "SSCN": first bytes of a compiled scenario (host byte order, a swapped magic is rejected) */
+#define SCENARIO_MAGIC 0x4E435353u
+#define SCENARIO_VERSION 3
+
+/* Suffix of the compiled file kept next to a text/XML scenario */
+#ifndef SCENARIO_BINARY_SUFFIX
+#define SCENARIO_BINARY_SUFFIX ".scnb"
+#endif
+
+/* Unused scenarios kept in the cache, least recently used ones are freed first */
+#ifndef SCENARIO_CACHE_MAX_IDLE
+#define SCENARIO_CACHE_MAX_IDLE 16
+#endif
+
+/* Channels a scenario can describe (channel1_* .. channel<n>_* keys) */
+#define SCENARIO_MAX_CHANNELS 2
+
+/* A phase with a current above this value (A) on the played channel injects a fault */
+#ifndef SV_FAULT_CURRENT_THRESHOLD
+#define SV_FAULT_CURRENT_THRESHOLD 1.0f
+#endif
+
+/* Frequency of the waveform at the start of a play, unless its first phase sets one */
+#ifndef SCENARIO_NOMINAL_FREQUENCY_HZ
+#define SCENARIO_NOMINAL_FREQUENCY_HZ 50.0f
+#endif
+
+/* Highest frequency a phase may set or a frequency ramp may reach */
+#ifndef SCENARIO_MAX_FREQUENCY_HZ
+#define SCENARIO_MAX_FREQUENCY_HZ 1000.0f
+#endif
+
+/* ScenarioPhase.flags */
+#define SCENARIO_PHASE_FAULT 0x1u
+#define SCENARIO_PHASE_POINT_ON_WAVE 0x2u // the phase starts at inception_angle_deg
+#define SCENARIO_PHASE_FREQUENCY 0x4u     // the phase sets frequency_hz, otherwise it continues the previous frequency
+
+/**
+ * @brief Header of a compiled scenario, followed by phase_count entries of phase_stride bytes.
+ */
+typedef struct
+{
+    uint32_t magic;        // SCENARIO_MAGIC
+    uint16_t version;      // SCENARIO_VERSION
+    uint16_t header_size;  // Offset of the phase table
+    uint32_t phase_stride; // Size of a phase entry, >= sizeof(ScenarioPhase)
+    uint32_t phase_count;
+    int32_t repeat_count;  // Plays of the phase list, 0 repeats until the simulation is stopped
+    uint16_t channel;      // Channel played by the publisher (0-based)
+    uint16_t channel_mask; // Channels set by the source (bit n: channel n + 1)
+    uint64_t duration_ms;  // Length of one play (sum of the phase durations)
+} ScenarioHeader;
+
+/**
+ * @brief One phase of a compiled scenario.
+ */
+typedef struct
+{
+    uint64_t start_ms; // Start of the phase from the start of the play (sum of the previous durations)
+    uint32_t duration_ms;
+    uint32_t flags;            // SCENARIO_PHASE_xx, computed by the compiler
+    float inception_angle_deg; // SCENARIO_PHASE_POINT_ON_WAVE: angle of V1 at the first sample (0: rising zero crossing)
+    float frequency_hz;        // Frequency at the start of the phase, computed by the compiler when not set
+    float rocof_hz_per_s;      // Frequency ramp during the phase
+    float phase_jump_deg;      // Added to the angle of every waveform at the start of the phase
+    float voltage[SCENARIO_MAX_CHANNELS][3];
+    float current[SCENARIO_MAX_CHANNELS][3];
+} ScenarioPhase;
+
+/**
+ * @brief A loaded scenario: a read-only compiled image, mapped from a file or held in memory.
+ */
+typedef struct
+{
+    const uint8_t *image; // Header followed by the phase table
+    size_t image_size;
+    bool mapped;          // image is a file mapping (munmap), otherwise a heap buffer (free)
+    const uint8_t *phases;
+    uint32_t phase_count;
+    uint32_t phase_stride;
+    int repeat_count;
+    int channel;
+    uint64_t duration_ms; // Length of one play
+} Scenario;
+
+/**
+ * @brief Compiles a text or XML scenario into a binary scenario file.
+ *
+ * Text: optional "repeat=<n>" header, then one "# Phase" line per phase followed by
+ * duration_ms=, channel<c>_voltage<1..3>=, channel<c>_current<1..3>= and optionally
+ * inception_angle_deg= (point-on-wave start), frequency_hz=, rocof_hz_per_s= and phase_jump_deg= lines.
+ * XML: <Scenario repeat="n"><Phase durationMs="..." inceptionAngleDeg="..." frequencyHz="..." rocofHzPerS="..."
+ * phaseJumpDeg="..."><Channel id="c" voltage1="..." ... current3="..."/></Phase></Scenario>.
+ * Unknown keys are errors. The file is written to a temporary name and renamed.
+ *
+ * @param source Text or XML scenario.
+ * @param output Binary scenario file, NULL for source + SCENARIO_BINARY_SUFFIX.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int Scenario_compile(const char *source, const char *output);
+
+/**
+ * @brief Loads a scenario without parsing it when possible.
+ *
+ * A binary scenario is mapped. For a text/XML scenario, the compiled file next to it is mapped when
+ * it is up to date; otherwise the source is compiled, the compiled file is (re)written for the next
+ * load and the scenario is served from memory.
+ *
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int Scenario_load(Scenario *scenario, const char *path);
+
+/**
+ * @brief Releases a loaded scenario, a zeroed Scenario is ignored.
+ */
+void Scenario_unload(Scenario *scenario);
+
+/**
+ * @brief Returns the shared, read-only scenario of a file, loading it only when the cache has no match.
+ *
+ * Scenarios are cached by path + modification time (no file access beyond a stat on a hit) and
+ * by a hash of their compiled content, so instances using identical scenarios share one copy.
+ * Every successful call must be paired with Scenario_release().
+ *
+ * @return The scenario, NULL on error.
+ */
+const Scenario *Scenario_acquire(const char *path);
+
+/**
+ * @brief Takes one more reference to an acquired scenario, to be dropped with Scenario_release().
+ */
+void Scenario_retain(const Scenario *scenario);
+
+/**
+ * @brief Drops a reference returned by Scenario_acquire().
+ *
+ * An unused scenario stays cached (up to SCENARIO_CACHE_MAX_IDLE of them) so that restarting a
+ * simulation does not load it again.
+ */
+void Scenario_release(const Scenario *scenario);
+
+/**
+ * @brief Frees the cached scenarios that are not in use.
+ */
+void Scenario_cache_clear(void);
+
+/**
+ * @brief Phase index (0 .. phase_count - 1) of a loaded scenario.
+ */
+static inline const ScenarioPhase *Scenario_phase(const Scenario *scenario, uint32_t index)
+{
+    return (const ScenarioPhase *)(scenario->phases + (size_t)index * scenario->phase_stride);
+}
+
+/**
+ * @brief Sample number of a time of a scenario: the first sample at or after it.
+ *
+ * The stream sends samples_per_period samples every period_ns. Boundaries are computed from absolute
+ * times with integer arithmetic, so they never drift however long the scenario (exact up to ~146 years
+ * at 2 samples per period).
+ */
+static inline uint64_t Scenario_time_to_sample(uint64_t ms, uint32_t samples_per_period, uint64_t period_ns)
+{
+    return (ms * 1000000ULL * samples_per_period + period_ns - 1) / period_ns;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
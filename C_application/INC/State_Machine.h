@@ -21,6 +21,8 @@ typedef enum {
     STATE_EVENT_start_listening,
     STATE_EVENT_stop_listening,
     STATE_EVENT_send_goose,
+    STATE_EVENT_get_latency, // answered in every state, data may hold "reset": true
+    STATE_EVENT_swap_scenario, // answered while running, data holds "scenarioConfigFile" and optionally "instance"
     STATE_EVENT_NONE
 } state_event_e;
 
@@ -39,8 +41,16 @@ typedef struct state_machine {
 int StateMachine_Launch(int (*shutdown_check_func)(void));
 
 // Function to push events to the state machine (if event_queue is managed internally)
+// requestId and data_obj stay owned by the caller, the queue stores copies
 int StateMachine_push_event(state_event_e event, const char *requestId,cJSON *data_obj);
 
+// Same as StateMachine_push_event() without copies: ownership of requestId (malloc'd) and
+// data_obj (detached cJSON tree) is always transferred, they are freed if the event is dropped
+int StateMachine_post_event(state_event_e event, char *requestId, cJSON *data_obj);
+
+// Async-signal-safe push of an event without request id and data (e.g. from a SIGINT handler)
+int StateMachine_signal_event(state_event_e event);
+
 // Function to signal shutdown and join the state machine thread
 int StateMachine_shutdown(void);
 int verif_shutdown(void);
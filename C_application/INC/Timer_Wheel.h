@@ -0,0 +1,106 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Timer of a TimerWheel, embedded in the structure of its owner.
+ */
+typedef struct TimerWheelEntry
+{
+    struct TimerWheelEntry *next;
+    struct TimerWheelEntry *prev;
+    uint64_t due_ns;   // Requested expiry time (CLOCK_MONOTONIC)
+    uint64_t due_tick; // Tick at which the timer expires
+    bool scheduled;
+} TimerWheelEntry;
+
+/**
+ * @brief Called by TimerWheel_advance() for each expired timer.
+ *
+ * The timer is no longer scheduled when the function is called. The function may schedule or
+ * cancel any timer of the wheel, itself included, even one due in the same tick: a timer
+ * scheduled at a time already due by now_ns expires later in the same TimerWheel_advance() call,
+ * a cancelled timer does not expire.
+ *
+ * @param entry The expired timer.
+ * @param due_ns The requested expiry time, the difference to the current time is the scheduling slip.
+ * @param context The context pointer given to TimerWheel_advance().
+ */
+typedef void (*timer_wheel_expiry_t)(TimerWheelEntry *entry, uint64_t due_ns, void *context);
+
+/**
+ * @brief Hashed timing wheel: scheduling, cancelling and expiring a timer cost O(1)
+ * whatever the number of timers.
+ *
+ * Timers further away than one revolution stay in their slot until their tick is reached.
+ * The wheel is not thread safe.
+ */
+typedef struct
+{
+    TimerWheelEntry *slots; // List heads
+    uint32_t slot_mask;
+    uint64_t tick_ns;
+    uint64_t start_ns;
+    uint64_t current_tick; // Last tick processed
+    uint32_t count;        // Scheduled timers
+} TimerWheel;
+
+/**
+ * @brief Prepares a wheel.
+ *
+ * @param wheel The wheel.
+ * @param slot_count Number of slots, rounded up to a power of two.
+ * @param tick_ns Resolution of the wheel in nanoseconds.
+ * @param start_ns CLOCK_MONOTONIC time of tick 0.
+ * @return SUCCESS (0) on success, FAIL (-1) on error.
+ */
+int TimerWheel_init(TimerWheel *wheel, uint32_t slot_count, uint64_t tick_ns, uint64_t start_ns);
+
+/**
+ * @brief Releases the slots of a wheel, the timers are left untouched.
+ */
+void TimerWheel_destroy(TimerWheel *wheel);
+
+/**
+ * @brief Schedules a timer, a timer already scheduled is moved.
+ *
+ * A timer due before the next tick expires at the next tick.
+ *
+ * @param wheel The wheel.
+ * @param entry The timer.
+ * @param due_ns CLOCK_MONOTONIC expiry time.
+ */
+void TimerWheel_schedule(TimerWheel *wheel, TimerWheelEntry *entry, uint64_t due_ns);
+
+/**
+ * @brief Cancels a timer, nothing happens if it is not scheduled.
+ */
+void TimerWheel_cancel(TimerWheel *wheel, TimerWheelEntry *entry);
+
+/**
+ * @brief Expires every timer due at the current time.
+ *
+ * @param wheel The wheel.
+ * @param now_ns Current CLOCK_MONOTONIC time.
+ * @param expire Function called for each expired timer.
+ * @param context Opaque pointer handed to the function.
+ * @return Number of expired timers.
+ */
+int TimerWheel_advance(TimerWheel *wheel, uint64_t now_ns, timer_wheel_expiry_t expire, void *context);
+
+/**
+ * @brief Returns the CLOCK_MONOTONIC time of the next tick to process.
+ */
+uint64_t TimerWheel_next_tick_ns(const TimerWheel *wheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
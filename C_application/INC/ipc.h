@@ -8,32 +8,34 @@
 /**
  * @brief Initializes the IPC socket module.
  *
- * This function creates a Unix domain socket, sets it to non-blocking mode,
- * and attempts to connect to the specified SOCKET_PATH.
+ * This function creates the epoll reactor, connects to the Node.js backend on
+ * SOCKET_PATH and listens on IPC_LISTEN_PATH for additional controllers (CLI,
+ * metrics scraper). Failing to listen is not fatal.
  *
- * @param event_cb A callback function to be invoked when an incoming IPC message
- * is successfully parsed and mapped to a state machine event.
- * This callback bridges the IPC module to your application's
- * event processing (e.g., pushing to a state machine queue).
- * @return 0 on successful initialization and connection (or connection in progress),
- * -1 on failure (e.g., socket creation failed, failed to set non-blocking,
- * or connection failed for reasons other than EINPROGRESS).
+ * @return 0 on successful initialization and connection,
+ * -1 on failure (e.g., reactor or socket creation failed, or connection failed).
  */
 int ipc_init();
 
 /**
  * @brief Runs the main communication loop for the IPC socket.
  *
- * This function continuously attempts to receive data from the connected Unix
- * domain socket. It operates in a non-blocking manner.
+ * This function waits on the epoll reactor without timeout and serves every
+ * controller connection: incoming requests, newly accepted controllers and the
+ * pending output of connections that could not take a whole response at once.
+ *
+ * Received bytes are framed incrementally (see IPC_Framing.h, mode selected with
+ * IPC_FRAMING_MODE): every complete message in a read is processed, and a partial
+ * message is kept until the rest arrives without rescanning what was already seen.
  *
  * Incoming JSON messages are parsed. Based on the "type" field, a corresponding
  * `state_event_e` is determined. The `requestId` from the "data" field (if present)
  * is also extracted. These are then passed to the `ipc_event_callback_t`
  * provided during initialization.
  *
- * The loop continues until `ipc_shutdown()` is called or a fatal
- * error occurs during reception.
+ * The loop continues until `ipc_shutdown()` is called, the shutdown check
+ * reports a shutdown (see `ipc_wakeup()`), the Node.js backend disconnects or a
+ * fatal error occurs during reception.
  *
  * @param shutdown_check_func A function pointer to a function that returns 1 if
  * the main application loop should shut down, 0 otherwise. This allows the IPC
@@ -52,15 +54,35 @@ int ipc_run_loop(int (*shutdown_check_func)(void));
 int ipc_shutdown(void);
 
 /**
- * @brief Sends a JSON response string back to the connected client.
+ * @brief Sends a JSON response string to the Node.js backend.
  *
- * This function is typically called by the application's event handler (the
- * `ipc_event_callback_t`) after processing an incoming request, to send
- * acknowledgement or results back to the client. It includes a simulated delay.
+ * Same as `ipc_send_reply(NULL, response_json)`.
  *
  * @param response_json A null-terminated C string containing the JSON response.
  * @return 0 on success, -1 on failure (e.g., socket not initialized, send error).
  */
 int ipc_send_response(const char *response_json);
 
+/**
+ * @brief Sends a JSON response string to the controller that sent a request.
+ *
+ * The response is queued on the connection the request with this `requestId` came
+ * from (the Node.js backend when unknown or NULL) and written without blocking:
+ * what the socket does not accept right away is written by the reactor when the
+ * connection becomes writable. Can be called from any thread.
+ *
+ * @param requestId The requestId of the request being answered, or NULL.
+ * @param response_json A null-terminated C string containing the JSON response.
+ * @return 0 on success, -1 on failure (no connection, connection stuck, send error).
+ */
+int ipc_send_reply(const char *requestId, const char *response_json);
+
+/**
+ * @brief Wakes up `ipc_run_loop()` so that it re-evaluates the shutdown flags.
+ *
+ * Must be called after requesting a shutdown from outside the IPC module.
+ * Async-signal-safe.
+ */
+void ipc_wakeup(void);
+
 #endif 
\ No newline at end of file
@@ -35,7 +35,9 @@ typedef struct {
 typedef void (*log_output_handler_t)(const log_entry_t* entry);
 
 // --- Core Logger Functions ---
-// These functions will have stub implementations in release mode
+// Log calls only copy a binary record (format pointer, raw arguments, TSC timestamp) into a
+// per-thread lock-free ring; a background drain thread formats the records and calls the
+// output handler. Module names and formats must be string literals, %s arguments are copied.
 
 // Initialize the logger
 bool logger_init(size_t buffer_size, uint8_t flush_threshold);
@@ -54,34 +56,37 @@ void logger_shutdown(void);
 
 // --- Conditional Logging Macros ---
 
+// Internal function prototype
+void logger_log(log_level_t level, const char* module, const char* file, uint32_t line, const char* format, ...);
+
+// Helper macro for logging error_info_t
+#define LOG_ERROR_CODE(module, error_info) do { \
+    char _err_msg[256]; \
+    snprintf(_err_msg, sizeof(_err_msg), "Error Code %d: %s", \
+            (error_info).code, \
+            (error_info).description ? (error_info).description : "(no description)"); \
+    logger_log(LOG_LEVEL_ERROR, module, __FILE__, __LINE__, "%s", _err_msg); \
+} while(0)
+
+// Warnings and errors are recorded in every build
+#define LOG_ERROR(module, ...) logger_log(LOG_LEVEL_ERROR, module, __FILE__, __LINE__, __VA_ARGS__)
+#define LOG_WARN(module, ...)  logger_log(LOG_LEVEL_WARN, module, __FILE__, __LINE__, __VA_ARGS__)
+
 #ifdef DEBUG
-    // Internal function prototype
-    void logger_log(log_level_t level, const char* module, const char* file, uint32_t line, const char* format, ...);
+    #define LOGGER_DEFAULT_LEVEL LOG_LEVEL_INFO
 
     // Logging macros with variadic arguments
-    #define LOG_ERROR(module, ...) logger_log(LOG_LEVEL_ERROR, module, __FILE__, __LINE__, __VA_ARGS__)
-    #define LOG_WARN(module, ...)  logger_log(LOG_LEVEL_WARN, module, __FILE__, __LINE__, __VA_ARGS__)
     #define LOG_INFO(module, ...)  logger_log(LOG_LEVEL_INFO, module, __FILE__, __LINE__, __VA_ARGS__)
     #define LOG_DEBUG(module, ...) logger_log(LOG_LEVEL_DEBUG, module, __FILE__, __LINE__, __VA_ARGS__)
     #define LOG_TRACE(module, ...) logger_log(LOG_LEVEL_TRACE, module, __FILE__, __LINE__, __VA_ARGS__)
 
-    // Helper macro for logging error_info_t
-    #define LOG_ERROR_CODE(module, error_info) do { \
-        char _err_msg[256]; \
-        snprintf(_err_msg, sizeof(_err_msg), "Error Code %d: %s", \
-                (error_info).code, \
-                (error_info).description ? (error_info).description : "(no description)"); \
-        logger_log(LOG_LEVEL_ERROR, module, __FILE__, __LINE__, "%s", _err_msg); \
-    } while(0)
-
 #else // NOT DEBUG
-    // Logging macros - expand to nothing in release mode
-    #define LOG_ERROR(module, ...) ((void)0)
-    #define LOG_WARN(module, ...)  ((void)0)
+    #define LOGGER_DEFAULT_LEVEL LOG_LEVEL_WARN
+
+    // Verbose logging macros - expand to nothing in release mode
     #define LOG_INFO(module, ...)  ((void)0)
     #define LOG_DEBUG(module, ...) ((void)0)
     #define LOG_TRACE(module, ...) ((void)0)
-    #define LOG_ERROR_CODE(module, error_info) ((void)0)
 #endif // DEBUG
 
 #endif // LOGGER_H
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define PARSER_H
 
 #include <stdbool.h> // For bool type
+#include <stddef.h> // For size_t
 #include <cjson/cJSON.h> // For cJSON parsing
 
 
@@ -12,6 +13,7 @@ typedef struct {
     char *svInterface;
     char *scenarioConfigFile;
     char *svIDs;
+    int txTimeLeadUs; // optional: frames handed to the kernel this long ahead with a launch time (SO_TXTIME), 0 = off
     
     char* GoCBRef; // Reference to the GOOSE Control Block
     char* DatSet;  // Data Set reference
@@ -63,6 +65,23 @@ int parseRequestConfig(
     char** requestId,
     cJSON** json_request_out // Added to return the root cJSON object
 );
+
+/**
+ * @brief Same as parseRequestConfig() for a message that is not NUL-terminated
+ * (e.g. a message framed in place inside a receive buffer).
+ *
+ * @param buffer The JSON message.
+ * @param length Length of the JSON message in bytes.
+ * @return SUCCESS (0) on successful parsing and data extraction, FAIL (-1) on error.
+ */
+int parseRequestConfigWithLength(
+    const char* buffer,
+    size_t length,
+    cJSON** type_obj,
+    cJSON** data_obj,
+    char** requestId,
+    cJSON** json_request_out
+);
 int parseGOOSEConfig(
     cJSON** data_obj,
     GOOSE_SimulationConfig* config
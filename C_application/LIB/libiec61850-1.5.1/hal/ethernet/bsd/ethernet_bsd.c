@@ -418,6 +418,118 @@ Ethernet_sendPacket(EthernetSocket self, uint8_t* buffer, int packetSize)
     write(self->bpf, buffer, packetSize);
 }
 
+int
+Ethernet_sendPackets(EthernetSocket self, uint8_t** buffers, int* packetSizes, int packetCount)
+{
+    int i;
+
+    /* BPF has no batched write - send one packet after the other. */
+    for (i = 0; i < packetCount; i++) {
+        if (write(self->bpf, buffers[i], packetSizes[i]) == -1)
+            return (i > 0) ? i : -1;
+    }
+
+    return packetCount;
+}
+
+bool
+Ethernet_enableTxRing(EthernetSocket self, int maxFrameSize, int frameCount)
+{
+    return false;
+}
+
+bool
+Ethernet_setFrameFilter(EthernetSocket self, const uint16_t* etherTypes, int etherTypeCount,
+        const uint16_t* appIds, int appIdCount, const uint8_t* dstAddrs, int dstAddrCount)
+{
+    return false;
+}
+
+bool
+Ethernet_setIgnoreOutgoing(EthernetSocket self, bool ignore)
+{
+    return false;
+}
+
+bool
+Ethernet_enableRxRing(EthernetSocket self, int blockSize, int blockCount, int blockTimeoutMs)
+{
+    return false;
+}
+
+int
+Ethernet_receivePackets(EthernetSocket self, uint8_t* buffer, int bufferSize, EthernetFrameHandler handler, void* parameter)
+{
+    int packetSize = Ethernet_receivePacket(self, buffer, bufferSize);
+
+    if (packetSize > 0) {
+        handler(parameter, buffer, packetSize);
+        return 1;
+    }
+
+    return 0;
+}
+
+bool
+Ethernet_enableRxTimestamps(EthernetSocket self)
+{
+    return false;
+}
+
+uint64_t
+Ethernet_getRxTimestamp(EthernetSocket self)
+{
+    return 0;
+}
+
+bool
+Ethernet_enableTxTimestamps(EthernetSocket self)
+{
+    return false;
+}
+
+void
+Ethernet_sendPacketTimestamped(EthernetSocket self, uint8_t* buffer, int packetSize)
+{
+    Ethernet_sendPacket(self, buffer, packetSize);
+}
+
+bool
+Ethernet_getTxTimestamp(EthernetSocket self, uint64_t* timestampNs)
+{
+    return false;
+}
+
+bool
+Ethernet_enableTxTime(EthernetSocket self, int clockId)
+{
+    return false;
+}
+
+void
+Ethernet_sendPacketAt(EthernetSocket self, uint8_t* buffer, int packetSize, uint64_t launchTimeNs)
+{
+    Ethernet_sendPacket(self, buffer, packetSize);
+}
+
+int
+Ethernet_sendPacketsAt(EthernetSocket self, uint8_t** buffers, int* packetSizes, const uint64_t* launchTimesNs, int packetCount)
+{
+    return Ethernet_sendPackets(self, buffers, packetSizes, packetCount);
+}
+
+uint64_t
+Ethernet_getTxTimeErrors(EthernetSocket self)
+{
+    return 0;
+}
+
+int
+Ethernet_getSocketFd(EthernetSocket self)
+{
+    return self->bpf;
+}
+
 void
 Ethernet_destroySocket(EthernetSocket self)
 {
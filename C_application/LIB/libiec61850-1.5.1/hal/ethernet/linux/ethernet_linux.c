@@ -21,16 +21,21 @@
  *  See COPYING file for the complete license text.
  */
 
+#define _GNU_SOURCE
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <poll.h>
 #include <linux/filter.h>
 #include <linux/if_packet.h>
 #include <linux/if_ether.h>
 #include <linux/if_arp.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <errno.h>
 
 #include <string.h>
 
@@ -41,10 +46,59 @@
 #define DEBUG_SOCKET 0
 #endif
 
+/* maximum number of messages passed to a single sendmmsg call */
+#define ETHERNET_MAX_SEND_BATCH 64
+
+/* maximum number of APPIDs/destination addresses checked by the kernel frame filter */
+#define ETHERNET_FILTER_MAX_VALUES 256
+
+#ifndef PACKET_IGNORE_OUTGOING
+#define PACKET_IGNORE_OUTGOING 23
+#endif
+
+#ifndef SO_TXTIME
+#define SO_TXTIME 61
+#define SCM_TXTIME SO_TXTIME
+#endif
+
+#ifndef SO_EE_ORIGIN_TXTIME
+#define SO_EE_ORIGIN_TXTIME 6
+#endif
+
+struct sEthernetTxRing {
+    uint8_t* ring;
+    size_t ringSize;
+    unsigned int blockSize;
+    unsigned int frameSize;
+    unsigned int framesPerBlock;
+    unsigned int frameCount;
+    unsigned int maxDataSize;
+    unsigned int nextFrame;
+};
+
+/* frame slot size announced to the kernel - only used to size the TPACKET_V3 ring */
+#define ETHERNET_RX_RING_FRAME_SIZE 2048
+
+struct sEthernetRxRing {
+    uint8_t* ring;
+    size_t ringSize;
+    unsigned int blockSize;
+    unsigned int blockCount;
+    unsigned int currentBlock;
+};
+
 struct sEthernetSocket {
     int rawSocket;
     bool isBind;
     struct sockaddr_ll socketAddress;
+    struct sEthernetTxRing* txRing;
+    struct sEthernetRxRing* rxRing;
+    bool rxTimestamps;
+    bool txTimestamps;
+    uint64_t rxTimestamp; /* kernel timestamp of the frame being handled */
+    uint64_t txTimestamp; /* transmit timestamp drained from the error queue, not fetched yet */
+    bool txTime;          /* frames sent with a launch time (SO_TXTIME) */
+    uint64_t txTimeErrors; /* frames dropped by the qdisc because of their launch time */
 };
 
 struct sEthernetHandleSet {
@@ -223,28 +277,142 @@ Ethernet_createSocket(const char* interfaceId, uint8_t* destAddress)
     return ethernetSocket;
 }
 
+static int
+filter_emit(struct sock_filter* program, int pos, uint16_t code, uint8_t jt, uint8_t jf, uint32_t k)
+{
+    program[pos].code = code;
+    program[pos].jt = jt;
+    program[pos].jf = jf;
+    program[pos].k = k;
+
+    return pos + 1;
+}
+
+/* unconditional jump from the instruction at pos to target */
+static int
+filter_emitJump(struct sock_filter* program, int pos, int target)
+{
+    return filter_emit(program, pos, BPF_JMP | BPF_JA, 0, 0, target - (pos + 1));
+}
+
+bool
+Ethernet_setFrameFilter(EthernetSocket self, const uint16_t* etherTypes, int etherTypeCount,
+        const uint16_t* appIds, int appIdCount, const uint8_t* dstAddrs, int dstAddrCount)
+{
+    if ((etherTypeCount < 0) || (etherTypeCount > ETHERNET_FILTER_MAX_VALUES))
+        return false;
+
+    /* too many values for a linear check - leave that part to the user space */
+    if ((appIds == NULL) || (appIdCount > ETHERNET_FILTER_MAX_VALUES))
+        appIdCount = 0;
+
+    if ((dstAddrs == NULL) || (dstAddrCount > ETHERNET_FILTER_MAX_VALUES))
+        dstAddrCount = 0;
+
+    /* each value is a "jeq value, 0, 1" followed by a jump to the next stage */
+    int etherTypeStage = 6;
+    int appIdStage = etherTypeStage + (2 * etherTypeCount) + 1;
+    int dstAddrStage = appIdStage + ((appIdCount > 0) ? (1 + (2 * appIdCount) + 1) : 0);
+    int acceptLabel = dstAddrStage + ((dstAddrCount > 0) ? ((5 * dstAddrCount) + 1) : 0);
+    int programLength = acceptLabel + 1;
+
+    struct sock_filter* program = (struct sock_filter*) GLOBAL_MALLOC(programLength * sizeof(struct sock_filter));
+
+    if (program == NULL)
+        return false;
+
+    int pos = 0;
+    int i;
+
+    if (etherTypeCount == 0) {
+        /* transmit only socket */
+        pos = filter_emit(program, pos, BPF_RET | BPF_K, 0, 0, 0);
+    }
+    else {
+        /* X := 4 when the frame carries an IEEE 802.1Q tag that has not been removed by the NIC */
+        pos = filter_emit(program, pos, BPF_LD | BPF_H | BPF_ABS, 0, 0, 12);
+        pos = filter_emit(program, pos, BPF_JMP | BPF_JEQ | BPF_K, 0, 2, 0x8100);
+        pos = filter_emit(program, pos, BPF_LDX | BPF_W | BPF_IMM, 0, 0, 4);
+        pos = filter_emitJump(program, pos, pos + 2);
+        pos = filter_emit(program, pos, BPF_LDX | BPF_W | BPF_IMM, 0, 0, 0);
+
+        pos = filter_emit(program, pos, BPF_LD | BPF_H | BPF_IND, 0, 0, 12);
+
+        for (i = 0; i < etherTypeCount; i++) {
+            pos = filter_emit(program, pos, BPF_JMP | BPF_JEQ | BPF_K, 0, 1, etherTypes[i]);
+            pos = filter_emitJump(program, pos, appIdStage);
+        }
+
+        pos = filter_emit(program, pos, BPF_RET | BPF_K, 0, 0, 0);
+
+        if (appIdCount > 0) {
+            pos = filter_emit(program, pos, BPF_LD | BPF_H | BPF_IND, 0, 0, 14);
+
+            for (i = 0; i < appIdCount; i++) {
+                pos = filter_emit(program, pos, BPF_JMP | BPF_JEQ | BPF_K, 0, 1, appIds[i]);
+                pos = filter_emitJump(program, pos, dstAddrStage);
+            }
+
+            pos = filter_emit(program, pos, BPF_RET | BPF_K, 0, 0, 0);
+        }
+
+        if (dstAddrCount > 0) {
+            for (i = 0; i < dstAddrCount; i++) {
+                const uint8_t* addr = dstAddrs + (6 * i);
+
+                uint32_t high = ((uint32_t) addr[0] << 24) | ((uint32_t) addr[1] << 16) | ((uint32_t) addr[2] << 8) | addr[3];
+                uint32_t low = ((uint32_t) addr[4] << 8) | addr[5];
+
+                pos = filter_emit(program, pos, BPF_LD | BPF_W | BPF_ABS, 0, 0, 0);
+                pos = filter_emit(program, pos, BPF_JMP | BPF_JEQ | BPF_K, 0, 3, high);
+                pos = filter_emit(program, pos, BPF_LD | BPF_H | BPF_ABS, 0, 0, 4);
+                pos = filter_emit(program, pos, BPF_JMP | BPF_JEQ | BPF_K, 0, 1, low);
+                pos = filter_emitJump(program, pos, acceptLabel);
+            }
+
+            pos = filter_emit(program, pos, BPF_RET | BPF_K, 0, 0, 0);
+        }
+
+        pos = filter_emit(program, pos, BPF_RET | BPF_K, 0, 0, 0x00040000);
+    }
+
+    struct sock_fprog fprog;
+
+    fprog.len = pos;
+    fprog.filter = program;
+
+    /* replaces the previous filter atomically */
+    bool result = (setsockopt(self->rawSocket, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) == 0);
+
+    if ((result == false) && DEBUG_SOCKET)
+        printf("ETHERNET_LINUX: Applying filter failed\n");
+
+    GLOBAL_FREEMEM(program);
+
+    return result;
+}
+
+bool
+Ethernet_setIgnoreOutgoing(EthernetSocket self, bool ignore)
+{
+    int value = ignore ? 1 : 0;
+
+    if (setsockopt(self->rawSocket, SOL_PACKET, PACKET_IGNORE_OUTGOING, &value, sizeof(value)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: PACKET_IGNORE_OUTGOING not supported\n");
+        return false;
+    }
+
+    return true;
+}
+
 void
 Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType)
 {
     if (etherType == 0x88b8)
     {
         /* enable linux kernel filtering for GOOSE */
-
-        struct sock_fprog fprog;
-        struct sock_filter filter[] = {
-            /* sudo tcpdump -i enx88d7f6377223 '(ether proto 0x88b8)' -dd */
-            { 0x28, 0, 0, 0x0000000c },
-            { 0x15, 0, 1, 0x000088b8 },
-            { 0x6, 0, 0, 0x00040000 },
-            { 0x6, 0, 0, 0x00000000 }
-        };
-
-        fprog.len = sizeof(filter) / sizeof(*filter);
-        fprog.filter = filter;
-
-        if (setsockopt(ethSocket->rawSocket, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) == -1)
-            if (DEBUG_SOCKET)
-                printf("ETHERNET_LINUX: Applying filter failed");
+        Ethernet_setFrameFilter(ethSocket, &etherType, 1, NULL, 0, NULL, 0);
     }
     else
     {
@@ -253,34 +421,702 @@ Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType)
 }
 
 
-/* non-blocking receive */
-int
-Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize)
+static bool
+bindSocket(EthernetSocket self)
 {
     if (self->isBind == false) {
         if (bind(self->rawSocket, (struct sockaddr*) &self->socketAddress, sizeof(self->socketAddress)) == 0)
             self->isBind = true;
-        else
-            return 0;
     }
 
+    return self->isBind;
+}
+
+/* non-blocking receive */
+int
+Ethernet_receivePacket(EthernetSocket self, uint8_t* buffer, int bufferSize)
+{
+    if (bindSocket(self) == false)
+        return 0;
+
     return recvfrom(self->rawSocket, buffer, bufferSize, MSG_DONTWAIT, 0, 0);
 }
 
+static void
+rxRing_destroy(EthernetSocket self)
+{
+    if (self->rxRing) {
+        munmap(self->rxRing->ring, self->rxRing->ringSize);
+        GLOBAL_FREEMEM(self->rxRing);
+        self->rxRing = NULL;
+    }
+}
+
+bool
+Ethernet_enableRxRing(EthernetSocket self, int blockSize, int blockCount, int blockTimeoutMs)
+{
+    if ((self == NULL) || (blockSize <= 0) || (blockCount <= 0))
+        return false;
+
+    if (self->rxRing)
+        return true;
+
+    /* the ring version is a socket option - it cannot be combined with the TPACKET_V2 transmit ring */
+    if (self->txRing)
+        return false;
+
+    /* frames must only enter the ring from the selected interface */
+    if (bindSocket(self) == false) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to bind socket for PACKET_RX_RING\n");
+        return false;
+    }
+
+    int version = TPACKET_V3;
+
+    if (setsockopt(self->rawSocket, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to select TPACKET_V3\n");
+        return false;
+    }
+
+    /* blocks are allocated by the kernel with a power of two number of pages */
+    unsigned int ringBlockSize = getpagesize();
+
+    while ((ringBlockSize < (unsigned int) blockSize) || (ringBlockSize < ETHERNET_RX_RING_FRAME_SIZE))
+        ringBlockSize <<= 1;
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+
+    req.tp_block_size = ringBlockSize;
+    req.tp_block_nr = blockCount;
+    req.tp_frame_size = ETHERNET_RX_RING_FRAME_SIZE;
+    req.tp_frame_nr = (ringBlockSize / ETHERNET_RX_RING_FRAME_SIZE) * blockCount;
+    req.tp_retire_blk_tov = (blockTimeoutMs > 0) ? blockTimeoutMs : 1;
+
+    if (setsockopt(self->rawSocket, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to create PACKET_RX_RING\n");
+        return false;
+    }
+
+    size_t ringSize = (size_t) ringBlockSize * blockCount;
+
+    uint8_t* ring = (uint8_t*) mmap(NULL, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, self->rawSocket, 0);
+
+    if (ring == MAP_FAILED) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to map PACKET_RX_RING\n");
+        return false;
+    }
+
+    struct sEthernetRxRing* rxRing = (struct sEthernetRxRing*) GLOBAL_CALLOC(1, sizeof(struct sEthernetRxRing));
+
+    if (rxRing == NULL) {
+        munmap(ring, ringSize);
+        return false;
+    }
+
+    rxRing->ring = ring;
+    rxRing->ringSize = ringSize;
+    rxRing->blockSize = ringBlockSize;
+    rxRing->blockCount = blockCount;
+    rxRing->currentBlock = 0;
+
+    self->rxRing = rxRing;
+
+    return true;
+}
+
+/* timestamp of a SCM_TIMESTAMPING control message, 0 if the message has none */
+static uint64_t
+getCmsgTimestamp(struct msghdr* msg)
+{
+    struct cmsghdr* cmsg;
+
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPING)) {
+            struct scm_timestamping* ts = (struct scm_timestamping*) CMSG_DATA(cmsg);
+
+            /* ts[0] is the software timestamp */
+            return (uint64_t) ts->ts[0].tv_sec * 1000000000ULL + ts->ts[0].tv_nsec;
+        }
+    }
+
+    return 0;
+}
+
+/* non-blocking receive that also fetches the kernel receive timestamp */
+static int
+receivePacketTimestamped(EthernetSocket self, uint8_t* buffer, int bufferSize)
+{
+    if (bindSocket(self) == false)
+        return 0;
+
+    char control[CMSG_SPACE(sizeof(struct scm_timestamping))];
+    struct iovec iov;
+    struct msghdr msg;
+
+    iov.iov_base = buffer;
+    iov.iov_len = bufferSize;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    int packetSize = recvmsg(self->rawSocket, &msg, MSG_DONTWAIT);
+
+    self->rxTimestamp = (packetSize > 0) ? getCmsgTimestamp(&msg) : 0;
+
+    return packetSize;
+}
+
+int
+Ethernet_receivePackets(EthernetSocket self, uint8_t* buffer, int bufferSize, EthernetFrameHandler handler, void* parameter)
+{
+    struct sEthernetRxRing* rxRing = self->rxRing;
+
+    if (rxRing == NULL) {
+        int packetSize;
+
+        if (self->rxTimestamps)
+            packetSize = receivePacketTimestamped(self, buffer, bufferSize);
+        else
+            packetSize = Ethernet_receivePacket(self, buffer, bufferSize);
+
+        if (packetSize > 0) {
+            handler(parameter, buffer, packetSize);
+            return 1;
+        }
+
+        if ((packetSize == -1) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+            return -1;
+
+        return 0;
+    }
+
+    int frames = 0;
+    unsigned int blocks;
+
+    /* visit each block at most once per call */
+    for (blocks = 0; blocks < rxRing->blockCount; blocks++) {
+        struct tpacket_block_desc* block = (struct tpacket_block_desc*) (rxRing->ring + ((size_t) rxRing->currentBlock * rxRing->blockSize));
+
+        if ((__atomic_load_n(&(block->hdr.bh1.block_status), __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+            break;
+
+        uint32_t packetCount = block->hdr.bh1.num_pkts;
+        struct tpacket3_hdr* hdr = (struct tpacket3_hdr*) ((uint8_t*) block + block->hdr.bh1.offset_to_first_pkt);
+        uint32_t i;
+
+        for (i = 0; i < packetCount; i++) {
+            /* without a timestamp source the kernel fills in a coarse clock - not usable */
+            if (hdr->tp_status & (TP_STATUS_TS_SOFTWARE | TP_STATUS_TS_RAW_HARDWARE))
+                self->rxTimestamp = (uint64_t) hdr->tp_sec * 1000000000ULL + hdr->tp_nsec;
+            else
+                self->rxTimestamp = 0;
+
+            handler(parameter, (uint8_t*) hdr + hdr->tp_mac, hdr->tp_snaplen);
+            frames++;
+
+            hdr = (struct tpacket3_hdr*) ((uint8_t*) hdr + hdr->tp_next_offset);
+        }
+
+        /* hand the whole block back to the kernel */
+        __atomic_store_n(&(block->hdr.bh1.block_status), TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+
+        rxRing->currentBlock = (rxRing->currentBlock + 1) % rxRing->blockCount;
+    }
+
+    return frames;
+}
+
+static struct tpacket2_hdr*
+txRing_getFrame(struct sEthernetTxRing* txRing, unsigned int frameIndex)
+{
+    unsigned int block = frameIndex / txRing->framesPerBlock;
+    unsigned int offset = (frameIndex % txRing->framesPerBlock) * txRing->frameSize;
+
+    return (struct tpacket2_hdr*) (txRing->ring + (block * txRing->blockSize) + offset);
+}
+
+/* copy a frame into the next free ring slot - returns false when the ring is full */
+static bool
+txRing_queueFrame(struct sEthernetTxRing* txRing, uint8_t* buffer, int packetSize)
+{
+    if ((packetSize < 0) || ((unsigned int) packetSize > txRing->maxDataSize))
+        return false;
+
+    struct tpacket2_hdr* hdr = txRing_getFrame(txRing, txRing->nextFrame);
+
+    uint32_t status = __atomic_load_n(&(hdr->tp_status), __ATOMIC_ACQUIRE);
+
+    if (status & TP_STATUS_WRONG_FORMAT) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: TX ring rejected frame (wrong format)\n");
+    }
+    else if (status != TP_STATUS_AVAILABLE) {
+        return false;
+    }
+
+    uint8_t* data = (uint8_t*) hdr + TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
+
+    memcpy(data, buffer, packetSize);
+    hdr->tp_len = packetSize;
+
+    __atomic_store_n(&(hdr->tp_status), TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+    txRing->nextFrame = (txRing->nextFrame + 1) % txRing->frameCount;
+
+    return true;
+}
+
+static int
+txRing_flush(EthernetSocket self)
+{
+    return sendto(self->rawSocket, NULL, 0, 0,
+            (struct sockaddr*) &(self->socketAddress), sizeof(self->socketAddress));
+}
+
+static void
+txRing_destroy(EthernetSocket self)
+{
+    if (self->txRing) {
+        munmap(self->txRing->ring, self->txRing->ringSize);
+        GLOBAL_FREEMEM(self->txRing);
+        self->txRing = NULL;
+    }
+}
+
+bool
+Ethernet_enableTxRing(EthernetSocket self, int maxFrameSize, int frameCount)
+{
+    if ((self == NULL) || (maxFrameSize <= 0) || (frameCount <= 0))
+        return false;
+
+    if (self->txRing)
+        return true;
+
+    /* ring frames carry no control message, so no launch time */
+    if (self->txTime)
+        return false;
+
+    int version = TPACKET_V2;
+
+    if (setsockopt(self->rawSocket, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to select TPACKET_V2\n");
+        return false;
+    }
+
+    unsigned int frameSize = TPACKET_ALIGN(TPACKET2_HDRLEN + maxFrameSize);
+    unsigned int blockSize = getpagesize();
+
+    while (blockSize < frameSize)
+        blockSize <<= 1;
+
+    unsigned int framesPerBlock = blockSize / frameSize;
+    unsigned int blockCount = (frameCount + framesPerBlock - 1) / framesPerBlock;
+
+    struct tpacket_req req;
+    req.tp_block_size = blockSize;
+    req.tp_block_nr = blockCount;
+    req.tp_frame_size = frameSize;
+    req.tp_frame_nr = blockCount * framesPerBlock;
+
+    if (setsockopt(self->rawSocket, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to create PACKET_TX_RING\n");
+        return false;
+    }
+
+    size_t ringSize = (size_t) blockSize * blockCount;
+
+    uint8_t* ring = (uint8_t*) mmap(NULL, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, self->rawSocket, 0);
+
+    if (ring == MAP_FAILED) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to map PACKET_TX_RING\n");
+        return false;
+    }
+
+    struct sEthernetTxRing* txRing = (struct sEthernetTxRing*) GLOBAL_CALLOC(1, sizeof(struct sEthernetTxRing));
+
+    if (txRing == NULL) {
+        munmap(ring, ringSize);
+        return false;
+    }
+
+    txRing->ring = ring;
+    txRing->ringSize = ringSize;
+    txRing->blockSize = blockSize;
+    txRing->frameSize = frameSize;
+    txRing->framesPerBlock = framesPerBlock;
+    txRing->frameCount = blockCount * framesPerBlock;
+    txRing->maxDataSize = frameSize - (TPACKET2_HDRLEN - sizeof(struct sockaddr_ll));
+    txRing->nextFrame = 0;
+
+    self->txRing = txRing;
+
+    return true;
+}
+
 void
 Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
 {
+    if (ethSocket->txRing) {
+        if (txRing_queueFrame(ethSocket->txRing, buffer, packetSize))
+            txRing_flush(ethSocket);
+        else if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: TX ring full - frame dropped\n");
+
+        return;
+    }
+
     sendto(ethSocket->rawSocket, buffer, packetSize,
                 0, (struct sockaddr*) &(ethSocket->socketAddress), sizeof(ethSocket->socketAddress));
 }
 
+int
+Ethernet_sendPackets(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, int packetCount)
+{
+    if ((ethSocket == NULL) || (packetCount < 0))
+        return -1;
+
+    int sentPackets = 0;
+
+    if (ethSocket->txRing) {
+        while (sentPackets < packetCount) {
+            if (txRing_queueFrame(ethSocket->txRing, buffers[sentPackets], packetSizes[sentPackets]) == false) {
+
+                /* ring full - let the kernel drain what is queued and retry once */
+                if (txRing_flush(ethSocket) == -1)
+                    break;
+
+                if (txRing_queueFrame(ethSocket->txRing, buffers[sentPackets], packetSizes[sentPackets]) == false)
+                    break;
+            }
+
+            sentPackets++;
+        }
+
+        if ((sentPackets > 0) && (txRing_flush(ethSocket) == -1))
+            return -1;
+
+        return sentPackets;
+    }
+
+    struct mmsghdr msgs[ETHERNET_MAX_SEND_BATCH];
+    struct iovec iovecs[ETHERNET_MAX_SEND_BATCH];
+
+    while (sentPackets < packetCount) {
+        int batchSize = packetCount - sentPackets;
+
+        if (batchSize > ETHERNET_MAX_SEND_BATCH)
+            batchSize = ETHERNET_MAX_SEND_BATCH;
+
+        int i;
+
+        for (i = 0; i < batchSize; i++) {
+            iovecs[i].iov_base = buffers[sentPackets + i];
+            iovecs[i].iov_len = packetSizes[sentPackets + i];
+
+            memset(&msgs[i], 0, sizeof(struct mmsghdr));
+            msgs[i].msg_hdr.msg_name = &(ethSocket->socketAddress);
+            msgs[i].msg_hdr.msg_namelen = sizeof(ethSocket->socketAddress);
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int result = sendmmsg(ethSocket->rawSocket, msgs, batchSize, 0);
+
+        if (result <= 0) {
+            if (DEBUG_SOCKET)
+                printf("ETHERNET_LINUX: sendmmsg failed\n");
+
+            return (sentPackets > 0) ? sentPackets : -1;
+        }
+
+        sentPackets += result;
+    }
+
+    return sentPackets;
+}
+
+bool
+Ethernet_enableRxTimestamps(EthernetSocket self)
+{
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+
+    if (self->txTimestamps)
+        flags |= SOF_TIMESTAMPING_OPT_TSONLY;
+
+    if (setsockopt(self->rawSocket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to enable receive timestamps\n");
+        return false;
+    }
+
+    self->rxTimestamps = true;
+
+    return true;
+}
+
+uint64_t
+Ethernet_getRxTimestamp(EthernetSocket self)
+{
+    return self->rxTimestamp;
+}
+
+bool
+Ethernet_enableTxTimestamps(EthernetSocket self)
+{
+    /* only the reporting flags - the frames to timestamp are selected with a control message */
+    int flags = SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_TSONLY;
+
+    if (self->rxTimestamps)
+        flags |= SOF_TIMESTAMPING_RX_SOFTWARE;
+
+    if (setsockopt(self->rawSocket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to enable transmit timestamps\n");
+        return false;
+    }
+
+    self->txTimestamps = true;
+
+    return true;
+}
+
+void
+Ethernet_sendPacketTimestamped(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
+{
+    if ((ethSocket->txTimestamps == false) || ethSocket->txRing) {
+        Ethernet_sendPacket(ethSocket, buffer, packetSize);
+        return;
+    }
+
+    char control[CMSG_SPACE(sizeof(uint32_t))];
+    struct iovec iov;
+    struct msghdr msg;
+
+    iov.iov_base = buffer;
+    iov.iov_len = packetSize;
+
+    memset(control, 0, sizeof(control));
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &(ethSocket->socketAddress);
+    msg.msg_namelen = sizeof(ethSocket->socketAddress);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SO_TIMESTAMPING;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint32_t));
+    *((uint32_t*) CMSG_DATA(cmsg)) = SOF_TIMESTAMPING_TX_SOFTWARE;
+
+    if ((sendmsg(ethSocket->rawSocket, &msg, 0) == -1) && DEBUG_SOCKET)
+        printf("ETHERNET_LINUX: Failed to send timestamped frame\n");
+}
+
+/* count the frames the launch time qdisc reported as dropped (missed or invalid launch time) */
+static void
+countTxTimeErrors(EthernetSocket self, struct msghdr* msg)
+{
+    struct cmsghdr* cmsg;
+
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if ((cmsg->cmsg_level == SOL_PACKET) && (cmsg->cmsg_type == PACKET_TX_TIMESTAMP)) {
+            struct sock_extended_err* err = (struct sock_extended_err*) CMSG_DATA(cmsg);
+
+            if (err->ee_origin == SO_EE_ORIGIN_TXTIME)
+                self->txTimeErrors++;
+        }
+    }
+}
+
+/* drain the error queue, keeps the last transmit timestamp found for Ethernet_getTxTimestamp */
+static void
+drainErrorQueue(EthernetSocket self)
+{
+    for (;;) {
+        char control[512];
+        struct msghdr msg;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(self->rawSocket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1)
+            break;
+
+        uint64_t timestamp = getCmsgTimestamp(&msg);
+
+        if (timestamp != 0)
+            self->txTimestamp = timestamp;
+
+        if (self->txTime)
+            countTxTimeErrors(self, &msg);
+    }
+}
+
+bool
+Ethernet_getTxTimestamp(EthernetSocket ethSocket, uint64_t* timestampNs)
+{
+    /* the last timestamp belongs to the last timestamped frame */
+    drainErrorQueue(ethSocket);
+
+    if (ethSocket->txTimestamp == 0)
+        return false;
+
+    *timestampNs = ethSocket->txTimestamp;
+    ethSocket->txTimestamp = 0;
+
+    return true;
+}
+
+bool
+Ethernet_enableTxTime(EthernetSocket self, int clockId)
+{
+    if (self->txRing)
+        return false;
+
+    struct sock_txtime txTime;
+
+    txTime.clockid = clockId;
+    txTime.flags = SOF_TXTIME_REPORT_ERRORS;
+
+    if (setsockopt(self->rawSocket, SOL_SOCKET, SO_TXTIME, &txTime, sizeof(txTime)) == -1) {
+        if (DEBUG_SOCKET)
+            printf("ETHERNET_LINUX: Failed to enable launch times (SO_TXTIME)\n");
+        return false;
+    }
+
+    self->txTime = true;
+
+    return true;
+}
+
+/* prepare a message carrying one frame and its launch time */
+static void
+prepareTxTimeMessage(EthernetSocket self, struct msghdr* msg, struct iovec* iov, char* control, size_t controlSize,
+        uint64_t launchTimeNs)
+{
+    memset(control, 0, controlSize);
+    memset(msg, 0, sizeof(struct msghdr));
+    msg->msg_name = &(self->socketAddress);
+    msg->msg_namelen = sizeof(self->socketAddress);
+    msg->msg_iov = iov;
+    msg->msg_iovlen = 1;
+    msg->msg_control = control;
+    msg->msg_controllen = controlSize;
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg);
+
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_TXTIME;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+    memcpy(CMSG_DATA(cmsg), &launchTimeNs, sizeof(uint64_t));
+}
+
+void
+Ethernet_sendPacketAt(EthernetSocket ethSocket, uint8_t* buffer, int packetSize, uint64_t launchTimeNs)
+{
+    if (ethSocket->txTime == false) {
+        Ethernet_sendPacket(ethSocket, buffer, packetSize);
+        return;
+    }
+
+    char control[CMSG_SPACE(sizeof(uint64_t))];
+    struct iovec iov;
+    struct msghdr msg;
+
+    iov.iov_base = buffer;
+    iov.iov_len = packetSize;
+
+    prepareTxTimeMessage(ethSocket, &msg, &iov, control, sizeof(control), launchTimeNs);
+
+    if ((sendmsg(ethSocket->rawSocket, &msg, 0) == -1) && DEBUG_SOCKET)
+        printf("ETHERNET_LINUX: Failed to send frame with launch time\n");
+}
+
+int
+Ethernet_sendPacketsAt(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, const uint64_t* launchTimesNs, int packetCount)
+{
+    if ((ethSocket == NULL) || (packetCount < 0))
+        return -1;
+
+    if (ethSocket->txTime == false)
+        return Ethernet_sendPackets(ethSocket, buffers, packetSizes, packetCount);
+
+    struct mmsghdr msgs[ETHERNET_MAX_SEND_BATCH];
+    struct iovec iovecs[ETHERNET_MAX_SEND_BATCH];
+    char controls[ETHERNET_MAX_SEND_BATCH][CMSG_SPACE(sizeof(uint64_t))];
+
+    int sentPackets = 0;
+
+    while (sentPackets < packetCount) {
+        int batchSize = packetCount - sentPackets;
+
+        if (batchSize > ETHERNET_MAX_SEND_BATCH)
+            batchSize = ETHERNET_MAX_SEND_BATCH;
+
+        int i;
+
+        for (i = 0; i < batchSize; i++) {
+            iovecs[i].iov_base = buffers[sentPackets + i];
+            iovecs[i].iov_len = packetSizes[sentPackets + i];
+
+            prepareTxTimeMessage(ethSocket, &msgs[i].msg_hdr, &iovecs[i], controls[i], sizeof(controls[i]),
+                    launchTimesNs[sentPackets + i]);
+            msgs[i].msg_len = 0;
+        }
+
+        int result = sendmmsg(ethSocket->rawSocket, msgs, batchSize, 0);
+
+        if (result <= 0) {
+            if (DEBUG_SOCKET)
+                printf("ETHERNET_LINUX: sendmmsg with launch times failed\n");
+
+            return (sentPackets > 0) ? sentPackets : -1;
+        }
+
+        sentPackets += result;
+    }
+
+    return sentPackets;
+}
+
+uint64_t
+Ethernet_getTxTimeErrors(EthernetSocket ethSocket)
+{
+    drainErrorQueue(ethSocket);
+
+    return ethSocket->txTimeErrors;
+}
+
 void
 Ethernet_destroySocket(EthernetSocket ethSocket)
 {
+    txRing_destroy(ethSocket);
+    rxRing_destroy(ethSocket);
     close(ethSocket->rawSocket);
     GLOBAL_FREEMEM(ethSocket);
 }
 
+int
+Ethernet_getSocketFd(EthernetSocket ethSocket)
+{
+    return ethSocket->rawSocket;
+}
+
 bool
 Ethernet_isSupported()
 {
@@ -378,6 +378,117 @@ Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
         printf("Error sending the packet: %s\n", pcap_geterr(ethSocket->rawSocket));
 }
 
+int
+Ethernet_sendPackets(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, int packetCount)
+{
+    int i;
+
+    for (i = 0; i < packetCount; i++) {
+        if (pcap_sendpacket(ethSocket->rawSocket, buffers[i], packetSizes[i]) != 0)
+            return (i > 0) ? i : -1;
+    }
+
+    return packetCount;
+}
+
+bool
+Ethernet_enableTxRing(EthernetSocket ethSocket, int maxFrameSize, int frameCount)
+{
+    return false;
+}
+
+bool
+Ethernet_setFrameFilter(EthernetSocket ethSocket, const uint16_t* etherTypes, int etherTypeCount,
+        const uint16_t* appIds, int appIdCount, const uint8_t* dstAddrs, int dstAddrCount)
+{
+    return false;
+}
+
+bool
+Ethernet_setIgnoreOutgoing(EthernetSocket ethSocket, bool ignore)
+{
+    return false;
+}
+
+bool
+Ethernet_enableRxRing(EthernetSocket ethSocket, int blockSize, int blockCount, int blockTimeoutMs)
+{
+    return false;
+}
+
+int
+Ethernet_receivePackets(EthernetSocket ethSocket, uint8_t* buffer, int bufferSize, EthernetFrameHandler handler, void* parameter)
+{
+    int packetSize = Ethernet_receivePacket(ethSocket, buffer, bufferSize);
+
+    if (packetSize > 0) {
+        handler(parameter, buffer, packetSize);
+        return 1;
+    }
+
+    return 0;
+}
+
+bool
+Ethernet_enableRxTimestamps(EthernetSocket ethSocket)
+{
+    return false;
+}
+
+uint64_t
+Ethernet_getRxTimestamp(EthernetSocket ethSocket)
+{
+    return 0;
+}
+
+bool
+Ethernet_enableTxTimestamps(EthernetSocket ethSocket)
+{
+    return false;
+}
+
+void
+Ethernet_sendPacketTimestamped(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
+{
+    Ethernet_sendPacket(ethSocket, buffer, packetSize);
+}
+
+bool
+Ethernet_getTxTimestamp(EthernetSocket ethSocket, uint64_t* timestampNs)
+{
+    return false;
+}
+
+bool
+Ethernet_enableTxTime(EthernetSocket ethSocket, int clockId)
+{
+    return false;
+}
+
+void
+Ethernet_sendPacketAt(EthernetSocket ethSocket, uint8_t* buffer, int packetSize, uint64_t launchTimeNs)
+{
+    Ethernet_sendPacket(ethSocket, buffer, packetSize);
+}
+
+int
+Ethernet_sendPacketsAt(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, const uint64_t* launchTimesNs, int packetCount)
+{
+    return Ethernet_sendPackets(ethSocket, buffers, packetSizes, packetCount);
+}
+
+uint64_t
+Ethernet_getTxTimeErrors(EthernetSocket ethSocket)
+{
+    return 0;
+}
+
+int
+Ethernet_getSocketFd(EthernetSocket ethSocket)
+{
+    return -1;
+}
+
 void
 Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType)
 {
@@ -478,6 +589,110 @@ Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
 {
 }
 
+int
+Ethernet_sendPackets(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, int packetCount)
+{
+    return -1;
+}
+
+bool
+Ethernet_enableTxRing(EthernetSocket ethSocket, int maxFrameSize, int frameCount)
+{
+    return false;
+}
+
+bool
+Ethernet_setFrameFilter(EthernetSocket ethSocket, const uint16_t* etherTypes, int etherTypeCount,
+        const uint16_t* appIds, int appIdCount, const uint8_t* dstAddrs, int dstAddrCount)
+{
+    return false;
+}
+
+bool
+Ethernet_setIgnoreOutgoing(EthernetSocket ethSocket, bool ignore)
+{
+    return false;
+}
+
+bool
+Ethernet_enableRxRing(EthernetSocket ethSocket, int blockSize, int blockCount, int blockTimeoutMs)
+{
+    return false;
+}
+
+int
+Ethernet_receivePackets(EthernetSocket ethSocket, uint8_t* buffer, int bufferSize, EthernetFrameHandler handler, void* parameter)
+{
+    int packetSize = Ethernet_receivePacket(ethSocket, buffer, bufferSize);
+
+    if (packetSize > 0) {
+        handler(parameter, buffer, packetSize);
+        return 1;
+    }
+
+    return 0;
+}
+
+bool
+Ethernet_enableRxTimestamps(EthernetSocket ethSocket)
+{
+    return false;
+}
+
+uint64_t
+Ethernet_getRxTimestamp(EthernetSocket ethSocket)
+{
+    return 0;
+}
+
+bool
+Ethernet_enableTxTimestamps(EthernetSocket ethSocket)
+{
+    return false;
+}
+
+void
+Ethernet_sendPacketTimestamped(EthernetSocket ethSocket, uint8_t* buffer, int packetSize)
+{
+    Ethernet_sendPacket(ethSocket, buffer, packetSize);
+}
+
+bool
+Ethernet_getTxTimestamp(EthernetSocket ethSocket, uint64_t* timestampNs)
+{
+    return false;
+}
+
+bool
+Ethernet_enableTxTime(EthernetSocket ethSocket, int clockId)
+{
+    return false;
+}
+
+void
+Ethernet_sendPacketAt(EthernetSocket ethSocket, uint8_t* buffer, int packetSize, uint64_t launchTimeNs)
+{
+    Ethernet_sendPacket(ethSocket, buffer, packetSize);
+}
+
+int
+Ethernet_sendPacketsAt(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, const uint64_t* launchTimesNs, int packetCount)
+{
+    return Ethernet_sendPackets(ethSocket, buffers, packetSizes, packetCount);
+}
+
+uint64_t
+Ethernet_getTxTimeErrors(EthernetSocket ethSocket)
+{
+    return 0;
+}
+
+int
+Ethernet_getSocketFd(EthernetSocket ethSocket)
+{
+    return -1;
+}
+
 void
 Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType)
 {
@@ -33,6 +33,13 @@ extern "C" {
  */
 typedef struct sEthernetSocket* EthernetSocket;
 
+/**
+ * \brief Callback for frames received by \ref Ethernet_receivePackets
+ *
+ * The frame buffer is only valid during the call.
+ */
+typedef void (*EthernetFrameHandler) (void* parameter, uint8_t* frame, int frameSize);
+
 /** Opaque reference for a set of Ethernet socket handles */
 typedef struct sEthernetHandleSet* EthernetHandleSet;
 
@@ -114,9 +121,61 @@ Ethernet_createSocket(const char* interfaceId, uint8_t* destAddress);
 PAL_API void
 Ethernet_destroySocket(EthernetSocket ethSocket);
 
+/**
+ * \brief get the operating system file descriptor of the ethernet socket (optional)
+ *
+ * The descriptor becomes readable when frames are pending and can be monitored by an event loop
+ * of the application (Linux: epoll) instead of an \ref EthernetHandleSet. The frames have
+ * to be received with the functions of this module.
+ *
+ * NOTE: Implementation is not required. Platforms without a pollable descriptor return -1.
+ *
+ * \param ethSocket the ethernet socket handle
+ *
+ * \return the file descriptor, -1 if not available
+ */
+PAL_API int
+Ethernet_getSocketFd(EthernetSocket ethSocket);
+
 PAL_API void
 Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize);
 
+/**
+ * \brief send multiple ethernet packets with a single call
+ *
+ * The packets have to be complete Ethernet frames (including the Ethernet header). Platforms
+ * that support it (Linux: sendmmsg or PACKET_TX_RING) transmit the whole batch with a single
+ * kernel call. Other platforms fall back to one send per packet.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param buffers array of pointers to the packet buffers
+ * \param packetSizes array with the size of each packet in bytes
+ * \param packetCount number of packets in the batch
+ *
+ * \return number of packets handed over to the network stack, -1 on error
+ */
+PAL_API int
+Ethernet_sendPackets(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, int packetCount);
+
+/**
+ * \brief enable the memory mapped transmit ring (optional)
+ *
+ * When enabled, \ref Ethernet_sendPacket and \ref Ethernet_sendPackets copy the frames into a ring
+ * buffer shared with the kernel (Linux: PACKET_TX_RING) and only one system call is required to
+ * flush all pending frames.
+ *
+ * NOTE: Implementation is not required. Platforms without support return false and the socket
+ * keeps using the normal send path.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param maxFrameSize maximum size of a single frame in bytes
+ * \param frameCount number of frames the ring can hold
+ *
+ * \return true if the transmit ring is active, false otherwise
+ */
+PAL_API bool
+Ethernet_enableTxRing(EthernetSocket ethSocket, int maxFrameSize, int frameCount);
+
 /*
  * \brief set a protocol filter for the specified etherType
  *
@@ -129,6 +188,47 @@ Ethernet_sendPacket(EthernetSocket ethSocket, uint8_t* buffer, int packetSize);
 PAL_API void
 Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType);
 
+/**
+ * \brief set a kernel frame filter on the ethernet socket (optional)
+ *
+ * Only frames matching one of the ether types, and one of the APPIDs and destination
+ * addresses (when given) are passed to the application. IEEE 802.1Q tagged frames are
+ * supported. A new filter replaces the previous one and can be set at any time, e.g.
+ * after subscribers have been added or removed.
+ *
+ * Without ether types the socket does not receive any frame (transmit only socket).
+ *
+ * NOTE: Implementation is not required. The filter is a performance optimization, the
+ * application has to check the received frames anyway.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param etherTypes the ether types to accept
+ * \param etherTypeCount number of ether types
+ * \param appIds the APPIDs to accept, NULL to accept any APPID
+ * \param appIdCount number of APPIDs
+ * \param dstAddrs the destination MAC addresses to accept (6 bytes each), NULL to accept any address
+ * \param dstAddrCount number of destination addresses
+ *
+ * \return true if the filter has been applied, false otherwise
+ */
+PAL_API bool
+Ethernet_setFrameFilter(EthernetSocket ethSocket, const uint16_t* etherTypes, int etherTypeCount,
+        const uint16_t* appIds, int appIdCount, const uint8_t* dstAddrs, int dstAddrCount);
+
+/**
+ * \brief do not pass the frames sent by the local host to the socket (optional)
+ *
+ * Saves the copy of every outgoing frame to sockets that do not need them
+ * (Linux: PACKET_IGNORE_OUTGOING, kernel 4.20 or later).
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param ignore true to ignore the outgoing frames
+ *
+ * \return true if the option has been applied, false otherwise
+ */
+PAL_API bool
+Ethernet_setIgnoreOutgoing(EthernetSocket ethSocket, bool ignore);
+
 /**
  * \brief receive an ethernet packet (non-blocking)
  *
@@ -141,6 +241,179 @@ Ethernet_setProtocolFilter(EthernetSocket ethSocket, uint16_t etherType);
 PAL_API int
 Ethernet_receivePacket(EthernetSocket ethSocket, uint8_t* buffer, int bufferSize);
 
+/**
+ * \brief enable the memory mapped receive ring (optional)
+ *
+ * The kernel writes the received frames into blocks of a ring buffer shared with the
+ * application (Linux: PACKET_RX_RING with TPACKET_V3). A block is passed to the application
+ * when it is full or when the block timeout expires, \ref Ethernet_receivePackets then
+ * handles all frames of the block without a system call or a copy and returns the
+ * whole block to the kernel.
+ *
+ * NOTE: Implementation is not required. Platforms without support return false and the socket
+ * keeps using the normal receive path. Cannot be combined with \ref Ethernet_enableTxRing.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param blockSize size of a ring block in bytes (rounded up to a power of two number of pages)
+ * \param blockCount number of blocks in the ring
+ * \param blockTimeoutMs time after which a partially filled block is passed to the application
+ *
+ * \return true if the receive ring is active, false otherwise
+ */
+PAL_API bool
+Ethernet_enableRxRing(EthernetSocket ethSocket, int blockSize, int blockCount, int blockTimeoutMs);
+
+/**
+ * \brief receive the available ethernet packets (non-blocking)
+ *
+ * With a receive ring all frames of the blocks ready for the application are passed
+ * to the handler directly from the ring. Otherwise at most one frame is received into
+ * \p buffer and passed to the handler.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param buffer the buffer used when no receive ring is active
+ * \param bufferSize the maximum size of the buffer
+ * \param handler function called for each received frame
+ * \param parameter user provided parameter passed to the handler
+ *
+ * \return number of frames passed to the handler, -1 on error
+ */
+PAL_API int
+Ethernet_receivePackets(EthernetSocket ethSocket, uint8_t* buffer, int bufferSize, EthernetFrameHandler handler, void* parameter);
+
+/**
+ * \brief enable kernel receive timestamps (optional)
+ *
+ * Every received frame is timestamped by the network stack when it enters the host
+ * (Linux: SO_TIMESTAMPING with software receive timestamps). The timestamp of the frame
+ * being handled is returned by \ref Ethernet_getRxTimestamp.
+ *
+ * NOTE: Implementation is not required. Platforms without support return false.
+ *
+ * \param ethSocket the ethernet socket handle
+ *
+ * \return true if receive timestamps are enabled, false otherwise
+ */
+PAL_API bool
+Ethernet_enableRxTimestamps(EthernetSocket ethSocket);
+
+/**
+ * \brief get the kernel receive timestamp of the frame being handled
+ *
+ * Only valid inside the \ref EthernetFrameHandler called by \ref Ethernet_receivePackets.
+ *
+ * \param ethSocket the ethernet socket handle
+ *
+ * \return receive time in nanoseconds since epoch (CLOCK_REALTIME), 0 if not available
+ */
+PAL_API uint64_t
+Ethernet_getRxTimestamp(EthernetSocket ethSocket);
+
+/**
+ * \brief enable kernel transmit timestamps (optional)
+ *
+ * Prepares the socket to report the time at which the frames sent with
+ * \ref Ethernet_sendPacketTimestamped are handed to the network device
+ * (Linux: SO_TIMESTAMPING with software transmit timestamps).
+ *
+ * NOTE: Implementation is not required. Platforms without support return false.
+ *
+ * \param ethSocket the ethernet socket handle
+ *
+ * \return true if transmit timestamps are enabled, false otherwise
+ */
+PAL_API bool
+Ethernet_enableTxTimestamps(EthernetSocket ethSocket);
+
+/**
+ * \brief send an ethernet packet and request its transmit timestamp
+ *
+ * Only this frame is timestamped, the other frames do not load the error queue of the
+ * socket. Falls back to \ref Ethernet_sendPacket when transmit timestamps are not enabled
+ * or when the transmit ring is active.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param buffer the frame to send
+ * \param packetSize size of the frame in bytes
+ */
+PAL_API void
+Ethernet_sendPacketTimestamped(EthernetSocket ethSocket, uint8_t* buffer, int packetSize);
+
+/**
+ * \brief fetch the transmit timestamp of the last frame sent with \ref Ethernet_sendPacketTimestamped (non-blocking)
+ *
+ * The timestamp is reported asynchronously once the frame reached the network device,
+ * the function has to be polled until it returns true.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param timestampNs returns the transmit time in nanoseconds since epoch (CLOCK_REALTIME)
+ *
+ * \return true if a timestamp was available, false otherwise
+ */
+PAL_API bool
+Ethernet_getTxTimestamp(EthernetSocket ethSocket, uint64_t* timestampNs);
+
+/**
+ * \brief enable launch time scheduled transmission (optional)
+ *
+ * Frames sent with \ref Ethernet_sendPacketAt and \ref Ethernet_sendPacketsAt carry a launch time
+ * and are held back by the kernel until then (Linux: SO_TXTIME/SCM_TXTIME, released by the ETF qdisc
+ * configured on the interface; without such a qdisc the frames are sent immediately). This allows frames
+ * to be queued well ahead of their transmission time. Frames that miss their launch time are dropped
+ * by the qdisc and counted by \ref Ethernet_getTxTimeErrors.
+ *
+ * NOTE: Implementation is not required. Platforms without support return false.
+ * Cannot be combined with \ref Ethernet_enableTxRing.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param clockId clock the launch times refer to (Linux: CLOCK_TAI for the ETF qdisc)
+ *
+ * \return true if launch times are enabled, false otherwise
+ */
+PAL_API bool
+Ethernet_enableTxTime(EthernetSocket ethSocket, int clockId);
+
+/**
+ * \brief send a frame at the given launch time
+ *
+ * Same as \ref Ethernet_sendPacket when launch times are not enabled.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param buffer the frame
+ * \param packetSize size of the frame in bytes
+ * \param launchTimeNs launch time in nanoseconds of the clock given to \ref Ethernet_enableTxTime
+ */
+PAL_API void
+Ethernet_sendPacketAt(EthernetSocket ethSocket, uint8_t* buffer, int packetSize, uint64_t launchTimeNs);
+
+/**
+ * \brief send a batch of frames, each with its own launch time
+ *
+ * Same as \ref Ethernet_sendPackets when launch times are not enabled.
+ *
+ * \param ethSocket the ethernet socket handle
+ * \param buffers array of pointers to the packet buffers
+ * \param packetSizes array with the size of each packet in bytes
+ * \param launchTimesNs array with the launch time of each packet
+ * \param packetCount number of packets in the batch
+ *
+ * \return number of packets handed over to the network stack, -1 on error
+ */
+PAL_API int
+Ethernet_sendPacketsAt(EthernetSocket ethSocket, uint8_t** buffers, int* packetSizes, const uint64_t* launchTimesNs, int packetCount);
+
+/**
+ * \brief get the number of frames dropped because of their launch time (non-blocking)
+ *
+ * Counts the frames reported by the kernel as having missed their launch time or carrying an invalid one.
+ *
+ * \param ethSocket the ethernet socket handle
+ *
+ * \return number of dropped frames since launch times were enabled
+ */
+PAL_API uint64_t
+Ethernet_getTxTimeErrors(EthernetSocket ethSocket);
+
 /**
  * \brief Indicates if runtime provides support for direct Ethernet access
  *
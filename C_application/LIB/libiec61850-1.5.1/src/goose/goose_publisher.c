@@ -36,12 +36,14 @@
 #define GOOSE_MAX_MESSAGE_SIZE 1518
 
 static bool
-prepareGooseBuffer(GoosePublisher self, CommParameters* parameters, const char* interfaceID, bool useVlanTags);
+prepareGooseBuffer(GoosePublisher self, CommParameters* parameters, const char* interfaceID, bool useVlanTags,
+        EthernetSocket sharedSocket);
 
 struct sGoosePublisher {
     uint8_t* buffer;
 
     EthernetSocket ethernetSocket;
+    bool ownsSocket;
     int lengthField;
     int payloadStart;
     int payloadLength;
@@ -58,16 +60,31 @@ struct sGoosePublisher {
     bool simulation;
 
     MmsValue* timestamp; /* time when stNum is increased */
+
+    /* pre-encoded frame (GoosePublisher_setupDataSet) */
+    bool frameValid;        /* false when the frame has to be encoded again before it is sent */
+    uint8_t* dataSetBuffer; /* encoded data set entries */
+    int dataSetSize;
+    int* entryOffsets;      /* offset of each entry in dataSetBuffer, entryCount + 1 elements */
+    int entryCount;
+
+    /* positions in the frame of the last encoded message */
+    int stNumPos;
+    int stNumSize;
+    int sqNumPos;
+    int sqNumSize;
+    int timestampPos;
+    int dataSetPos;
 };
 
-GoosePublisher
-GoosePublisher_createEx(CommParameters* parameters, const char* interfaceID, bool useVlanTag)
+static GoosePublisher
+createPublisher(CommParameters* parameters, const char* interfaceID, bool useVlanTag, EthernetSocket sharedSocket)
 {
     GoosePublisher self = (GoosePublisher) GLOBAL_CALLOC(1, sizeof(struct sGoosePublisher));
 
     if (self) {
 
-        if (prepareGooseBuffer(self, parameters, interfaceID, useVlanTag)) {
+        if (prepareGooseBuffer(self, parameters, interfaceID, useVlanTag, sharedSocket)) {
             self->timestamp = MmsValue_newUtcTimeByMsTime(Hal_getTimeInMs());
 
             GoosePublisher_reset(self);
@@ -82,6 +99,28 @@ GoosePublisher_createEx(CommParameters* parameters, const char* interfaceID, boo
     return self;
 }
 
+GoosePublisher
+GoosePublisher_createEx(CommParameters* parameters, const char* interfaceID, bool useVlanTag)
+{
+    return createPublisher(parameters, interfaceID, useVlanTag, NULL);
+}
+
+GoosePublisher
+GoosePublisher_createWithSocket(CommParameters* parameters, const char* interfaceID, EthernetSocket ethSocket,
+        bool useVlanTag)
+{
+    if (ethSocket == NULL)
+        return NULL;
+
+    return createPublisher(parameters, interfaceID, useVlanTag, ethSocket);
+}
+
+EthernetSocket
+GoosePublisher_getSocket(GoosePublisher self)
+{
+    return self->ethernetSocket;
+}
+
 GoosePublisher
 GoosePublisher_create(CommParameters* parameters, const char* interfaceID)
 {
@@ -92,7 +131,7 @@ void
 GoosePublisher_destroy(GoosePublisher self)
 {
     if (self) {
-        if (self->ethernetSocket) {
+        if (self->ethernetSocket && self->ownsSocket) {
             Ethernet_destroySocket(self->ethernetSocket);
         }
 
@@ -110,6 +149,12 @@ GoosePublisher_destroy(GoosePublisher self)
         if (self->buffer)
             GLOBAL_FREEMEM(self->buffer);
 
+        if (self->dataSetBuffer)
+            GLOBAL_FREEMEM(self->dataSetBuffer);
+
+        if (self->entryOffsets)
+            GLOBAL_FREEMEM(self->entryOffsets);
+
         GLOBAL_FREEMEM(self);
     }
 }
@@ -118,30 +163,35 @@ void
 GoosePublisher_setGoID(GoosePublisher self, char* goID)
 {
     self->goID = StringUtils_copyString(goID);
+    self->frameValid = false;
 }
 
 void
 GoosePublisher_setGoCbRef(GoosePublisher self, char* goCbRef)
 {
     self->goCBRef = StringUtils_copyString(goCbRef);
+    self->frameValid = false;
 }
 
 void
 GoosePublisher_setDataSetRef(GoosePublisher self, char* dataSetRef)
 {
     self->dataSetRef = StringUtils_copyString(dataSetRef);
+    self->frameValid = false;
 }
 
 void
 GoosePublisher_setConfRev(GoosePublisher self, uint32_t confRev)
 {
     self->confRev = confRev;
+    self->frameValid = false;
 }
 
 void
 GoosePublisher_setSimulation(GoosePublisher self, bool simulation)
 {
     self->simulation = simulation;
+    self->frameValid = false;
 }
 
 void
@@ -160,6 +210,7 @@ void
 GoosePublisher_setNeedsCommission(GoosePublisher self, bool ndsCom)
 {
     self->needsCommission = ndsCom;
+    self->frameValid = false;
 }
 
 uint64_t
@@ -190,10 +241,12 @@ void
 GoosePublisher_setTimeAllowedToLive(GoosePublisher self, uint32_t timeAllowedToLive)
 {
     self->timeAllowedToLive = timeAllowedToLive;
+    self->frameValid = false;
 }
 
 static bool
-prepareGooseBuffer(GoosePublisher self, CommParameters* parameters, const char* interfaceID, bool useVlanTags)
+prepareGooseBuffer(GoosePublisher self, CommParameters* parameters, const char* interfaceID, bool useVlanTags,
+        EthernetSocket sharedSocket)
 {
     uint8_t srcAddr[6];
 
@@ -222,12 +275,28 @@ prepareGooseBuffer(GoosePublisher self, CommParameters* parameters, const char*
         appId = parameters->appId;
     }
 
-    if (interfaceID != NULL)
-        self->ethernetSocket = Ethernet_createSocket(interfaceID, dstAddr);
-    else
-        self->ethernetSocket = Ethernet_createSocket(CONFIG_ETHERNET_INTERFACE_ID, dstAddr);
+    if (sharedSocket) {
+        /* the frames carry the destination address, a raw socket can send them to any address */
+        self->ethernetSocket = sharedSocket;
+        self->ownsSocket = false;
+    }
+    else {
+        if (interfaceID != NULL)
+            self->ethernetSocket = Ethernet_createSocket(interfaceID, dstAddr);
+        else
+            self->ethernetSocket = Ethernet_createSocket(CONFIG_ETHERNET_INTERFACE_ID, dstAddr);
+
+        self->ownsSocket = true;
+
+        if (self->ethernetSocket) {
+            /* transmit only: keep the received and the locally sent frames out of the socket */
+            Ethernet_setFrameFilter(self->ethernetSocket, NULL, 0, NULL, 0, NULL, 0);
+            Ethernet_setIgnoreOutgoing(self->ethernetSocket, true);
+        }
+    }
 
     if (self->ethernetSocket) {
+
         self->buffer = (uint8_t*) GLOBAL_MALLOC(GOOSE_MAX_MESSAGE_SIZE);
 
         memcpy(self->buffer, dstAddr, 6);
@@ -280,69 +349,43 @@ prepareGooseBuffer(GoosePublisher self, CommParameters* parameters, const char*
     }
 }
 
-static int32_t
-createGoosePayload(GoosePublisher self, LinkedList dataSetValues, uint8_t* buffer, size_t maxPayloadSize) {
-
-    /* Step 1 - calculate length fields */
-    uint32_t goosePduLength = 0;
-
-    goosePduLength += BerEncoder_determineEncodedStringSize(self->goCBRef);
+/* size of the GOOSE PDU elements in front of the data set entries */
+static uint32_t
+determinePduHeaderSize(GoosePublisher self, uint32_t numberOfDataSetEntries)
+{
+    uint32_t headerSize = 0;
 
-    uint32_t timeAllowedToLive = self->timeAllowedToLive;
+    headerSize += BerEncoder_determineEncodedStringSize(self->goCBRef);
 
-    goosePduLength += 2 + BerEncoder_UInt32determineEncodedSize(timeAllowedToLive);
+    headerSize += 2 + BerEncoder_UInt32determineEncodedSize(self->timeAllowedToLive);
 
-    goosePduLength += BerEncoder_determineEncodedStringSize(self->dataSetRef);
+    headerSize += BerEncoder_determineEncodedStringSize(self->dataSetRef);
 
     if (self->goID != NULL)
-        goosePduLength += BerEncoder_determineEncodedStringSize(self->goID);
+        headerSize += BerEncoder_determineEncodedStringSize(self->goID);
     else
-        goosePduLength += BerEncoder_determineEncodedStringSize(self->goCBRef);
-
-    goosePduLength += 2 + 8; /* for T (UTCTIME) */
+        headerSize += BerEncoder_determineEncodedStringSize(self->goCBRef);
 
-    goosePduLength += 2 + BerEncoder_UInt32determineEncodedSize(self->sqNum);
+    headerSize += 2 + 8; /* for T (UTCTIME) */
 
-    goosePduLength += 2 + BerEncoder_UInt32determineEncodedSize(self->stNum);
-
-    goosePduLength += 2 + BerEncoder_UInt32determineEncodedSize(self->confRev);
-
-    goosePduLength += 6; /* for ndsCom and simulation */
-
-    uint32_t numberOfDataSetEntries = LinkedList_size(dataSetValues);
-
-    goosePduLength += 2 + BerEncoder_UInt32determineEncodedSize(numberOfDataSetEntries);
-
-    uint32_t dataSetSize = 0;
+    headerSize += 2 + BerEncoder_UInt32determineEncodedSize(self->sqNum);
 
-    LinkedList element = LinkedList_getNext(dataSetValues);
+    headerSize += 2 + BerEncoder_UInt32determineEncodedSize(self->stNum);
 
-    while (element != NULL) {
-        MmsValue* dataSetEntry = (MmsValue*) element->data;
+    headerSize += 2 + BerEncoder_UInt32determineEncodedSize(self->confRev);
 
-        if (dataSetEntry) {
-            dataSetSize += MmsValue_encodeMmsData(dataSetEntry, NULL, 0, false);
-        }
-        else {
-            /* TODO encode MMS NULL */
-            if (DEBUG_GOOSE_PUBLISHER)
-                printf("GOOSE_PUBLISHER: NULL value in data set!\n");
-        }
+    headerSize += 6; /* for ndsCom and simulation */
 
-        element = LinkedList_getNext(element);
-    }
+    headerSize += 2 + BerEncoder_UInt32determineEncodedSize(numberOfDataSetEntries);
 
-    uint32_t allDataSize = dataSetSize + BerEncoder_determineLengthSize(dataSetSize) + 1;
-
-    goosePduLength += allDataSize;
-
-    uint32_t payloadSize = 1 + BerEncoder_determineLengthSize(goosePduLength) + goosePduLength;
-
-    if (payloadSize > maxPayloadSize)
-        return -1;
-
-    /* Step 2 - encode to buffer */
+    return headerSize;
+}
 
+/* encode the GOOSE PDU up to the data set entries and remember the position of the patchable fields */
+static int32_t
+encodePduHeader(GoosePublisher self, uint32_t goosePduLength, uint32_t numberOfDataSetEntries, uint32_t dataSetSize,
+        uint8_t* buffer)
+{
     int32_t bufPos = 0;
 
     /* Encode GOOSE PDU */
@@ -352,7 +395,7 @@ createGoosePayload(GoosePublisher self, LinkedList dataSetValues, uint8_t* buffe
     bufPos = BerEncoder_encodeStringWithTag(0x80, self->goCBRef, buffer, bufPos);
 
     /* Encode timeAllowedToLive */
-    bufPos = BerEncoder_encodeUInt32WithTL(0x81, timeAllowedToLive, buffer, bufPos);
+    bufPos = BerEncoder_encodeUInt32WithTL(0x81, self->timeAllowedToLive, buffer, bufPos);
 
     /* Encode datSet reference */
     bufPos = BerEncoder_encodeStringWithTag(0x82, self->dataSetRef, buffer, bufPos);
@@ -364,13 +407,18 @@ createGoosePayload(GoosePublisher self, LinkedList dataSetValues, uint8_t* buffe
         bufPos = BerEncoder_encodeStringWithTag(0x83, self->goCBRef, buffer, bufPos);
 
     /* Encode t */
+    self->timestampPos = self->payloadStart + bufPos + 2;
     bufPos = BerEncoder_encodeOctetString(0x84, self->timestamp->value.utcTime, 8, buffer, bufPos);
 
     /* Encode stNum */
+    self->stNumPos = self->payloadStart + bufPos + 2;
     bufPos = BerEncoder_encodeUInt32WithTL(0x85, self->stNum, buffer, bufPos);
+    self->stNumSize = self->payloadStart + bufPos - self->stNumPos;
 
     /* Encode sqNum */
+    self->sqNumPos = self->payloadStart + bufPos + 2;
     bufPos = BerEncoder_encodeUInt32WithTL(0x86, self->sqNum, buffer, bufPos);
+    self->sqNumSize = self->payloadStart + bufPos - self->sqNumPos;
 
     /* Encode simulation */
     bufPos = BerEncoder_encodeBoolean(0x87, self->simulation, buffer, bufPos);
@@ -387,6 +435,51 @@ createGoosePayload(GoosePublisher self, LinkedList dataSetValues, uint8_t* buffe
     /* Encode all data */
     bufPos = BerEncoder_encodeTL(0xab, dataSetSize, buffer, bufPos);
 
+    self->dataSetPos = self->payloadStart + bufPos;
+
+    return bufPos;
+}
+
+static int32_t
+createGoosePayload(GoosePublisher self, LinkedList dataSetValues, uint8_t* buffer, size_t maxPayloadSize) {
+
+    /* Step 1 - calculate length fields */
+    uint32_t numberOfDataSetEntries = LinkedList_size(dataSetValues);
+
+    uint32_t goosePduLength = determinePduHeaderSize(self, numberOfDataSetEntries);
+
+    uint32_t dataSetSize = 0;
+
+    LinkedList element = LinkedList_getNext(dataSetValues);
+
+    while (element != NULL) {
+        MmsValue* dataSetEntry = (MmsValue*) element->data;
+
+        if (dataSetEntry) {
+            dataSetSize += MmsValue_encodeMmsData(dataSetEntry, NULL, 0, false);
+        }
+        else {
+            /* TODO encode MMS NULL */
+            if (DEBUG_GOOSE_PUBLISHER)
+                printf("GOOSE_PUBLISHER: NULL value in data set!\n");
+        }
+
+        element = LinkedList_getNext(element);
+    }
+
+    uint32_t allDataSize = dataSetSize + BerEncoder_determineLengthSize(dataSetSize) + 1;
+
+    goosePduLength += allDataSize;
+
+    uint32_t payloadSize = 1 + BerEncoder_determineLengthSize(goosePduLength) + goosePduLength;
+
+    if (payloadSize > maxPayloadSize)
+        return -1;
+
+    /* Step 2 - encode to buffer */
+
+    int32_t bufPos = encodePduHeader(self, goosePduLength, numberOfDataSetEntries, dataSetSize, buffer);
+
     /* Encode data set entries */
     element = LinkedList_getNext(dataSetValues);
 
@@ -406,6 +499,51 @@ createGoosePayload(GoosePublisher self, LinkedList dataSetValues, uint8_t* buffe
     return bufPos;
 }
 
+static void
+setLengthField(GoosePublisher self)
+{
+    int lengthIndex = self->lengthField;
+
+    size_t gooseLength = self->payloadLength + 8;
+
+    self->buffer[lengthIndex] = gooseLength / 256;
+    self->buffer[lengthIndex + 1] = gooseLength & 0xff;
+}
+
+/* encode the complete frame from the pre-encoded data set */
+static bool
+encodePreparedFrame(GoosePublisher self)
+{
+    uint8_t* buffer = self->buffer + self->payloadStart;
+
+    size_t maxPayloadSize = GOOSE_MAX_MESSAGE_SIZE - self->payloadStart;
+
+    uint32_t goosePduLength = determinePduHeaderSize(self, self->entryCount);
+
+    goosePduLength += self->dataSetSize + BerEncoder_determineLengthSize(self->dataSetSize) + 1;
+
+    uint32_t payloadSize = 1 + BerEncoder_determineLengthSize(goosePduLength) + goosePduLength;
+
+    if (payloadSize > maxPayloadSize) {
+        if (DEBUG_GOOSE_PUBLISHER)
+            printf("GOOSE_PUBLISHER: data set too large for a single frame\n");
+
+        return false;
+    }
+
+    int32_t bufPos = encodePduHeader(self, goosePduLength, self->entryCount, self->dataSetSize, buffer);
+
+    memcpy(buffer + bufPos, self->dataSetBuffer, self->dataSetSize);
+
+    self->payloadLength = bufPos + self->dataSetSize;
+
+    setLengthField(self);
+
+    self->frameValid = true;
+
+    return true;
+}
+
 int
 GoosePublisher_publish(GoosePublisher self, LinkedList dataSet)
 {
@@ -418,17 +556,15 @@ GoosePublisher_publish(GoosePublisher self, LinkedList dataSet)
     if (self->payloadLength == -1)
         return -1;
 
+    /* the prepared frame has been overwritten */
+    self->frameValid = false;
+
     self->sqNum++;
 
     if (self->sqNum == 0)
         self->sqNum = 1;
 
-    int lengthIndex = self->lengthField;
-
-    size_t gooseLength = self->payloadLength + 8;
-
-    self->buffer[lengthIndex] = gooseLength / 256;
-    self->buffer[lengthIndex + 1] = gooseLength & 0xff;
+    setLengthField(self);
 
     if (DEBUG_GOOSE_PUBLISHER)
         printf("GOOSE_PUBLISHER: send GOOSE message\n");
@@ -456,3 +592,152 @@ GoosePublisher_publishAndDump(GoosePublisher self, LinkedList dataSet, char *msg
 
     return rc;
 }
+
+bool
+GoosePublisher_setupDataSet(GoosePublisher self, LinkedList dataSet)
+{
+    int entryCount = LinkedList_size(dataSet);
+
+    if (self->dataSetBuffer == NULL) {
+        self->dataSetBuffer = (uint8_t*) GLOBAL_MALLOC(GOOSE_MAX_MESSAGE_SIZE);
+
+        if (self->dataSetBuffer == NULL)
+            return false;
+    }
+
+    if (self->entryOffsets)
+        GLOBAL_FREEMEM(self->entryOffsets);
+
+    self->entryOffsets = (int*) GLOBAL_MALLOC((entryCount + 1) * sizeof(int));
+    self->entryCount = 0;
+    self->dataSetSize = 0;
+    self->frameValid = false;
+
+    if (self->entryOffsets == NULL)
+        return false;
+
+    int bufPos = 0;
+    int entry = 0;
+
+    LinkedList element = LinkedList_getNext(dataSet);
+
+    while (element != NULL) {
+        MmsValue* dataSetEntry = (MmsValue*) element->data;
+
+        if (dataSetEntry == NULL) {
+            if (DEBUG_GOOSE_PUBLISHER)
+                printf("GOOSE_PUBLISHER: NULL value in data set!\n");
+
+            return false;
+        }
+
+        if (bufPos + MmsValue_encodeMmsData(dataSetEntry, NULL, 0, false) > GOOSE_MAX_MESSAGE_SIZE)
+            return false;
+
+        self->entryOffsets[entry++] = bufPos;
+
+        bufPos = MmsValue_encodeMmsData(dataSetEntry, self->dataSetBuffer, bufPos, true);
+
+        element = LinkedList_getNext(element);
+    }
+
+    self->entryOffsets[entry] = bufPos;
+    self->entryCount = entry;
+    self->dataSetSize = bufPos;
+
+    return encodePreparedFrame(self);
+}
+
+bool
+GoosePublisher_setDataSetValue(GoosePublisher self, int index, MmsValue* value)
+{
+    if ((self->entryOffsets == NULL) || (index < 0) || (index >= self->entryCount) || (value == NULL))
+        return false;
+
+    int offset = self->entryOffsets[index];
+    int oldSize = self->entryOffsets[index + 1] - offset;
+    int newSize = MmsValue_encodeMmsData(value, NULL, 0, false);
+
+    if (newSize == oldSize) {
+        /* fast path: same encoded size, patch the entry in place */
+        MmsValue_encodeMmsData(value, self->dataSetBuffer, offset, true);
+
+        if (self->frameValid)
+            memcpy(self->buffer + self->dataSetPos + offset, self->dataSetBuffer + offset, newSize);
+
+        return true;
+    }
+
+    int delta = newSize - oldSize;
+
+    if (self->dataSetSize + delta > GOOSE_MAX_MESSAGE_SIZE)
+        return false;
+
+    /* the encoded size changed: move the following entries, the frame is encoded again before it is sent */
+    memmove(self->dataSetBuffer + offset + newSize, self->dataSetBuffer + offset + oldSize,
+            self->dataSetSize - (offset + oldSize));
+
+    MmsValue_encodeMmsData(value, self->dataSetBuffer, offset, true);
+
+    int i;
+    for (i = index + 1; i <= self->entryCount; i++)
+        self->entryOffsets[i] += delta;
+
+    self->dataSetSize += delta;
+    self->frameValid = false;
+
+    return true;
+}
+
+int
+GoosePublisher_updateFrame(GoosePublisher self)
+{
+    if (self->entryOffsets == NULL)
+        return -1;
+
+    if (self->frameValid) {
+        /* a number with another encoded size changes the length fields */
+        if ((BerEncoder_UInt32determineEncodedSize(self->stNum) != self->stNumSize) ||
+                (BerEncoder_UInt32determineEncodedSize(self->sqNum) != self->sqNumSize))
+            self->frameValid = false;
+    }
+
+    if (self->frameValid) {
+        BerEncoder_encodeUInt32(self->stNum, self->buffer, self->stNumPos);
+        BerEncoder_encodeUInt32(self->sqNum, self->buffer, self->sqNumPos);
+        memcpy(self->buffer + self->timestampPos, self->timestamp->value.utcTime, 8);
+    }
+    else {
+        if (encodePreparedFrame(self) == false)
+            return -1;
+    }
+
+    self->sqNum++;
+
+    if (self->sqNum == 0)
+        self->sqNum = 1;
+
+    return self->payloadStart + self->payloadLength;
+}
+
+uint8_t*
+GoosePublisher_getFrameBuffer(GoosePublisher self)
+{
+    return self->buffer;
+}
+
+int
+GoosePublisher_publishFrame(GoosePublisher self)
+{
+    int frameSize = GoosePublisher_updateFrame(self);
+
+    if (frameSize == -1)
+        return -1;
+
+    if (DEBUG_GOOSE_PUBLISHER)
+        printf("GOOSE_PUBLISHER: send pre-encoded GOOSE message\n");
+
+    Ethernet_sendPacket(self->ethernetSocket, self->buffer, frameSize);
+
+    return 0;
+}
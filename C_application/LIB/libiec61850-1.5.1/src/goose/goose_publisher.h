@@ -27,6 +27,7 @@
 #include "iec61850_common.h"
 #include "linked_list.h"
 #include "mms_value.h"
+#include "hal_ethernet.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -67,6 +68,29 @@ GoosePublisher_create(CommParameters* parameters, const char* interfaceID);
 LIB61850_API GoosePublisher
 GoosePublisher_createEx(CommParameters* parameters, const char* interfaceID, bool useVlanTag);
 
+/**
+ * \brief Create a new GoosePublisher instance that sends through an existing Ethernet socket
+ *
+ * Many publishers (e.g. simulated IEDs) can share a single socket and their frames can be sent
+ * in batches with \ref Ethernet_sendPackets. The socket is not destroyed with the publisher.
+ *
+ * \param parameters GOOSE communication parameters
+ * \param interfaceId name of the Ethernet interface of the socket (source MAC address)
+ * \param ethSocket the socket used to send the messages
+ * \param useVlanTag enable or disable the usage of VLAN tags in GOOSE messages
+ */
+LIB61850_API GoosePublisher
+GoosePublisher_createWithSocket(CommParameters* parameters, const char* interfaceID, EthernetSocket ethSocket,
+        bool useVlanTag);
+
+/**
+ * \brief Get the Ethernet socket used by the GoosePublisher instance
+ *
+ * \param self GoosePublisher instance
+ */
+LIB61850_API EthernetSocket
+GoosePublisher_getSocket(GoosePublisher self);
+
 /**
  * \brief Release all resources of the GoosePublisher instance
  *
@@ -98,6 +122,79 @@ GoosePublisher_publish(GoosePublisher self, LinkedList dataSet);
 LIB61850_API int
 GoosePublisher_publishAndDump(GoosePublisher self, LinkedList dataSet, char* msgBuf, int32_t* msgLen, int32_t bufSize);
 
+/**
+ * \brief Encode the data set once for the pre-encoded frame mode
+ *
+ * The data set entries are BER encoded a single time and the complete GOOSE frame is built
+ * around them. Afterwards \ref GoosePublisher_publishFrame only patches stNum, sqNum and the
+ * timestamp in place and single entries are replaced with \ref GoosePublisher_setDataSetValue,
+ * no MmsValue is encoded when publishing. The data set can be set up again at any time.
+ *
+ * NOTE: The data set must not contain NULL values. \ref GoosePublisher_publish can still be used
+ * but overwrites the pre-encoded frame, it is encoded again by the next \ref GoosePublisher_publishFrame.
+ *
+ * \param self GoosePublisher instance
+ * \param dataSet the GOOSE data set (list of MmsValue)
+ *
+ * \return true if the data set fits into a single frame, false otherwise
+ */
+LIB61850_API bool
+GoosePublisher_setupDataSet(GoosePublisher self, LinkedList dataSet);
+
+/**
+ * \brief Replace an entry of the pre-encoded data set
+ *
+ * When the encoded size of the value does not change (e.g. BOOLEAN, fixed size BIT STRING,
+ * FLOAT, UTC time) the entry is patched in place at its fixed offset in the frame. Otherwise the
+ * following entries are moved and the frame is encoded again by the next publish.
+ *
+ * NOTE: Changing a data set member is a state change, call \ref GoosePublisher_increaseStNum.
+ *
+ * \param self GoosePublisher instance
+ * \param index position of the entry in the data set
+ * \param value the new value of the entry
+ *
+ * \return true if the entry has been replaced, false otherwise
+ */
+LIB61850_API bool
+GoosePublisher_setDataSetValue(GoosePublisher self, int index, MmsValue* value);
+
+/**
+ * \brief Update the pre-encoded frame for the next message without sending it
+ *
+ * Patches stNum, sqNum and the timestamp into the frame and increases the sequence number, like
+ * \ref GoosePublisher_publish does. The frame is returned by \ref GoosePublisher_getFrameBuffer and
+ * stays valid until the next call of a function of this publisher.
+ *
+ * \param self GoosePublisher instance
+ *
+ * \return size of the frame in bytes, -1 if no data set has been set up or it does not fit into a frame
+ */
+LIB61850_API int
+GoosePublisher_updateFrame(GoosePublisher self);
+
+/**
+ * \brief Get the buffer of the frame prepared by \ref GoosePublisher_updateFrame
+ *
+ * \param self GoosePublisher instance
+ *
+ * \return the complete Ethernet frame
+ */
+LIB61850_API uint8_t*
+GoosePublisher_getFrameBuffer(GoosePublisher self);
+
+/**
+ * \brief Publish a GOOSE message from the pre-encoded frame
+ *
+ * NOTE: This function also increases the sequence number of the GOOSE publisher
+ *
+ * \param self GoosePublisher instance
+ *
+ * \return 0 on success, -1 if no data set has been set up with \ref GoosePublisher_setupDataSet
+ */
+LIB61850_API int
+GoosePublisher_publishFrame(GoosePublisher self);
+
 /**
  * \brief Sets the GoID used by the GoosePublisher instance
  *
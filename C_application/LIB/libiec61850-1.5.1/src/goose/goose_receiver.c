@@ -45,6 +45,22 @@
 
 #define ETH_P_GOOSE 0x88b8
 
+#define GOOSE_SUBSCRIBER_INDEX_INITIAL_SIZE 16
+
+/* memory for the data set values of a subscriber decoding into an arena */
+#define GOOSE_VALUE_ARENA_INITIAL_SIZE 4096
+#define GOOSE_VALUE_ARENA_MAX_SIZE (1024 * 1024)
+
+/* entry of the subscriber index (hash table keyed by appId, goCbRef and dstMac) */
+typedef struct sGooseSubscriberIndexEntry* GooseSubscriberIndexEntry;
+
+struct sGooseSubscriberIndexEntry
+{
+    GooseSubscriber subscriber;
+    uint32_t hash;
+    GooseSubscriberIndexEntry next;
+};
+
 struct sGooseReceiver
 {
     bool running;
@@ -53,6 +69,22 @@ struct sGooseReceiver
     uint8_t* buffer;
     EthernetSocket ethSocket;
     LinkedList subscriberList;
+
+    /* subscriber index, observers are not indexed */
+    GooseSubscriberIndexEntry* indexBuckets;
+    int indexSize; /* number of buckets (power of two) */
+    int indexCount;
+    int wildcardAppIdCount; /* indexed subscribers accepting any APPID */
+    int wildcardDstMacCount; /* indexed subscribers accepting any destination MAC */
+    GooseSubscriber observer;
+
+    /* memory mapped receive ring (0 blocks: disabled) */
+    int rxRingBlockSize;
+    int rxRingBlockCount;
+    int rxRingBlockTimeoutMs;
+
+    bool rxTimestamps;
+    uint64_t rxTimestamp; /* kernel receive time of the frame being parsed */
 #if (CONFIG_MMS_THREADLESS_STACK == 0)
     Thread thread;
 #endif
@@ -70,6 +102,17 @@ GooseReceiver_createEx(uint8_t* buffer)
         self->buffer = buffer;
         self->ethSocket = NULL;
         self->subscriberList = LinkedList_create();
+        self->indexBuckets = NULL;
+        self->indexSize = 0;
+        self->indexCount = 0;
+        self->wildcardAppIdCount = 0;
+        self->wildcardDstMacCount = 0;
+        self->observer = NULL;
+        self->rxRingBlockSize = 0;
+        self->rxRingBlockCount = 0;
+        self->rxRingBlockTimeoutMs = 0;
+        self->rxTimestamps = false;
+        self->rxTimestamp = 0;
 #if (CONFIG_MMS_THREADLESS_STACK == 0)
         self->thread = NULL;
 #endif
@@ -90,16 +133,314 @@ GooseReceiver_create()
     return self;
 }
 
+/* FNV-1a over goCbRef, APPID and destination MAC (-1 / NULL for the wildcards) */
+static uint32_t
+subscriberIndexHash(const uint8_t* goCbRef, int goCbRefLen, int32_t appId, const uint8_t* dstMac)
+{
+    uint32_t hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < goCbRefLen; i++) {
+        hash ^= goCbRef[i];
+        hash *= 16777619u;
+    }
+
+    for (i = 0; i < 4; i++) {
+        hash ^= (uint8_t) (((uint32_t) appId) >> (8 * i));
+        hash *= 16777619u;
+    }
+
+    if (dstMac) {
+        for (i = 0; i < 6; i++) {
+            hash ^= dstMac[i];
+            hash *= 16777619u;
+        }
+    }
+    else {
+        hash ^= 0xff;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static uint32_t
+subscriberIndexHashOf(GooseSubscriber subscriber)
+{
+    return subscriberIndexHash((const uint8_t*) subscriber->goCBRef, subscriber->goCBRefLen, subscriber->appId,
+            subscriber->dstMacSet ? subscriber->dstMac : NULL);
+}
+
+static bool
+subscriberIndexResize(GooseReceiver self, int newSize)
+{
+    GooseSubscriberIndexEntry* buckets = (GooseSubscriberIndexEntry*) GLOBAL_CALLOC(newSize, sizeof(GooseSubscriberIndexEntry));
+    int i;
+
+    if (buckets == NULL)
+        return false;
+
+    for (i = 0; i < self->indexSize; i++) {
+        GooseSubscriberIndexEntry entry = self->indexBuckets[i];
+
+        while (entry) {
+            GooseSubscriberIndexEntry next = entry->next;
+            int bucket = entry->hash & (newSize - 1);
+
+            entry->next = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    if (self->indexBuckets)
+        GLOBAL_FREEMEM(self->indexBuckets);
+
+    self->indexBuckets = buckets;
+    self->indexSize = newSize;
+
+    return true;
+}
+
+static void
+subscriberIndexAdd(GooseReceiver self, GooseSubscriber subscriber)
+{
+    GooseSubscriberIndexEntry entry;
+
+    if (subscriber->isObserver) {
+        if (self->observer == NULL)
+            self->observer = subscriber;
+        return;
+    }
+
+    if (self->indexCount >= self->indexSize) {
+        if (subscriberIndexResize(self, self->indexSize ? self->indexSize * 2 : GOOSE_SUBSCRIBER_INDEX_INITIAL_SIZE) == false)
+            return;
+    }
+
+    entry = (GooseSubscriberIndexEntry) GLOBAL_MALLOC(sizeof(struct sGooseSubscriberIndexEntry));
+
+    if (entry) {
+        int bucket;
+
+        entry->subscriber = subscriber;
+        entry->hash = subscriberIndexHashOf(subscriber);
+
+        bucket = entry->hash & (self->indexSize - 1);
+        entry->next = self->indexBuckets[bucket];
+        self->indexBuckets[bucket] = entry;
+
+        self->indexCount++;
+
+        if (subscriber->appId == -1)
+            self->wildcardAppIdCount++;
+
+        if (subscriber->dstMacSet == false)
+            self->wildcardDstMacCount++;
+    }
+}
+
+static void
+subscriberIndexRemove(GooseReceiver self, GooseSubscriber subscriber)
+{
+    int i;
+
+    if (subscriber == self->observer) {
+        LinkedList element;
+
+        self->observer = NULL;
+
+        /* promote the next observer, if any */
+        element = LinkedList_getNext(self->subscriberList);
+
+        while (element) {
+            GooseSubscriber other = (GooseSubscriber) LinkedList_getData(element);
+
+            if (other->isObserver) {
+                self->observer = other;
+                break;
+            }
+
+            element = LinkedList_getNext(element);
+        }
+
+        return;
+    }
+
+    /* the key fields may have changed since the subscriber was added: search all buckets */
+    for (i = 0; i < self->indexSize; i++) {
+        GooseSubscriberIndexEntry* link = &(self->indexBuckets[i]);
+
+        while (*link) {
+            GooseSubscriberIndexEntry entry = *link;
+
+            if (entry->subscriber == subscriber) {
+                *link = entry->next;
+
+                self->indexCount--;
+
+                if (subscriber->appId == -1)
+                    self->wildcardAppIdCount--;
+
+                if (subscriber->dstMacSet == false)
+                    self->wildcardDstMacCount--;
+
+                GLOBAL_FREEMEM(entry);
+                return;
+            }
+
+            link = &(entry->next);
+        }
+    }
+}
+
+static void
+subscriberIndexDestroy(GooseReceiver self)
+{
+    int i;
+
+    for (i = 0; i < self->indexSize; i++) {
+        GooseSubscriberIndexEntry entry = self->indexBuckets[i];
+
+        while (entry) {
+            GooseSubscriberIndexEntry next = entry->next;
+            GLOBAL_FREEMEM(entry);
+            entry = next;
+        }
+    }
+
+    if (self->indexBuckets)
+        GLOBAL_FREEMEM(self->indexBuckets);
+
+    self->indexBuckets = NULL;
+    self->indexSize = 0;
+    self->indexCount = 0;
+}
+
+static GooseSubscriber
+subscriberIndexProbe(GooseReceiver self, const uint8_t* goCbRef, int goCbRefLen, int32_t appId, const uint8_t* dstMac)
+{
+    uint32_t hash = subscriberIndexHash(goCbRef, goCbRefLen, appId, dstMac);
+    GooseSubscriberIndexEntry entry = self->indexBuckets[hash & (self->indexSize - 1)];
+
+    while (entry) {
+        GooseSubscriber subscriber = entry->subscriber;
+
+        if ((entry->hash == hash) && (subscriber->goCBRefLen == goCbRefLen) && (subscriber->appId == appId) &&
+                (dstMac ? (subscriber->dstMacSet && (memcmp(subscriber->dstMac, dstMac, 6) == 0)) : (subscriber->dstMacSet == false)) &&
+                (memcmp(subscriber->goCBRef, goCbRef, goCbRefLen) == 0))
+        {
+            return subscriber;
+        }
+
+        entry = entry->next;
+    }
+
+    return NULL;
+}
+
+/* find the subscriber of a message, exact key first, then the wildcard subscribers */
+static GooseSubscriber
+subscriberIndexLookup(GooseReceiver self, const uint8_t* goCbRef, int goCbRefLen, uint16_t appId, const uint8_t* dstMac)
+{
+    GooseSubscriber subscriber;
+
+    if (self->indexCount == 0)
+        return NULL;
+
+    subscriber = subscriberIndexProbe(self, goCbRef, goCbRefLen, appId, dstMac);
+
+    if ((subscriber == NULL) && self->wildcardAppIdCount)
+        subscriber = subscriberIndexProbe(self, goCbRef, goCbRefLen, -1, dstMac);
+
+    if ((subscriber == NULL) && self->wildcardDstMacCount)
+        subscriber = subscriberIndexProbe(self, goCbRef, goCbRefLen, appId, NULL);
+
+    if ((subscriber == NULL) && self->wildcardAppIdCount && self->wildcardDstMacCount)
+        subscriber = subscriberIndexProbe(self, goCbRef, goCbRefLen, -1, NULL);
+
+    return subscriber;
+}
+
+/* let the kernel drop the frames no subscriber is interested in */
+static void
+updateFrameFilter(GooseReceiver self)
+{
+    uint16_t etherType = ETH_P_GOOSE;
+    int subscriberCount = LinkedList_size(self->subscriberList);
+    uint16_t* appIds = NULL;
+    uint8_t* dstMacs = NULL;
+    int appIdCount = 0;
+    int dstMacCount = 0;
+
+    if (self->ethSocket == NULL)
+        return;
+
+    /* observers and wildcard subscribers receive every GOOSE message */
+    if ((self->observer == NULL) && (self->indexCount > 0)) {
+        if (self->wildcardAppIdCount == 0)
+            appIds = (uint16_t*) GLOBAL_MALLOC(subscriberCount * sizeof(uint16_t));
+
+        if (self->wildcardDstMacCount == 0)
+            dstMacs = (uint8_t*) GLOBAL_MALLOC(subscriberCount * 6);
+    }
+
+    LinkedList element = LinkedList_getNext(self->subscriberList);
+
+    while (element) {
+        GooseSubscriber subscriber = (GooseSubscriber) LinkedList_getData(element);
+        int i;
+
+        if (appIds) {
+            for (i = 0; i < appIdCount; i++) {
+                if (appIds[i] == (uint16_t) subscriber->appId)
+                    break;
+            }
+
+            if (i == appIdCount)
+                appIds[appIdCount++] = (uint16_t) subscriber->appId;
+        }
+
+        if (dstMacs) {
+            for (i = 0; i < dstMacCount; i++) {
+                if (memcmp(dstMacs + (6 * i), subscriber->dstMac, 6) == 0)
+                    break;
+            }
+
+            if (i == dstMacCount)
+                memcpy(dstMacs + (6 * dstMacCount++), subscriber->dstMac, 6);
+        }
+
+        element = LinkedList_getNext(element);
+    }
+
+    if (Ethernet_setFrameFilter(self->ethSocket, &etherType, 1, appIds, appIdCount, dstMacs, dstMacCount) == false) {
+        if (DEBUG_GOOSE_SUBSCRIBER)
+            printf("GOOSE_SUBSCRIBER: failed to set kernel frame filter\n");
+    }
+
+    if (appIds)
+        GLOBAL_FREEMEM(appIds);
+
+    if (dstMacs)
+        GLOBAL_FREEMEM(dstMacs);
+}
+
 void
 GooseReceiver_addSubscriber(GooseReceiver self, GooseSubscriber subscriber)
 {
     LinkedList_add(self->subscriberList, (void*) subscriber);
+    subscriberIndexAdd(self, subscriber);
+    updateFrameFilter(self);
 }
 
 void
 GooseReceiver_removeSubscriber(GooseReceiver self, GooseSubscriber subscriber)
 {
-    LinkedList_remove(self->subscriberList, (void*) subscriber);
+    if (LinkedList_remove(self->subscriberList, (void*) subscriber)) {
+        subscriberIndexRemove(self, subscriber);
+        updateFrameFilter(self);
+    }
 }
 
 void
@@ -111,6 +452,20 @@ GooseReceiver_setInterfaceId(GooseReceiver self, const char* interfaceId)
     self->interfaceId = StringUtils_copyString(interfaceId);
 }
 
+void
+GooseReceiver_enableRxRing(GooseReceiver self, int blockSize, int blockCount, int blockTimeoutMs)
+{
+    self->rxRingBlockSize = blockSize;
+    self->rxRingBlockCount = blockCount;
+    self->rxRingBlockTimeoutMs = blockTimeoutMs;
+}
+
+void
+GooseReceiver_enableRxTimestamps(GooseReceiver self)
+{
+    self->rxTimestamps = true;
+}
+
 const char*
 GooseReceiver_getInterfaceId(GooseReceiver self)
 {
@@ -129,8 +484,9 @@ createNewStringFromBufferElement(MmsValue* value, uint8_t* bufferSrc, int elemen
     value->value.visibleString.size = elementLength;
 }
 
+/* update the values in place - allowRealloc: growing strings may be reallocated (not for arena values) */
 static GooseParseError
-parseAllData(uint8_t* buffer, int allDataLength, MmsValue* dataSetValues)
+parseAllData(uint8_t* buffer, int allDataLength, MmsValue* dataSetValues, bool allowRealloc)
 {
     int bufPos = 0;
     int elementLength = 0;
@@ -174,7 +530,7 @@ parseAllData(uint8_t* buffer, int allDataLength, MmsValue* dataSetValues)
             if (DEBUG_GOOSE_SUBSCRIBER)
                 printf("GOOSE_SUBSCRIBER:    found array\n");
             if (MmsValue_getType(value) == MMS_ARRAY) {
-                if (parseAllData(buffer + bufPos, elementLength, value) != GOOSE_PARSE_ERROR_NO_ERROR)
+                if (parseAllData(buffer + bufPos, elementLength, value, allowRealloc) != GOOSE_PARSE_ERROR_NO_ERROR)
                     pe = GOOSE_PARSE_ERROR_SUBLEVEL;
             }
             else {
@@ -186,7 +542,7 @@ parseAllData(uint8_t* buffer, int allDataLength, MmsValue* dataSetValues)
             if (DEBUG_GOOSE_SUBSCRIBER)
                 printf("GOOSE_SUBSCRIBER:    found structure\n");
             if (MmsValue_getType(value) == MMS_STRUCTURE) {
-                if (parseAllData(buffer + bufPos, elementLength, value) != GOOSE_PARSE_ERROR_NO_ERROR)
+                if (parseAllData(buffer + bufPos, elementLength, value, allowRealloc) != GOOSE_PARSE_ERROR_NO_ERROR)
                     pe = GOOSE_PARSE_ERROR_SUBLEVEL;
             }
             else {
@@ -277,6 +633,9 @@ parseAllData(uint8_t* buffer, int allDataLength, MmsValue* dataSetValues)
                     value->value.octetString.size = elementLength;
                     memcpy(value->value.octetString.buf, buffer + bufPos, elementLength);
                 }
+                else if (allowRealloc == false) {
+                    pe = GOOSE_PARSE_ERROR_LENGTH_MISMATCH;
+                }
                 else {
                     uint8_t* newBuf = (uint8_t*)GLOBAL_MALLOC(elementLength);
 
@@ -307,12 +666,17 @@ parseAllData(uint8_t* buffer, int allDataLength, MmsValue* dataSetValues)
                         memcpy(value->value.visibleString.buf, buffer + bufPos, elementLength);
                         value->value.visibleString.buf[elementLength] = 0;
                     }
+                    else if (allowRealloc == false) {
+                        pe = GOOSE_PARSE_ERROR_LENGTH_MISMATCH;
+                    }
                     else {
                         GLOBAL_FREEMEM(value->value.visibleString.buf);
 
                         createNewStringFromBufferElement(value, buffer + bufPos, elementLength);
                     }
                 }
+                else if (allowRealloc == false)
+                    pe = GOOSE_PARSE_ERROR_LENGTH_MISMATCH;
                 else
                     createNewStringFromBufferElement(value, buffer + bufPos, elementLength);
 
@@ -361,7 +725,7 @@ parseAllData(uint8_t* buffer, int allDataLength, MmsValue* dataSetValues)
         elementIndex++;
     }
 
-    if (elementIndex <= maxIndex) {
+    if ((pe == GOOSE_PARSE_ERROR_NO_ERROR) && (elementIndex <= maxIndex)) {
         pe = GOOSE_PARSE_ERROR_UNDERFLOW;
     }
 
@@ -589,8 +953,308 @@ parseAllDataUnknownValue(GooseSubscriber self, uint8_t* buffer, int allDataLengt
     return NULL;
 }
 
+/* bump allocator for data set values decoded into the subscriber arena */
+struct sGooseValueArena
+{
+    uint8_t* memory;
+    int size;
+    int used;
+    bool exhausted;
+};
+
+static void*
+valueArena_alloc(struct sGooseValueArena* arena, int size)
+{
+    void* ptr;
+
+    size = (size + 7) & ~7;
+
+    if ((size > arena->size) || (arena->used > arena->size - size)) {
+        arena->exhausted = true;
+        return NULL;
+    }
+
+    ptr = arena->memory + arena->used;
+    arena->used += size;
+
+    memset(ptr, 0, size);
+
+    return ptr;
+}
+
+static MmsValue*
+valueArena_newValue(struct sGooseValueArena* arena, MmsType type)
+{
+    MmsValue* value = (MmsValue*) valueArena_alloc(arena, sizeof(MmsValue));
+
+    if (value)
+        value->type = type;
+
+    return value;
+}
+
+/* same as parseAllDataUnknownValue but all memory is taken from the arena - returns NULL when the arena is exhausted */
+static MmsValue*
+parseAllDataToArena(struct sGooseValueArena* arena, uint8_t* buffer, int allDataLength, bool isStructure)
+{
+    int bufPos = 0;
+    int elementLength = 0;
+    int elementCount = 0;
+
+    while (bufPos < allDataLength) {
+        bufPos++;
+
+        bufPos = BerDecoder_decodeLength(buffer, &elementLength, bufPos, allDataLength);
+        if (bufPos < 0)
+            return NULL;
+
+        bufPos += elementLength;
+        elementCount++;
+    }
+
+    MmsValue* dataSetValues = valueArena_newValue(arena, isStructure ? MMS_STRUCTURE : MMS_ARRAY);
+
+    if (dataSetValues == NULL)
+        return NULL;
+
+    dataSetValues->value.structure.components = (MmsValue**) valueArena_alloc(arena, elementCount * sizeof(MmsValue*));
+
+    if ((elementCount > 0) && (dataSetValues->value.structure.components == NULL))
+        return NULL;
+
+    int elementIndex = 0;
+
+    bufPos = 0;
+
+    while (bufPos < allDataLength) {
+        uint8_t tag = buffer[bufPos++];
+
+        bufPos = BerDecoder_decodeLength(buffer, &elementLength, bufPos, allDataLength);
+        if (bufPos < 0)
+            return NULL;
+
+        MmsValue* value = NULL;
+
+        switch (tag)
+        {
+        case 0x80: /* reserved for access result */
+            break;
+
+        case 0xa1: /* array */
+        case 0xa2: /* structure */
+            value = parseAllDataToArena(arena, buffer + bufPos, elementLength, (tag == 0xa2));
+
+            if (value == NULL)
+                return NULL;
+
+            break;
+
+        case 0x83: /* boolean */
+            value = valueArena_newValue(arena, MMS_BOOLEAN);
+
+            if (value)
+                value->value.boolean = BerDecoder_decodeBoolean(buffer, bufPos);
+
+            break;
+
+        case 0x84: /* BIT STRING */
+            if (elementLength > 0) {
+                value = valueArena_newValue(arena, MMS_BIT_STRING);
+
+                if (value) {
+                    value->value.bitString.size = (8 * (elementLength - 1)) - buffer[bufPos];
+                    value->value.bitString.buf = (uint8_t*) valueArena_alloc(arena, elementLength);
+
+                    if (value->value.bitString.buf == NULL)
+                        return NULL;
+
+                    memcpy(value->value.bitString.buf, buffer + bufPos + 1, elementLength - 1);
+                }
+            }
+            break;
+
+        case 0x85: /* integer */
+        case 0x86: /* unsigned integer */
+            value = valueArena_newValue(arena, (tag == 0x85) ? MMS_INTEGER : MMS_UNSIGNED);
+
+            if (value) {
+                /* room for the largest 32/64 bit encoding so that the value can be updated in place */
+                int maxSize = (elementLength <= 4) ? 5 : 9;
+
+                if (elementLength > maxSize)
+                    maxSize = elementLength;
+
+                value->value.integer = (Asn1PrimitiveValue*) valueArena_alloc(arena, sizeof(Asn1PrimitiveValue));
+
+                if (value->value.integer == NULL)
+                    return NULL;
+
+                value->value.integer->octets = (uint8_t*) valueArena_alloc(arena, maxSize);
+
+                if (value->value.integer->octets == NULL)
+                    return NULL;
+
+                value->value.integer->maxSize = maxSize;
+                value->value.integer->size = elementLength;
+                memcpy(value->value.integer->octets, buffer + bufPos, elementLength);
+            }
+            break;
+
+        case 0x87: /* Float */
+            if ((elementLength == 9) || (elementLength == 5)) {
+                value = valueArena_newValue(arena, MMS_FLOAT);
+
+                if (value) {
+                    if (elementLength == 9) {
+                        value->value.floatingPoint.formatWidth = 64;
+                        value->value.floatingPoint.exponentWidth = 11;
+                        MmsValue_setDouble(value, BerDecoder_decodeDouble(buffer, bufPos));
+                    }
+                    else {
+                        value->value.floatingPoint.formatWidth = 32;
+                        value->value.floatingPoint.exponentWidth = 8;
+                        MmsValue_setFloat(value, BerDecoder_decodeFloat(buffer, bufPos));
+                    }
+                }
+            }
+            break;
+
+        case 0x89: /* octet string */
+            value = valueArena_newValue(arena, MMS_OCTET_STRING);
+
+            if (value) {
+                value->value.octetString.buf = (uint8_t*) valueArena_alloc(arena, elementLength);
+
+                if ((elementLength > 0) && (value->value.octetString.buf == NULL))
+                    return NULL;
+
+                value->value.octetString.size = elementLength;
+                value->value.octetString.maxSize = elementLength;
+                memcpy(value->value.octetString.buf, buffer + bufPos, elementLength);
+            }
+            break;
+
+        case 0x8a: /* visible string */
+            value = valueArena_newValue(arena, MMS_VISIBLE_STRING);
+
+            if (value) {
+                value->value.visibleString.buf = (char*) valueArena_alloc(arena, elementLength + 1);
+
+                if (value->value.visibleString.buf == NULL)
+                    return NULL;
+
+                memcpy(value->value.visibleString.buf, buffer + bufPos, elementLength);
+                value->value.visibleString.buf[elementLength] = 0;
+                value->value.visibleString.size = elementLength;
+            }
+            break;
+
+        case 0x8c: /* binary time */
+            if ((elementLength == 4) || (elementLength == 6)) {
+                value = valueArena_newValue(arena, MMS_BINARY_TIME);
+
+                if (value) {
+                    value->value.binaryTime.size = elementLength;
+                    memcpy(value->value.binaryTime.buf, buffer + bufPos, elementLength);
+                }
+            }
+            break;
+
+        case 0x91: /* Utctime */
+            if (elementLength == 8) {
+                value = valueArena_newValue(arena, MMS_UTC_TIME);
+
+                if (value)
+                    MmsValue_setUtcTimeByBuffer(value, buffer + bufPos);
+            }
+            break;
+
+        default:
+            if (DEBUG_GOOSE_SUBSCRIBER)
+                printf("GOOSE_SUBSCRIBER:    found unkown tag %02x\n", tag);
+            return NULL;
+        }
+
+        if (arena->exhausted)
+            return NULL;
+
+        bufPos += elementLength;
+
+        if (value != NULL)
+            dataSetValues->value.structure.components[elementIndex++] = value;
+    }
+
+    /* elements with an invalid length are skipped */
+    dataSetValues->value.structure.size = elementIndex;
+
+    return dataSetValues;
+}
+
+/* release the data set values allocated by the receiver */
+static void
+releaseDataSetValues(GooseSubscriber self)
+{
+    if (self->dataSetValuesInArena == false)
+        MmsValue_delete(self->dataSetValues);
+
+    self->dataSetValues = NULL;
+    self->dataSetValuesInArena = false;
+}
+
+/* build a new value tree for a data set of unknown structure */
+static MmsValue*
+createDataSetValues(GooseSubscriber self, uint8_t* buffer, int allDataLength)
+{
+    if (self->valueArenaEnabled) {
+        struct sGooseValueArena arena;
+
+        if (self->valueArena == NULL) {
+            self->valueArena = (uint8_t*) GLOBAL_MALLOC(GOOSE_VALUE_ARENA_INITIAL_SIZE);
+            self->valueArenaSize = self->valueArena ? GOOSE_VALUE_ARENA_INITIAL_SIZE : 0;
+        }
+
+        while (self->valueArena) {
+            arena.memory = self->valueArena;
+            arena.size = self->valueArenaSize;
+            arena.used = 0;
+            arena.exhausted = false;
+
+            MmsValue* values = parseAllDataToArena(&arena, buffer, allDataLength, false);
+
+            if (values) {
+                self->dataSetValuesInArena = true;
+                self->dataSetValuesSelfAllocated = true;
+                return values;
+            }
+
+            /* malformed message */
+            if (arena.exhausted == false)
+                return NULL;
+
+            if (arena.size >= GOOSE_VALUE_ARENA_MAX_SIZE)
+                break;
+
+            /* grow the arena - only happens while the largest data set has not been seen yet */
+            GLOBAL_FREEMEM(self->valueArena);
+
+            self->valueArenaSize *= 2;
+            self->valueArena = (uint8_t*) GLOBAL_MALLOC(self->valueArenaSize);
+
+            if (self->valueArena == NULL)
+                self->valueArenaSize = 0;
+        }
+
+        if (DEBUG_GOOSE_SUBSCRIBER)
+            printf("GOOSE_SUBSCRIBER: value arena exhausted - falling back to heap allocation\n");
+    }
+
+    self->dataSetValuesInArena = false;
+
+    return parseAllDataUnknownValue(self, buffer, allDataLength, false);
+}
+
 static int
-parseGoosePayload(GooseReceiver self, uint8_t* buffer, int apduLength)
+parseGoosePayload(GooseReceiver self, uint8_t* buffer, int apduLength, uint16_t appId, const uint8_t* dstMac)
 {
     int bufPos = 0;
     uint32_t timeAllowedToLive = 0;
@@ -637,38 +1301,28 @@ parseGoosePayload(GooseReceiver self, uint8_t* buffer, int apduLength)
                 if (DEBUG_GOOSE_SUBSCRIBER)
                     printf("GOOSE_SUBSCRIBER:   Found gocbRef\n");
 
-                {
-                    LinkedList element = LinkedList_getNext(self->subscriberList);
-
-                    while (element != NULL) {
-                        GooseSubscriber subscriber = (GooseSubscriber) LinkedList_getData(element);
-
-                        if (subscriber->isObserver)
-                        {
-                            if (elementLength > 129) {
-                                if (DEBUG_GOOSE_SUBSCRIBER)
-                                    printf("GOOSE_SUBSCRIBER:   gocbRef too long!\n");
-                            }
-                            else {
-                                memcpy(subscriber->goCBRef, buffer + bufPos, elementLength);
-                                subscriber->goCBRef[elementLength] = 0;
-                            }
-
-                            matchingSubscriber = subscriber;
-                            break;
-                        }
-                        else if (subscriber->goCBRefLen == elementLength) {
-                            if (memcmp(subscriber->goCBRef, buffer + bufPos, elementLength) == 0) {
-                                if (DEBUG_GOOSE_SUBSCRIBER)
-                                    printf("GOOSE_SUBSCRIBER:   gocbRef is matching!\n");
-                                matchingSubscriber = subscriber;
-                                break;
-                            }
-                        }
+                if (self->observer) {
+                    GooseSubscriber subscriber = self->observer;
 
-                        element = LinkedList_getNext(element);
+                    if (elementLength > 129) {
+                        if (DEBUG_GOOSE_SUBSCRIBER)
+                            printf("GOOSE_SUBSCRIBER:   gocbRef too long!\n");
                     }
+                    else {
+                        memcpy(subscriber->goCBRef, buffer + bufPos, elementLength);
+                        subscriber->goCBRef[elementLength] = 0;
+                    }
+
+                    matchingSubscriber = subscriber;
+                }
+                else {
+                    matchingSubscriber = subscriberIndexLookup(self, buffer + bufPos, elementLength, appId, dstMac);
 
+                    if (DEBUG_GOOSE_SUBSCRIBER && matchingSubscriber)
+                        printf("GOOSE_SUBSCRIBER:   gocbRef is matching!\n");
+                }
+
+                {
                     if (matchingSubscriber == NULL)
                         return 0;
                 }
@@ -784,10 +1438,8 @@ parseGoosePayload(GooseReceiver self, uint8_t* buffer, int apduLength)
 
             if (matchingSubscriber->dataSetValuesSelfAllocated) {
                 /* when confRev changed replaced old data set */
-                if ((matchingSubscriber->dataSetValues != NULL) && (matchingSubscriber->confRev != confRev)) {
-                    MmsValue_delete(matchingSubscriber->dataSetValues);
-                    matchingSubscriber->dataSetValues = NULL;
-                }
+                if ((matchingSubscriber->dataSetValues != NULL) && (matchingSubscriber->confRev != confRev))
+                    releaseDataSetValues(matchingSubscriber);
             }
 
             matchingSubscriber->confRev = confRev;
@@ -801,17 +1453,28 @@ parseGoosePayload(GooseReceiver self, uint8_t* buffer, int apduLength)
                 MmsValue_setUtcTime(matchingSubscriber->timestamp, 0);
             }
             
-            if (matchingSubscriber->isObserver && matchingSubscriber->dataSetValues != NULL) {
-                MmsValue_delete(matchingSubscriber->dataSetValues);
-                matchingSubscriber->dataSetValues = NULL;
-            }
-
             bool isValid = true;
 
-            if (matchingSubscriber->dataSetValues == NULL)
-                matchingSubscriber->dataSetValues = parseAllDataUnknownValue(matchingSubscriber, dataSetBufferAddress, dataSetBufferLength, false);
+            if (matchingSubscriber->rawListener != NULL) {
+                /* the listener decodes allData itself */
+                matchingSubscriber->parseError = GOOSE_PARSE_ERROR_NO_ERROR;
+            }
+            else if (matchingSubscriber->dataSetValues == NULL)
+                matchingSubscriber->dataSetValues = createDataSetValues(matchingSubscriber, dataSetBufferAddress, dataSetBufferLength);
             else {
-                GooseParseError parseError = parseAllData(dataSetBufferAddress, dataSetBufferLength, matchingSubscriber->dataSetValues);
+                /* values in the arena cannot grow: a longer string is handled by decoding into the arena again */
+                GooseParseError parseError = parseAllData(dataSetBufferAddress, dataSetBufferLength, matchingSubscriber->dataSetValues,
+                        (matchingSubscriber->dataSetValuesInArena == false));
+
+                /* the data set of an observer changes with the observed GoCB: reuse the values only when the structure is unchanged */
+                if ((parseError != GOOSE_PARSE_ERROR_NO_ERROR) && (matchingSubscriber->isObserver ||
+                        (matchingSubscriber->dataSetValuesInArena && (parseError == GOOSE_PARSE_ERROR_LENGTH_MISMATCH))))
+                {
+                    releaseDataSetValues(matchingSubscriber);
+                    matchingSubscriber->dataSetValues = createDataSetValues(matchingSubscriber, dataSetBufferAddress, dataSetBufferLength);
+
+                    parseError = GOOSE_PARSE_ERROR_NO_ERROR;
+                }
 
                 if (parseError != GOOSE_PARSE_ERROR_NO_ERROR) {
                     isValid = false;
@@ -832,6 +1495,11 @@ parseGoosePayload(GooseReceiver self, uint8_t* buffer, int apduLength)
             matchingSubscriber->sqNum = sqNum;
 
             matchingSubscriber->invalidityTime = Hal_getTimeInMs() + timeAllowedToLive;
+            matchingSubscriber->rxTimestamp = self->rxTimestamp;
+
+            if (matchingSubscriber->rawListener != NULL)
+                matchingSubscriber->rawListener(matchingSubscriber, dataSetBufferAddress, dataSetBufferLength,
+                        matchingSubscriber->rawListenerParameter);
 
             if (matchingSubscriber->listener != NULL)
                 matchingSubscriber->listener(matchingSubscriber, matchingSubscriber->listenerParameter);
@@ -916,34 +1584,24 @@ parseGooseMessage(GooseReceiver self, uint8_t* buffer, int numbytes)
     }
 
     /* check if there is an interested subscriber */
-    LinkedList element = LinkedList_getNext(self->subscriberList);
-
-    while (element != NULL) {
-        GooseSubscriber subscriber = (GooseSubscriber) LinkedList_getData(element);
-        
-        if (subscriber->isObserver)
-        {
-            subscriber->appId = appId;
-            memcpy(subscriber->srcMac, srcMac,6);
-            memcpy(subscriber->dstMac, dstMac, 6);
-            subscriberFound = true;
-            subscriber->vlanSet = vlanSet;
-            subscriber->vlanId = vlanId;
-            subscriber->vlanPrio = priority;
-            break;
-        }
-
-        if (((subscriber->appId == -1) || (subscriber->appId == appId)) &&
-                (!subscriber->dstMacSet || (memcmp(subscriber->dstMac, dstMac,6) == 0))) {
-            subscriberFound = true;
-            break;
-        }
-
-        element = LinkedList_getNext(element);
+    if (self->observer) {
+        GooseSubscriber subscriber = self->observer;
+
+        subscriber->appId = appId;
+        memcpy(subscriber->srcMac, srcMac,6);
+        memcpy(subscriber->dstMac, dstMac, 6);
+        subscriberFound = true;
+        subscriber->vlanSet = vlanSet;
+        subscriber->vlanId = vlanId;
+        subscriber->vlanPrio = priority;
+    }
+    else if (self->indexCount > 0) {
+        /* the subscriber is selected with the gocbRef in the payload */
+        subscriberFound = true;
     }
 
     if (subscriberFound)
-        parseGoosePayload(self, buffer + bufPos, apduLength);
+        parseGoosePayload(self, buffer + bufPos, apduLength, appId, dstMac);
     else {
         if (DEBUG_GOOSE_SUBSCRIBER)
             printf("GOOSE_SUBSCRIBER: GOOSE message ignored due to unknown DST-MAC or APPID value\n");
@@ -1039,6 +1697,8 @@ GooseReceiver_destroy(GooseReceiver self)
         if (self->interfaceId != NULL)
             GLOBAL_FREEMEM(self->interfaceId);
 
+        subscriberIndexDestroy(self);
+
         LinkedList_destroyDeep(self->subscriberList,
                 (LinkedListValueDeleteFunction) GooseSubscriber_destroy);
 
@@ -1059,7 +1719,22 @@ GooseReceiver_startThreadless(GooseReceiver self)
         self->ethSocket = Ethernet_createSocket(self->interfaceId, NULL);
 
     if (self->ethSocket != NULL) {
-        Ethernet_setProtocolFilter(self->ethSocket, ETH_P_GOOSE);
+        updateFrameFilter(self);
+
+        if (self->rxRingBlockCount > 0) {
+            if (Ethernet_enableRxRing(self->ethSocket, self->rxRingBlockSize, self->rxRingBlockCount,
+                    self->rxRingBlockTimeoutMs) == false)
+            {
+                if (DEBUG_GOOSE_SUBSCRIBER)
+                    printf("GOOSE_SUBSCRIBER: receive ring not available - using normal receive\n");
+            }
+        }
+
+        if (self->rxTimestamps) {
+            if ((Ethernet_enableRxTimestamps(self->ethSocket) == false) && DEBUG_GOOSE_SUBSCRIBER)
+                printf("GOOSE_SUBSCRIBER: receive timestamps not available\n");
+        }
+
         self->running = true;
     }
     else
@@ -1071,28 +1746,35 @@ GooseReceiver_startThreadless(GooseReceiver self)
 void
 GooseReceiver_stopThreadless(GooseReceiver self)
 {
-    if (self->ethSocket)
+    if (self->ethSocket) {
         Ethernet_destroySocket(self->ethSocket);
+        self->ethSocket = NULL;
+    }
 
     self->running = false;
 }
 
 /* call after reception of ethernet frame */
+static void
+handleReceivedFrame(void* parameter, uint8_t* frame, int frameSize)
+{
+    GooseReceiver self = (GooseReceiver) parameter;
+
+    self->rxTimestamp = Ethernet_getRxTimestamp(self->ethSocket);
+
+    parseGooseMessage(self, frame, frameSize);
+}
+
 bool
 GooseReceiver_tick(GooseReceiver self)
 {
-    int packetSize = Ethernet_receivePacket(self->ethSocket, self->buffer, ETH_BUFFER_LENGTH);
-
-    if (packetSize > 0) {
-        parseGooseMessage(self, self->buffer, packetSize);
-        return true;
-    }
-    else
-        return false;
+    return (Ethernet_receivePackets(self->ethSocket, self->buffer, ETH_BUFFER_LENGTH,
+            handleReceivedFrame, (void*) self) > 0);
 }
 
 void
 GooseReceiver_handleMessage(GooseReceiver self, uint8_t* buffer, int size)
 {
+    self->rxTimestamp = 0;
     parseGooseMessage(self, buffer, size);
 }
@@ -73,6 +73,35 @@ GooseReceiver_createEx(uint8_t* buffer);
 LIB61850_API void
 GooseReceiver_setInterfaceId(GooseReceiver self, const char* interfaceId);
 
+/**
+ * \brief Receive the frames through a memory mapped receive ring (Linux: TPACKET_V3)
+ *
+ * The frames are parsed directly from the ring blocks, which are released to the kernel
+ * as a whole. Has to be called before the receiver is started. When the platform does
+ * not support a receive ring the receiver uses the normal receive path.
+ *
+ * NOTE: a block is passed to the receiver when it is full or when \p blockTimeoutMs
+ * expires, so the timeout bounds the additional receive latency.
+ *
+ * \param self the GooseReceiver instance
+ * \param blockSize size of a ring block in bytes
+ * \param blockCount number of blocks in the ring
+ * \param blockTimeoutMs time after which a partially filled block is processed
+ */
+LIB61850_API void
+GooseReceiver_enableRxRing(GooseReceiver self, int blockSize, int blockCount, int blockTimeoutMs);
+
+/**
+ * \brief Timestamp the received frames in the kernel
+ *
+ * The receive time of the last message is available with \ref GooseSubscriber_getRxTimestamp.
+ * Has to be called before the receiver is started. Not supported on all platforms.
+ *
+ * \param self the GooseReceiver instance
+ */
+LIB61850_API void
+GooseReceiver_enableRxTimestamps(GooseReceiver self);
+
 /**
  * \brief return the interface ID used by the GOOSE receiver
  *
@@ -86,6 +115,11 @@ GooseReceiver_getInterfaceId(GooseReceiver self);
 /**
  * \brief Add a subscriber to this receiver instance
  *
+ * The receiver indexes its subscribers by GoCB reference, APPID and destination MAC address,
+ * so that incoming messages are dispatched in constant time regardless of the number of
+ * subscribers. Set these parameters (GooseSubscriber_setAppId, GooseSubscriber_setDstMac)
+ * before adding the subscriber and do not change them afterwards.
+ *
  * NOTE: Do not call this function while the receiver is running (after GooseReceiver_start
  * has been called)!
  *
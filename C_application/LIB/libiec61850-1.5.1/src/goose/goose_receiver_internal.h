@@ -65,6 +65,17 @@ struct sGooseSubscriber {
 
     GooseListener listener;
     void* listenerParameter;
+
+    GooseRawListener rawListener;
+    void* rawListenerParameter;
+
+    /* data set values decoded into a subscriber owned arena instead of single heap allocations */
+    bool valueArenaEnabled;
+    bool dataSetValuesInArena;
+    uint8_t* valueArena;
+    int valueArenaSize;
+
+    uint64_t rxTimestamp; /* kernel receive time of the last message (ns since epoch), 0 if not available */
 };
 
 
@@ -101,9 +101,12 @@ GooseSubscriber_destroy(GooseSubscriber self)
     if (self) {
         MmsValue_delete(self->timestamp);
 
-        if (self->dataSetValuesSelfAllocated)
+        if (self->dataSetValuesSelfAllocated && (self->dataSetValuesInArena == false))
             MmsValue_delete(self->dataSetValues);
 
+        if (self->valueArena)
+            GLOBAL_FREEMEM(self->valueArena);
+
         GLOBAL_FREEMEM(self);
     }
 }
@@ -115,6 +118,19 @@ GooseSubscriber_setListener(GooseSubscriber self, GooseListener listener, void*
     self->listenerParameter = parameter;
 }
 
+void
+GooseSubscriber_setRawListener(GooseSubscriber self, GooseRawListener listener, void* parameter)
+{
+    self->rawListener = listener;
+    self->rawListenerParameter = parameter;
+}
+
+void
+GooseSubscriber_enableValueArena(GooseSubscriber self, bool enable)
+{
+    self->valueArenaEnabled = enable;
+}
+
 int32_t
 GooseSubscriber_getAppId(GooseSubscriber self)
 {
@@ -193,6 +209,12 @@ GooseSubscriber_getTimestamp(GooseSubscriber self)
     return MmsValue_getUtcTimeInMs(self->timestamp);
 }
 
+uint64_t
+GooseSubscriber_getRxTimestamp(GooseSubscriber self)
+{
+    return self->rxTimestamp;
+}
+
 MmsValue*
 GooseSubscriber_getDataSetValues(GooseSubscriber self)
 {
@@ -59,6 +59,16 @@ typedef struct sGooseSubscriber* GooseSubscriber;
  */
 typedef void (*GooseListener)(GooseSubscriber subscriber, void* parameter);
 
+/**
+ * \brief user provided callback function that receives the undecoded data set of a GOOSE message.
+ *
+ * \param subscriber the subscriber object that invoked the callback function,
+ * \param allData the BER encoded content of the allData element (the data set values), only valid during the call
+ * \param allDataLength the size of allData in bytes
+ * \param parameter a user provided parameter that will be passed to the callback function
+ */
+typedef void (*GooseRawListener)(GooseSubscriber subscriber, const uint8_t* allData, int allDataLength, void* parameter);
+
 /**
  * \brief create a new GOOSE subscriber instance.
  *
@@ -169,6 +179,37 @@ GooseSubscriber_destroy(GooseSubscriber self);
 LIB61850_API void
 GooseSubscriber_setListener(GooseSubscriber self, GooseListener listener, void* parameter);
 
+/**
+ * \brief set a callback function that receives the data set of each GOOSE message without decoding it.
+ *
+ * When a raw listener is set, the data set values are not decoded into MmsValue instances
+ * (\ref GooseSubscriber_getDataSetValues keeps returning the values of the last decoded message).
+ * The header values (stNum, sqNum, timestamp, ...) are available as usual. A listener set with
+ * \ref GooseSubscriber_setListener is invoked after the raw listener.
+ *
+ * \param self GooseSubscriber instance to operate on.
+ * \param listener user provided callback function or NULL to decode the data set values again
+ * \param parameter a user provided parameter that will be passed to the callback function
+ */
+LIB61850_API void
+GooseSubscriber_setRawListener(GooseSubscriber self, GooseRawListener listener, void* parameter);
+
+/**
+ * \brief decode the data set values of unknown structure into a subscriber owned memory arena.
+ *
+ * Applies to subscribers created without data set values and to observers. The values of the
+ * previous message are always updated in place when the data set structure is unchanged.
+ * Otherwise a new value tree is required: with the arena it is built in a memory block that is
+ * reused for every following message instead of being allocated element by element on the heap.
+ *
+ * Has to be called before the receiver is started.
+ *
+ * \param self GooseSubscriber instance to operate on.
+ * \param enable true to decode into the arena
+ */
+LIB61850_API void
+GooseSubscriber_enableValueArena(GooseSubscriber self, bool enable);
+
 /**
  * \brief Get the APPID value of the received GOOSE message
  *
@@ -276,6 +317,19 @@ GooseSubscriber_getTimeAllowedToLive(GooseSubscriber self);
 LIB61850_API uint64_t
 GooseSubscriber_getTimestamp(GooseSubscriber self);
 
+/**
+ * \brief Get the time at which the last message was received by the host.
+ *
+ * The frame is timestamped by the kernel when it enters the network stack, so the value does
+ * not include the scheduling delay of the receiver. Requires \ref GooseReceiver_enableRxTimestamps.
+ *
+ * \param self GooseSubscriber instance to operate on.
+ *
+ * \return the receive time in nanoseconds since epoch (1.1.1970 UTC), 0 if not available.
+ */
+LIB61850_API uint64_t
+GooseSubscriber_getRxTimestamp(GooseSubscriber self);
+
 /**
  * \brief get the data set values received with the last report
  *
@@ -63,7 +63,10 @@ struct sSVPublisher_ASDU {
     uint16_t smpRate;
 
     uint8_t* smpCntBuf;
+    uint8_t* confRevBuf;
     uint8_t* smpSynchBuf;
+    uint8_t* smpRateBuf;
+    uint8_t* smpModBuf;
 
     SVPublisher_ASDU _next;
 };
@@ -82,6 +85,17 @@ struct sSVPublisher {
     SVPublisher_ASDU asduList;
 };
 
+struct sSVPublisher_Batch {
+    EthernetSocket ethernetSocket;
+
+    int maxFrames;
+    int frameCount;
+
+    uint8_t* frameMemory; /* maxFrames * SV_MAX_MESSAGE_SIZE bytes */
+    uint8_t** frames;
+    int* frameSizes;
+};
+
 
 static bool
 preparePacketBuffer(SVPublisher self, CommParameters* parameters, const char* interfaceId, bool useVlanTags)
@@ -126,6 +140,10 @@ preparePacketBuffer(SVPublisher self, CommParameters* parameters, const char* in
         return false;
     }
 
+    /* transmit only: keep the received and the locally sent frames out of the socket */
+    Ethernet_setFrameFilter(self->ethernetSocket, NULL, 0, NULL, 0, NULL, 0);
+    Ethernet_setIgnoreOutgoing(self->ethernetSocket, true);
+
     self->buffer = (uint8_t*) GLOBAL_MALLOC(SV_MAX_MESSAGE_SIZE);
 
     if (self->buffer) {
@@ -236,6 +254,21 @@ encodeInt32FixedSize(int32_t value, uint8_t* buffer, int bufPos)
     return bufPos;
 }
 
+static inline uint32_t
+hostToNetworkOrder32(uint32_t value)
+{
+#if (ORDER_LITTLE_ENDIAN == 1)
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(value);
+#else
+    return ((value & 0x000000ffU) << 24) | ((value & 0x0000ff00U) << 8) |
+           ((value & 0x00ff0000U) >> 8) | ((value & 0xff000000U) >> 24);
+#endif
+#else
+    return value;
+#endif
+}
+
 static int
 encodeInt64FixedSize(int64_t value, uint8_t* buffer, int bufPos)
 {
@@ -376,6 +409,7 @@ SVPublisher_ASDU_encodeToBuffer(SVPublisher_ASDU self, uint8_t* buffer, int bufP
 
     /* ConfRev */
     bufPos = BerEncoder_encodeTL(0x83, 4, buffer, bufPos);
+    self->confRevBuf = buffer + bufPos;
     bufPos = encodeUInt32FixedSize(self->confRev, buffer, bufPos);
 
     /* RefrTm */
@@ -393,6 +427,7 @@ SVPublisher_ASDU_encodeToBuffer(SVPublisher_ASDU self, uint8_t* buffer, int bufP
     /* SmpRate */
     if (self->hasSmpRate) {
         bufPos = BerEncoder_encodeTL(0x86, 2, buffer, bufPos);
+        self->smpRateBuf = buffer + bufPos;
         bufPos = encodeUInt16FixedSize(self->smpRate, buffer, bufPos);
     }
 
@@ -406,6 +441,7 @@ SVPublisher_ASDU_encodeToBuffer(SVPublisher_ASDU self, uint8_t* buffer, int bufP
     /* SmpMod */
     if (self->hasSmpMod) {
         bufPos = BerEncoder_encodeTL(0x88, 2, buffer, bufPos);
+        self->smpModBuf = buffer + bufPos;
         bufPos = encodeUInt16FixedSize(self->smpMod, buffer, bufPos);
     }
 
@@ -480,6 +516,221 @@ SVPublisher_publish(SVPublisher self)
     Ethernet_sendPacket(self->ethernetSocket, self->buffer, self->payloadStart + self->payloadLength);
 }
 
+bool
+SVPublisher_enableTxTimestamps(SVPublisher self)
+{
+    return Ethernet_enableTxTimestamps(self->ethernetSocket);
+}
+
+void
+SVPublisher_publishTimestamped(SVPublisher self)
+{
+    if (DEBUG_SV_PUBLISHER)
+        printf("SV_PUBLISHER: send timestamped SV message\n");
+
+    Ethernet_sendPacketTimestamped(self->ethernetSocket, self->buffer, self->payloadStart + self->payloadLength);
+}
+
+bool
+SVPublisher_getTxTimestamp(SVPublisher self, uint64_t* timestampNs)
+{
+    return Ethernet_getTxTimestamp(self->ethernetSocket, timestampNs);
+}
+
+void
+SVPublisher_publishFrame(SVPublisher self, uint8_t* frame, int frameSize)
+{
+    if (DEBUG_SV_PUBLISHER)
+        printf("SV_PUBLISHER: send prepared SV message\n");
+
+    Ethernet_sendPacket(self->ethernetSocket, frame, frameSize);
+}
+
+void
+SVPublisher_publishFrameTimestamped(SVPublisher self, uint8_t* frame, int frameSize)
+{
+    if (DEBUG_SV_PUBLISHER)
+        printf("SV_PUBLISHER: send timestamped prepared SV message\n");
+
+    Ethernet_sendPacketTimestamped(self->ethernetSocket, frame, frameSize);
+}
+
+bool
+SVPublisher_enableLaunchTime(SVPublisher self, int clockId)
+{
+    return Ethernet_enableTxTime(self->ethernetSocket, clockId);
+}
+
+void
+SVPublisher_publishFrameAt(SVPublisher self, uint8_t* frame, int frameSize, uint64_t launchTimeNs)
+{
+    if (DEBUG_SV_PUBLISHER)
+        printf("SV_PUBLISHER: send prepared SV message at %llu\n", (unsigned long long) launchTimeNs);
+
+    Ethernet_sendPacketAt(self->ethernetSocket, frame, frameSize, launchTimeNs);
+}
+
+int
+SVPublisher_publishFramesAt(SVPublisher self, uint8_t** frames, int* frameSizes, const uint64_t* launchTimesNs, int frameCount)
+{
+    if (DEBUG_SV_PUBLISHER)
+        printf("SV_PUBLISHER: send %i prepared SV messages with launch times\n", frameCount);
+
+    return Ethernet_sendPacketsAt(self->ethernetSocket, frames, frameSizes, launchTimesNs, frameCount);
+}
+
+uint64_t
+SVPublisher_getLaunchTimeErrors(SVPublisher self)
+{
+    return Ethernet_getTxTimeErrors(self->ethernetSocket);
+}
+
+uint8_t*
+SVPublisher_getFrameBuffer(SVPublisher self, int* frameSize)
+{
+    if (self->payloadLength == 0)
+        return NULL;
+
+    if (frameSize)
+        *frameSize = self->payloadStart + self->payloadLength;
+
+    return self->buffer;
+}
+
+static int
+getFrameOffset(SVPublisher self, uint8_t* fieldBuf)
+{
+    if (fieldBuf == NULL)
+        return -1;
+
+    return (int) (fieldBuf - self->buffer);
+}
+
+bool
+SVPublisher_getASDULayout(SVPublisher self, SVPublisher_ASDU asdu, SVPublisher_ASDU_Layout* layout)
+{
+    if ((self->payloadLength == 0) || (asdu->_dataBuffer == NULL))
+        return false;
+
+    if ((asdu->_dataBuffer < self->buffer) || (asdu->_dataBuffer >= self->buffer + self->payloadStart + self->payloadLength))
+        return false;
+
+    layout->smpCnt = getFrameOffset(self, asdu->smpCntBuf);
+    layout->confRev = getFrameOffset(self, asdu->confRevBuf);
+    layout->refrTm = asdu->hasRefrTm ? getFrameOffset(self, (uint8_t*) asdu->refrTm) : -1;
+    layout->smpSynch = getFrameOffset(self, asdu->smpSynchBuf);
+    layout->smpRate = asdu->hasSmpRate ? getFrameOffset(self, asdu->smpRateBuf) : -1;
+    layout->smpMod = asdu->hasSmpMod ? getFrameOffset(self, asdu->smpModBuf) : -1;
+    layout->data = getFrameOffset(self, asdu->_dataBuffer);
+    layout->dataSize = asdu->dataSize;
+
+    return true;
+}
+
+SVPublisher_Batch
+SVPublisher_Batch_create(SVPublisher transmitter, int maxFrames)
+{
+    if ((transmitter == NULL) || (maxFrames <= 0))
+        return NULL;
+
+    SVPublisher_Batch self = (SVPublisher_Batch) GLOBAL_CALLOC(1, sizeof(struct sSVPublisher_Batch));
+
+    if (self) {
+        self->ethernetSocket = transmitter->ethernetSocket;
+        self->maxFrames = maxFrames;
+        self->frameCount = 0;
+
+        self->frameMemory = (uint8_t*) GLOBAL_MALLOC((size_t) maxFrames * SV_MAX_MESSAGE_SIZE);
+        self->frames = (uint8_t**) GLOBAL_CALLOC(maxFrames, sizeof(uint8_t*));
+        self->frameSizes = (int*) GLOBAL_CALLOC(maxFrames, sizeof(int));
+
+        if ((self->frameMemory == NULL) || (self->frames == NULL) || (self->frameSizes == NULL)) {
+            SVPublisher_Batch_destroy(self);
+            return NULL;
+        }
+
+        int i;
+
+        for (i = 0; i < maxFrames; i++)
+            self->frames[i] = self->frameMemory + (i * SV_MAX_MESSAGE_SIZE);
+    }
+
+    return self;
+}
+
+bool
+SVPublisher_Batch_enableTxRing(SVPublisher_Batch self)
+{
+    return Ethernet_enableTxRing(self->ethernetSocket, SV_MAX_MESSAGE_SIZE, self->maxFrames);
+}
+
+int
+SVPublisher_Batch_getFrameCount(SVPublisher_Batch self)
+{
+    return self->frameCount;
+}
+
+void
+SVPublisher_Batch_destroy(SVPublisher_Batch self)
+{
+    if (self) {
+        if (self->frameMemory)
+            GLOBAL_FREEMEM(self->frameMemory);
+
+        if (self->frames)
+            GLOBAL_FREEMEM(self->frames);
+
+        if (self->frameSizes)
+            GLOBAL_FREEMEM(self->frameSizes);
+
+        GLOBAL_FREEMEM(self);
+    }
+}
+
+bool
+SVPublisher_queue(SVPublisher self, SVPublisher_Batch batch)
+{
+    if (batch->frameCount >= batch->maxFrames)
+        return false;
+
+    int frameSize = self->payloadStart + self->payloadLength;
+
+    memcpy(batch->frames[batch->frameCount], self->buffer, frameSize);
+    batch->frameSizes[batch->frameCount] = frameSize;
+    batch->frameCount++;
+
+    return true;
+}
+
+bool
+SVPublisher_Batch_queueFrame(SVPublisher_Batch self, const uint8_t* frame, int frameSize)
+{
+    if ((self->frameCount >= self->maxFrames) || (frameSize <= 0) || (frameSize > SV_MAX_MESSAGE_SIZE))
+        return false;
+
+    memcpy(self->frames[self->frameCount], frame, frameSize);
+    self->frameSizes[self->frameCount] = frameSize;
+    self->frameCount++;
+
+    return true;
+}
+
+int
+SVPublisher_publishBatch(SVPublisher_Batch batch)
+{
+    if (batch->frameCount == 0)
+        return 0;
+
+    if (DEBUG_SV_PUBLISHER)
+        printf("SV_PUBLISHER: send batch of %i SV messages\n", batch->frameCount);
+
+    int sent = Ethernet_sendPackets(batch->ethernetSocket, batch->frames, batch->frameSizes, batch->frameCount);
+
+    batch->frameCount = 0;
+
+    return sent;
+}
+
 void
 SVPublisher_destroy(SVPublisher self)
 {
@@ -544,6 +795,32 @@ SVPublisher_ASDU_setINT32(SVPublisher_ASDU self, int index, int32_t value)
     encodeInt32FixedSize(value, self->_dataBuffer, index);
 }
 
+void
+SVPublisher_ASDU_setINT32Array(SVPublisher_ASDU self, int index, const int32_t* values, const Quality* q, int count)
+{
+    uint8_t* buffer = self->_dataBuffer + index;
+    int i;
+
+    /* Quality is encoded as a 32 bit big endian word too: one byte swap loop for the whole vector */
+    if (q) {
+        for (i = 0; i < count; i++) {
+            uint32_t words[2];
+
+            words[0] = hostToNetworkOrder32((uint32_t) values[i]);
+            words[1] = hostToNetworkOrder32((uint32_t) q[i]);
+
+            memcpy(buffer + (i * 8), words, 8);
+        }
+    }
+    else {
+        for (i = 0; i < count; i++) {
+            uint32_t word = hostToNetworkOrder32((uint32_t) values[i]);
+
+            memcpy(buffer + (i * 4), &word, 4);
+        }
+    }
+}
+
 int
 SVPublisher_ASDU_addINT64(SVPublisher_ASDU self)
 {
@@ -66,6 +66,11 @@ typedef struct sSVPublisher* SVPublisher;
  */
 typedef struct sSVPublisher_ASDU* SVPublisher_ASDU;
 
+/**
+ * \brief An opaque type representing a queue of encoded SV frames that are sent with a single call.
+ */
+typedef struct sSVPublisher_Batch* SVPublisher_Batch;
+
 /**
  * \brief Create a new IEC61850-9-2 Sampled Values publisher.
  *
@@ -119,6 +124,239 @@ SVPublisher_setupComplete(SVPublisher self);
 LIB61850_API void
 SVPublisher_publish(SVPublisher self);
 
+/**
+ * \brief Enable transmit timestamps for the frames sent with \ref SVPublisher_publishTimestamped
+ *
+ * NOTE: Not supported on all platforms (Linux: kernel software timestamps).
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \return true if transmit timestamps are available, false otherwise
+ */
+LIB61850_API bool
+SVPublisher_enableTxTimestamps(SVPublisher self);
+
+/**
+ * \brief Publish all registered ASDUs and request the transmit timestamp of this frame
+ *
+ * Same as \ref SVPublisher_publish when transmit timestamps are not enabled. The timestamp
+ * is fetched with \ref SVPublisher_getTxTimestamp.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ */
+LIB61850_API void
+SVPublisher_publishTimestamped(SVPublisher self);
+
+/**
+ * \brief Get the transmit timestamp of the last frame sent with \ref SVPublisher_publishTimestamped (non-blocking)
+ *
+ * The timestamp is reported once the frame reached the network device, the function
+ * has to be polled until it returns true.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[out] timestampNs transmit time in nanoseconds since epoch
+ * \return true if the timestamp is available, false otherwise
+ */
+LIB61850_API bool
+SVPublisher_getTxTimestamp(SVPublisher self, uint64_t* timestampNs);
+
+/**
+ * \brief Byte offsets of the header fields and of the dataset of an ASDU within the encoded frame.
+ *
+ * All offsets are counted from the first byte of the Ethernet frame (see \ref SVPublisher_getFrameBuffer)
+ * and stay valid until the next call of \ref SVPublisher_setupComplete. An offset of -1 indicates that the
+ * field is not present in the ASDU. The offset of a dataset slot is \p data plus the index returned by the
+ * SVPublisher_ASDU_add*() function.
+ */
+typedef struct {
+    int smpCnt;   /**< smpCnt value (2 bytes, big endian) */
+    int confRev;  /**< confRev value (4 bytes, big endian) */
+    int refrTm;   /**< refrTm value (8 bytes UTC time), -1 if not present */
+    int smpSynch; /**< smpSynch value (1 byte) */
+    int smpRate;  /**< smpRate value (2 bytes, big endian), -1 if not present */
+    int smpMod;   /**< smpMod value (2 bytes, big endian), -1 if not present */
+    int data;     /**< first byte of the dataset (sample) */
+    int dataSize; /**< size of the dataset in bytes */
+} SVPublisher_ASDU_Layout;
+
+/**
+ * \brief Get the encoded frame (frame template) of the publisher.
+ *
+ * The buffer contains the complete Ethernet frame as it is sent by \ref SVPublisher_publish. Header fields
+ * and dataset values can be patched in place at the offsets given by \ref SVPublisher_getASDULayout.
+ *
+ * NOTE: Only valid after \ref SVPublisher_setupComplete has been called.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[out] frameSize returns the size of the frame in bytes (can be NULL).
+ * \return the frame buffer, or NULL if the publisher is not set up.
+ */
+LIB61850_API uint8_t*
+SVPublisher_getFrameBuffer(SVPublisher self, int* frameSize);
+
+/**
+ * \brief Get the byte offsets of the fields of an ASDU within the frame template.
+ *
+ * NOTE: Only valid after \ref SVPublisher_setupComplete has been called.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[in] asdu an ASDU of this publisher.
+ * \param[out] layout returns the offsets of the ASDU fields.
+ * \return true on success, false if the ASDU is not encoded in the frame of this publisher.
+ */
+LIB61850_API bool
+SVPublisher_getASDULayout(SVPublisher self, SVPublisher_ASDU asdu, SVPublisher_ASDU_Layout* layout);
+
+/**
+ * \brief Send a frame built outside of the publisher (e.g. a copy of the frame template with patched values)
+ *
+ * The frame is sent over the Ethernet socket of the publisher as is. The publisher's own frame
+ * buffer and ASDUs are not touched, so the frame can be prepared by another thread.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[in] frame the complete Ethernet frame (see \ref SVPublisher_getFrameBuffer).
+ * \param[in] frameSize size of the frame in bytes.
+ */
+LIB61850_API void
+SVPublisher_publishFrame(SVPublisher self, uint8_t* frame, int frameSize);
+
+/**
+ * \brief Send a frame built outside of the publisher and request its transmit timestamp
+ *
+ * Same as \ref SVPublisher_publishFrame when transmit timestamps are not enabled. The timestamp
+ * is fetched with \ref SVPublisher_getTxTimestamp.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[in] frame the complete Ethernet frame.
+ * \param[in] frameSize size of the frame in bytes.
+ */
+LIB61850_API void
+SVPublisher_publishFrameTimestamped(SVPublisher self, uint8_t* frame, int frameSize);
+
+/**
+ * \brief Enable launch time scheduled transmission for the frames sent with \ref SVPublisher_publishFrameAt
+ * and \ref SVPublisher_publishFramesAt
+ *
+ * The kernel holds each frame back until its launch time (Linux: SO_TXTIME, released by an ETF qdisc
+ * on the interface), so frames can be handed over well before they are due.
+ *
+ * NOTE: Not supported on all platforms. Cannot be combined with \ref SVPublisher_Batch_enableTxRing.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[in] clockId clock the launch times refer to (Linux: CLOCK_TAI for the ETF qdisc).
+ * \return true if launch times are enabled, false otherwise
+ */
+LIB61850_API bool
+SVPublisher_enableLaunchTime(SVPublisher self, int clockId);
+
+/**
+ * \brief Send a frame built outside of the publisher at the given launch time
+ *
+ * Same as \ref SVPublisher_publishFrame when launch times are not enabled.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[in] frame the complete Ethernet frame.
+ * \param[in] frameSize size of the frame in bytes.
+ * \param[in] launchTimeNs launch time in nanoseconds of the clock given to \ref SVPublisher_enableLaunchTime.
+ */
+LIB61850_API void
+SVPublisher_publishFrameAt(SVPublisher self, uint8_t* frame, int frameSize, uint64_t launchTimeNs);
+
+/**
+ * \brief Send several frames built outside of the publisher, each at its own launch time
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[in] frames the complete Ethernet frames.
+ * \param[in] frameSizes size of each frame in bytes.
+ * \param[in] launchTimesNs launch time of each frame.
+ * \param[in] frameCount number of frames.
+ * \return number of frames sent, -1 on error.
+ */
+LIB61850_API int
+SVPublisher_publishFramesAt(SVPublisher self, uint8_t** frames, int* frameSizes, const uint64_t* launchTimesNs, int frameCount);
+
+/**
+ * \brief Get the number of frames dropped by the kernel because they missed their launch time (non-blocking)
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ */
+LIB61850_API uint64_t
+SVPublisher_getLaunchTimeErrors(SVPublisher self);
+
+/**
+ * \brief Create a new batch for collecting SV frames of one or more publishers.
+ *
+ * All frames in the batch are sent over the Ethernet socket of the \p transmitter publisher. Only
+ * queue frames of publishers that use the same Ethernet interface as the transmitter.
+ *
+ * \param[in] transmitter the publisher whose Ethernet socket is used to send the batch.
+ * \param[in] maxFrames maximum number of frames the batch can hold.
+ * \return the new batch instance or NULL on error.
+ */
+LIB61850_API SVPublisher_Batch
+SVPublisher_Batch_create(SVPublisher transmitter, int maxFrames);
+
+/**
+ * \brief Use a memory mapped transmit ring (Linux PACKET_TX_RING) for sending the batch.
+ *
+ * NOTE: The ring is attached to the socket of the transmitter, so \ref SVPublisher_publish calls
+ * of the transmitter will also use the ring.
+ *
+ * \param[in] self the batch instance.
+ * \return true if the transmit ring is active, false when not supported (normal batch send is used).
+ */
+LIB61850_API bool
+SVPublisher_Batch_enableTxRing(SVPublisher_Batch self);
+
+/**
+ * \brief Get the number of frames currently queued in the batch.
+ *
+ * \param[in] self the batch instance.
+ */
+LIB61850_API int
+SVPublisher_Batch_getFrameCount(SVPublisher_Batch self);
+
+/**
+ * \brief Destroy the batch instance. Queued frames are discarded.
+ *
+ * \param[in] self the batch instance.
+ */
+LIB61850_API void
+SVPublisher_Batch_destroy(SVPublisher_Batch self);
+
+/**
+ * \brief Copy the current frame of the publisher (all registered ASDUs) into the batch.
+ *
+ * The ASDU values can be changed right after the call to prepare the next frame.
+ *
+ * \param[in] self the Sampled Values publisher instance.
+ * \param[in] batch the batch to add the frame to.
+ * \return true if the frame was queued, false if the batch is full.
+ */
+LIB61850_API bool
+SVPublisher_queue(SVPublisher self, SVPublisher_Batch batch);
+
+/**
+ * \brief Copy an already encoded frame (e.g. a snapshot of \ref SVPublisher_getFrameBuffer) into the batch.
+ *
+ * Frames of any publisher sending on the interface of the batch can be queued.
+ *
+ * \param[in] self the batch instance.
+ * \param[in] frame the Ethernet frame.
+ * \param[in] frameSize size of the frame in bytes.
+ * \return true if the frame was queued, false if the batch is full or the frame too large.
+ */
+LIB61850_API bool
+SVPublisher_Batch_queueFrame(SVPublisher_Batch self, const uint8_t* frame, int frameSize);
+
+/**
+ * \brief Send all queued frames of the batch and empty the batch.
+ *
+ * \param[in] batch the batch instance.
+ * \return number of frames sent, -1 on error.
+ */
+LIB61850_API int
+SVPublisher_publishBatch(SVPublisher_Batch batch);
+
 /**
  * \brief Destroy an IEC61850-9-2 Sampled Values instance.
  *
@@ -181,6 +419,22 @@ SVPublisher_ASDU_addINT32(SVPublisher_ASDU self);
 LIB61850_API void
 SVPublisher_ASDU_setINT32(SVPublisher_ASDU self, int index, int32_t value);
 
+/**
+ * \brief Set a vector of 32-bit integer values in the ASDU in a single pass.
+ *
+ * When \p q is not NULL the data block is expected to contain \p count pairs of INT32 and
+ * quality values (as created by alternating SVPublisher_ASDU_addINT32() and SVPublisher_ASDU_addQuality()),
+ * otherwise \p count consecutive INT32 values.
+ *
+ * \param[in] self the Sampled Values ASDU instance.
+ * \param[in] index The offset within the data block of the ASDU of the first INT32 value.
+ * \param[in] values The values which should be set.
+ * \param[in] q The quality of each value, or NULL.
+ * \param[in] count Number of values.
+ */
+LIB61850_API void
+SVPublisher_ASDU_setINT32Array(SVPublisher_ASDU self, int index, const int32_t* values, const Quality* q, int count);
+
 /**
  * \brief Reserve memory for a signed 64-bit integer in the ASDU.
  *
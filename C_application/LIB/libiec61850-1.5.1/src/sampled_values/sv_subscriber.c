@@ -55,6 +55,11 @@ struct sSVReceiver {
 
     LinkedList subscriberList;
 
+    /* memory mapped receive ring (0 blocks: disabled) */
+    int rxRingBlockSize;
+    int rxRingBlockCount;
+    int rxRingBlockTimeoutMs;
+
 #if (CONFIG_MMS_THREADLESS_STACK == 0)
     Semaphore subscriberListLock;
 #endif
@@ -114,6 +119,14 @@ SVReceiver_setInterfaceId(SVReceiver self, const char* interfaceId)
     self->interfaceId = StringUtils_copyString(interfaceId);
 }
 
+void
+SVReceiver_enableRxRing(SVReceiver self, int blockSize, int blockCount, int blockTimeoutMs)
+{
+    self->rxRingBlockSize = blockSize;
+    self->rxRingBlockCount = blockCount;
+    self->rxRingBlockTimeoutMs = blockTimeoutMs;
+}
+
 void
 SVReceiver_disableDestAddrCheck(SVReceiver self)
 {
@@ -126,6 +139,68 @@ SVReceiver_enableDestAddrCheck(SVReceiver self)
     self->checkDestAddr = true;
 }
 
+/* let the kernel drop the frames no subscriber is interested in - called with the subscriber list locked */
+static void
+updateFrameFilter(SVReceiver self)
+{
+    uint16_t etherType = ETH_P_SV;
+    int subscriberCount = LinkedList_size(self->subscriberList);
+    uint16_t* appIds = NULL;
+    uint8_t* dstAddrs = NULL;
+    int appIdCount = 0;
+    int dstAddrCount = 0;
+
+    if ((self->running == false) || (self->ethSocket == NULL))
+        return;
+
+    if (subscriberCount > 0) {
+        appIds = (uint16_t*) GLOBAL_MALLOC(subscriberCount * sizeof(uint16_t));
+
+        if (self->checkDestAddr)
+            dstAddrs = (uint8_t*) GLOBAL_MALLOC(subscriberCount * 6);
+    }
+
+    LinkedList element = LinkedList_getNext(self->subscriberList);
+
+    while (element) {
+        SVSubscriber subscriber = (SVSubscriber) LinkedList_getData(element);
+        int i;
+
+        if (appIds) {
+            for (i = 0; i < appIdCount; i++) {
+                if (appIds[i] == subscriber->appId)
+                    break;
+            }
+
+            if (i == appIdCount)
+                appIds[appIdCount++] = subscriber->appId;
+        }
+
+        if (dstAddrs) {
+            for (i = 0; i < dstAddrCount; i++) {
+                if (memcmp(dstAddrs + (6 * i), subscriber->ethAddr, 6) == 0)
+                    break;
+            }
+
+            if (i == dstAddrCount)
+                memcpy(dstAddrs + (6 * dstAddrCount++), subscriber->ethAddr, 6);
+        }
+
+        element = LinkedList_getNext(element);
+    }
+
+    if (Ethernet_setFrameFilter(self->ethSocket, &etherType, 1, appIds, appIdCount, dstAddrs, dstAddrCount) == false) {
+        if (DEBUG_SV_SUBSCRIBER)
+            printf("SV_SUBSCRIBER: failed to set kernel frame filter\n");
+    }
+
+    if (appIds)
+        GLOBAL_FREEMEM(appIds);
+
+    if (dstAddrs)
+        GLOBAL_FREEMEM(dstAddrs);
+}
+
 void
 SVReceiver_addSubscriber(SVReceiver self, SVSubscriber subscriber)
 {
@@ -134,6 +209,7 @@ SVReceiver_addSubscriber(SVReceiver self, SVSubscriber subscriber)
 #endif
 
     LinkedList_add(self->subscriberList, (void*) subscriber);
+    updateFrameFilter(self);
 
 #if (CONFIG_MMS_THREADLESS_STACK == 0)
     Semaphore_post(self->subscriberListLock);
@@ -147,7 +223,8 @@ SVReceiver_removeSubscriber(SVReceiver self, SVSubscriber subscriber)
     Semaphore_wait(self->subscriberListLock);
 #endif
 
-    LinkedList_remove(self->subscriberList, (void*) subscriber);
+    if (LinkedList_remove(self->subscriberList, (void*) subscriber))
+        updateFrameFilter(self);
 
 #if (CONFIG_MMS_THREADLESS_STACK == 0)
     Semaphore_post(self->subscriberListLock);
@@ -256,7 +333,26 @@ SVReceiver_startThreadless(SVReceiver self)
 
         Ethernet_setProtocolFilter(self->ethSocket, ETH_P_SV);
 
+        if (self->rxRingBlockCount > 0) {
+            if (Ethernet_enableRxRing(self->ethSocket, self->rxRingBlockSize, self->rxRingBlockCount,
+                    self->rxRingBlockTimeoutMs) == false)
+            {
+                if (DEBUG_SV_SUBSCRIBER)
+                    printf("SV_SUBSCRIBER: receive ring not available - using normal receive\n");
+            }
+        }
+
         self->running = true;
+
+#if (CONFIG_MMS_THREADLESS_STACK == 0)
+        Semaphore_wait(self->subscriberListLock);
+#endif
+
+        updateFrameFilter(self);
+
+#if (CONFIG_MMS_THREADLESS_STACK == 0)
+        Semaphore_post(self->subscriberListLock);
+#endif
     }
     
     return self->ethSocket;
@@ -459,10 +555,9 @@ exit_error:
 }
 
 static void
-parseSVMessage(SVReceiver self, int numbytes)
+parseSVMessage(SVReceiver self, uint8_t* buffer, int numbytes)
 {
     int bufPos;
-    uint8_t* buffer = self->buffer;
 
     if (numbytes < 22) return;
 
@@ -559,17 +654,17 @@ parseSVMessage(SVReceiver self, int numbytes)
     }
 }
 
+static void
+handleReceivedFrame(void* parameter, uint8_t* frame, int frameSize)
+{
+    parseSVMessage((SVReceiver) parameter, frame, frameSize);
+}
+
 bool
 SVReceiver_tick(SVReceiver self)
 {
-    int packetSize = Ethernet_receivePacket(self->ethSocket, self->buffer, ETH_BUFFER_LENGTH);
-
-    if (packetSize > 0) {
-        parseSVMessage(self, packetSize);
-        return true;
-    }
-    else
-        return false;
+    return (Ethernet_receivePackets(self->ethSocket, self->buffer, ETH_BUFFER_LENGTH,
+            handleReceivedFrame, (void*) self) > 0);
 }
 
 SVSubscriber
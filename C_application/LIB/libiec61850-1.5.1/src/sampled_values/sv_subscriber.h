@@ -166,6 +166,24 @@ SVReceiver_enableDestAddrCheck(SVReceiver self);
 LIB61850_API void
 SVReceiver_setInterfaceId(SVReceiver self, const char* interfaceId);
 
+/**
+ * \brief Receive the frames through a memory mapped receive ring (Linux: TPACKET_V3)
+ *
+ * The frames are parsed directly from the ring blocks, which are released to the kernel
+ * as a whole. Has to be called before the receiver is started. When the platform does
+ * not support a receive ring the receiver uses the normal receive path.
+ *
+ * NOTE: a block is passed to the receiver when it is full or when \p blockTimeoutMs
+ * expires, so the timeout bounds the additional receive latency.
+ *
+ * \param self the SVReceiver instance
+ * \param blockSize size of a ring block in bytes
+ * \param blockCount number of blocks in the ring
+ * \param blockTimeoutMs time after which a partially filled block is processed
+ */
+LIB61850_API void
+SVReceiver_enableRxRing(SVReceiver self, int blockSize, int blockCount, int blockTimeoutMs);
+
 /**
  * \brief Add a subscriber instance to the receiver
  *
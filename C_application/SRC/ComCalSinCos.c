@@ -10,6 +10,7 @@
 //   Date   *   Auteur   * Anomalie * Commentaire
 //------------------------------------------------------------------------------
 // 10/01/18 *  BPi       *          * Creation
+// 17/10/26 *            *          * Ajout des versions vectorielles (lots)
 //==============================================================================
 
 #ifndef _COM_CAL_SIN_COS_C_
@@ -21,10 +22,16 @@
 
 #include "ComCalSinCos.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COM_CAL_SIN_COS_AVX2
+#include <immintrin.h>
+#endif
+
 //==============================================================================
 // Macros ======================================================================
 //==============================================================================
 #define FAST_MATH_TABLE_SIZE  512
+#define FAST_MATH_DELTA       0.0122718463030f  // 2*pi/FAST_MATH_TABLE_SIZE
 
 //==============================================================================
 // Types =======================================================================
@@ -210,4 +217,209 @@ void fComCalSinCos(f32 theta, f32 *pSinVal, f32 *pCosVal)
    *pSinVal = fract*temp + f1;
 }
 
+/**
+ * @brief  Floating-point sin function (sine part of fComCalSinCos only).
+ * @param[in]  theta    input value in degrees
+ * @return sine of theta.
+ */
+static f32 fComCalSin(f32 theta)
+{
+   f32 fract, in;
+   u16 indexS, indexC;
+   f32 f1, f2, d1, d2;
+   u32 n;
+   f32 findex, Df, temp;
+
+   if (theta < 0)
+   {
+      theta += (f32)360.;
+   }
+   else if (theta > 360.)
+   {
+      theta -= (f32)360.;
+   }
+   in = theta * 0.00277777777778f;
+
+   n = (u32) in;
+   if(in < 0.0f)
+   {
+      n--;
+   }
+   in = in - (f32) n;
+
+   findex = (f32) FAST_MATH_TABLE_SIZE * in;
+   indexS = ((u16)findex) & 0x1ff;
+   indexC = (indexS + (FAST_MATH_TABLE_SIZE / 4)) & 0x1ff;
+   fract = findex - (f32) indexS;
+
+   f1 = sinTable_f32[indexS+0];
+   f2 = sinTable_f32[indexS+1];
+   d1 = sinTable_f32[indexC+0];
+   d2 = sinTable_f32[indexC+1];
+
+   Df = f2 - f1;
+   temp = FAST_MATH_DELTA*(d1 + d2) - 2*Df;
+   temp = fract*temp + (3*Df - (d2 + 2*d1)*FAST_MATH_DELTA);
+   temp = fract*temp + d1*FAST_MATH_DELTA;
+
+   return fract*temp + f1;
+}
+
+static void fComCalSinCosBatchScalar(const f32 *pTheta, f32 *pSinVal, f32 *pCosVal, size_t n)
+{
+   for (size_t i = 0; i < n; i++)
+   {
+      fComCalSinCos(pTheta[i], &pSinVal[i], &pCosVal[i]);
+   }
+}
+
+static void fComCalSinBatchScalar(const f32 *pTheta, f32 *pSinVal, size_t n)
+{
+   for (size_t i = 0; i < n; i++)
+   {
+      pSinVal[i] = fComCalSin(pTheta[i]);
+   }
+}
+
+#ifdef COM_CAL_SIN_COS_AVX2
+/*
+ * AVX2 versions: same table, same cubic Hermite interpolation as the scalar code,
+ * 8 angles per iteration with gathers. No FMA so the results match the scalar path.
+ */
+__attribute__((target("avx2")))
+static inline __m256 fComCalHermiteAvx2(__m256 fract, __m256 f1, __m256 f2, __m256 d1, __m256 d2)
+{
+   const __m256 dn = _mm256_set1_ps(FAST_MATH_DELTA);
+   const __m256 two = _mm256_set1_ps(2.0f);
+   const __m256 three = _mm256_set1_ps(3.0f);
+   __m256 df, temp;
+
+   df = _mm256_sub_ps(f2, f1);
+   temp = _mm256_sub_ps(_mm256_mul_ps(dn, _mm256_add_ps(d1, d2)), _mm256_mul_ps(two, df));
+   temp = _mm256_add_ps(_mm256_mul_ps(fract, temp),
+                        _mm256_sub_ps(_mm256_mul_ps(three, df),
+                                      _mm256_mul_ps(_mm256_add_ps(d2, _mm256_mul_ps(two, d1)), dn)));
+   temp = _mm256_add_ps(_mm256_mul_ps(fract, temp), _mm256_mul_ps(d1, dn));
+   return _mm256_add_ps(_mm256_mul_ps(fract, temp), f1);
+}
+
+/* Angle reduction and table indexes, see fComCalSinCos */
+__attribute__((target("avx2")))
+static inline __m256 fComCalIndexAvx2(const f32 *pTheta, __m256i *pIndexS, __m256i *pIndexC)
+{
+   const __m256 zero = _mm256_setzero_ps();
+   const __m256 full = _mm256_set1_ps(360.0f);
+   const __m256i mask = _mm256_set1_epi32(0x1ff);
+   __m256 theta, in, findex;
+   __m256i indexS;
+
+   theta = _mm256_loadu_ps(pTheta);
+   theta = _mm256_add_ps(theta, _mm256_and_ps(_mm256_cmp_ps(theta, zero, _CMP_LT_OQ), full));
+   theta = _mm256_sub_ps(theta, _mm256_and_ps(_mm256_cmp_ps(theta, full, _CMP_GT_OQ), full));
+   in = _mm256_mul_ps(theta, _mm256_set1_ps(0.00277777777778f));
+   in = _mm256_sub_ps(in, _mm256_floor_ps(in));
+
+   findex = _mm256_mul_ps(_mm256_set1_ps((f32)FAST_MATH_TABLE_SIZE), in);
+   indexS = _mm256_and_si256(_mm256_cvttps_epi32(findex), mask);
+   *pIndexS = indexS;
+   *pIndexC = _mm256_and_si256(_mm256_add_epi32(indexS, _mm256_set1_epi32(FAST_MATH_TABLE_SIZE / 4)), mask);
+
+   return _mm256_sub_ps(findex, _mm256_cvtepi32_ps(indexS));
+}
+
+__attribute__((target("avx2")))
+static void fComCalSinCosBatchAvx2(const f32 *pTheta, f32 *pSinVal, f32 *pCosVal, size_t n)
+{
+   const __m256i one = _mm256_set1_epi32(1);
+   size_t i = 0;
+
+   for (; i + 8 <= n; i += 8)
+   {
+      __m256i indexS, indexC;
+      __m256 fract = fComCalIndexAvx2(&pTheta[i], &indexS, &indexC);
+      __m256 s0 = _mm256_i32gather_ps(sinTable_f32, indexS, 4);
+      __m256 s1 = _mm256_i32gather_ps(sinTable_f32, _mm256_add_epi32(indexS, one), 4);
+      __m256 c0 = _mm256_i32gather_ps(sinTable_f32, indexC, 4);
+      __m256 c1 = _mm256_i32gather_ps(sinTable_f32, _mm256_add_epi32(indexC, one), 4);
+      __m256 zero = _mm256_setzero_ps();
+
+      _mm256_storeu_ps(&pCosVal[i], fComCalHermiteAvx2(fract, c0, c1, _mm256_sub_ps(zero, s0), _mm256_sub_ps(zero, s1)));
+      _mm256_storeu_ps(&pSinVal[i], fComCalHermiteAvx2(fract, s0, s1, c0, c1));
+   }
+   fComCalSinCosBatchScalar(&pTheta[i], &pSinVal[i], &pCosVal[i], n - i);
+}
+
+__attribute__((target("avx2")))
+static void fComCalSinBatchAvx2(const f32 *pTheta, f32 *pSinVal, size_t n)
+{
+   const __m256i one = _mm256_set1_epi32(1);
+   size_t i = 0;
+
+   for (; i + 8 <= n; i += 8)
+   {
+      __m256i indexS, indexC;
+      __m256 fract = fComCalIndexAvx2(&pTheta[i], &indexS, &indexC);
+      __m256 s0 = _mm256_i32gather_ps(sinTable_f32, indexS, 4);
+      __m256 s1 = _mm256_i32gather_ps(sinTable_f32, _mm256_add_epi32(indexS, one), 4);
+      __m256 c0 = _mm256_i32gather_ps(sinTable_f32, indexC, 4);
+      __m256 c1 = _mm256_i32gather_ps(sinTable_f32, _mm256_add_epi32(indexC, one), 4);
+
+      _mm256_storeu_ps(&pSinVal[i], fComCalHermiteAvx2(fract, s0, s1, c0, c1));
+   }
+   fComCalSinBatchScalar(&pTheta[i], &pSinVal[i], n - i);
+}
+#endif
+
+/* CPU dispatch, resolved once: concurrent first calls resolve to the same value */
+static void (*pfSinCosBatch)(const f32 *, f32 *, f32 *, size_t) = NULL;
+static void (*pfSinBatch)(const f32 *, f32 *, size_t) = NULL;
+
+static void fComCalSelectBatch(void)
+{
+#ifdef COM_CAL_SIN_COS_AVX2
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+   {
+      pfSinBatch = fComCalSinBatchAvx2;
+      pfSinCosBatch = fComCalSinCosBatchAvx2;
+      return;
+   }
+#endif
+   pfSinBatch = fComCalSinBatchScalar;
+   pfSinCosBatch = fComCalSinCosBatchScalar;
+}
+
+/**
+ * @brief  Floating-point sin_cos function on an array of angles.
+ * @param[in]  pTheta   input values in degrees
+ * @param[out] pSinVal  processed sine outputs
+ * @param[out] pCosVal  processed cos outputs
+ * @param[in]  n        number of angles
+ * @return none.
+ */
+void fComCalSinCosBatch(const f32 *pTheta, f32 *pSinVal, f32 *pCosVal, size_t n)
+{
+   if (NULL == pfSinCosBatch)
+   {
+      fComCalSelectBatch();
+   }
+   pfSinCosBatch(pTheta, pSinVal, pCosVal, n);
+}
+
+/**
+ * @brief  Floating-point sin function on an array of angles (cos is not computed).
+ * @param[in]  pTheta   input values in degrees
+ * @param[out] pSinVal  processed sine outputs
+ * @param[in]  n        number of angles
+ * @return none.
+ */
+void fComCalSinBatch(const f32 *pTheta, f32 *pSinVal, size_t n)
+{
+   if (NULL == pfSinBatch)
+   {
+      fComCalSelectBatch();
+   }
+   pfSinBatch(pTheta, pSinVal, n);
+}
+
 #endif
@@ -10,19 +10,54 @@
 #include <errno.h> // For strerror
 #include <signal.h>
 #include "parser.h"
+#include "ipc.h"
 #include <pthread.h>
 #include "logger.h"
+#include "Latency_Engine.h"
+#include "hal_ethernet.h"
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
 volatile sig_atomic_t running_Goose = 1;
 extern volatile bool internal_shutdown_flag;
 static volatile sig_atomic_t cleanup_in_progress = 0;
 bool goose_receiver_cleanup(void);
 bool goose_receiver_is_running(void);
-static pthread_t *threads = NULL;
 static ThreadData *thread_data = NULL;
 int goose_instance_count = 0;
 static pthread_mutex_t goose_cleanup_mutex = PTHREAD_MUTEX_INITIALIZER;
-static void goose_thread_cleanup(void *arg);
+
+// One receiver (socket) per network interface, shared by every instance listening on it.
+// The receiver owns the subscribers added to it and dispatches each frame through its subscriber index.
+typedef struct {
+    char *interface;
+    GooseReceiver receiver;
+    EthernetSocket socket; // socket of the threadless receiver, NULL when not started
+    int subscriber_count;
+} GooseInterfaceReceiver;
+
+// Memory mapped receive ring (TPACKET_V3) of each interface receiver, 0 blocks to receive with recvfrom.
+// A partially filled block is processed after GOOSE_RX_RING_BLOCK_TIMEOUT_MS.
+#ifndef GOOSE_RX_RING_BLOCKS
+#define GOOSE_RX_RING_BLOCKS 8
+#endif
+#define GOOSE_RX_RING_BLOCK_SIZE (64 * 1024)
+#define GOOSE_RX_RING_BLOCK_TIMEOUT_MS 1
+
+// The receivers run threadless: a single event thread waits on the sockets of every interface with epoll
+// and ticks the receivers that have frames pending. Writing the stop eventfd ends the thread at once.
+#define GOOSE_MAX_EVENTS 16
+// Frames handled per receiver and wake-up, a busy interface must not starve the others (epoll is level triggered)
+#define GOOSE_MAX_TICKS_PER_EVENT 64
+
+static GooseInterfaceReceiver *interface_receivers = NULL;
+static int interface_receiver_count = 0;
+static int goose_epoll_fd = FAIL;
+static int goose_stop_fd = FAIL;
+static pthread_t goose_event_thread;
+static bool goose_event_thread_started = false;
 
 void sigint_handler_Goose(int signalId)
 {
@@ -30,244 +65,251 @@ void sigint_handler_Goose(int signalId)
     running_Goose = 0;
     internal_shutdown_flag = 1;
     cleanup_in_progress = 1;
+    ipc_wakeup();
 }
 
-void monitor_shutdown() {
-    while (running_Goose) {
-        sleep(1);
-    }
-    
-    // Do cleanup here, not in signal handler
-    printf("Shutdown requested, cleaning up...\n");
-    fflush(stdout);
-    
-    if (SUCCESS == goose_receiver_cleanup()) {
-        printf("GOOSE receiver cleanup completed successfully.\n");
-    } else {
-        printf("GOOSE receiver cleanup failed.\n");
-    }
-    
-    exit(0);
-}
 long long get_current_time_ms() {
     struct timeval tv;
     gettimeofday(&tv, NULL);
     return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
+// Raw listener: the data set is handed over undecoded, so no MmsValue tree is built per message
 static void
-gooseListener(GooseSubscriber subscriber, void *parameter)
+gooseListener(GooseSubscriber subscriber, const uint8_t *allData, int allDataLength, void *parameter)
 {
+    uint64_t handled_ns = Latency_now_ns();
+    ThreadData *data = (ThreadData *)parameter;
+
+    // The listener instances are in the same order as the SV instances: the stNum change closes the fault of the instance
+    Latency_goose_received((int)(data - thread_data), GooseSubscriber_getStNum(subscriber),
+                           GooseSubscriber_getRxTimestamp(subscriber), handled_ns);
+
+    // Raw listener: the data set itself is not needed to close the fault
+    (void)allData;
+    (void)allDataLength;
+
     static uint64_t last_print_time = 0;
-uint64_t now = get_current_time_ms(); // Implement this function
-if (now - last_print_time > 1000) { // Only print once per second
-    last_print_time = now;
-    LOG_INFO("Goose_Listener", "GOOSE message received");
-    printf("GOOSE message received\n");
-}
-    if (GooseSubscriber_isVlanSet(subscriber))
+    uint64_t now = (uint64_t)get_current_time_ms();
+    if (now - last_print_time > 1000) // Only log once per second
     {
-        //  printf("    vlanId: %u\n", GooseSubscriber_getVlanId(subscriber));
-        // printf("    vlanPrio: %u\n", GooseSubscriber_getVlanPrio(subscriber));
+        last_print_time = now;
+        LOG_INFO("Goose_Listener", "GOOSE message received");
     }
-    //  printf("  appId: %d\n", GooseSubscriber_getAppId(subscriber));
-    uint8_t macBuf[6];
-    GooseSubscriber_getSrcMac(subscriber, macBuf);
-    //  printf("  srcMac: %02X:%02X:%02X:%02X:%02X:%02X\n", macBuf[0],macBuf[1],macBuf[2],macBuf[3],macBuf[4],macBuf[5]);
-    GooseSubscriber_getDstMac(subscriber, macBuf);
-
-    //  printf("  dstMac: %02X:%02X:%02X:%02X:%02X:%02X\n", macBuf[0],macBuf[1],macBuf[2],macBuf[3],macBuf[4],macBuf[5]);
-    // printf("  goId: %s\n", GooseSubscriber_getGoId(subscriber));
-    // printf("  goCbRef: %s\n", GooseSubscriber_getGoCbRef(subscriber));
-    // printf("  dataSet: %s\n", GooseSubscriber_getDataSet(subscriber));
-    //  printf("  confRev: %u\n", GooseSubscriber_getConfRev(subscriber));
-    //  printf("  ndsCom: %s\n", GooseSubscriber_needsCommission(subscriber) ? "true" : "false");
-    // printf("  simul: %s\n", GooseSubscriber_isTest(subscriber) ? "true" : "false");
-    // printf("  stNum: %u sqNum: %u\n", GooseSubscriber_getStNum(subscriber),
-    //     GooseSubscriber_getSqNum(subscriber));
-
-    uint64_t timestamp = GooseSubscriber_getTimestamp(subscriber);
-    MmsValue *values = GooseSubscriber_getDataSetValues(subscriber);
-
-    char buffer[1024];
-
-    MmsValue_printToBuffer(values, buffer, 1024);
-
-    //printf("  AllData: %s\n", buffer);
-    //  printf("--------------------------\n");
-    //fflush(stdout);
 }
 
-static void goose_thread_cleanup(void *arg) {
-    ThreadData *data = (ThreadData *)arg;
-    if (data == NULL) return;
+static GooseInterfaceReceiver *goose_get_interface_receiver(const char *interface)
+{
+    for (int i = 0; i < interface_receiver_count; i++)
+    {
+        if (0 == strcmp(interface_receivers[i].interface, interface))
+        {
+            return &interface_receivers[i];
+        }
+    }
+
+    // The array holds at most one entry per instance, it is sized in Goose_receiver_start()
+    GooseInterfaceReceiver *entry = &interface_receivers[interface_receiver_count];
 
-    LOG_INFO("Goose_Listener", "Cleaning up thread resources");
-    
-    if (data->receiver != NULL) {
-        GooseReceiver_stop(data->receiver);
-        GooseReceiver_destroy(data->receiver);
-        data->receiver = NULL;
+    entry->receiver = GooseReceiver_create();
+    if (!entry->receiver)
+    {
+        LOG_ERROR("Goose_Listener", "Receiver creation failed for interface %s", interface);
+        return NULL;
     }
+    entry->interface = strdup(interface);
+    if (!entry->interface)
+    {
+        LOG_ERROR("Goose_Listener", "Memory allocation failed for interface %s", interface);
+        GooseReceiver_destroy(entry->receiver);
+        entry->receiver = NULL;
+        return NULL;
+    }
+    GooseReceiver_setInterfaceId(entry->receiver, entry->interface);
+    if (GOOSE_RX_RING_BLOCKS > 0)
+    {
+        GooseReceiver_enableRxRing(entry->receiver, GOOSE_RX_RING_BLOCK_SIZE, GOOSE_RX_RING_BLOCKS, GOOSE_RX_RING_BLOCK_TIMEOUT_MS);
+    }
+    // Trip latency is measured from the kernel receive time, not from when the ring block is processed
+    GooseReceiver_enableRxTimestamps(entry->receiver);
+    entry->subscriber_count = 0;
+    interface_receiver_count++;
+    return entry;
+}
+
+static void *goose_event_loop(void *arg)
+{
+    struct epoll_event events[GOOSE_MAX_EVENTS];
+    bool stop = false;
+
+    (void)arg;
+    while (!stop)
+    {
+        // No timeout: frames and the stop request both wake the thread
+        int nb_events = epoll_wait(goose_epoll_fd, events, GOOSE_MAX_EVENTS, -1);
+        if (nb_events < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LOG_ERROR("Goose_Listener", "epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < nb_events; i++)
+        {
+            GooseInterfaceReceiver *entry = (GooseInterfaceReceiver *)events[i].data.ptr;
+
+            if (NULL == entry)
+            {
+                stop = true;
+                continue;
+            }
+
+            int ticks = 0;
+            while (ticks < GOOSE_MAX_TICKS_PER_EVENT && GooseReceiver_tick(entry->receiver))
+            {
+                ticks++;
+            }
 
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                // Reading SO_ERROR clears a pending socket error (e.g. interface down), the ring
+                // receive path never does and the error would wake the thread again and again
+                int err = 0;
+                socklen_t len = sizeof(err);
+                int fd = Ethernet_getSocketFd(entry->socket);
+                if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || (events[i].events & EPOLLHUP))
+                {
+                    LOG_ERROR("Goose_Listener", "Receive socket of %s failed, interface no longer monitored", entry->interface);
+                    epoll_ctl(goose_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+                }
+                else if (0 != err)
+                {
+                    LOG_WARN("Goose_Listener", "Receive error on %s: %s", entry->interface, strerror(err));
+                }
+            }
+        }
+    }
+    return NULL;
 }
-void *goose_thread_task(void *arg) 
+
+static void goose_event_loop_stop(void)
 {
-    ThreadData *data = (ThreadData *)arg;
-    int ret = SUCCESS;
-    
-    if (data == NULL) {
-        return (void*)(intptr_t)FAIL;
+    if (goose_event_thread_started)
+    {
+        uint64_t one = 1;
+        ssize_t ret = write(goose_stop_fd, &one, sizeof(one));
+        (void)ret;
+        pthread_join(goose_event_thread, NULL);
+        goose_event_thread_started = false;
     }
-    
-    // Set cancellation points
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-    pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
-    
-    // Block signals that might interfere with cleanup
-    sigset_t mask, oldmask;
-    sigemptyset(&mask);
-    sigaddset(&mask, SIGRTMIN);
-    sigaddset(&mask, SIGRTMIN+1);
-    sigaddset(&mask, SIGRTMIN+2);
-    sigaddset(&mask, SIGRTMIN+3);
-    sigaddset(&mask, SIGRTMIN+4);
-    sigaddset(&mask, SIGRTMIN+5);
-    pthread_sigmask(SIG_BLOCK, &mask, &oldmask);
-    
-    // Install cleanup handler
-    pthread_cleanup_push(goose_thread_cleanup, data);
-    
-    LOG_INFO("Goose_Listener", "Thread started for appid 0x%04x", data->AppID);
-    
-    // Initialize receiver
-    data->receiver = GooseReceiver_create();
-    if (!data->receiver) {
-        LOG_ERROR("Goose_Listener", "Receiver creation failed");
-        ret = FAIL;
-        goto cleanup;
+    if (goose_epoll_fd >= 0)
+    {
+        close(goose_epoll_fd);
+        goose_epoll_fd = FAIL;
     }
-    
-    GooseReceiver_setInterfaceId(data->receiver, data->interface);
-    
-    // Use the actual GoCBRef from thread_data instead of hardcoded string
-    data->subscriber = GooseSubscriber_create(data->GoCBRef, NULL);
-    if (!data->subscriber) {
-        LOG_ERROR("Goose_Listener", "Subscriber creation failed");
-        ret = FAIL;
-        goto cleanup;
+    if (goose_stop_fd >= 0)
+    {
+        close(goose_stop_fd);
+        goose_stop_fd = FAIL;
     }
-    
-    // Use the actual AppID from thread_data instead of hardcoded 1000
-    GooseSubscriber_setAppId(data->subscriber, data->AppID);
-    
-    // Use the actual MAC address from thread_data instead of hardcoded MAC
-    GooseSubscriber_setDstMac(data->subscriber, data->MACAddress);
-    
-    GooseSubscriber_setListener(data->subscriber, gooseListener, NULL);
-    GooseReceiver_addSubscriber(data->receiver, data->subscriber);
-    
-    GooseReceiver_start(data->receiver);
-    
-    // Check if receiver started successfully
-    if (!GooseReceiver_isRunning(data->receiver)) {
-        LOG_ERROR("Goose_Listener", "Failed to start receiver");
-        ret = FAIL;
-        goto cleanup;
+}
+
+static int goose_event_loop_start(void)
+{
+    struct epoll_event ev;
+
+    goose_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    goose_stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (goose_epoll_fd < 0 || goose_stop_fd < 0 || epoll_ctl(goose_epoll_fd, EPOLL_CTL_ADD, goose_stop_fd, &ev) < 0)
+    {
+        LOG_ERROR("Goose_Listener", "Event loop creation failed: %s", strerror(errno));
+        goose_event_loop_stop();
+        return FAIL;
     }
-    
-    // Main loop with proper cancellation handling
-    while (running_Goose && !internal_shutdown_flag) {
-        pthread_testcancel(); // Cancellation point
-        
-        if (!GooseReceiver_isRunning(data->receiver)) {
-            LOG_WARN("Goose_Listener", "Receiver stopped unexpectedly");
-            ret = FAIL;
-            break;
-        }
-        
-        // Sleep with cancellation point - use nanosleep instead of Thread_sleep
-        struct timespec ts = {0, 50000000}; // 50ms
-        if (nanosleep(&ts, NULL) == -1 && errno == EINTR) {
-            // Handle interruption gracefully
-            pthread_testcancel();
+    return SUCCESS;
+}
+
+static int goose_start_interface_receiver(GooseInterfaceReceiver *entry)
+{
+    struct epoll_event ev;
+
+    entry->socket = GooseReceiver_startThreadless(entry->receiver);
+    if (NULL == entry->socket)
+    {
+        LOG_ERROR("Goose_Listener", "Failed to start receiver on interface %s", entry->interface);
+        return FAIL;
+    }
+
+    int fd = Ethernet_getSocketFd(entry->socket);
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = entry;
+    if (fd < 0 || epoll_ctl(goose_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        LOG_ERROR("Goose_Listener", "Cannot monitor receive socket of %s: %s", entry->interface,
+                  (fd < 0) ? "no file descriptor" : strerror(errno));
+        GooseReceiver_stopThreadless(entry->receiver);
+        entry->socket = NULL;
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+static void goose_destroy_interface_receivers(void)
+{
+    // The event thread is the only user of the receive sockets: join it before closing them
+    goose_event_loop_stop();
+
+    for (int i = 0; i < interface_receiver_count; i++)
+    {
+        if (interface_receivers[i].receiver != NULL)
+        {
+            if (interface_receivers[i].socket != NULL)
+            {
+                GooseReceiver_stopThreadless(interface_receivers[i].receiver);
+                interface_receivers[i].socket = NULL;
+            }
+            // Also destroys the subscribers added to the receiver
+            GooseReceiver_destroy(interface_receivers[i].receiver);
+            interface_receivers[i].receiver = NULL;
         }
+        free(interface_receivers[i].interface);
+        interface_receivers[i].interface = NULL;
+    }
+    free(interface_receivers);
+    interface_receivers = NULL;
+    interface_receiver_count = 0;
+
+    // The subscribers were owned by the receivers
+    for (int i = 0; i < goose_instance_count; ++i)
+    {
+        thread_data[i].receiver = NULL;
+        thread_data[i].subscriber = NULL;
     }
-    
-cleanup:
-    // Restore signal mask before cleanup
-    pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
-    
-    // Pop and execute cleanup handler
-    pthread_cleanup_pop(1);
-    
-    LOG_INFO("Goose_Listener", "Thread exiting for appid 0x%04x", data->AppID);
-    return (ret == SUCCESS) ? NULL : (void*)(intptr_t)ret;
 }
+
 bool goose_receiver_cleanup(void) {
     pthread_mutex_lock(&goose_cleanup_mutex);
     
     // Step 1: Signal all threads to stop gracefully
     running_Goose = false;
     internal_shutdown_flag = true;
+    ipc_wakeup();
     
-    // Step 2: Stop all receivers first
-    for (int i = 0; i < goose_instance_count; ++i) {
-        if (thread_data[i].receiver && GooseReceiver_isRunning(thread_data[i].receiver)) {
-            GooseReceiver_stop(thread_data[i].receiver);
-        }
-    }
-    
-    // Give threads time to exit gracefully
-    struct timespec sleep_time = {0, 100000000}; // 100ms
-    nanosleep(&sleep_time, NULL);
-    
-    // Step 3: Join threads with timeout
-    if (threads != NULL) {
-        for (int i = 0; i < goose_instance_count; ++i) {
-            if (threads[i] != 0) {
-                void *thread_result;
-                struct timespec timeout;
-                clock_gettime(CLOCK_REALTIME, &timeout);
-                timeout.tv_sec += 3; // 3 second timeout
-                
-                int rc = pthread_timedjoin_np(threads[i], &thread_result, &timeout);
-                if (rc == ETIMEDOUT) {
-                    LOG_ERROR("Goose_Listener", "Thread %d timeout - canceling", i);
-                    pthread_cancel(threads[i]);
-                    
-                    // Try to join after cancel
-                    timeout.tv_sec += 1;
-                    rc = pthread_timedjoin_np(threads[i], NULL, &timeout);
-                    if (rc == ETIMEDOUT) {
-                        LOG_ERROR("Goose_Listener", "Thread %d still hanging - detaching", i);
-                        pthread_detach(threads[i]);
-                    }
-                } else if (rc != 0) {
-                    LOG_ERROR("Goose_Listener", "Thread %d join error: %s", i, strerror(rc));
-                }
-                threads[i] = 0;  // Mark as handled
-            }
-        }
-        free(threads);
-        threads = NULL;
+    // Step 2: Stop the event thread and the interface receivers,
+    // this destroys the subscribers with them
+    if (thread_data != NULL)
+    {
+        goose_destroy_interface_receivers();
     }
-    
-    // Step 4: Clean up all resources
+
+    // Step 3: Clean up all resources
     for (int i = 0; i < goose_instance_count; ++i) {
-        // Clean up GooseReceiver and GooseSubscriber
-        if (thread_data[i].receiver != NULL) {
-            if (GooseReceiver_isRunning(thread_data[i].receiver)) {
-                GooseReceiver_stop(thread_data[i].receiver);
-            }
-            GooseReceiver_destroy(thread_data[i].receiver);
-            thread_data[i].receiver = NULL;
-        }
-        
-        if (thread_data[i].subscriber != NULL) {
-            GooseSubscriber_destroy(thread_data[i].subscriber);
-            thread_data[i].subscriber = NULL;
-        }
-        
         // Free allocated strings with null checks
         if (thread_data[i].interface) {
             free(thread_data[i].interface);
@@ -300,78 +342,6 @@ bool goose_receiver_cleanup(void) {
     return SUCCESS;
 }
 
-// // If pthread_timedjoin_np is not available on your system, use this alternative:
-// bool goose_receiver_cleanup_alternative(void) {
-//     pthread_mutex_lock(&goose_cleanup_mutex);
-    
-//     // Signal all threads to stop
-//     running_Goose = false;
-//     internal_shutdown_flag = true;
-    
-//     for (int i = 0; i < goose_instance_count; ++i) {
-//         if (thread_data[i].receiver) {
-//             GooseReceiver_stop(thread_data[i].receiver);
-//         }
-//     }
-    
-//     // Give threads time to finish gracefully
-//     Thread_sleep(500);
-    
-//     // Cancel and join threads
-//     if (threads != NULL) {
-//         for (int i = 0; i < goose_instance_count; ++i) {
-//             if (threads[i] != 0) {
-//                 pthread_cancel(threads[i]);
-//                 pthread_join(threads[i], NULL);
-//             }
-//         }
-//         free(threads);
-//         threads = NULL;
-//     }
-    
-//     // Clean up resources
-//     for (int i = 0; i < goose_instance_count; ++i) {
-//         if (thread_data[i].receiver != NULL) {
-//             GooseReceiver_destroy(thread_data[i].receiver);
-//             thread_data[i].receiver = NULL;
-//         }
-//         if (thread_data[i].subscriber != NULL) {
-//             GooseSubscriber_destroy(thread_data[i].subscriber);
-//             thread_data[i].subscriber = NULL;
-//         }
-        
-//         if (thread_data[i].interface) {
-//             free(thread_data[i].interface);
-//             thread_data[i].interface = NULL;
-//         }
-//         if (thread_data[i].GoCBRef) {
-//             free(thread_data[i].GoCBRef);
-//             thread_data[i].GoCBRef = NULL;
-//         }
-//         if (thread_data[i].DatSet) {
-//             free(thread_data[i].DatSet);
-//             thread_data[i].DatSet = NULL;
-//         }
-//         if (thread_data[i].MACAddress) {
-//             free(thread_data[i].MACAddress);
-//             thread_data[i].MACAddress = NULL;
-//         }
-        
-//         memset(&thread_data[i], 0, sizeof(ThreadData));
-//     }
-    
-//     if (thread_data) {
-//         free(thread_data);
-//         thread_data = NULL;
-//     }
-//     goose_instance_count = 0;
-    
-//     pthread_mutex_unlock(&goose_cleanup_mutex);
-//     LOG_INFO("Goose_Listener", "GOOSE cleanup complete");
-//     return SUCCESS;
-// }
-
-
 int Goose_receiver_init(SV_SimulationConfig *config, int number_of_subscribers)
 {
     LOG_INFO("Goose_Listener", "Starting Goose_Listener");
@@ -383,19 +353,15 @@ int Goose_receiver_init(SV_SimulationConfig *config, int number_of_subscribers)
     }
 
     // Clean up any previous allocations if init is called multiple times without cleanup
-    if (threads != NULL || thread_data != NULL)
+    if (thread_data != NULL)
     {
         LOG_INFO("Goose_Listener", "Previous SV Publisher instances found. Cleaning up before re-initialization.");
 
-        if (threads)
-        {
-            free(threads);
-            threads = NULL;
-        }
+        goose_destroy_interface_receivers();
         if (thread_data)
         {
             // Need to free internal strings within thread_data if they were strdup'd
-            for (int i = 0; i < number_of_subscribers; ++i)
+            for (int i = 0; i < goose_instance_count; ++i)
             {
 
                 if (thread_data[i].interface)
@@ -415,20 +381,11 @@ int Goose_receiver_init(SV_SimulationConfig *config, int number_of_subscribers)
 
     goose_instance_count = number_of_subscribers;
 
-    threads = (pthread_t *)malloc(goose_instance_count * sizeof(pthread_t));
-    if (!threads)
-    {
-        LOG_ERROR("Goose_Listener", "Memory allocation failed for threads!");
-        return FAIL;
-    }
-    memset(threads, 0, goose_instance_count * sizeof(pthread_t)); // Initialize to 0
-
     thread_data = (ThreadData *)malloc(goose_instance_count * sizeof(ThreadData));
     if (!thread_data)
     {
         LOG_ERROR("Goose_Listener", "Memory allocation failed for thread_data!");
-        free(threads); // Clean up threads array
-        threads = NULL;
+        goose_instance_count = 0;
         return FAIL;
     }
     memset(thread_data, 0, goose_instance_count * sizeof(ThreadData)); // Initialize to 0
@@ -564,18 +521,13 @@ cleanup_init_failure:
         free(thread_data);
         thread_data = NULL; // Set to NULL to avoid dangling pointer
     }
-    if (threads)
-    {
-        free(threads);
-        threads = NULL;
-    }
     goose_instance_count = 0;
     return FAIL;
 }
 
 int Goose_receiver_start()
 {
-    if (threads == NULL || thread_data == NULL || goose_instance_count <= 0)
+    if (thread_data == NULL || goose_instance_count <= 0)
     {
         LOG_ERROR("Goose_Listener", "SV Publisher not initialized. Call SVPublisher_init first.");
         return FAIL;
@@ -592,21 +544,71 @@ int Goose_receiver_start()
         return FAIL;
     }
 
-    bool all_threads_created = SUCCESS;
+    if (interface_receivers != NULL)
+    {
+        LOG_ERROR("Goose_Listener", "GOOSE receivers already started");
+        return FAIL;
+    }
+    interface_receivers = (GooseInterfaceReceiver *)calloc(goose_instance_count, sizeof(GooseInterfaceReceiver));
+    if (!interface_receivers)
+    {
+        LOG_ERROR("Goose_Listener", "Memory allocation failed for interface receivers!");
+        return FAIL;
+    }
+
+    int retval = SUCCESS;
     for (int i = 0; i < goose_instance_count; i++)
     {
-        if (pthread_create(&threads[i], NULL, goose_thread_task, &thread_data[i]) != 0)
+        GooseInterfaceReceiver *entry = goose_get_interface_receiver(thread_data[i].interface);
+        if (!entry)
+        {
+            retval = FAIL;
+            continue;
+        }
+
+        thread_data[i].subscriber = GooseSubscriber_create(thread_data[i].GoCBRef, NULL);
+        if (!thread_data[i].subscriber)
+        {
+            LOG_ERROR("Goose_Listener", "Subscriber creation failed for instance %d", i);
+            retval = FAIL;
+            continue;
+        }
+
+        // The key (GoCBRef, APPID, destination MAC) must be complete before the subscriber is indexed
+        GooseSubscriber_setAppId(thread_data[i].subscriber, thread_data[i].AppID);
+        GooseSubscriber_setDstMac(thread_data[i].subscriber, thread_data[i].MACAddress);
+        GooseSubscriber_setRawListener(thread_data[i].subscriber, gooseListener, &thread_data[i]);
+        GooseReceiver_addSubscriber(entry->receiver, thread_data[i].subscriber);
+
+        thread_data[i].receiver = entry->receiver;
+        entry->subscriber_count++;
+        LOG_INFO("Goose_Listener", "Instance %d (appid 0x%04x) subscribed on %s", i, thread_data[i].AppID, entry->interface);
+    }
+
+    if (SUCCESS != goose_event_loop_start())
+    {
+        return FAIL;
+    }
+    for (int i = 0; i < interface_receiver_count; i++)
+    {
+        if (SUCCESS != goose_start_interface_receiver(&interface_receivers[i]))
         {
-            LOG_ERROR("Goose_Listener", "Failed to create thread for instance %d: %s", i, strerror(errno));
-            all_threads_created = FAIL;
+            retval = FAIL;
         }
         else
         {
-            LOG_INFO("Goose_Listener", "Created thread for instance %d", i);
+            LOG_INFO("Goose_Listener", "Receiver started on %s for %d subscribers",
+                     interface_receivers[i].interface, interface_receivers[i].subscriber_count);
         }
     }
-    LOG_INFO("Goose_Listener", "Goose_Listener threads started.");
-    printf("Goose_Listener threads started.\n");
+    if (0 != pthread_create(&goose_event_thread, NULL, goose_event_loop, NULL))
+    {
+        LOG_ERROR("Goose_Listener", "Failed to create the GOOSE event thread");
+        return FAIL;
+    }
+    goose_event_thread_started = true;
+    LOG_INFO("Goose_Listener", "Goose_Listener receivers started.");
+    printf("Goose_Listener started: %d receivers for %d instances on one event thread.\n", interface_receiver_count, goose_instance_count);
     fflush(stdout);
-    return all_threads_created;
+    return retval;
 }
@@ -0,0 +1,561 @@
+#include "Goose_LoadGen.h"
+#include "Goose_Publisher.h"
+#include "Timer_Wheel.h"
+#include "logger.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "mms_value.h"
+#include "goose_publisher.h"
+#include "hal_ethernet.h"
+#include "linked_list.h"
+
+#define NS_PER_SEC 1000000000ULL
+#define NS_PER_MS 1000000ULL
+// Wheel resolution: a message is handed to the send path at most one tick after it is due
+#ifndef GOOSE_LOAD_TICK_NS
+#define GOOSE_LOAD_TICK_NS 250000ULL
+#endif
+#define GOOSE_LOAD_WHEEL_SLOTS 4096
+// Frames handed to the kernel with one Ethernet_sendPackets() call
+#ifndef GOOSE_LOAD_BATCH
+#define GOOSE_LOAD_BATCH 64
+#endif
+#define GOOSE_LOAD_TX_RING_FRAMES 512
+#define GOOSE_LOAD_MAX_FRAME_SIZE 1536
+#define GOOSE_LOAD_MAX_DATA_SET_SIZE 256
+#define GOOSE_LOAD_NAME_SIZE 130 // VisibleString129 + NUL
+#define GOOSE_LOAD_QUALITY_BITS 13
+#define GOOSE_LOAD_SLIP_BUCKETS 64
+
+typedef enum
+{
+    LOAD_TIMER_RETRANSMIT,
+    LOAD_TIMER_EVENT,
+    LOAD_TIMER_BURST
+} LoadTimerKind;
+
+typedef struct
+{
+    TimerWheelEntry entry; // first member: the wheel hands the entry back to load_expire()
+    LoadTimerKind kind;
+    int publisher;
+} LoadTimer;
+
+// The data set alternates stVal (BOOLEAN) and q (BIT STRING) entries, all of fixed encoded size:
+// a state change toggles the first stVal and is patched in place
+typedef struct
+{
+    GoosePublisher publisher;
+    LinkedList data_set;
+    MmsValue *st_val;
+    LoadTimer retransmit;
+    LoadTimer event;
+    uint32_t interval_ms;
+    uint64_t batch_id; // batch holding the frame of the publisher
+} VirtualPublisher;
+
+typedef struct
+{
+    uint64_t sent;
+    uint64_t send_errors;
+    uint64_t state_changes;
+    uint64_t batches;
+    uint64_t slip_count;
+    uint64_t slip_sum_ns;
+    uint64_t slip_max_ns;
+    uint64_t slip_buckets[GOOSE_LOAD_SLIP_BUCKETS]; // bucket b: slip < 2^b ns
+} LoadCounters;
+
+static VirtualPublisher *publishers = NULL;
+static int publisher_count = 0;
+static GooseLoadProfile load_profile;
+static EthernetSocket load_socket = NULL;
+static TimerWheel wheel;
+static bool wheel_ready = false;
+static LoadTimer burst_timer;
+static int burst_cursor = 0;
+static uint64_t event_period_ns = 0;
+
+// Batch of frames waiting for the send path, the buffers belong to the publishers
+static uint8_t *batch_buffers[GOOSE_LOAD_BATCH];
+static int batch_sizes[GOOSE_LOAD_BATCH];
+static int batch_count = 0;
+static uint64_t batch_id = 1;
+
+// Counters are written by the generator thread and read by Goose_LoadGen_get_stats() under the mutex
+static pthread_mutex_t load_mutex = PTHREAD_MUTEX_INITIALIZER;
+static LoadCounters counters;
+static uint64_t start_ns = 0;
+static uint64_t end_ns = 0; // 0 while running
+static uint64_t report_ns = 0;
+static uint64_t report_sent = 0;
+static bool stats_valid = false;
+static pthread_t load_thread;
+static bool load_thread_started = false;
+static volatile bool load_running = false;
+
+static uint64_t monotonic_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// xorshift64: deterministic spread of the event phases
+static uint64_t load_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void load_flush(void)
+{
+    if (0 == batch_count)
+    {
+        return;
+    }
+    int sent = Ethernet_sendPackets(load_socket, batch_buffers, batch_sizes, batch_count);
+    if (sent < 0)
+    {
+        sent = 0;
+    }
+    counters.sent += (uint64_t)sent;
+    counters.send_errors += (uint64_t)(batch_count - sent);
+    counters.batches++;
+    batch_count = 0;
+    batch_id++;
+}
+
+static void load_record_slip(uint64_t slip_ns)
+{
+    int bucket = 0;
+    while (bucket < GOOSE_LOAD_SLIP_BUCKETS - 1 && (1ULL << bucket) <= slip_ns)
+    {
+        bucket++;
+    }
+    counters.slip_buckets[bucket]++;
+    counters.slip_count++;
+    counters.slip_sum_ns += slip_ns;
+    if (slip_ns > counters.slip_max_ns)
+    {
+        counters.slip_max_ns = slip_ns;
+    }
+}
+
+// Queues the next message of a publisher (stNum, sqNum and t patched in its pre-encoded frame)
+static void load_queue(VirtualPublisher *vp)
+{
+    // The frame buffer is reused by the next message of the publisher: send the batch holding the previous one first
+    if (vp->batch_id == batch_id)
+    {
+        load_flush();
+    }
+    int frame_size = GoosePublisher_updateFrame(vp->publisher);
+    if (frame_size < 0)
+    {
+        counters.send_errors++;
+        return;
+    }
+    batch_buffers[batch_count] = GoosePublisher_getFrameBuffer(vp->publisher);
+    batch_sizes[batch_count] = frame_size;
+    batch_count++;
+    vp->batch_id = batch_id;
+    if (GOOSE_LOAD_BATCH == batch_count)
+    {
+        load_flush();
+    }
+}
+
+static void load_state_change(VirtualPublisher *vp, uint64_t due_ns)
+{
+    MmsValue_setBoolean(vp->st_val, !MmsValue_getBoolean(vp->st_val));
+    GoosePublisher_setDataSetValue(vp->publisher, 0, vp->st_val);
+    GoosePublisher_increaseStNum(vp->publisher);
+    load_queue(vp);
+    counters.state_changes++;
+
+    vp->interval_ms = load_profile.min_time_ms;
+    TimerWheel_schedule(&wheel, &vp->retransmit.entry, due_ns + (uint64_t)vp->interval_ms * NS_PER_MS);
+}
+
+static void load_expire(TimerWheelEntry *entry, uint64_t due_ns, void *context)
+{
+    LoadTimer *timer = (LoadTimer *)entry;
+    uint64_t now_ns = *(uint64_t *)context;
+
+    load_record_slip(now_ns > due_ns ? now_ns - due_ns : 0);
+
+    switch (timer->kind)
+    {
+    case LOAD_TIMER_RETRANSMIT:
+    {
+        VirtualPublisher *vp = &publishers[timer->publisher];
+        load_queue(vp);
+        // IEC 61850-8-1 retransmission: the interval doubles up to maxTime
+        vp->interval_ms = (vp->interval_ms >= load_profile.max_time_ms / 2) ? load_profile.max_time_ms : vp->interval_ms * 2;
+        TimerWheel_schedule(&wheel, entry, due_ns + (uint64_t)vp->interval_ms * NS_PER_MS);
+        break;
+    }
+    case LOAD_TIMER_EVENT:
+        load_state_change(&publishers[timer->publisher], due_ns);
+        TimerWheel_schedule(&wheel, entry, due_ns + event_period_ns);
+        break;
+    case LOAD_TIMER_BURST:
+        for (uint32_t i = 0; i < load_profile.burst_size; i++)
+        {
+            load_state_change(&publishers[burst_cursor], due_ns);
+            burst_cursor = (burst_cursor + 1) % publisher_count;
+        }
+        TimerWheel_schedule(&wheel, entry, due_ns + (uint64_t)load_profile.burst_interval_ms * NS_PER_MS);
+        break;
+    }
+}
+
+static void *load_generator_thread(void *arg)
+{
+    struct timespec ts;
+    uint64_t stop_ns = load_profile.duration_ms ? start_ns + (uint64_t)load_profile.duration_ms * NS_PER_MS : 0;
+
+    (void)arg;
+    while (load_running)
+    {
+        uint64_t next_ns = TimerWheel_next_tick_ns(&wheel);
+        ts.tv_sec = (time_t)(next_ns / NS_PER_SEC);
+        ts.tv_nsec = (long)(next_ns % NS_PER_SEC);
+        int rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        if (rc != 0 && rc != EINTR)
+        {
+            LOG_ERROR("Goose_LoadGen", "clock_nanosleep failed: %s", strerror(rc));
+            break;
+        }
+
+        uint64_t now_ns = monotonic_now_ns();
+        pthread_mutex_lock(&load_mutex);
+        TimerWheel_advance(&wheel, now_ns, load_expire, &now_ns);
+        load_flush();
+        if (stop_ns && now_ns >= stop_ns)
+        {
+            end_ns = now_ns;
+            load_running = false;
+        }
+        pthread_mutex_unlock(&load_mutex);
+    }
+    return NULL;
+}
+
+static void load_destroy_publishers(void)
+{
+    for (int i = 0; i < publisher_count; i++)
+    {
+        if (publishers[i].publisher)
+        {
+            GoosePublisher_destroy(publishers[i].publisher);
+        }
+        if (publishers[i].data_set)
+        {
+            LinkedList_destroyDeep(publishers[i].data_set, (LinkedListValueDeleteFunction)MmsValue_delete);
+        }
+    }
+    free(publishers);
+    publishers = NULL;
+    publisher_count = 0;
+    if (load_socket)
+    {
+        Ethernet_destroySocket(load_socket);
+        load_socket = NULL;
+    }
+    if (wheel_ready)
+    {
+        TimerWheel_destroy(&wheel);
+        wheel_ready = false;
+    }
+    batch_count = 0;
+}
+
+static int load_create_publisher(int index, const GOOSE_SimulationConfig *config, uint16_t app_id, const uint8_t *dst_mac)
+{
+    VirtualPublisher *vp = &publishers[index];
+    CommParameters parameters;
+    char go_cb_ref[GOOSE_LOAD_NAME_SIZE];
+    char data_set_ref[GOOSE_LOAD_NAME_SIZE];
+    char go_id[GOOSE_LOAD_NAME_SIZE];
+
+    memset(&parameters, 0, sizeof(parameters));
+    memcpy(parameters.dstAddress, dst_mac, 6);
+    parameters.appId = (uint16_t)(app_id + index);
+    parameters.vlanPriority = 4;
+
+    vp->publisher = GoosePublisher_createWithSocket(&parameters, config->Interface, load_socket, true);
+    if (!vp->publisher)
+    {
+        return FAIL;
+    }
+    if (publisher_count > 1)
+    {
+        snprintf(go_cb_ref, sizeof(go_cb_ref), "%s_%d", config->GoCBRef, index);
+        snprintf(data_set_ref, sizeof(data_set_ref), "%s_%d", config->DatSet, index);
+        snprintf(go_id, sizeof(go_id), "%s_%d", config->GoID ? config->GoID : config->GoCBRef, index);
+    }
+    else
+    {
+        snprintf(go_cb_ref, sizeof(go_cb_ref), "%s", config->GoCBRef);
+        snprintf(data_set_ref, sizeof(data_set_ref), "%s", config->DatSet);
+        snprintf(go_id, sizeof(go_id), "%s", config->GoID ? config->GoID : config->GoCBRef);
+    }
+    GoosePublisher_setGoCbRef(vp->publisher, go_cb_ref);
+    GoosePublisher_setDataSetRef(vp->publisher, data_set_ref);
+    GoosePublisher_setGoID(vp->publisher, go_id);
+    GoosePublisher_setConfRev(vp->publisher, 1);
+    GoosePublisher_setTimeAllowedToLive(vp->publisher, 2 * load_profile.max_time_ms);
+
+    vp->data_set = LinkedList_create();
+    if (!vp->data_set)
+    {
+        return FAIL;
+    }
+    for (int i = 0; i < load_profile.data_set_size; i++)
+    {
+        MmsValue *value = (0 == i % 2) ? MmsValue_newBoolean(false) : MmsValue_newBitString(GOOSE_LOAD_QUALITY_BITS);
+        if (!value)
+        {
+            return FAIL;
+        }
+        LinkedList_add(vp->data_set, value);
+        if (0 == i)
+        {
+            vp->st_val = value;
+        }
+    }
+    if (!GoosePublisher_setupDataSet(vp->publisher, vp->data_set))
+    {
+        LOG_ERROR("Goose_LoadGen", "Data set of %d entries does not fit into a frame", load_profile.data_set_size);
+        return FAIL;
+    }
+
+    vp->retransmit.kind = LOAD_TIMER_RETRANSMIT;
+    vp->retransmit.publisher = index;
+    vp->event.kind = LOAD_TIMER_EVENT;
+    vp->event.publisher = index;
+    return SUCCESS;
+}
+
+void Goose_LoadGen_default_profile(GooseLoadProfile *profile)
+{
+    memset(profile, 0, sizeof(*profile));
+    profile->publishers = 1;
+    profile->data_set_size = 8;
+    profile->min_time_ms = GOOSE_MIN_TIME_MS;
+    profile->max_time_ms = GOOSE_MAX_TIME_MS;
+}
+
+int Goose_LoadGen_start(const GOOSE_SimulationConfig *config, const GooseLoadProfile *profile)
+{
+    uint8_t dst_mac[6];
+
+    if (!config || !profile || !config->GoCBRef || !config->DatSet || !config->MACAddress || !config->AppID || !config->Interface)
+    {
+        LOG_ERROR("Goose_LoadGen", "Incomplete GOOSE configuration");
+        return FAIL;
+    }
+    if (profile->publishers <= 0 || profile->data_set_size <= 0 || profile->data_set_size > GOOSE_LOAD_MAX_DATA_SET_SIZE ||
+        profile->min_time_ms == 0 || profile->max_time_ms < profile->min_time_ms || profile->event_rate_hz < 0 ||
+        (profile->burst_size > 0 && profile->burst_interval_ms == 0))
+    {
+        LOG_ERROR("Goose_LoadGen", "Invalid load profile: %d publishers, %d entries, minTime %u ms, maxTime %u ms, burst %u/%u ms",
+                  profile->publishers, profile->data_set_size, profile->min_time_ms, profile->max_time_ms,
+                  profile->burst_size, profile->burst_interval_ms);
+        return FAIL;
+    }
+    char *endptr;
+    unsigned long app_id = strtoul(config->AppID, &endptr, 0);
+    if (*endptr != '\0' || app_id > UINT16_MAX)
+    {
+        LOG_ERROR("Goose_LoadGen", "Invalid AppID: %s", config->AppID);
+        return FAIL;
+    }
+    if (!parse_mac_address(config->MACAddress, dst_mac))
+    {
+        LOG_ERROR("Goose_LoadGen", "Invalid MAC address: %s", config->MACAddress);
+        return FAIL;
+    }
+
+    Goose_LoadGen_stop();
+
+    load_profile = *profile;
+    if (load_profile.burst_size > (uint32_t)load_profile.publishers)
+    {
+        load_profile.burst_size = (uint32_t)load_profile.publishers;
+    }
+
+    load_socket = Ethernet_createSocket(config->Interface, NULL);
+    if (!load_socket)
+    {
+        LOG_ERROR("Goose_LoadGen", "Failed to open a socket on %s. The interface may not exist or root permission is required.",
+                  config->Interface);
+        return FAIL;
+    }
+    // Transmit only, every frame of a batch goes through the memory mapped ring when available
+    Ethernet_setFrameFilter(load_socket, NULL, 0, NULL, 0, NULL, 0);
+    Ethernet_setIgnoreOutgoing(load_socket, true);
+    Ethernet_enableTxRing(load_socket, GOOSE_LOAD_MAX_FRAME_SIZE, GOOSE_LOAD_TX_RING_FRAMES);
+
+    publishers = (VirtualPublisher *)calloc(load_profile.publishers, sizeof(VirtualPublisher));
+    if (!publishers)
+    {
+        LOG_ERROR("Goose_LoadGen", "Memory allocation failed for %d publishers", load_profile.publishers);
+        load_destroy_publishers();
+        return FAIL;
+    }
+    publisher_count = load_profile.publishers;
+    for (int i = 0; i < publisher_count; i++)
+    {
+        if (SUCCESS != load_create_publisher(i, config, (uint16_t)app_id, dst_mac))
+        {
+            LOG_ERROR("Goose_LoadGen", "Failed to create virtual publisher %d", i);
+            load_destroy_publishers();
+            return FAIL;
+        }
+    }
+
+    start_ns = monotonic_now_ns();
+    if (SUCCESS != TimerWheel_init(&wheel, GOOSE_LOAD_WHEEL_SLOTS, GOOSE_LOAD_TICK_NS, start_ns))
+    {
+        load_destroy_publishers();
+        return FAIL;
+    }
+    wheel_ready = true;
+
+    // Stable state at start: the maxTime retransmissions are spread evenly over one maxTime period
+    uint64_t max_time_ns = (uint64_t)load_profile.max_time_ms * NS_PER_MS;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    event_period_ns = (load_profile.event_rate_hz > 0) ? (uint64_t)((double)NS_PER_SEC / load_profile.event_rate_hz) : 0;
+    for (int i = 0; i < publisher_count; i++)
+    {
+        VirtualPublisher *vp = &publishers[i];
+        vp->interval_ms = load_profile.max_time_ms;
+        TimerWheel_schedule(&wheel, &vp->retransmit.entry, start_ns + max_time_ns * (uint64_t)i / (uint64_t)publisher_count);
+        if (event_period_ns > 0)
+        {
+            TimerWheel_schedule(&wheel, &vp->event.entry, start_ns + load_random(&seed) % event_period_ns);
+        }
+    }
+    burst_cursor = 0;
+    if (load_profile.burst_size > 0)
+    {
+        burst_timer.kind = LOAD_TIMER_BURST;
+        TimerWheel_schedule(&wheel, &burst_timer.entry, start_ns + (uint64_t)load_profile.burst_interval_ms * NS_PER_MS);
+    }
+
+    pthread_mutex_lock(&load_mutex);
+    memset(&counters, 0, sizeof(counters));
+    end_ns = 0;
+    report_ns = start_ns;
+    report_sent = 0;
+    stats_valid = true;
+    pthread_mutex_unlock(&load_mutex);
+
+    load_running = true;
+    if (0 != pthread_create(&load_thread, NULL, load_generator_thread, NULL))
+    {
+        LOG_ERROR("Goose_LoadGen", "Failed to create the load generator thread");
+        load_running = false;
+        load_destroy_publishers();
+        return FAIL;
+    }
+    load_thread_started = true;
+    LOG_INFO("Goose_LoadGen", "Load generator started: %d publishers on %s, %.3f events/s each, burst %u every %u ms, %d entries",
+             publisher_count, config->Interface, load_profile.event_rate_hz, load_profile.burst_size,
+             load_profile.burst_interval_ms, load_profile.data_set_size);
+    return SUCCESS;
+}
+
+int Goose_LoadGen_get_stats(GooseLoadStats *stats)
+{
+    if (!stats)
+    {
+        return FAIL;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    pthread_mutex_lock(&load_mutex);
+    if (!stats_valid)
+    {
+        pthread_mutex_unlock(&load_mutex);
+        return FAIL;
+    }
+    uint64_t now_ns = end_ns ? end_ns : monotonic_now_ns();
+    uint64_t elapsed_ns = now_ns - start_ns;
+
+    stats->running = (0 == end_ns);
+    stats->publishers = load_profile.publishers;
+    stats->elapsed_ms = elapsed_ns / NS_PER_MS;
+    stats->sent = counters.sent;
+    stats->send_errors = counters.send_errors;
+    stats->state_changes = counters.state_changes;
+    stats->batches = counters.batches;
+    stats->msgs_per_s = elapsed_ns ? (double)counters.sent * NS_PER_SEC / (double)elapsed_ns : 0;
+    if (now_ns > report_ns)
+    {
+        stats->current_msgs_per_s = (double)(counters.sent - report_sent) * NS_PER_SEC / (double)(now_ns - report_ns);
+    }
+    report_ns = now_ns;
+    report_sent = counters.sent;
+
+    if (counters.slip_count)
+    {
+        stats->slip_mean_ns = counters.slip_sum_ns / counters.slip_count;
+        stats->slip_max_ns = counters.slip_max_ns;
+        uint64_t rank = (counters.slip_count * 99 + 99) / 100;
+        uint64_t seen = 0;
+        for (int b = 0; b < GOOSE_LOAD_SLIP_BUCKETS; b++)
+        {
+            seen += counters.slip_buckets[b];
+            if (seen >= rank)
+            {
+                stats->slip_p99_ns = (b < 63) ? (1ULL << b) : UINT64_MAX;
+                break;
+            }
+        }
+        if (stats->slip_p99_ns > stats->slip_max_ns)
+        {
+            stats->slip_p99_ns = stats->slip_max_ns;
+        }
+    }
+    pthread_mutex_unlock(&load_mutex);
+    return SUCCESS;
+}
+
+void Goose_LoadGen_stop(void)
+{
+    load_running = false;
+    if (load_thread_started)
+    {
+        pthread_join(load_thread, NULL);
+        load_thread_started = false;
+    }
+
+    pthread_mutex_lock(&load_mutex);
+    if (stats_valid && 0 == end_ns)
+    {
+        end_ns = monotonic_now_ns();
+    }
+    if (publishers)
+    {
+        LOG_INFO("Goose_LoadGen", "Load generator stopped: %llu messages sent, %llu send errors",
+                 (unsigned long long)counters.sent, (unsigned long long)counters.send_errors);
+    }
+    pthread_mutex_unlock(&load_mutex);
+
+    load_destroy_publishers();
+}
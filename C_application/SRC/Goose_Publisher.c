@@ -6,69 +6,356 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
-#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
 
 #include "mms_value.h"
 #include "goose_publisher.h"
-#include "hal_thread.h"
+#include "hal_time.h"
+#include "linked_list.h"
+#include "Timer_Wheel.h"
+#include "logger.h"
+#include "util.h"
+
+#define NS_PER_MS 1000000ULL
+// Resolution of the retransmission timer wheel, one revolution covers GOOSE_WHEEL_SLOTS ticks
+#define GOOSE_WHEEL_TICK_NS NS_PER_MS
+#define GOOSE_WHEEL_SLOTS 1024
+#define GOOSE_DEFAULT_VLAN_PRIORITY 4
+#define GOOSE_QUALITY_BITS 13
 
-LinkedList dataSetValues ;
-GoosePublisher publisher;
+// Data set of a control block: stVal, q, t
+enum
+{
+    GOOSE_ENTRY_ST_VAL = 0,
+    GOOSE_ENTRY_QUALITY,
+    GOOSE_ENTRY_TIMESTAMP,
+    GOOSE_ENTRY_COUNT
+};
 
-void goose_publisher_send(GOOSE_SimulationConfig* config)
+typedef struct
 {
+    TimerWheelEntry timer; // first member: the wheel hands the timer back to goose_retransmit()
+    GoosePublisher publisher;
+    LinkedList data_set;
+    MmsValue *values[GOOSE_ENTRY_COUNT];
+    uint32_t interval_ms; // current retransmission interval
+} GooseControlBlock;
 
-    dataSetValues = LinkedList_create();
+static GooseControlBlock *control_blocks = NULL;
+static int control_block_count = 0;
+static uint32_t min_time = GOOSE_MIN_TIME_MS;
+static uint32_t max_time = GOOSE_MAX_TIME_MS;
+static uint64_t sent_count = 0;
+static uint64_t send_errors = 0;
 
-    LinkedList_add(dataSetValues, MmsValue_newIntegerFromInt32(1234));
-    LinkedList_add(dataSetValues, MmsValue_newBinaryTime(false));
-    LinkedList_add(dataSetValues, MmsValue_newIntegerFromInt32(5678));
+// The wheel is shared by the retransmission thread and the threads changing states
+static pthread_mutex_t goose_publisher_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TimerWheel wheel;
+static bool wheel_ready = false;
+static pthread_t wheel_thread;
+static bool wheel_thread_started = false;
+static volatile bool publisher_running = false;
 
+static uint64_t monotonic_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void goose_send(GooseControlBlock *block)
+{
+    if (0 == GoosePublisher_publishFrame(block->publisher))
+    {
+        sent_count++;
+    }
+    else
+    {
+        send_errors++;
+    }
+}
 
-    CommParameters gooseCommParameters;
+static void goose_retransmit(TimerWheelEntry *entry, uint64_t due_ns, void *context)
+{
+    GooseControlBlock *block = (GooseControlBlock *)entry;
 
-    gooseCommParameters.appId = 1000;
-    gooseCommParameters.dstAddress[0] = 0x01;
-    gooseCommParameters.dstAddress[1] = 0x0c;
-    gooseCommParameters.dstAddress[2] = 0xcd;
-    gooseCommParameters.dstAddress[3] = 0x01;
-    gooseCommParameters.dstAddress[4] = 0x00;
-    gooseCommParameters.dstAddress[5] = 0x01;
-    gooseCommParameters.vlanId = 0;
-    gooseCommParameters.vlanPriority = 4;
-    publisher = GoosePublisher_create(&gooseCommParameters, config->Interface);
+    (void)context;
+    goose_send(block);
 
-    if (publisher) 
+    // IEC 61850-8-1: the interval doubles after each repetition until it reaches maxTime.
+    // The next deadline follows the previous one, a late wake-up does not stretch the sequence.
+    block->interval_ms = (block->interval_ms >= max_time / 2) ? max_time : block->interval_ms * 2;
+    TimerWheel_schedule(&wheel, entry, due_ns + (uint64_t)block->interval_ms * NS_PER_MS);
+}
+
+// New state: new stNum and timestamp, sent at once and repeated from minTime (caller holds the mutex)
+static void goose_state_change(GooseControlBlock *block)
+{
+    uint64_t now_ms = GoosePublisher_increaseStNum(block->publisher);
+
+    MmsValue_setUtcTimeMs(block->values[GOOSE_ENTRY_TIMESTAMP], now_ms);
+    GoosePublisher_setDataSetValue(block->publisher, GOOSE_ENTRY_TIMESTAMP, block->values[GOOSE_ENTRY_TIMESTAMP]);
+    goose_send(block);
+
+    block->interval_ms = min_time;
+    TimerWheel_schedule(&wheel, &block->timer, monotonic_now_ns() + (uint64_t)min_time * NS_PER_MS);
+}
+
+static void *goose_wheel_thread(void *arg)
+{
+    struct timespec ts;
+
+    (void)arg;
+    while (publisher_running)
     {
-        GoosePublisher_setGoCbRef(publisher, "simpleIOGenericIO/LLN0$GO$gcbAnalogValues");
-        GoosePublisher_setConfRev(publisher, 1);
-        GoosePublisher_setDataSetRef(publisher, "simpleIOGenericIO/LLN0$AnalogValues");
-        GoosePublisher_setTimeAllowedToLive(publisher, 500);
+        pthread_mutex_lock(&goose_publisher_mutex);
+        uint64_t next_ns = TimerWheel_next_tick_ns(&wheel);
+        pthread_mutex_unlock(&goose_publisher_mutex);
 
-        int i = 0;
-             for (i = 0; i < 4; i++) {
-            Thread_sleep(1000);
+        ts.tv_sec = (time_t)(next_ns / 1000000000ULL);
+        ts.tv_nsec = (long)(next_ns % 1000000000ULL);
+        int rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        if (rc != 0 && rc != EINTR)
+        {
+            LOG_ERROR("Goose_Publisher", "clock_nanosleep failed: %s", strerror(rc));
+            break;
+        }
 
-            if (i == 3) {
-                /* now change dataset to send an invalid GOOSE message */
-                LinkedList_add(dataSetValues, MmsValue_newBoolean(true));
-                GoosePublisher_publish(publisher, dataSetValues);
-            }
-            else {
-                if (GoosePublisher_publish(publisher, dataSetValues) == -1) {
-                    printf("Error sending message!\n");
-                }
+        pthread_mutex_lock(&goose_publisher_mutex);
+        TimerWheel_advance(&wheel, monotonic_now_ns(), goose_retransmit, NULL);
+        pthread_mutex_unlock(&goose_publisher_mutex);
+    }
+    return NULL;
+}
+
+static int goose_control_block_create(GooseControlBlock *block, const GOOSE_SimulationConfig *config, int index)
+{
+    CommParameters parameters;
+
+    if (!config->GoCBRef || !config->DatSet || !config->MACAddress || !config->AppID || !config->Interface)
+    {
+        LOG_ERROR("Goose_Publisher", "Incomplete configuration for control block %d", index);
+        return FAIL;
+    }
+
+    memset(&parameters, 0, sizeof(parameters));
+    char *endptr;
+    unsigned long app_id = strtoul(config->AppID, &endptr, 0);
+    if (*endptr != '\0' || app_id > UINT16_MAX)
+    {
+        LOG_ERROR("Goose_Publisher", "Invalid AppID for control block %d: %s", index, config->AppID);
+        return FAIL;
+    }
+    if (!parse_mac_address(config->MACAddress, parameters.dstAddress))
+    {
+        LOG_ERROR("Goose_Publisher", "Invalid MAC address for control block %d: %s", index, config->MACAddress);
+        return FAIL;
+    }
+    parameters.appId = (uint16_t)app_id;
+    parameters.vlanId = 0;
+    parameters.vlanPriority = GOOSE_DEFAULT_VLAN_PRIORITY;
+
+    block->publisher = GoosePublisher_create(&parameters, config->Interface);
+    if (!block->publisher)
+    {
+        LOG_ERROR("Goose_Publisher", "Failed to create GOOSE publisher on %s. The interface may not exist or root permission is required.",
+                  config->Interface);
+        return FAIL;
+    }
+    GoosePublisher_setGoCbRef(block->publisher, config->GoCBRef);
+    GoosePublisher_setDataSetRef(block->publisher, config->DatSet);
+    if (config->GoID)
+    {
+        GoosePublisher_setGoID(block->publisher, config->GoID);
+    }
+    GoosePublisher_setConfRev(block->publisher, 1);
+    // A subscriber declares the stream lost after TAL without a message
+    GoosePublisher_setTimeAllowedToLive(block->publisher, 2 * max_time);
+
+    block->data_set = LinkedList_create();
+    block->values[GOOSE_ENTRY_ST_VAL] = MmsValue_newBoolean(false);
+    block->values[GOOSE_ENTRY_QUALITY] = MmsValue_newBitString(GOOSE_QUALITY_BITS);
+    block->values[GOOSE_ENTRY_TIMESTAMP] = MmsValue_newUtcTimeByMsTime(Hal_getTimeInMs());
+    for (int i = 0; i < GOOSE_ENTRY_COUNT; i++)
+    {
+        if (!block->values[i])
+        {
+            LOG_ERROR("Goose_Publisher", "Memory allocation failed for the data set of control block %d", index);
+            return FAIL;
+        }
+    }
+    for (int i = 0; i < GOOSE_ENTRY_COUNT; i++)
+    {
+        LinkedList_add(block->data_set, block->values[i]);
+    }
+
+    if (!GoosePublisher_setupDataSet(block->publisher, block->data_set))
+    {
+        LOG_ERROR("Goose_Publisher", "Failed to encode the data set of control block %d", index);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+static void goose_control_block_destroy(GooseControlBlock *block)
+{
+    if (block->publisher)
+    {
+        GoosePublisher_destroy(block->publisher);
+        block->publisher = NULL;
+    }
+    if (block->data_set && LinkedList_size(block->data_set) > 0)
+    {
+        // The values are owned by the list
+        LinkedList_destroyDeep(block->data_set, (LinkedListValueDeleteFunction)MmsValue_delete);
+    }
+    else
+    {
+        for (int i = 0; i < GOOSE_ENTRY_COUNT; i++)
+        {
+            if (block->values[i])
+            {
+                MmsValue_delete(block->values[i]);
             }
         }
+        if (block->data_set)
+        {
+            LinkedList_destroyStatic(block->data_set);
+        }
+    }
+    block->data_set = NULL;
+    memset(block->values, 0, sizeof(block->values));
+}
+
+int Goose_publisher_init(GOOSE_SimulationConfig *config, int count, uint32_t min_time_ms, uint32_t max_time_ms)
+{
+    if (config == NULL || count <= 0 || min_time_ms == 0 || max_time_ms < min_time_ms)
+    {
+        LOG_ERROR("Goose_Publisher", "Invalid input: %d control blocks, minTime %u ms, maxTime %u ms", count, min_time_ms, max_time_ms);
+        return FAIL;
+    }
+    if (control_blocks != NULL)
+    {
+        LOG_INFO("Goose_Publisher", "Previous GOOSE control blocks found. Cleaning up before re-initialization.");
+        goose_publisher_cleanup();
+    }
+
+    min_time = min_time_ms;
+    max_time = max_time_ms;
+    control_blocks = (GooseControlBlock *)calloc(count, sizeof(GooseControlBlock));
+    if (!control_blocks)
+    {
+        LOG_ERROR("Goose_Publisher", "Memory allocation failed for %d control blocks", count);
+        return FAIL;
+    }
+    control_block_count = count;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (SUCCESS != goose_control_block_create(&control_blocks[i], &config[i], i))
+        {
+            goose_publisher_cleanup();
+            return FAIL;
+        }
+    }
+    sent_count = 0;
+    send_errors = 0;
+    LOG_INFO("Goose_Publisher", "%d GOOSE control blocks ready (minTime %u ms, maxTime %u ms)", count, min_time, max_time);
+    return SUCCESS;
+}
+
+int Goose_publisher_start(void)
+{
+    if (control_blocks == NULL)
+    {
+        LOG_ERROR("Goose_Publisher", "GOOSE publisher not initialized. Call Goose_publisher_init first.");
+        return FAIL;
+    }
+    if (publisher_running)
+    {
+        return SUCCESS;
+    }
 
+    if (SUCCESS != TimerWheel_init(&wheel, GOOSE_WHEEL_SLOTS, GOOSE_WHEEL_TICK_NS, monotonic_now_ns()))
+    {
+        return FAIL;
+    }
+    wheel_ready = true;
+
+    // The initial state is a state change: stNum 1, repeated from minTime
+    pthread_mutex_lock(&goose_publisher_mutex);
+    for (int i = 0; i < control_block_count; i++)
+    {
+        GoosePublisher_setStNum(control_blocks[i].publisher, 0);
+        goose_state_change(&control_blocks[i]);
+    }
+    pthread_mutex_unlock(&goose_publisher_mutex);
+
+    publisher_running = true;
+    if (0 != pthread_create(&wheel_thread, NULL, goose_wheel_thread, NULL))
+    {
+        LOG_ERROR("Goose_Publisher", "Failed to create the GOOSE retransmission thread");
+        publisher_running = false;
+        return FAIL;
     }
-  else {
-        printf("Failed to create GOOSE publisher. Reason can be that the Ethernet interface doesn't exist or root permission are required.\n");
+    wheel_thread_started = true;
+    LOG_INFO("Goose_Publisher", "GOOSE publisher started for %d control blocks", control_block_count);
+    return SUCCESS;
+}
+
+int Goose_publisher_set_state(int index, bool state)
+{
+    if (index < 0 || index >= control_block_count || !publisher_running)
+    {
+        LOG_ERROR("Goose_Publisher", "Invalid control block %d or publisher not running", index);
+        return FAIL;
     }
 
+    GooseControlBlock *block = &control_blocks[index];
+    pthread_mutex_lock(&goose_publisher_mutex);
+    if (MmsValue_getBoolean(block->values[GOOSE_ENTRY_ST_VAL]) != state)
+    {
+        MmsValue_setBoolean(block->values[GOOSE_ENTRY_ST_VAL], state);
+        GoosePublisher_setDataSetValue(block->publisher, GOOSE_ENTRY_ST_VAL, block->values[GOOSE_ENTRY_ST_VAL]);
+        goose_state_change(block);
+    }
+    pthread_mutex_unlock(&goose_publisher_mutex);
+    return SUCCESS;
 }
+
+uint64_t Goose_publisher_get_sent_count(void)
+{
+    pthread_mutex_lock(&goose_publisher_mutex);
+    uint64_t count = sent_count;
+    pthread_mutex_unlock(&goose_publisher_mutex);
+    return count;
+}
+
 void goose_publisher_cleanup(void)
 {
-    GoosePublisher_destroy(publisher);
-    LinkedList_destroyDeep(dataSetValues, (LinkedListValueDeleteFunction) MmsValue_delete);
-}
\ No newline at end of file
+    publisher_running = false;
+    if (wheel_thread_started)
+    {
+        pthread_join(wheel_thread, NULL);
+        wheel_thread_started = false;
+    }
+    if (wheel_ready)
+    {
+        TimerWheel_destroy(&wheel);
+        wheel_ready = false;
+    }
+
+    if (send_errors)
+    {
+        LOG_WARN("Goose_Publisher", "%llu GOOSE messages could not be sent", (unsigned long long)send_errors);
+    }
+    for (int i = 0; i < control_block_count; i++)
+    {
+        goose_control_block_destroy(&control_blocks[i]);
+    }
+    free(control_blocks);
+    control_blocks = NULL;
+    control_block_count = 0;
+}
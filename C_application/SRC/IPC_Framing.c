@@ -0,0 +1,297 @@
+#include "IPC_Framing.h"
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "logger.h"
+
+int ipc_framer_init(IpcFramer *framer, ipc_framing_e mode, size_t max_message_size)
+{
+    memset(framer, 0, sizeof(*framer));
+
+    framer->data = (char *)malloc(IPC_FRAMER_INITIAL_CAPACITY);
+    if (!framer->data)
+    {
+        LOG_ERROR("IPC_Framing", "Memory allocation failed for receive buffer");
+        return FAIL;
+    }
+    framer->capacity = IPC_FRAMER_INITIAL_CAPACITY;
+    framer->max_message_size = max_message_size;
+    framer->mode = mode;
+    return SUCCESS;
+}
+
+void ipc_framer_free(IpcFramer *framer)
+{
+    free(framer->data);
+    framer->data = NULL;
+    framer->capacity = 0;
+    ipc_framer_reset(framer);
+}
+
+void ipc_framer_reset(IpcFramer *framer)
+{
+    framer->read_pos = 0;
+    framer->write_pos = 0;
+    framer->scan_pos = 0;
+    framer->depth = 0;
+    framer->in_string = false;
+    framer->escape = false;
+}
+
+char *ipc_framer_write_ptr(IpcFramer *framer, size_t min_room, size_t *room)
+{
+    // Everything consumed: restart at the beginning for free
+    if (framer->read_pos == framer->write_pos)
+    {
+        framer->read_pos = 0;
+        framer->write_pos = 0;
+        framer->scan_pos = 0;
+    }
+
+    // Reclaim the consumed bytes before growing
+    if (framer->capacity - framer->write_pos < min_room && framer->read_pos > 0)
+    {
+        memmove(framer->data, framer->data + framer->read_pos, framer->write_pos - framer->read_pos);
+        framer->write_pos -= framer->read_pos;
+        framer->scan_pos -= framer->read_pos;
+        framer->read_pos = 0;
+    }
+
+    if (framer->capacity - framer->write_pos < min_room)
+    {
+        // One maximal message with its header plus one receive worth of the next message
+        size_t limit = framer->max_message_size + IPC_FRAMER_MAX_HEADER + min_room;
+        size_t new_capacity = framer->capacity;
+
+        while (new_capacity - framer->write_pos < min_room)
+        {
+            new_capacity *= 2;
+        }
+        if (limit < framer->capacity)
+        {
+            limit = framer->capacity;
+        }
+        if (new_capacity > limit)
+        {
+            new_capacity = limit;
+        }
+        if (new_capacity - framer->write_pos < min_room)
+        {
+            return NULL;
+        }
+
+        char *data = (char *)realloc(framer->data, new_capacity);
+        if (!data)
+        {
+            LOG_ERROR("IPC_Framing", "Memory allocation failed for %zu bytes receive buffer", new_capacity);
+            return NULL;
+        }
+        framer->data = data;
+        framer->capacity = new_capacity;
+    }
+
+    *room = framer->capacity - framer->write_pos;
+    return framer->data + framer->write_pos;
+}
+
+void ipc_framer_commit(IpcFramer *framer, size_t length)
+{
+    framer->write_pos += length;
+}
+
+static int ipc_framer_next_json(IpcFramer *framer, const char **message, size_t *length)
+{
+    const char *data = framer->data;
+    size_t pos = framer->scan_pos;
+
+    while (pos < framer->write_pos)
+    {
+        char c = data[pos];
+
+        if (0 == framer->depth)
+        {
+            if (c != '{')
+            {
+                // Whitespace (or garbage) between two objects
+                pos++;
+                framer->read_pos = pos;
+                continue;
+            }
+        }
+
+        if (framer->in_string)
+        {
+            if (framer->escape)
+            {
+                framer->escape = false;
+            }
+            else if (c == '\\')
+            {
+                framer->escape = true;
+            }
+            else if (c == '"')
+            {
+                framer->in_string = false;
+            }
+        }
+        else if (c == '"')
+        {
+            framer->in_string = true;
+        }
+        else if (c == '{')
+        {
+            framer->depth++;
+        }
+        else if (c == '}')
+        {
+            framer->depth--;
+            if (0 == framer->depth)
+            {
+                pos++;
+                *message = data + framer->read_pos;
+                *length = pos - framer->read_pos;
+                framer->read_pos = pos;
+                framer->scan_pos = pos;
+                return 1;
+            }
+        }
+        pos++;
+    }
+
+    framer->scan_pos = pos;
+    if (framer->write_pos - framer->read_pos > framer->max_message_size)
+    {
+        LOG_ERROR("IPC_Framing", "Incoming JSON message exceeds %zu bytes", framer->max_message_size);
+        ipc_framer_reset(framer);
+        return FAIL;
+    }
+    return 0;
+}
+
+static int ipc_framer_next_line(IpcFramer *framer, const char **message, size_t *length)
+{
+    for (;;)
+    {
+        char *newline = memchr(framer->data + framer->scan_pos, '\n', framer->write_pos - framer->scan_pos);
+
+        if (!newline)
+        {
+            framer->scan_pos = framer->write_pos;
+            if (framer->write_pos - framer->read_pos > framer->max_message_size)
+            {
+                LOG_ERROR("IPC_Framing", "Incoming line exceeds %zu bytes", framer->max_message_size);
+                ipc_framer_reset(framer);
+                return FAIL;
+            }
+            return 0;
+        }
+
+        size_t end = (size_t)(newline - framer->data);
+        size_t start = framer->read_pos;
+
+        framer->read_pos = end + 1;
+        framer->scan_pos = end + 1;
+        if (end > start && framer->data[end - 1] == '\r')
+        {
+            end--;
+        }
+        if (end > start)
+        {
+            *message = framer->data + start;
+            *length = end - start;
+            return 1;
+        }
+        // Empty line: keep-alive, skip it
+    }
+}
+
+static int ipc_framer_next_prefixed(IpcFramer *framer, const char **message, size_t *length)
+{
+    size_t pending = framer->write_pos - framer->read_pos;
+
+    if (pending < IPC_FRAMER_MAX_HEADER)
+    {
+        return 0;
+    }
+
+    const uint8_t *header = (const uint8_t *)framer->data + framer->read_pos;
+    size_t payload = ((size_t)header[0] << 24) | ((size_t)header[1] << 16) | ((size_t)header[2] << 8) | (size_t)header[3];
+
+    if (payload > framer->max_message_size)
+    {
+        LOG_ERROR("IPC_Framing", "Announced message size %zu exceeds %zu bytes", payload, framer->max_message_size);
+        ipc_framer_reset(framer);
+        return FAIL;
+    }
+    if (pending - IPC_FRAMER_MAX_HEADER < payload)
+    {
+        return 0;
+    }
+
+    *message = framer->data + framer->read_pos + IPC_FRAMER_MAX_HEADER;
+    *length = payload;
+    framer->read_pos += IPC_FRAMER_MAX_HEADER + payload;
+    framer->scan_pos = framer->read_pos;
+    return 1;
+}
+
+int ipc_framer_next(IpcFramer *framer, const char **message, size_t *length)
+{
+    int retval;
+
+    switch (framer->mode)
+    {
+    case IPC_FRAMING_NEWLINE:
+        retval = ipc_framer_next_line(framer, message, length);
+        break;
+    case IPC_FRAMING_LENGTH_PREFIX:
+        retval = ipc_framer_next_prefixed(framer, message, length);
+        break;
+    case IPC_FRAMING_JSON_STREAM:
+    default:
+        retval = ipc_framer_next_json(framer, message, length);
+        break;
+    }
+    return retval;
+}
+
+size_t ipc_framer_header(ipc_framing_e mode, size_t length, uint8_t header[IPC_FRAMER_MAX_HEADER])
+{
+    if (IPC_FRAMING_LENGTH_PREFIX != mode)
+    {
+        return 0;
+    }
+
+    header[0] = (uint8_t)(length >> 24);
+    header[1] = (uint8_t)(length >> 16);
+    header[2] = (uint8_t)(length >> 8);
+    header[3] = (uint8_t)length;
+    return IPC_FRAMER_MAX_HEADER;
+}
+
+const char *ipc_framer_trailer(ipc_framing_e mode, size_t *length)
+{
+    if (IPC_FRAMING_NEWLINE != mode)
+    {
+        *length = 0;
+        return NULL;
+    }
+
+    *length = 1;
+    return "\n";
+}
+
+const char *ipc_framing_to_string(ipc_framing_e mode)
+{
+    switch (mode)
+    {
+    case IPC_FRAMING_JSON_STREAM:
+        return "json-stream";
+    case IPC_FRAMING_NEWLINE:
+        return "newline";
+    case IPC_FRAMING_LENGTH_PREFIX:
+        return "length-prefix";
+    default:
+        return "unknown";
+    }
+}
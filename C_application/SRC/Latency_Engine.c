@@ -0,0 +1,398 @@
+#include "Latency_Engine.h"
+#include "logger.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define NS_PER_SEC 1000000000ULL
+
+/* Measurement state of one instance, shared by the publishing scheduler (fault side),
+   the GOOSE receiver (trip side) and the state machine (statistics) */
+typedef struct
+{
+    pthread_mutex_t lock;
+
+    /* Pending fault injection */
+    bool armed;                // fault frame sent, waiting for the GOOSE state change
+    bool tripped;              // state change received, waiting for the transmit timestamp
+    bool tx_timestamp_pending; // kernel transmit timestamp requested but not handed over yet
+    uint64_t tx_ns;
+    uint64_t tx_timestamp_ns;
+    uint64_t rx_ns;
+    uint64_t rx_timestamp_ns;
+
+    /* Last stNum received for the control block */
+    bool st_num_valid;
+    uint32_t st_num;
+
+    /* Statistics */
+    uint64_t injections;
+    uint64_t samples;
+    uint64_t missed;
+    uint64_t spurious;
+    uint64_t kernel_timestamped;
+    uint32_t last_smp_cnt;
+    uint64_t last_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t sum_ns;
+    uint64_t *histogram;
+} LatencyInstance;
+
+static LatencyInstance *instances = NULL;
+static int latency_instance_count = 0;
+
+unsigned int Latency_histogram_index(uint64_t value_ns)
+{
+    if (value_ns >= (1ULL << LATENCY_HISTOGRAM_MAX_BITS))
+    {
+        value_ns = (1ULL << LATENCY_HISTOGRAM_MAX_BITS) - 1;
+    }
+    if (value_ns < LATENCY_HISTOGRAM_SUB_COUNT)
+    {
+        return (unsigned int)value_ns;
+    }
+
+    unsigned int msb = 63U - (unsigned int)__builtin_clzll(value_ns);
+    unsigned int shift = msb - (LATENCY_HISTOGRAM_SUB_BITS - 1);
+    unsigned int sub = (unsigned int)(value_ns >> shift); // in [HALF_COUNT, SUB_COUNT)
+
+    return LATENCY_HISTOGRAM_SUB_COUNT + (shift - 1) * LATENCY_HISTOGRAM_HALF_COUNT + (sub - LATENCY_HISTOGRAM_HALF_COUNT);
+}
+
+uint64_t Latency_histogram_bucket_value(unsigned int index)
+{
+    if (index < LATENCY_HISTOGRAM_SUB_COUNT)
+    {
+        return index;
+    }
+
+    unsigned int offset = index - LATENCY_HISTOGRAM_SUB_COUNT;
+    unsigned int shift = offset / LATENCY_HISTOGRAM_HALF_COUNT + 1;
+    uint64_t sub = LATENCY_HISTOGRAM_HALF_COUNT + offset % LATENCY_HISTOGRAM_HALF_COUNT;
+
+    return ((sub + 1) << shift) - 1;
+}
+
+uint64_t Latency_histogram_quantile(const uint64_t *histogram, unsigned int bucket_count, uint64_t samples,
+                                    uint64_t min_ns, uint64_t max_ns, uint64_t numerator, uint64_t denominator)
+{
+    uint64_t rank = (samples * numerator + denominator - 1) / denominator;
+    uint64_t seen = 0;
+
+    if (0 == rank)
+    {
+        rank = 1;
+    }
+    for (unsigned int index = 0; index < bucket_count; index++)
+    {
+        seen += histogram[index];
+        if (seen >= rank)
+        {
+            uint64_t value = Latency_histogram_bucket_value(index);
+            if (value > max_ns)
+            {
+                value = max_ns;
+            }
+            if (value < min_ns)
+            {
+                value = min_ns;
+            }
+            return value;
+        }
+    }
+    return max_ns;
+}
+
+static void latency_clear_stats(LatencyInstance *inst)
+{
+    if (inst->samples > 0)
+    {
+        // Only the buckets up to the maximum were used: keeps the time the lock is held short
+        memset(inst->histogram, 0, (Latency_histogram_index(inst->max_ns) + 1) * sizeof(uint64_t));
+    }
+    inst->injections = 0;
+    inst->samples = 0;
+    inst->missed = 0;
+    inst->spurious = 0;
+    inst->kernel_timestamped = 0;
+    inst->last_ns = 0;
+    inst->min_ns = UINT64_MAX;
+    inst->max_ns = 0;
+    inst->sum_ns = 0;
+}
+
+/* Both ends of the pending fault are known: record the sample. Called with the lock held. */
+static void latency_complete(LatencyInstance *inst)
+{
+    uint64_t latency_ns;
+
+    // Kernel timestamps are only compared with each other, the fallback uses the monotonic clock on both ends
+    if (0 != inst->tx_timestamp_ns && 0 != inst->rx_timestamp_ns && inst->rx_timestamp_ns >= inst->tx_timestamp_ns)
+    {
+        latency_ns = inst->rx_timestamp_ns - inst->tx_timestamp_ns;
+        inst->kernel_timestamped++;
+    }
+    else
+    {
+        latency_ns = (inst->rx_ns > inst->tx_ns) ? inst->rx_ns - inst->tx_ns : 0;
+    }
+
+    inst->samples++;
+    inst->last_ns = latency_ns;
+    inst->sum_ns += latency_ns;
+    if (latency_ns < inst->min_ns)
+    {
+        inst->min_ns = latency_ns;
+    }
+    if (latency_ns > inst->max_ns)
+    {
+        inst->max_ns = latency_ns;
+    }
+    inst->histogram[Latency_histogram_index(latency_ns)]++;
+
+    inst->armed = false;
+    inst->tripped = false;
+    inst->tx_timestamp_pending = false;
+}
+
+static LatencyInstance *latency_instance(int instance)
+{
+    if (NULL == instances || instance < 0 || instance >= latency_instance_count)
+    {
+        return NULL;
+    }
+    return &instances[instance];
+}
+
+int Latency_init(int instance_count)
+{
+    Latency_cleanup();
+
+    if (instance_count <= 0)
+    {
+        LOG_ERROR("Latency_Engine", "Invalid instance count %d", instance_count);
+        return FAIL;
+    }
+
+    instances = (LatencyInstance *)calloc(instance_count, sizeof(LatencyInstance));
+    if (!instances)
+    {
+        LOG_ERROR("Latency_Engine", "Memory allocation failed for %d instances", instance_count);
+        return FAIL;
+    }
+
+    for (int i = 0; i < instance_count; i++)
+    {
+        instances[i].histogram = (uint64_t *)calloc(LATENCY_HISTOGRAM_BUCKETS, sizeof(uint64_t));
+        if (!instances[i].histogram)
+        {
+            LOG_ERROR("Latency_Engine", "Memory allocation failed for the histogram of instance %d", i);
+            latency_instance_count = i;
+            Latency_cleanup();
+            return FAIL;
+        }
+        pthread_mutex_init(&instances[i].lock, NULL);
+        latency_clear_stats(&instances[i]);
+        latency_instance_count = i + 1;
+    }
+
+    LOG_INFO("Latency_Engine", "Measuring trip latency of %d instances", instance_count);
+    return SUCCESS;
+}
+
+void Latency_cleanup(void)
+{
+    if (instances)
+    {
+        for (int i = 0; i < latency_instance_count; i++)
+        {
+            pthread_mutex_destroy(&instances[i].lock);
+            free(instances[i].histogram);
+        }
+        free(instances);
+        instances = NULL;
+    }
+    latency_instance_count = 0;
+}
+
+int Latency_get_instance_count(void)
+{
+    return latency_instance_count;
+}
+
+uint64_t Latency_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+void Latency_fault_started(int instance, uint32_t smp_cnt, uint64_t tx_ns, bool tx_timestamp_pending)
+{
+    LatencyInstance *inst = latency_instance(instance);
+    if (!inst)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&inst->lock);
+    if (inst->armed)
+    {
+        if (inst->tripped)
+        {
+            // The transmit timestamp of the previous fault never came: measure it with the fallback clock
+            inst->tx_timestamp_ns = 0;
+            latency_complete(inst);
+        }
+        else
+        {
+            inst->missed++;
+        }
+    }
+
+    inst->armed = true;
+    inst->tripped = false;
+    inst->tx_timestamp_pending = tx_timestamp_pending;
+    inst->tx_ns = tx_ns;
+    inst->tx_timestamp_ns = 0;
+    inst->rx_ns = 0;
+    inst->rx_timestamp_ns = 0;
+    inst->injections++;
+    inst->last_smp_cnt = smp_cnt;
+    pthread_mutex_unlock(&inst->lock);
+}
+
+void Latency_tx_timestamp(int instance, uint64_t tx_timestamp_ns)
+{
+    LatencyInstance *inst = latency_instance(instance);
+    if (!inst)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&inst->lock);
+    if (inst->armed && inst->tx_timestamp_pending)
+    {
+        inst->tx_timestamp_ns = tx_timestamp_ns;
+        inst->tx_timestamp_pending = false;
+        if (inst->tripped)
+        {
+            latency_complete(inst);
+        }
+    }
+    pthread_mutex_unlock(&inst->lock);
+}
+
+void Latency_fault_cleared(int instance)
+{
+    LatencyInstance *inst = latency_instance(instance);
+    if (!inst)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&inst->lock);
+    if (inst->armed && !inst->tripped)
+    {
+        inst->missed++;
+        inst->armed = false;
+        inst->tx_timestamp_pending = false;
+    }
+    pthread_mutex_unlock(&inst->lock);
+}
+
+void Latency_goose_received(int instance, uint32_t st_num, uint64_t rx_timestamp_ns, uint64_t rx_ns)
+{
+    LatencyInstance *inst = latency_instance(instance);
+    if (!inst)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&inst->lock);
+    if (!inst->st_num_valid)
+    {
+        // First message of the control block: nothing to compare with yet
+        inst->st_num_valid = true;
+        inst->st_num = st_num;
+    }
+    else if (st_num != inst->st_num)
+    {
+        inst->st_num = st_num;
+        if (inst->armed && !inst->tripped)
+        {
+            inst->tripped = true;
+            inst->rx_ns = rx_ns;
+            inst->rx_timestamp_ns = rx_timestamp_ns;
+            if (!inst->tx_timestamp_pending)
+            {
+                latency_complete(inst);
+            }
+        }
+        else
+        {
+            inst->spurious++;
+        }
+    }
+    pthread_mutex_unlock(&inst->lock);
+}
+
+int Latency_get_stats(int instance, LatencyStats *stats)
+{
+    LatencyInstance *inst = latency_instance(instance);
+    unsigned int bucket_count = 0;
+    if (!inst || !stats)
+    {
+        return FAIL;
+    }
+
+    // The lock is shared with the transmit job (Latency_fault_started): the buckets are copied under it,
+    // the quantiles are computed once it is released
+    uint64_t *histogram = (uint64_t *)malloc(LATENCY_HISTOGRAM_BUCKETS * sizeof(uint64_t));
+    if (!histogram)
+    {
+        LOG_ERROR("Latency_Engine", "Memory allocation failed for the statistics of instance %d", instance);
+        return FAIL;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_lock(&inst->lock);
+    stats->injections = inst->injections;
+    stats->samples = inst->samples;
+    stats->missed = inst->missed;
+    stats->spurious = inst->spurious;
+    stats->kernel_timestamped = inst->kernel_timestamped;
+    stats->last_smp_cnt = inst->last_smp_cnt;
+    if (inst->samples > 0)
+    {
+        stats->last_ns = inst->last_ns;
+        stats->min_ns = inst->min_ns;
+        stats->max_ns = inst->max_ns;
+        stats->mean_ns = inst->sum_ns / inst->samples;
+        bucket_count = Latency_histogram_index(inst->max_ns) + 1; // the buckets above the maximum are empty
+        memcpy(histogram, inst->histogram, bucket_count * sizeof(uint64_t));
+    }
+    pthread_mutex_unlock(&inst->lock);
+
+    if (stats->samples > 0)
+    {
+        stats->p50_ns = Latency_histogram_quantile(histogram, bucket_count, stats->samples, stats->min_ns, stats->max_ns, 500, 1000);
+        stats->p99_ns = Latency_histogram_quantile(histogram, bucket_count, stats->samples, stats->min_ns, stats->max_ns, 990, 1000);
+        stats->p999_ns = Latency_histogram_quantile(histogram, bucket_count, stats->samples, stats->min_ns, stats->max_ns, 999, 1000);
+    }
+    free(histogram);
+    return SUCCESS;
+}
+
+void Latency_reset(void)
+{
+    for (int i = 0; i < latency_instance_count; i++)
+    {
+        pthread_mutex_lock(&instances[i].lock);
+        latency_clear_stats(&instances[i]);
+        pthread_mutex_unlock(&instances[i].lock);
+    }
+}
@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include "util.h"
 #include "logger.h"
+#include "Latency_Engine.h"
+#include "Goose_LoadGen.h"
+#include "SV_Publisher.h"
+#include "Scenario.h"
 
 int ModuleManager_init(shutdown_check_callback_t shutdown_check)
 {
@@ -61,6 +65,12 @@ int ModuleManager_shutdown(void)
         LOG_ERROR("ModuleManager", "Failed to shut down StateMachineModule");
         return FAIL;
     }
+    // A simulation still running at Ctrl+C is stopped here, never from the signal handler
+    SVPublisher_stop();
+    // Kept after the simulation stops so the results can still be queried
+    Latency_cleanup();
+    Goose_LoadGen_stop();
+    Scenario_cache_clear();
 
     LOG_INFO("ModuleManager", "All modules shut down successfully");
     return SUCCESS;
@@ -1,148 +1,229 @@
 #include "Ring_Buffer.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h> // Add this for strdup()
-#include <pthread.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include "util.h"
 #include "logger.h"
 #include <cjson/cJSON.h>
-int event_queue_init(EventQueue *event_queue)
+
+static void event_queue_wakeup(EventQueue *event_queue)
 {
-    int retval = SUCCESS;
-    if (pthread_mutex_init(&event_queue->mutex, NULL) != EXIT_SUCCESS)
-    {
-        LOG_ERROR("RingBuffer", "pthread_mutex_init() error");
-        retval = FAIL;
-    }
-    else
-    {
-        if (pthread_cond_init(&event_queue->cond, NULL) != EXIT_SUCCESS)
-        {
-            LOG_ERROR("RingBuffer", "pthread_cond_init() error");
-            retval = FAIL;
-        }
-        else
-        {
-            event_queue->head = 0;
-            event_queue->tail = 0;
-            event_queue->shutdown = 0; // Initialize shutdown flag to false
-            memset(event_queue->events, 0, sizeof(event_queue->events));
-            memset(event_queue->requestIds, 0, sizeof(event_queue->requestIds));
-        }
-    }
-    return retval;
+    uint64_t one = 1;
+    // Only fails when the counter would overflow, the consumer is awake anyway in that case
+    ssize_t ret = write(event_queue->wakeup_fd, &one, sizeof(one));
+    (void)ret;
 }
 
-// Push event to queue
-int event_queue_push(state_event_e event, const char *requestId, EventQueue *event_queue, cJSON *data_obj)
+int event_queue_init(EventQueue *event_queue, size_t capacity)
 {
-    int retval = SUCCESS;
-    pthread_mutex_lock(&event_queue->mutex);
+    size_t size = 2;
 
-    if ((event_queue->tail + 1) % QUEUE_SIZE == event_queue->head)
+    while (size < capacity)
     {
-        LOG_ERROR("RingBuffer", "Event queue full, dropping event");
-        retval = FAIL;
-        goto unlock;
+        size <<= 1;
     }
 
-    // Store event
-    event_queue->events[event_queue->tail] = event;
+    event_queue->slots = (EventQueueSlot *)calloc(size, sizeof(EventQueueSlot));
+    if (!event_queue->slots)
+    {
+        LOG_ERROR("RingBuffer", "Memory allocation failed for %zu event slots", size);
+        return FAIL;
+    }
 
-    // Handle requestId
-    if (requestId)
+    event_queue->wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (event_queue->wakeup_fd < 0)
     {
-        event_queue->requestIds[event_queue->tail] = strdup(requestId);
-        if (!event_queue->requestIds[event_queue->tail])
-        {
-            LOG_ERROR("RingBuffer", "strdup failed for requestId");
-            retval = FAIL;
-            goto unlock;
-        }
+        LOG_ERROR("RingBuffer", "eventfd() error: %s", strerror(errno));
+        free(event_queue->slots);
+        event_queue->slots = NULL;
+        return FAIL;
     }
-    else
+
+    for (size_t i = 0; i < size; i++)
     {
-        event_queue->requestIds[event_queue->tail] = NULL;
+        atomic_init(&event_queue->slots[i].sequence, i);
     }
+    event_queue->capacity = size;
+    event_queue->mask = size - 1;
+    atomic_init(&event_queue->tail, 0);
+    atomic_init(&event_queue->head, 0);
+    atomic_init(&event_queue->dropped, 0);
+    atomic_init(&event_queue->high_water, 0);
+    atomic_init(&event_queue->shutdown, 0);
+    return SUCCESS;
+}
 
-    // Handle JSON data
-    if (data_obj)
+// Push event to queue (lock-free, no allocation, no logging: safe in signal handlers)
+int event_queue_push(state_event_e event, char *requestId, EventQueue *event_queue, cJSON *data_obj)
+{
+    EventQueueSlot *slot;
+    size_t pos;
+
+    if (atomic_load_explicit(&event_queue->shutdown, memory_order_relaxed))
+    {
+        return FAIL;
+    }
+
+    pos = atomic_load_explicit(&event_queue->tail, memory_order_relaxed);
+    for (;;)
     {
-        event_queue->data_objs[event_queue->tail] = cJSON_Duplicate(data_obj, 1);
-        if (!event_queue->data_objs[event_queue->tail])
+        slot = &event_queue->slots[pos & event_queue->mask];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0)
         {
-            LOG_ERROR("RingBuffer", "Failed to duplicate JSON data");
-            if (event_queue->requestIds[event_queue->tail])
+            // Slot is free: claim it
+            if (atomic_compare_exchange_weak_explicit(&event_queue->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
             {
-                free((char *)event_queue->requestIds[event_queue->tail]);
-                event_queue->requestIds[event_queue->tail] = NULL;
+                break;
             }
-            retval = FAIL;
-            goto unlock;
+        }
+        else if (diff < 0)
+        {
+            // The consumer has not released this slot yet: queue full
+            atomic_fetch_add_explicit(&event_queue->dropped, 1, memory_order_relaxed);
+            return FAIL;
+        }
+        else
+        {
+            // Another producer claimed it first
+            pos = atomic_load_explicit(&event_queue->tail, memory_order_relaxed);
         }
     }
-    else
+
+    slot->event = event;
+    slot->requestId = requestId;
+    slot->data_obj = data_obj;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+    // Track the deepest queue occupancy
+    size_t used = pos + 1 - atomic_load_explicit(&event_queue->head, memory_order_relaxed);
+    size_t high = atomic_load_explicit(&event_queue->high_water, memory_order_relaxed);
+    while (used > high &&
+           !atomic_compare_exchange_weak_explicit(&event_queue->high_water, &high, used,
+                                                  memory_order_relaxed, memory_order_relaxed))
     {
-        event_queue->data_objs[event_queue->tail] = NULL;
     }
-    LOG_DEBUG("RingBuffer", "Pushed event: %s, requestId: %s",
-              state_event_to_string(event), requestId ? requestId : "N/A");
-    event_queue->tail = (event_queue->tail + 1) % QUEUE_SIZE;
-    pthread_cond_signal(&event_queue->cond);
-
-unlock:
-    pthread_mutex_unlock(&event_queue->mutex);
-    return retval;
+
+    event_queue_wakeup(event_queue);
+    return SUCCESS;
 }
-// Pop event from queue
 
-int event_queue_pop(EventQueue *event_queue, state_event_e *event, const char **requestId_out, cJSON **data_obj_out)
+static bool event_queue_try_pop(EventQueue *event_queue, state_event_e *event, char **requestId, cJSON **data_obj)
 {
-    int retval = SUCCESS;
-    pthread_mutex_lock(&event_queue->mutex);
+    size_t pos = atomic_load_explicit(&event_queue->head, memory_order_relaxed);
+    EventQueueSlot *slot = &event_queue->slots[pos & event_queue->mask];
+    size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
 
-    while (event_queue->head == event_queue->tail && !event_queue->shutdown)
+    if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
     {
-        pthread_cond_wait(&event_queue->cond, &event_queue->mutex);
+        return false; // empty, or the producer has not finished writing this slot
     }
 
-    if (event_queue->shutdown && event_queue->head == event_queue->tail)
+    *event = slot->event;
+    *requestId = slot->requestId;
+    *data_obj = slot->data_obj;
+    slot->requestId = NULL;
+    slot->data_obj = NULL;
+
+    // Release the slot for the producers of the next round
+    atomic_store_explicit(&slot->sequence, pos + event_queue->capacity, memory_order_release);
+    atomic_store_explicit(&event_queue->head, pos + 1, memory_order_relaxed);
+    return true;
+}
+
+// Pop event from queue
+
+int event_queue_pop(EventQueue *event_queue, state_event_e *event, const char **requestId_out, cJSON **data_obj_out)
+{
+    char *requestId = NULL;
+    cJSON *data_obj = NULL;
+
+    while (!event_queue_try_pop(event_queue, event, &requestId, &data_obj))
     {
-        *event = STATE_EVENT_shutdown;
-        retval = FAIL;
-        goto unlock;
-    }
+        if (atomic_load_explicit(&event_queue->shutdown, memory_order_acquire))
+        {
+            *event = STATE_EVENT_shutdown;
+            return FAIL;
+        }
 
-    *event = event_queue->events[event_queue->head];
+        uint64_t count;
+        if (read(event_queue->wakeup_fd, &count, sizeof(count)) < 0 && errno != EINTR)
+        {
+            LOG_ERROR("RingBuffer", "eventfd read error: %s", strerror(errno));
+            *event = STATE_EVENT_shutdown;
+            return FAIL;
+        }
+    }
 
     // Transfer requestId
     if (requestId_out)
     {
-        *requestId_out = event_queue->requestIds[event_queue->head];
+        *requestId_out = requestId;
     }
-    else if (event_queue->requestIds[event_queue->head])
+    else if (requestId)
     {
-        free((char *)event_queue->requestIds[event_queue->head]);
+        free(requestId);
     }
-    event_queue->requestIds[event_queue->head] = NULL;
 
     // Transfer data_obj
     if (data_obj_out)
     {
-        *data_obj_out = event_queue->data_objs[event_queue->head];
+        *data_obj_out = data_obj;
     }
-    else if (event_queue->data_objs[event_queue->head])
+    else if (data_obj)
     {
-        cJSON_Delete(event_queue->data_objs[event_queue->head]);
+        cJSON_Delete(data_obj);
     }
-    event_queue->data_objs[event_queue->head] = NULL;
 
-    event_queue->head = (event_queue->head + 1) % QUEUE_SIZE;
     LOG_DEBUG("RingBuffer", "Popped event: %s, requestId: %s",
-              state_event_to_string(*event),
-              requestId_out && *requestId_out ? *requestId_out : "N/A");
+              state_event_to_string(*event), requestId ? requestId : "N/A");
+    return SUCCESS;
+}
+
+int event_queue_shutdown(EventQueue *event_queue)
+{
+    atomic_store_explicit(&event_queue->shutdown, 1, memory_order_release);
+    event_queue_wakeup(event_queue);
+    return SUCCESS;
+}
+
+void event_queue_destroy(EventQueue *event_queue)
+{
+    state_event_e event;
+    char *requestId;
+    cJSON *data_obj;
+
+    if (!event_queue->slots)
+    {
+        return;
+    }
+
+    while (event_queue_try_pop(event_queue, &event, &requestId, &data_obj))
+    {
+        free(requestId);
+        cJSON_Delete(data_obj);
+    }
+
+    close(event_queue->wakeup_fd);
+    event_queue->wakeup_fd = -1;
+    free(event_queue->slots);
+    event_queue->slots = NULL;
+}
+
+int event_queue_get_fd(EventQueue *event_queue)
+{
+    return event_queue->wakeup_fd;
+}
 
-unlock:
-    pthread_mutex_unlock(&event_queue->mutex);
-    return retval;
-}
\ No newline at end of file
+void event_queue_get_stats(EventQueue *event_queue, EventQueueStats *stats)
+{
+    stats->dropped = atomic_load_explicit(&event_queue->dropped, memory_order_relaxed);
+    stats->high_water = atomic_load_explicit(&event_queue->high_water, memory_order_relaxed);
+    stats->capacity = event_queue->capacity;
+}
@@ -0,0 +1,69 @@
+#include "SV_Dds.h"
+#include "ComCalSinCos.h"
+#include <math.h>
+
+/* 2^64 as a double: turns to phase */
+#define SV_DDS_TURN 18446744073709551616.0
+/* Degrees of one unit of the 24 upper bits of a phase: exact in a float */
+#define SV_DDS_DEGREES_PER_UNIT (360.0f / 16777216.0f)
+
+uint64_t SV_Dds_step(double frequency_hz, double sample_rate_hz)
+{
+    double turns = frequency_hz / sample_rate_hz;
+
+    if (!(turns > 0.0))
+    {
+        return 0;
+    }
+    if (turns >= 1.0)
+    {
+        turns -= floor(turns);
+    }
+    return (uint64_t)(turns * SV_DDS_TURN);
+}
+
+int64_t SV_Dds_step_delta(double rocof_hz_per_s, double sample_rate_hz)
+{
+    // The frequency changes by rocof / sample_rate Hz per sample
+    return (int64_t)llround(rocof_hz_per_s / (sample_rate_hz * sample_rate_hz) * SV_DDS_TURN);
+}
+
+uint64_t SV_Dds_angle(double degrees)
+{
+    double turns = degrees / 360.0;
+
+    turns -= floor(turns); // 0 <= turns < 1
+    if (turns >= 1.0)
+    {
+        return 0;
+    }
+    return (uint64_t)(turns * SV_DDS_TURN);
+}
+
+void SV_Dds_compute(const SVDdsChannel *const *channels, int channel_count, int sample_count, float *values)
+{
+    float angles[SV_DDS_BATCH_MAX];
+    const int count = channel_count * sample_count;
+
+    if (count <= 0 || count > SV_DDS_BATCH_MAX)
+    {
+        return;
+    }
+    for (int c = 0; c < channel_count; c++)
+    {
+        uint64_t phase = channels[c]->phase;
+        uint64_t step = channels[c]->step;
+
+        for (int n = 0; n < sample_count; n++)
+        {
+            angles[n * channel_count + c] = (float)(uint32_t)(phase >> 40) * SV_DDS_DEGREES_PER_UNIT;
+            phase += step;
+            step += (uint64_t)channels[c]->step_delta;
+        }
+    }
+    fComCalSinBatch(angles, values, (size_t)count);
+    for (int i = 0; i < count; i++)
+    {
+        values[i] *= channels[i % channel_count]->amplitude;
+    }
+}
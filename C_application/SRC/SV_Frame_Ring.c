@@ -0,0 +1,104 @@
+#include "SV_Frame_Ring.h"
+#include "logger.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+int SV_FrameRing_init(SVFrameRing *ring, uint32_t capacity)
+{
+    uint32_t size = 1;
+
+    if (ring == NULL || capacity == 0 || capacity > (1u << 16))
+    {
+        LOG_ERROR("SV_Frame_Ring", "Invalid ring capacity %u", capacity);
+        return FAIL;
+    }
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    ring->slots = (SVFrameSlot *)calloc(size, sizeof(SVFrameSlot));
+    if (!ring->slots)
+    {
+        LOG_ERROR("SV_Frame_Ring", "Memory allocation failed for %u slots", size);
+        return FAIL;
+    }
+    ring->capacity = size;
+    ring->mask = size - 1;
+    atomic_init(&ring->low_water, size);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    return SUCCESS;
+}
+
+void SV_FrameRing_destroy(SVFrameRing *ring)
+{
+    if (ring)
+    {
+        free(ring->slots);
+        ring->slots = NULL;
+        ring->capacity = 0;
+    }
+}
+
+SVFrameSlot *SV_FrameRing_reserve(SVFrameRing *ring)
+{
+    uint32_t tail = (uint32_t)atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = (uint32_t)atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if ((uint32_t)(tail - head) >= ring->capacity)
+    {
+        return NULL;
+    }
+    return &ring->slots[tail & ring->mask];
+}
+
+void SV_FrameRing_commit(SVFrameRing *ring)
+{
+    uint32_t tail = (uint32_t)atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->tail, (uint32_t)(tail + 1), memory_order_release);
+}
+
+SVFrameSlot *SV_FrameRing_peekAt(SVFrameRing *ring, uint32_t index)
+{
+    uint32_t head = (uint32_t)atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = (uint32_t)atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t occupancy = (uint32_t)(tail - head);
+
+    if (0 == index && occupancy < atomic_load_explicit(&ring->low_water, memory_order_relaxed))
+    {
+        atomic_store_explicit(&ring->low_water, occupancy, memory_order_relaxed);
+    }
+    if (index >= occupancy)
+    {
+        return NULL;
+    }
+    return &ring->slots[(head + index) & ring->mask];
+}
+
+SVFrameSlot *SV_FrameRing_peek(SVFrameRing *ring)
+{
+    return SV_FrameRing_peekAt(ring, 0);
+}
+
+void SV_FrameRing_release(SVFrameRing *ring)
+{
+    uint32_t head = (uint32_t)atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->head, (uint32_t)(head + 1), memory_order_release);
+}
+
+uint32_t SV_FrameRing_occupancy(SVFrameRing *ring)
+{
+    uint32_t head = (uint32_t)atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = (uint32_t)atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    return (uint32_t)(tail - head);
+}
+
+uint32_t SV_FrameRing_low_water(SVFrameRing *ring)
+{
+    return atomic_load_explicit(&ring->low_water, memory_order_relaxed);
+}
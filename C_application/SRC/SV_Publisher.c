@@ -23,28 +23,23 @@
 #include <sys/mman.h>
 #include <sys/time.h>
 #include "parser.h"
+#include "ipc.h"
 #include <unistd.h> // For sleep()
 #include "util.h"
+#include "SV_Scheduler.h"
+#include "Latency_Engine.h"
+#include "SV_Frame_Ring.h"
+#include "Scenario.h"
+#include "SV_Dds.h"
+#include <stdatomic.h>
 // Internal state for the SV Publisher module
 
 // CommParameters parameters = {0, 0, 0x5000, {0x01, 0x0C, 0xCD, 0x01, 0x00, 0x01}};
 
 #define COM_VDPA_NB_ECH_PAR_SV 2
-#define FREQ_EN_HZ (f32)50.
-#define PI (f32)3.1415926536
-#define MAX_PHASES 150
 /* 2400 for 2 samples and 4800 for 1 sample*/
 #define SAMPLES_PER_SECOND 2400
 
-/* Sampling time defined as 208 microseconds */
-#define SAMPLING_TIME_208US (float)0.000208f
-#define DELAY_416US (float)(SAMPLING_TIME_208US * 2.f)
-#define DELAY_208US 208.0f
-#define LOOPS_PER_CYCLE (uint32_t)((1.0f / SIGNAL_FREQUENCY) / SAMPLING_TIME_208US)
-
-/* Signal frequency (for example 50 Hz) */
-#define SIGNAL_FREQUENCY (float)50.0f
-
 /* Constants for RMS values */
 #define OMT_VEFF_RMS_VOLTAGE (float)8.0f
 #define OMT_VEFF_RMS_CURRENT (float)0.0f
@@ -55,10 +50,30 @@
 #define CONSTANT_I4 7.0f
 #define CONSTANT_I5 8.0f
 #define COM_VDPA_PERIODE_SV_EN_NS 416667 // 2*208.33 us (Freq 4800Hz -> 1 ech toute les 208.33 us)
-#define COM_VDPA_CADENCE_ECH_EN_US (f32)(COM_VDPA_PERIODE_SV_EN_NS / COM_VDPA_NB_ECH_PAR_SV / 1000.)
 
-typedef float f32;
-typedef f32 float32_t; // Pour compatibilite ancienne version
+/* Publishing scheduler: one SCHED_FIFO thread serves every instance */
+#define SV_SCHEDULER_THREADS 1
+#define SV_SCHEDULER_PRIORITY 80
+#define SV_PUBLISH_PERIOD_NS (uint64_t)COM_VDPA_PERIODE_SV_EN_NS
+#define SV_PUBLISH_OFFSET_NS (uint64_t)0
+
+/* Exact sample rate of the stream (4799.996 Hz), the waveform generator runs at it */
+#define SV_SAMPLE_RATE_HZ ((double)COM_VDPA_NB_ECH_PAR_SV * 1e9 / (double)SV_PUBLISH_PERIOD_NS)
+
+/* Frame pipeline: a generator thread keeps SV_PIPELINE_RING_FRAMES ready-to-send frames per instance
+   (32 frames = 6.7 ms of stream), refilled every SV_PIPELINE_REFILL_NS */
+#ifndef SV_PIPELINE_RING_FRAMES
+#define SV_PIPELINE_RING_FRAMES 32
+#endif
+#ifndef SV_PIPELINE_REFILL_NS
+#define SV_PIPELINE_REFILL_NS 1000000L
+#endif
+
+/* Launch time mode (txTimeLeadUs): clock of the ETF qdisc */
+#define SV_LAUNCH_CLOCK CLOCK_TAI
+
+/* Number of publishing periods the kernel transmit timestamp of a fault frame is polled for */
+#define SV_TX_TIMESTAMP_MAX_POLLS 8
 
 enum
 {
@@ -81,48 +96,71 @@ enum
     COM_VDPA_NB_DATA_PAR_ECH
 };
 
-typedef struct
+/* Channels of an ASDU, in dataset order (COM_VDPA_ECH_DATA_IND_xx / 2) */
+enum
 {
-    float channel1_voltage[3];
-    float channel1_current[3];
-    int duration_ms;
-} PhaseSettings;
-
-/* GOOSE Subscriber Code Integration */
-
-/* Track old stNum to detect changes */
-
-static uint32_t oldStNum = 0;
-/* Variables for latency measurement */
-
-static bool isMeasuring = false;
-static bool latencyMeasured = false;
-static uint32_t sampleCount = 0;
-static int current_phase = 0;
-static uint64_t phase_start_tick = 0;
-static uint64_t phase_duration_ticks = 0;
-static uint8_t end_test = 0;
-static uint64_t faultStartTimeNs = 0;
+    SV_WAVE_I1,
+    SV_WAVE_I2,
+    SV_WAVE_I3,
+    SV_WAVE_I4,
+    SV_WAVE_V1,
+    SV_WAVE_V2,
+    SV_WAVE_V3,
+    SV_WAVE_V4,
+    SV_WAVE_NB_CHANNELS
+};
 
-static f32 angleCrs = (f32)0.;
-static f32 pasCrs = FREQ_EN_HZ * (f32)360. * COM_VDPA_CADENCE_ECH_EN_US / (f32)1000000.;
+/* Waveform samples computed per batch (6 channels each, at most SV_DDS_BATCH_MAX values) */
+#define SV_WAVE_AHEAD_SAMPLES 8
 
-PhaseSettings phases[MAX_PHASES];
-int phase_count = 0;
+/* Per-instance simulation state (phase clock, sample counters, scenario, ASDU indexes).
+   Aligned on a cache line so instances served by different scheduler threads never share one. */
+typedef struct __attribute__((aligned(64)))
+{
+    /* Hot fields, touched for every sample */
+    uint64_t tick_208_us;
+    uint64_t next_boundary_tick; // sample number the next phase (or play) starts at
+    int current_phase;
+    int phase_count;
+    uint32_t sampleCount;
+    uint8_t end_test;
+    int next_sample;    // ASDU of the next generated frame (0 .. COM_VDPA_NB_ECH_PAR_SV - 1)
+
+    /* Scenario repetition: plays of the phase list, 0 repeats until the simulation is stopped */
+    int repeat_count;
+    int play;
+
+    /* Phase boundaries: the sample number of a boundary is computed from its time in the compiled scenario,
+       relative to the sample the scenario started at and to the start of the current play */
+    uint64_t scenario_origin_tick;
+    uint64_t play_origin_ms;
+    bool transition_pending; // the next generated frame is the first of current_phase
+
+    /* Latency measurement: fault state of the last generated frame */
+    bool fault_active;
+
+    int tbIndData[COM_VDPA_NB_ECH_PAR_SV][COM_VDPA_NB_DATA_PAR_ECH];
+
+    /* Waveform generators of V1..V3 and I1..I3: phase accumulators running across phases and plays */
+    SVDdsChannel voltage_dds[3];
+    SVDdsChannel current_dds[3];
+
+    /* V1..V3, I1..I3 of the next samples, computed in one batch. Emptied when a phase is entered: the
+       accumulators then change other than by their own stepping */
+    float wave_ahead[SV_WAVE_AHEAD_SAMPLES][6];
+    int wave_ahead_next;
+    int wave_ahead_count;
+
+    /* Compiled scenario, read-only and shared with the instances playing the same file */
+    const Scenario *scenario;
+} SV_InstanceState;
 
-uint64_t tick_208_us = 0;
 volatile sig_atomic_t running = 1;
 extern volatile bool internal_shutdown_flag;
-/* Number of loops incremented for each sample sent (tracking time in 256us steps) */
-static uint32_t sNbLoop208us = 0;
-/* Variables for voltages and currents */
-static int channel1_voltage1, channel1_voltage2, channel1_voltage3;
-static int channel1_current1, channel1_current2, channel1_current3;
-
-static int tbIndData[COM_VDPA_NB_ECH_PAR_SV][COM_VDPA_NB_DATA_PAR_ECH];
 
 typedef struct
 {
+    SV_InstanceState state; // must stay first: keeps the hot state at the start of the cache-aligned instance
     uint16_t GOOSEappId; // app id svpub
     char *svInterface;
     const char *scenarioConfigFile;
@@ -132,506 +170,757 @@ typedef struct
     SVPublisher_ASDU asdu1;
     SVPublisher_ASDU asdu2;
     SVPublisher_ASDU asdu;
-    GooseReceiver gooseReceiver;
-    GooseSubscriber gooseSubscriber;
-    timer_t timerid;
+    int instance;       // index of the instance in the latency engine
+    bool tx_timestamps; // kernel transmit timestamps available on the publisher socket
+    uint64_t period_ns; // publishing period of this instance
+    uint64_t offset_ns; // phase offset of the first frame relative to scheduler start
     char *goCbRef;
 
+    /* Frame pipeline: filled by the generator thread, drained by the scheduler job */
+    SVFrameRing ring;
+    int refr_tm_offset[COM_VDPA_NB_ECH_PAR_SV]; // refrTm of each ASDU in the frame template
+    atomic_uint_fast64_t generated_frames;
+    atomic_uint_fast64_t sent_frames;
+    atomic_uint_fast64_t late_frames; // frames not ready at their deadline
+
+    /* Transmit stage only: pending transmit timestamp of the last fault frame */
+    bool tx_timestamp_pending;
+    uint32_t tx_timestamp_polls;
+
+    /* Launch time mode: frames are handed to the kernel launch_lead_ns before their launch time,
+       launch time of frame n = launch_base_ns + n * period_ns / COM_VDPA_NB_ECH_PAR_SV (SV_LAUNCH_CLOCK) */
+    uint64_t launch_lead_ns; // 0: frames are sent at their deadline
+    bool launch_base_set;
+    uint64_t launch_base_ns;
+    int64_t launch_to_monotonic_ns; // SV_LAUNCH_CLOCK - CLOCK_MONOTONIC
+    int64_t launch_to_realtime_ns;  // SV_LAUNCH_CLOCK - CLOCK_REALTIME
+    atomic_uint_fast64_t launch_errors;
+
+    /* Scenario hot swap: published by SVPublisher_swap_scenario(), taken by the generator */
+    _Atomic(const Scenario *) pending_scenario;
+    atomic_uint_fast64_t scenario_swaps;
+
+    /* Phase transitions sent, written by the transmit stage only. Seqlock: transition_seq is odd while an
+       entry is written, readers copy the log again if it was odd or changed during their copy */
+    SVPhaseTransition transitions[SV_TRANSITION_LOG_SIZE];
+    uint64_t transition_count;
+    atomic_uint_fast64_t transition_seq;
+
 } ThreadData;
 
+/* Instances sent together: same interface, period and offset, so their frames of a deadline leave in one batch */
+typedef struct
+{
+    ThreadData **instances;
+    int count;
+    SVPublisher_Batch batch; // on the socket of the first instance, holds the frames of one deadline
+} SVTransmitGroup;
+
 int instance_count = 0;
-static pthread_t *threads = NULL;
 static ThreadData *thread_data = NULL;
+static SVTransmitGroup *tx_groups = NULL;
+static int tx_group_count = 0;
+static pthread_t sv_generator_thread;
+static bool sv_generator_started = false;
 
-static float fOmtStpmSimuGetVal(float veff, float freq, float phi, uint16_t harmoniques);
+static void sv_generate_frames(ThreadData *data);
 // Forward declaration for the publishing thread function
 static void *sv_publishing_thread(void *arg);
 
+/* Signal context: only raises flags. The threads are joined and the instances released by
+   ModuleManager_shutdown() once the IPC loop has returned to main. */
 void sigint_handler(int sig)
 {
-    LOG_INFO("SV_Publisher", "Received Ctrl+C, shutting down...");
     running = false;
-    SVPublisher_stop();
-    StateMachine_push_event(STATE_EVENT_shutdown, NULL, NULL);
+    StateMachine_signal_event(STATE_EVENT_shutdown);
     internal_shutdown_flag = true; // Signal ipc_run_loop to exit
+    ipc_wakeup();
 }
-void timer_handler(int signum, siginfo_t *si, void *uc)
-
+/* Fetches the kernel transmit timestamp of the frame that started the fault phase, gives up after
+   SV_TX_TIMESTAMP_MAX_POLLS calls (the latency engine then falls back to the monotonic clock) */
+static void sv_latency_poll_tx_timestamp(ThreadData *data)
 {
-    ThreadData *current_data = (ThreadData *)si->si_value.sival_ptr;
-    if (current_data == NULL)
+    uint64_t tx_timestamp_ns;
+
+    if (SVPublisher_getTxTimestamp(data->svPublisher, &tx_timestamp_ns))
     {
-        printf("Timer handler: current_data is NULL\n");
-        return;
+        data->tx_timestamp_pending = false;
+        Latency_tx_timestamp(data->instance, tx_timestamp_ns);
     }
-    //   printf("Timer handler for appid  0x%04x\n", current_data->parameters.appId);
+    else if (++data->tx_timestamp_polls >= SV_TX_TIMESTAMP_MAX_POLLS)
+    {
+        data->tx_timestamp_pending = false;
+        Latency_tx_timestamp(data->instance, 0);
+    }
+}
 
-    static __thread int sample = 0;
-    bool faultCondition = false;
-    Quality q = QUALITY_VALIDITY_GOOD;
-    SVPublisher_ASDU asdu;
-    if (current_data && running)
+/* Publishes the first frame of a fault phase with a transmit timestamp request and arms the measurement */
+static void sv_latency_publish_fault(ThreadData *data, SVFrameSlot *slot)
+{
+    // Armed before sending so that a very fast trip cannot be taken for a spurious state change
+    Latency_fault_started(data->instance, slot->smp_cnt, Latency_now_ns(), data->tx_timestamps);
+    SVPublisher_publishFrameTimestamped(data->svPublisher, slot->frame, slot->size);
+
+    data->tx_timestamp_pending = data->tx_timestamps;
+    data->tx_timestamp_polls = 0;
+    if (data->tx_timestamp_pending)
     {
-        for (int sample = 0; sample < COM_VDPA_NB_ECH_PAR_SV; sample++)
-        {
-            if (0 == sample)
-            {
-                asdu = current_data->asdu1;
-            }
-            else
-            {
-                asdu = current_data->asdu2;
-            }
-#ifdef SINU_METHOD_ANA
-            /* Calculate instantaneous values and send samples */
-            channel1_voltage1 = (int)(100.f * fComStpmSimuGetVal(phases[current_phase].channel1_voltage[0], 0.0f));   // V1
-            channel1_voltage2 = (int)(100.f * fComStpmSimuGetVal(phases[current_phase].channel1_voltage[1], 240.0f)); // V2
-            channel1_voltage3 = (int)(100.f * fComStpmSimuGetVal(phases[current_phase].channel1_voltage[2], 120.0f)); // V3
-
-            channel1_current1 = (int)(1000.f * fComStpmSimuGetVal(phases[current_phase].channel1_current[0], 0.0f));   // I1
-            channel1_current2 = (int)(1000.f * fComStpmSimuGetVal(phases[current_phase].channel1_current[1], 240.0f)); // I2
-            channel1_current3 = (int)(1000.f * fComStpmSimuGetVal(phases[current_phase].channel1_current[2], 120.0f)); // I3
-#else
-            channel1_voltage1 = (int)(100.f * fOmtStpmSimuGetVal(phases[current_phase].channel1_voltage[0], FREQ_EN_HZ, 0.0f, 0));   // V1
-            channel1_voltage2 = (int)(100.f * fOmtStpmSimuGetVal(phases[current_phase].channel1_voltage[1], FREQ_EN_HZ, 240.0f, 0)); // V2
-            channel1_voltage3 = (int)(100.f * fOmtStpmSimuGetVal(phases[current_phase].channel1_voltage[2], FREQ_EN_HZ, 120.0f, 0)); // V3
-
-            channel1_current1 = (int)(1000.f * fOmtStpmSimuGetVal(phases[current_phase].channel1_current[0], FREQ_EN_HZ, 0.0f, 0));   // I1
-            channel1_current2 = (int)(1000.f * fOmtStpmSimuGetVal(phases[current_phase].channel1_current[1], FREQ_EN_HZ, 240.0f, 0)); // I2
-            channel1_current3 = (int)(1000.f * fOmtStpmSimuGetVal(phases[current_phase].channel1_current[2], FREQ_EN_HZ, 120.0f, 0)); // I3
-#endif
-            /*if(current_phase == 1)
-            {
-                printf("[%d] V1 %d V2 %d V3 %d \n\r",sNbLoop208us,channel1_voltage1,channel1_voltage2,channel1_voltage3);
-                printf("[%d] I1 %d I2 %d I3 %d \n\r",sNbLoop208us,channel1_current1,channel1_current2,channel1_current3);
-            }*/
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I1], channel1_current1);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I1Q], q);
+        sv_latency_poll_tx_timestamp(data);
+    }
+}
 
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I2], channel1_current2);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I2Q], q);
+/* Sample number of a time of the scenario: the sample rate of the stream is the rational
+   COM_VDPA_NB_ECH_PAR_SV / SV_PUBLISH_PERIOD_NS */
+static uint64_t sv_ms_to_samples(uint64_t ms)
+{
+    return Scenario_time_to_sample(ms, COM_VDPA_NB_ECH_PAR_SV, SV_PUBLISH_PERIOD_NS);
+}
 
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I3], channel1_current3);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I3Q], q);
+/* Angles of the V1..V3 and I1..I3 waveforms, V1 is the reference */
+static const double sv_dds_phi_deg[3] = {0.0, 240.0, 120.0};
 
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I4], channel1_current1 + channel1_current2 + channel1_current3);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_I4Q], q);
+/* Waveform of a phase: amplitudes, frequency ramp and phase jump. The frequency is set by the first
+   phase of a play and by the phases with frequency_hz, the others continue the current one. */
+static void sv_dds_enter_phase(SV_InstanceState *st, const ScenarioPhase *phase)
+{
+    const bool set_frequency = (0 == st->current_phase) || (phase->flags & SCENARIO_PHASE_FREQUENCY);
+    const uint64_t step = SV_Dds_step(phase->frequency_hz, SV_SAMPLE_RATE_HZ);
+    const int64_t step_delta = SV_Dds_step_delta(phase->rocof_hz_per_s, SV_SAMPLE_RATE_HZ);
+    const uint64_t jump = SV_Dds_angle(phase->phase_jump_deg);
 
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V1], channel1_voltage1);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V1Q], q);
+    for (int ph = 0; ph < 3; ph++)
+    {
+        SVDdsChannel *channels[2] = {&st->voltage_dds[ph], &st->current_dds[ph]};
 
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V2], channel1_voltage2);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V2Q], q);
+        st->voltage_dds[ph].amplitude = 100.0f * 1.41421356f * phase->voltage[st->scenario->channel][ph];
+        st->current_dds[ph].amplitude = 1000.0f * 1.41421356f * phase->current[st->scenario->channel][ph];
+        for (int c = 0; c < 2; c++)
+        {
+            if (set_frequency)
+            {
+                channels[c]->step = step;
+            }
+            channels[c]->step_delta = step_delta;
+            channels[c]->phase += jump;
+        }
+    }
+    st->wave_ahead_next = st->wave_ahead_count = 0;
+}
 
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V3], channel1_voltage3);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V3Q], q);
+/* Phases of the waveforms of a new stream: V1 starts at the inception angle of the first phase (0 without one) */
+static void sv_dds_start(SV_InstanceState *st)
+{
+    const ScenarioPhase *first = Scenario_phase(st->scenario, 0);
+    double origin_deg = 0.0;
 
-            SVPublisher_ASDU_setINT32(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V4], channel1_voltage1 + channel1_voltage2 + channel1_voltage3);
-            SVPublisher_ASDU_setQuality(asdu, tbIndData[sample][COM_VDPA_ECH_DATA_IND_V4Q], q);
+    if (first->flags & SCENARIO_PHASE_POINT_ON_WAVE)
+    {
+        origin_deg = (double)first->inception_angle_deg - (double)first->phase_jump_deg; // the jump is applied on entry
+    }
+    for (int ph = 0; ph < 3; ph++)
+    {
+        st->voltage_dds[ph].phase = SV_Dds_angle(origin_deg + sv_dds_phi_deg[ph]);
+        st->current_dds[ph].phase = st->voltage_dds[ph].phase;
+    }
+    st->wave_ahead_next = st->wave_ahead_count = 0;
+}
 
-            // printf("Channel 1 - Voltage1: %d, Voltage2: %d, Voltage3: %d\n", channel1_voltage1, channel1_voltage2, channel1_voltage3);
-            // printf("Channel 1 - Current1: %d, Current2: %d, Current3: %d\n", channel1_current1, channel1_current2, channel1_current3);
+/* Computes the waveforms of the next samples in one batch, up to the sample after which a phase can be
+   entered: the boundary sample, or every sample while a point-on-wave phase waits for its angle */
+static void sv_wave_compute_ahead(SV_InstanceState *st)
+{
+    const SVDdsChannel *channels[6] = {&st->voltage_dds[0], &st->voltage_dds[1], &st->voltage_dds[2],
+                                       &st->current_dds[0], &st->current_dds[1], &st->current_dds[2]};
+    int count = SV_WAVE_AHEAD_SAMPLES;
 
-#ifdef SINU_METHOD_ANA
-            angleCrs += pasCrs;
-            if (angleCrs > (f32)360.)
-            {
-                angleCrs -= (f32)360.;
-            }
-#endif
-            /* Latency measurement logic */
-            /* Detect when current > 1 and start measurement if not started yet */
-            faultCondition = (phases[current_phase].channel1_current[0] > 1.0f || phases[current_phase].channel1_current[1] > 1.0f || phases[current_phase].channel1_current[2] > 1.0f);
+    if (0 == st->end_test)
+    {
+        if (st->tick_208_us >= st->next_boundary_tick)
+        {
+            count = 1;
+        }
+        else if (st->next_boundary_tick - st->tick_208_us < (uint64_t)count)
+        {
+            count = (int)(st->next_boundary_tick - st->tick_208_us);
+        }
+    }
+    SV_Dds_compute(channels, 6, count, &st->wave_ahead[0][0]);
+    st->wave_ahead_next = 0;
+    st->wave_ahead_count = count;
+}
 
-            /* If the current returns to exactly 1.0, reset measuring state */
-            bool resetCondition =
-                (phases[current_phase].channel1_current[0] == 1.0f) &&
-                (phases[current_phase].channel1_current[1] == 1.0f) &&
-                (phases[current_phase].channel1_current[2] == 1.0f);
+/* Point on wave: true when the next sample, after the phase jump of the phase, is the first one at or after
+   its inception angle on V1 */
+static bool sv_dds_at_inception(const SV_InstanceState *st, const ScenarioPhase *phase)
+{
+    const SVDdsChannel *v1 = &st->voltage_dds[0];
+    const uint64_t past = v1->phase + SV_Dds_angle(phase->phase_jump_deg) - SV_Dds_angle(phase->inception_angle_deg);
 
-            if (resetCondition && isMeasuring)
-            {
-                isMeasuring = false;
-                latencyMeasured = false;
-            }
+    return past < v1->step;
+}
 
-            tick_208_us++;
-            if ((current_phase < phase_count) && (end_test == 0))
-            {
-                if ((tick_208_us - phase_start_tick) >= phase_duration_ticks)
-                {
-                    // printf("[time %u ms] Passing Phase from %d -> %d \n\r", phases[current_phase].duration_ms, current_phase, current_phase + 1);
-                    current_phase++;
-                    phase_start_tick = tick_208_us;
-                    phase_duration_ticks = phases[current_phase].duration_ms * 1000 / (unsigned int)DELAY_208US;
-                }
-
-                if (current_phase == phase_count)
-                {
-                    end_test = 1;
-                    current_phase = phase_count - 1;
-                }
-            }
+/* Boundary of the current phase: start of the next phase, or of the first phase of the next play */
+static void sv_phase_schedule_next(SV_InstanceState *st)
+{
+    uint64_t ms = st->play_origin_ms + st->scenario->duration_ms;
 
-            sNbLoop208us++;
+    if (st->current_phase + 1 < st->phase_count)
+    {
+        ms = st->play_origin_ms + Scenario_phase(st->scenario, st->current_phase + 1)->start_ms;
+    }
+    st->next_boundary_tick = st->scenario_origin_tick + sv_ms_to_samples(ms);
+}
 
-            if (sNbLoop208us >= LOOPS_PER_CYCLE)
-            {
-                sNbLoop208us -= LOOPS_PER_CYCLE;
-            }
-            SVPublisher_ASDU_setSmpCnt(asdu, sampleCount);
-            SVPublisher_ASDU_setRefrTmNs(asdu, Hal_getTimeInNs());
-            sampleCount = (sampleCount + 1) % SAMPLES_PER_SECOND;
+/* Plays the scenario from its first phase, starting with the next generated sample. The waveforms keep
+   their phase: a swapped scenario continues the signal without a discontinuity. */
+static void sv_scenario_begin(SV_InstanceState *st)
+{
+    st->phase_count = (int)st->scenario->phase_count;
+    st->repeat_count = st->scenario->repeat_count;
+    st->play = 0;
+    st->end_test = 0;
+    st->current_phase = 0;
+    st->scenario_origin_tick = st->tick_208_us;
+    st->play_origin_ms = 0;
+    st->transition_pending = true;
+    sv_dds_enter_phase(st, Scenario_phase(st->scenario, 0));
+    sv_phase_schedule_next(st);
+}
 
-            if (running)
-            {
-                SVPublisher_publish(current_data->svPublisher);
-                // printf("Published from appid 0x%04x\n", current_data->parameters.appId);
-            }
-        }
+/* Moves to the next phase at its boundary sample; after the last phase, to the next play or to the end.
+   A point-on-wave phase is entered at the first sample reaching its inception angle, within one period. */
+static void sv_phase_advance(SV_InstanceState *st)
+{
+    int next = st->current_phase + 1;
 
-        if (faultCondition && !isMeasuring)
+    if (next == st->phase_count)
+    {
+        if (0 != st->repeat_count && st->play + 1 >= st->repeat_count)
         {
-            isMeasuring = true;
-            latencyMeasured = false;
-            faultStartTimeNs = Hal_getTimeInNs();
-            // printf("Fault detected, start measuring latency...\n");
+            st->end_test = 1;
+            return;
         }
+        next = 0;
+    }
+
+    const ScenarioPhase *phase = Scenario_phase(st->scenario, next);
+    if ((phase->flags & SCENARIO_PHASE_POINT_ON_WAVE) && !sv_dds_at_inception(st, phase))
+    {
+        return;
+    }
+    if (0 == next)
+    {
+        // Play the scenario again: every play injects its fault phases again
+        st->play++;
+        st->play_origin_ms += st->scenario->duration_ms;
     }
+    st->current_phase = next;
+    st->transition_pending = true;
+    sv_dds_enter_phase(st, phase);
+    sv_phase_schedule_next(st);
 }
 
-static f32 fComStpmSimuGetVal(f32 veff, f32 phi)
+/* Generator stage: switches to the scenario published by SVPublisher_swap_scenario(). The generator is
+   the only reader of the scenario of a running instance, so the old one can be released at once. */
+static void sv_apply_pending_scenario(ThreadData *data)
 {
-    f32 theta;
+    SV_InstanceState *st = &data->state;
+    const Scenario *scenario = atomic_exchange_explicit(&data->pending_scenario, NULL, memory_order_acquire);
 
-    theta = angleCrs + phi; // Angle en degre
-    if (theta > (f32)360.)
+    if (!scenario)
     {
-        theta -= (f32)360.;
+        return;
     }
-    theta = theta * 2. * PI / (f32)360.; // Angle en radians
-    return (veff * 1.41421356 * sin(theta));
+    Scenario_release(st->scenario);
+    st->scenario = scenario;
+    sv_scenario_begin(st);
+    atomic_fetch_add_explicit(&data->scenario_swaps, 1, memory_order_relaxed);
 }
 
-/* Function to simulate the STPM values based on input */
-static float fOmtStpmSimuGetVal(float veff, float freq, float phi, uint16_t harmoniques)
+/* Generator stage: computes the samples of the next frame of an instance (waveform, ASDU encoding,
+   phase bookkeeping) into a free ring slot. Returns false when the ring is full. */
+static bool sv_generate_frame(ThreadData *data)
 {
-    float fsin;
-    float fcos;
-    float theta;
+    SV_InstanceState *st = &data->state;
+    SVFrameSlot *slot = SV_FrameRing_reserve(&data->ring);
 
-    if (0U == harmoniques)
+    static const Quality qualities[SV_WAVE_NB_CHANNELS] = {
+        QUALITY_VALIDITY_GOOD, QUALITY_VALIDITY_GOOD, QUALITY_VALIDITY_GOOD, QUALITY_VALIDITY_GOOD,
+        QUALITY_VALIDITY_GOOD, QUALITY_VALIDITY_GOOD, QUALITY_VALIDITY_GOOD, QUALITY_VALIDITY_GOOD};
+    SVPublisher_ASDU asdu;
+    if (!slot)
     {
-        theta = (freq / 1000000.0f) * (float)sNbLoop208us * DELAY_208US;
-        theta -= (uint32_t)theta;
-        theta *= 360.0f;
-        theta += phi;
-        if (theta > 360.0f)
-        {
-            theta -= 360.0f;
-        }
-        fComCalSinCos(theta, &fsin, &fcos);
+        return false;
+    }
+    // Frame boundary: a swapped scenario applies from this frame on
+    if (atomic_load_explicit(&data->pending_scenario, memory_order_relaxed))
+    {
+        sv_apply_pending_scenario(data);
+    }
+
+    const int sample = st->next_sample;
+    const ScenarioPhase *phase = Scenario_phase(st->scenario, st->current_phase); // phase of the samples of this frame
+    const bool fault = (phase->flags & SCENARIO_PHASE_FAULT) != 0;
+    const int transition_phase = st->transition_pending ? st->current_phase : -1;
+    const int play = st->play;
+    if (0 == sample)
+    {
+        asdu = data->asdu1;
     }
     else
     {
-        float fsinh;
-        fsin = 0.0f;
-        for (uint8_t ind_rang = 0U; ind_rang < 16; ind_rang++)
+        asdu = data->asdu2;
+    }
+    int32_t wave[SV_WAVE_NB_CHANNELS];
+
+    /* Sines computed ahead in batches, the phase accumulators carry frequency, ramps and jumps */
+    if (st->wave_ahead_next == st->wave_ahead_count)
+    {
+        sv_wave_compute_ahead(st);
+    }
+    const float *values = st->wave_ahead[st->wave_ahead_next++];
+    for (int ph = 0; ph < 3; ph++)
+    {
+        wave[SV_WAVE_V1 + ph] = (int32_t)values[ph];
+        wave[SV_WAVE_I1 + ph] = (int32_t)values[3 + ph];
+        SV_Dds_advance(&st->voltage_dds[ph]);
+        SV_Dds_advance(&st->current_dds[ph]);
+    }
+    wave[SV_WAVE_V4] = wave[SV_WAVE_V1] + wave[SV_WAVE_V2] + wave[SV_WAVE_V3];
+    wave[SV_WAVE_I4] = wave[SV_WAVE_I1] + wave[SV_WAVE_I2] + wave[SV_WAVE_I3];
+    /* The INT32/Quality pairs are contiguous in the dataset: patch them in one pass */
+    SVPublisher_ASDU_setINT32Array(asdu, st->tbIndData[sample][COM_VDPA_ECH_DATA_IND_I1], wave, qualities, SV_WAVE_NB_CHANNELS);
+
+    st->tick_208_us++;
+    st->transition_pending = false;
+    if ((0 == st->end_test) && (st->tick_208_us >= st->next_boundary_tick))
+    {
+        sv_phase_advance(st);
+    }
+    slot->smp_cnt = st->sampleCount;
+    slot->sample_number = st->tick_208_us - 1;
+    slot->transition_phase = transition_phase;
+    slot->transition_play = play;
+    SVPublisher_ASDU_setSmpCnt(asdu, st->sampleCount);
+    st->sampleCount = (st->sampleCount + 1) % SAMPLES_PER_SECOND;
+
+    slot->fault_started = fault && !st->fault_active;
+    slot->fault_cleared = !fault && st->fault_active;
+    st->fault_active = fault;
+
+    /* The frame buffer of the publisher is the generator's scratch frame: snapshot it into the slot,
+       refrTm is written by the transmit stage */
+    int frame_size = 0;
+    const uint8_t *frame = SVPublisher_getFrameBuffer(data->svPublisher, &frame_size);
+    memcpy(slot->frame, frame, frame_size);
+    slot->size = frame_size;
+    slot->refr_tm_offset = data->refr_tm_offset[sample];
+    SV_FrameRing_commit(&data->ring);
+
+    st->next_sample = (sample + 1) % COM_VDPA_NB_ECH_PAR_SV;
+    atomic_fetch_add_explicit(&data->generated_frames, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Generator stage: tops up the ring of an instance */
+static void sv_generate_frames(ThreadData *data)
+{
+    while (running && sv_generate_frame(data))
+    {
+    }
+}
+
+/* Generator thread: the scenario is deterministic, so frames are computed ahead of their deadline
+   outside of the real-time thread; a slow computation only lowers the ring occupancy */
+static void *sv_generator_loop(void *arg)
+{
+    const struct timespec refill = {0, SV_PIPELINE_REFILL_NS};
+    (void)arg;
+
+    while (running)
+    {
+        for (int i = 0; i < instance_count; i++)
         {
-            if (0U != ((1 << ind_rang) & harmoniques))
-            {
-                theta = ((freq * (ind_rang + 1)) / 1000000.0f) * (float)sNbLoop208us * DELAY_208US;
-                theta -= (uint32_t)theta;
-                theta *= 360.0f;
-                theta += phi;
-                if (theta > 360.0f)
-                {
-                    theta -= 360.0f;
-                }
-                fComCalSinCos(theta, &fsinh, &fcos);
-                fsin += fsinh;
-            }
+            sv_generate_frames(&thread_data[i]);
         }
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &refill, NULL);
     }
-    return (veff * 1.41421356f * fsin);
+    return NULL;
 }
 
-static void setupSVPublisher(ThreadData *data)
+static void sv_patch_refr_tm(SVFrameSlot *slot, uint64_t refr_tm_ns)
 {
+    if (slot->refr_tm_offset >= 0)
+    {
+        Timestamp *refrTm = (Timestamp *)(slot->frame + slot->refr_tm_offset);
 
-    data->asdu1 = SVPublisher_addASDU(data->svPublisher, data->svIDs, NULL, 1);
-    data->asdu2 = SVPublisher_addASDU(data->svPublisher, "svtesting", NULL, 1);
+        Timestamp_setTimeInNanoseconds(refrTm, refr_tm_ns);
+        Timestamp_setSubsecondPrecision(refrTm, 20);
+    }
+}
 
-    for (uint8_t no_ech = 0U; no_ech < COM_VDPA_NB_ECH_PAR_SV; no_ech++)
+/* Transmit stage: remembers the first frame of a phase with the refrTm it was sent with, never waits for
+   the readers of the log */
+static void sv_record_transition(ThreadData *data, const SVFrameSlot *slot, uint64_t refr_tm_ns)
+{
+    uint_fast64_t seq = atomic_load_explicit(&data->transition_seq, memory_order_relaxed);
+
+    atomic_store_explicit(&data->transition_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    SVPhaseTransition *transition = &data->transitions[data->transition_count % SV_TRANSITION_LOG_SIZE];
+    transition->phase = slot->transition_phase;
+    transition->play = slot->transition_play;
+    transition->smp_cnt = slot->smp_cnt;
+    transition->sample_number = slot->sample_number;
+    transition->timestamp_ns = refr_tm_ns;
+    data->transition_count++;
+    atomic_store_explicit(&data->transition_seq, seq + 2, memory_order_release);
+}
+
+static int64_t sv_clock_offset_ns(clockid_t clock, clockid_t reference)
+{
+    struct timespec a, b;
+
+    clock_gettime(clock, &a);
+    clock_gettime(reference, &b);
+    return ((int64_t)a.tv_sec - (int64_t)b.tv_sec) * 1000000000LL + ((int64_t)a.tv_nsec - (int64_t)b.tv_nsec);
+}
+
+/* Transmit stage in launch time mode: hands every frame due before deadline + lead to the kernel in one
+   batch, each with the launch time of its sample number; the ETF qdisc releases them on time */
+static void sv_publish_launch_time(ThreadData *data, uint64_t deadline_ns)
+{
+    uint8_t *frames[SV_PIPELINE_RING_FRAMES];
+    int sizes[SV_PIPELINE_RING_FRAMES];
+    uint64_t launch_times[SV_PIPELINE_RING_FRAMES];
+    int count = 0;
+
+    SVFrameSlot *slot = SV_FrameRing_peek(&data->ring);
+    if (!slot)
     {
-        if (0 == no_ech)
+        atomic_fetch_add_explicit(&data->late_frames, COM_VDPA_NB_ECH_PAR_SV, memory_order_relaxed);
+        return;
+    }
+    if (!data->launch_base_set)
+    {
+        // The first frame leaves lead after the first deadline, the stream keeps that offset
+        data->launch_to_monotonic_ns = sv_clock_offset_ns(SV_LAUNCH_CLOCK, CLOCK_MONOTONIC);
+        data->launch_to_realtime_ns = sv_clock_offset_ns(SV_LAUNCH_CLOCK, CLOCK_REALTIME);
+        data->launch_base_ns = deadline_ns + data->launch_to_monotonic_ns + data->launch_lead_ns -
+                               slot->sample_number * data->period_ns / COM_VDPA_NB_ECH_PAR_SV;
+        data->launch_base_set = true;
+    }
+
+    const uint64_t horizon_ns = deadline_ns + data->launch_to_monotonic_ns + data->launch_lead_ns;
+    while (count < SV_PIPELINE_RING_FRAMES && NULL != (slot = SV_FrameRing_peekAt(&data->ring, count)))
+    {
+        const uint64_t launch_ns = data->launch_base_ns + slot->sample_number * data->period_ns / COM_VDPA_NB_ECH_PAR_SV;
+        if (launch_ns > horizon_ns)
         {
-            data->asdu = data->asdu1;
+            break;
         }
-        else
+
+        // refrTm is the time the frame leaves, not the time it is queued
+        sv_patch_refr_tm(slot, launch_ns - data->launch_to_realtime_ns);
+        if (slot->transition_phase >= 0)
         {
-            data->asdu = data->asdu2;
+            sv_record_transition(data, slot, launch_ns - data->launch_to_realtime_ns);
         }
-
-        for (uint8_t no_data = 0U; no_data < COM_VDPA_NB_DATA_PAR_ECH; no_data++)
+        if (slot->fault_cleared)
         {
-            if ((no_data & 0x01) == 0)
-            {
-                tbIndData[no_ech][no_data] = SVPublisher_ASDU_addINT32(data->asdu);
-            }
-            else
-            {
-                tbIndData[no_ech][no_data] = SVPublisher_ASDU_addQuality(data->asdu);
-            }
+            Latency_fault_cleared(data->instance);
         }
-
-        SVPublisher_ASDU_setSmpCntWrap(data->asdu, SAMPLES_PER_SECOND);
-        SVPublisher_ASDU_setRefrTm(data->asdu, 0);
+        if (slot->fault_started)
+        {
+            Latency_fault_started(data->instance, slot->smp_cnt, launch_ns - data->launch_to_monotonic_ns, false);
+        }
+        frames[count] = slot->frame;
+        sizes[count] = slot->size;
+        launch_times[count] = launch_ns;
+        count++;
     }
-    SVPublisher_setupComplete(data->svPublisher);
 
-    // else
-    // {
-    //     printf("Failed to create SVPublisher for appid %u\n", data->parameters.appId);
-    // }
+    if (count > 0)
+    {
+        SVPublisher_publishFramesAt(data->svPublisher, frames, sizes, launch_times, count);
+        for (int i = 0; i < count; i++)
+        {
+            SV_FrameRing_release(&data->ring);
+        }
+        atomic_fetch_add_explicit(&data->sent_frames, count, memory_order_relaxed);
+    }
+    atomic_store_explicit(&data->launch_errors, SVPublisher_getLaunchTimeErrors(data->svPublisher), memory_order_relaxed);
 }
 
-int loadScenarioFile(const char *filename)
+/* Adds an instance to the transmit group of its interface, period and offset, creating the group if needed */
+static int sv_transmit_group_join(ThreadData *data)
 {
-    FILE *file = fopen(filename, "r");
-    if (!file)
+    SVTransmitGroup *group = NULL;
+
+    if (!tx_groups)
+    {
+        tx_groups = calloc(instance_count, sizeof(SVTransmitGroup));
+        if (!tx_groups)
+        {
+            return FAIL;
+        }
+    }
+    for (int g = 0; g < tx_group_count; g++)
+    {
+        ThreadData *first = tx_groups[g].instances[0];
+        if ((first->period_ns == data->period_ns) && (first->offset_ns == data->offset_ns) &&
+            ((first->svInterface == data->svInterface) ||
+             (first->svInterface && data->svInterface && (0 == strcmp(first->svInterface, data->svInterface)))))
+        {
+            group = &tx_groups[g];
+            break;
+        }
+    }
+    if (!group)
     {
-        perror("Could not open scenario file");
-        return -1;
+        group = &tx_groups[tx_group_count];
+        group->instances = calloc(instance_count, sizeof(ThreadData *));
+        if (!group->instances)
+        {
+            return FAIL;
+        }
+        tx_group_count++;
     }
+    group->instances[group->count++] = data;
+    return SUCCESS;
+}
 
-    for (int i = 0; i < MAX_PHASES; i++)
+/* Releases the transmit groups, the scheduler must be stopped */
+static void sv_transmit_groups_free(void)
+{
+    for (int g = 0; g < tx_group_count; g++)
     {
-        for (int j = 0; j < 3; j++)
+        if (tx_groups[g].batch)
         {
-            phases[i].channel1_voltage[j] = 0.0f;
-            phases[i].channel1_current[j] = 0.0f;
+            SVPublisher_Batch_destroy(tx_groups[g].batch);
         }
-        phases[i].duration_ms = 0;
+        free(tx_groups[g].instances);
+    }
+    free(tx_groups);
+    tx_groups = NULL;
+    tx_group_count = 0;
+}
+
+/* Scheduler job of an instance in launch time mode */
+static void sv_publish_launch_tick(void *context, uint64_t deadline_ns)
+{
+    if (running)
+    {
+        sv_publish_launch_time((ThreadData *)context, deadline_ns);
     }
+}
 
-    char line[256];
-    int current_phase = -1;
+/* Scheduler job (transmit stage): sends the pre-built frames due at this deadline for every instance of
+   the group in one batch (one sendmmsg call), only the refrTm timestamp is written at send time */
+static void sv_publish_group_tick(void *context, uint64_t deadline_ns)
+{
+    SVTransmitGroup *group = (SVTransmitGroup *)context;
 
-    while (fgets(line, sizeof(line), file) && current_phase < MAX_PHASES - 1)
+    (void)deadline_ns; // refrTm is the time a frame is actually sent, the job may run after its deadline
+    if (!running)
     {
-        if (strstr(line, "# Phase"))
+        return;
+    }
+    for (int i = 0; i < group->count; i++)
+    {
+        ThreadData *current_data = group->instances[i];
+
+        if (current_data->tx_timestamp_pending)
         {
-            current_phase++;
+            sv_latency_poll_tx_timestamp(current_data);
         }
-        else if (current_phase >= 0)
+        for (int sample = 0; sample < COM_VDPA_NB_ECH_PAR_SV; sample++)
         {
-            float value;
-            int duration;
-
-            if (sscanf(line, "duration_ms=%d", &duration) == 1)
+            SVFrameSlot *slot = SV_FrameRing_peek(&current_data->ring);
+            if (!slot)
             {
-                phases[current_phase].duration_ms = duration;
+                // The generator fell behind: the missing frames go out at the next deadlines
+                atomic_fetch_add_explicit(&current_data->late_frames, COM_VDPA_NB_ECH_PAR_SV - sample, memory_order_relaxed);
+                break;
             }
-            if (sscanf(line, "channel1_voltage1=%f", &value) == 1)
-            {
-                phases[current_phase].channel1_voltage[0] = value;
-            }
-            if (sscanf(line, "channel1_voltage2=%f", &value) == 1)
-            {
-                phases[current_phase].channel1_voltage[1] = value;
-            }
-            if (sscanf(line, "channel1_voltage3=%f", &value) == 1)
+
+            const uint64_t refr_tm_ns = Hal_getTimeInNs();
+            sv_patch_refr_tm(slot, refr_tm_ns);
+            if (slot->transition_phase >= 0)
             {
-                phases[current_phase].channel1_voltage[2] = value;
+                sv_record_transition(current_data, slot, refr_tm_ns);
             }
-            if (sscanf(line, "channel1_current1=%f", &value) == 1)
+            if (slot->fault_cleared)
             {
-                phases[current_phase].channel1_current[0] = value;
+                Latency_fault_cleared(current_data->instance);
             }
-            if (sscanf(line, "channel1_current2=%f", &value) == 1)
+
+            if (slot->fault_started)
             {
-                phases[current_phase].channel1_current[1] = value;
+                // Sent on its own with a transmit timestamp request, after the frames queued before it
+                SVPublisher_publishBatch(group->batch);
+                sv_latency_publish_fault(current_data, slot);
             }
-            if (sscanf(line, "channel1_current3=%f", &value) == 1)
+            else
             {
-                phases[current_phase].channel1_current[2] = value;
+                SVPublisher_Batch_queueFrame(group->batch, slot->frame, slot->size);
             }
+            SV_FrameRing_release(&current_data->ring);
+            atomic_fetch_add_explicit(&current_data->sent_frames, 1, memory_order_relaxed);
         }
     }
-
-    phase_count = current_phase + 1;
-    fclose(file);
-
-    return 0;
+    SVPublisher_publishBatch(group->batch);
 }
 
-/* GOOSE listener callback */
-static void gooseListener(GooseSubscriber subscriber, void *parameter)
+static void setupSVPublisher(ThreadData *data)
 {
-    uint32_t newStNum = GooseSubscriber_getStNum(subscriber);
 
-    /* Only if stNum changed */
-    if (newStNum != oldStNum)
-    {
-        oldStNum = newStNum;
+    data->asdu1 = SVPublisher_addASDU(data->svPublisher, data->svIDs, NULL, 1);
+    data->asdu2 = SVPublisher_addASDU(data->svPublisher, "svtesting", NULL, 1);
 
-        /* If we are currently measuring (fault active) and haven't measured latency yet */
-        if (isMeasuring && !latencyMeasured)
+    for (uint8_t no_ech = 0U; no_ech < COM_VDPA_NB_ECH_PAR_SV; no_ech++)
+    {
+        if (0 == no_ech)
         {
-            uint64_t now = Hal_getTimeInNs();
-            uint64_t latency = now - faultStartTimeNs;
-            printf("Latency measured: %f ms (stNum changed to %u)\n", ((float)latency / 1000000.f), newStNum);
-            latencyMeasured = true;
+            data->asdu = data->asdu1;
+        }
+        else
+        {
+            data->asdu = data->asdu2;
         }
-    }
-}
-
-static int setupGooseSubscriber(ThreadData *data)
-{
-    data->gooseReceiver = GooseReceiver_create();
-    if (data->gooseReceiver == NULL)
-    {
-        printf("Failed to create GooseReceiver\n");
-        return -1;
-    }
 
-    GooseReceiver_setInterfaceId(data->gooseReceiver, data->svInterface);
+        for (uint8_t no_data = 0U; no_data < COM_VDPA_NB_DATA_PAR_ECH; no_data++)
+        {
+            if ((no_data & 0x01) == 0)
+            {
+                data->state.tbIndData[no_ech][no_data] = SVPublisher_ASDU_addINT32(data->asdu);
+            }
+            else
+            {
+                data->state.tbIndData[no_ech][no_data] = SVPublisher_ASDU_addQuality(data->asdu);
+            }
+        }
 
-    data->gooseSubscriber = GooseSubscriber_create(data->goCbRef, NULL);
-    if (data->gooseSubscriber == NULL)
-    {
-        printf("Failed to create GooseSubscriber\n");
-        GooseReceiver_destroy(data->gooseReceiver);
-        return -1;
+        SVPublisher_ASDU_setSmpCntWrap(data->asdu, SAMPLES_PER_SECOND);
+        SVPublisher_ASDU_setRefrTm(data->asdu, 0);
     }
-    // printf("dstMac: %02x:%02x:%02x:%02x:%02x:%02x\n",
-    //        data->parameters.dstAddress[0], data->parameters.dstAddress[1], data->parameters.dstAddress[2],
-    //        data->parameters.dstAddress[3], data->parameters.dstAddress[4], data->parameters.dstAddress[5]);
-    //  uint8_t dstMac[6] = {0x01, 0x0c, 0xcd, 0x01, 0x10, 0x08};
-    // GooseSubscriber_setDstMac(data->gooseSubscriber, data->parameters.dstAddress);
-
-    // printf("GOOSE appid 0x%04x\n", data->GOOSEappId);
-    // GooseSubscriber_setAppId(data->gooseSubscriber, data->GOOSEappId);
-    // GooseSubscriber_setListener(data->gooseSubscriber, gooseListener, NULL);
-    // GooseReceiver_addSubscriber(data->gooseReceiver, data->gooseSubscriber);
-
-    // GooseReceiver_start(data->gooseReceiver);
+    SVPublisher_setupComplete(data->svPublisher);
 
-    // if (!GooseReceiver_isRunning(data->gooseReceiver))
+    // else
     // {
-    //     printf("Failed to start GOOSE subscriber. Root permission or correct interface required.\n");
-    //     GooseReceiver_destroy(data->gooseReceiver);
-    //     return -1;
+    //     printf("Failed to create SVPublisher for appid %u\n", data->parameters.appId);
     // }
-
-    return 0;
 }
 
-void *thread_task(void *arg)
+static void sv_instance_cleanup(ThreadData *data)
 {
-    ThreadData *data = (ThreadData *)arg;
+    if (data->svPublisher)
+    {
+        SVPublisher_destroy(data->svPublisher);
+        data->svPublisher = NULL;
+    }
+    // Free strdup'd strings within this ThreadData instance
+    // These were allocated in SVPublisher_init and are part of this instance's data
+    if (data->svInterface)
+        free(data->svInterface);
+    if (data->goCbRef)
+        free(data->goCbRef);
+    if (data->scenarioConfigFile)
+        free(data->scenarioConfigFile);
+    if (data->svIDs)
+        free(data->svIDs);
+    SV_FrameRing_destroy(&data->ring);
+    Scenario_release(data->state.scenario);
+    data->state.scenario = NULL;
+    Scenario_release(atomic_exchange_explicit(&data->pending_scenario, NULL, memory_order_acquire));
+    data->svInterface = NULL;
+    data->goCbRef = NULL;
+    data->scenarioConfigFile = NULL;
+    data->svIDs = NULL;
+}
 
-  //  printf("Thread started for appid 0x%04x on interface %s\n", data->parameters.appId, data->svInterface);
-   /* printf("svInterface %s\nappid 0x%04x\ndstMac: %02x:%02x:%02x:%02x:%02x:%02x\n",
-           data->svInterface, data->parameters.appId,
-           data->parameters.dstAddress[0], data->parameters.dstAddress[1], data->parameters.dstAddress[2],
-           data->parameters.dstAddress[3], data->parameters.dstAddress[4], data->parameters.dstAddress[5]);
-*/
+static int sv_instance_setup(ThreadData *data)
+{
     data->parameters.vlanPriority = 0;
 
     data->svPublisher = SVPublisher_create(&data->parameters, data->svInterface);
     if (!data->svPublisher)
     {
-        printf("Failed to create SVPublisher for appid %u\n", data->parameters.appId);
-        goto cleanup_on_error;
+        LOG_ERROR("SV_Publisher", "Failed to create SVPublisher for appid %u", data->parameters.appId);
+        return FAIL;
     }
-    if (loadScenarioFile(data->scenarioConfigFile) != 0)
+    // Every instance starts its own phase clock and sample counter from zero
+    memset(&data->state, 0, sizeof(data->state));
+    data->state.scenario = Scenario_acquire(data->scenarioConfigFile);
+    if (!data->state.scenario)
     {
-        printf("Erreur loading scenario file\n");
-        goto cleanup_on_error;
+        LOG_ERROR("SV_Publisher", "Error loading scenario file %s", data->scenarioConfigFile);
+        return FAIL;
     }
-   // printf("phase_count = %u\n", phase_count);
-// uncomment  if you want to use GOOSE
-/// i  will be receiving GOOSE messages once i start the simulation the vdpa  will send GOOSE messages
-//once i send a phase change command to the vdpa it will send GOOSE messages then i will calculate the latency
-//so i need to setup GOOSE subscriber to listen for GOOSE messages with personalized parameters
-// for every svinstance i will have a GOOSE subscriber
-    // Optional: Comment out GOOSE if not needed, or fix with correct interface
-    // if (setupGooseSubscriber(data) != 0)
-    // {
-    //     printf("Failed to setup GOOSE Subscriber\n");
-    //     goto cleanup_on_error;
-    // }
+    sv_dds_start(&data->state);
+    sv_scenario_begin(&data->state);
 
-    setupSVPublisher(data);
-    if (!data->svPublisher)
+    // The trip side of the latency measurement is the GOOSE listener subscribed to this instance's GoCBRef
+    data->tx_timestamps = SVPublisher_enableTxTimestamps(data->svPublisher);
+    if (!data->tx_timestamps)
     {
-        printf("Failed to create SVPublisher\n");
-        goto cleanup_on_error;
+        LOG_WARN("SV_Publisher", "No kernel transmit timestamps for appid %u, latency measured with the monotonic clock", data->parameters.appId);
     }
 
-    phase_start_tick = tick_208_us;
-    phase_duration_ticks = phases[current_phase].duration_ms * 1000 / (unsigned int)DELAY_208US;
+    setupSVPublisher(data);
 
-    setup_timer(data); // Start periodic publishing
-    // Run indefinitely until Ctrl+C
-    while (running)
+    // The transmit stage sends snapshots of the frame template, it only writes the refrTm of each ASDU
+    int frame_size = 0;
+    SVPublisher_ASDU asdus[COM_VDPA_NB_ECH_PAR_SV] = {data->asdu1, data->asdu2};
+    if (!SVPublisher_getFrameBuffer(data->svPublisher, &frame_size) || frame_size > SV_FRAME_RING_MAX_FRAME_SIZE)
     {
-        sleep(1); // Sleep to reduce CPU usage; timer_handler does the publishing
+        LOG_ERROR("SV_Publisher", "Frame of %d bytes does not fit into a ring slot for appid %u", frame_size, data->parameters.appId);
+        return FAIL;
     }
-    LOG_INFO("SV_Publisher", "Thread for appid %p gracefully shutting down.", data->parameters.appId);
-    // --- Unconditional Cleanup when thread exits its loop ---
-    if (data->svPublisher)
+    for (int sample = 0; sample < COM_VDPA_NB_ECH_PAR_SV; sample++)
     {
-        SVPublisher_destroy(data->svPublisher);
-        data->svPublisher = NULL;
+        SVPublisher_ASDU_Layout layout;
+
+        data->refr_tm_offset[sample] = SVPublisher_getASDULayout(data->svPublisher, asdus[sample], &layout) ? layout.refrTm : -1;
     }
-    if (data->gooseReceiver)
+    if (SUCCESS != SV_FrameRing_init(&data->ring, SV_PIPELINE_RING_FRAMES))
     {
-        GooseReceiver_stop(data->gooseReceiver);
-        GooseReceiver_destroy(data->gooseReceiver);
-        data->gooseReceiver = NULL;
+        return FAIL;
     }
-    // Free strdup'd strings within this ThreadData instance
-    // These were allocated in SVPublisher_init and are part of this thread's data
-    if (data->svInterface)
-        free(data->svInterface);
-    if (data->goCbRef)
-        free(data->goCbRef);
-    if (data->scenarioConfigFile)
-        free(data->scenarioConfigFile);
-    if (data->svIDs)
-        free(data->svIDs);
+    atomic_init(&data->generated_frames, 0);
+    atomic_init(&data->sent_frames, 0);
+    atomic_init(&data->late_frames, 0);
+    atomic_init(&data->launch_errors, 0);
+    data->tx_timestamp_pending = false;
+    data->launch_base_set = false;
 
-   // printf("SV_Publisher Thread for appid 0x%04x finished publishing\n", data->parameters.appId);
-    return NULL;
+    data->period_ns = SV_PUBLISH_PERIOD_NS;
+    data->offset_ns = SV_PUBLISH_OFFSET_NS;
 
-cleanup_on_error:
-    // This block handles cleanup only if an error occurred during initialization
-    if (data->svPublisher)
+    if (data->launch_lead_ns)
     {
-        SVPublisher_destroy(data->svPublisher);
-        data->svPublisher = NULL;
-    }
-    if (data->gooseReceiver)
-    {
-        GooseReceiver_stop(data->gooseReceiver);
-        GooseReceiver_destroy(data->gooseReceiver);
-        data->gooseReceiver = NULL;
+        // The ring has to hold the lead plus one refill interval and one period
+        uint64_t max_lead_ns = (uint64_t)data->ring.capacity * data->period_ns / COM_VDPA_NB_ECH_PAR_SV -
+                               SV_PIPELINE_REFILL_NS - data->period_ns;
+        if (data->launch_lead_ns > max_lead_ns)
+        {
+            LOG_WARN("SV_Publisher", "Launch time lead of %llu us exceeds the frame ring, reduced to %llu us",
+                     (unsigned long long)(data->launch_lead_ns / 1000), (unsigned long long)(max_lead_ns / 1000));
+            data->launch_lead_ns = max_lead_ns;
+        }
+        if (!SVPublisher_enableLaunchTime(data->svPublisher, SV_LAUNCH_CLOCK))
+        {
+            LOG_WARN("SV_Publisher", "No launch times (SO_TXTIME) for appid %u, frames are sent at their deadline", data->parameters.appId);
+            data->launch_lead_ns = 0;
+        }
+        else
+        {
+            LOG_INFO("SV_Publisher", "appid %u: frames queued %llu us ahead with launch times", data->parameters.appId,
+                     (unsigned long long)(data->launch_lead_ns / 1000));
+        }
     }
-    // Free strdup'd strings here as well if they were allocated before the error
-    if (data->svInterface)
-        free(data->svInterface);
-    if (data->goCbRef)
-        free(data->goCbRef);
-    if (data->scenarioConfigFile)
-        free(data->scenarioConfigFile);
-    if (data->svIDs)
-        free(data->svIDs);
 
-  //  printf("Thread for appid 0x%04x failed initialization and finished cleanup\n", data->parameters.appId);
-    return NULL;
+    return SUCCESS;
 }
 
 bool SVPublisher_init(SV_SimulationConfig *instances, int number_publishers)
@@ -644,17 +933,11 @@ bool SVPublisher_init(SV_SimulationConfig *instances, int number_publishers)
         LOG_ERROR("SV_Publisher", "Invalid input: instances array is NULL or number_publishers is non-positive.");
         return FAIL;
     }
-
     // Clean up any previous allocations if init is called multiple times without cleanup
-    if (threads != NULL || thread_data != NULL)
+    if (thread_data != NULL)
     {
         LOG_INFO("SV_Publisher", "Previous SV Publisher instances found. Cleaning up before re-initialization.");
 
-        if (threads)
-        {
-            free(threads);
-            threads = NULL;
-        }
         if (thread_data)
         {
             // Need to free internal strings within thread_data if they were strdup'd
@@ -669,6 +952,7 @@ bool SVPublisher_init(SV_SimulationConfig *instances, int number_publishers)
                     free(thread_data[i].scenarioConfigFile);
                 if (thread_data[i].svIDs)
                     free(thread_data[i].svIDs);
+                Scenario_release(thread_data[i].state.scenario);
             }
             free(thread_data);
             thread_data = NULL;
@@ -678,20 +962,11 @@ bool SVPublisher_init(SV_SimulationConfig *instances, int number_publishers)
 
     instance_count = number_publishers;
 
-    threads = (pthread_t *)malloc(instance_count * sizeof(pthread_t));
-    if (!threads)
-    {
-        LOG_ERROR("SV_Publisher", "Memory allocation failed for threads!");
-        return FAIL;
-    }
-    memset(threads, 0, instance_count * sizeof(pthread_t)); // Initialize to 0
-
-    thread_data = (ThreadData *)malloc(instance_count * sizeof(ThreadData));
-    if (!thread_data)
+    // ThreadData embeds the cache-line aligned SV_InstanceState, plain malloc() is not enough
+    if (0 != posix_memalign((void **)&thread_data, _Alignof(ThreadData), instance_count * sizeof(ThreadData)))
     {
+        thread_data = NULL;
         LOG_ERROR("SV_Publisher", "Memory allocation failed for thread_data!");
-        free(threads); // Clean up threads array
-        threads = NULL;
         return FAIL;
     }
     memset(thread_data, 0, instance_count * sizeof(ThreadData)); // Initialize to 0
@@ -701,6 +976,8 @@ bool SVPublisher_init(SV_SimulationConfig *instances, int number_publishers)
     {
         // Initialize thread_data[i] to ensure all pointers are NULL before strdup
         memset(&thread_data[i], 0, sizeof(ThreadData));
+        thread_data[i].instance = i;
+        thread_data[i].launch_lead_ns = (uint64_t)instances[i].txTimeLeadUs * 1000;
 
         thread_data[i].parameters.vlanPriority = 0; // Default or get from config if available
         thread_data[i].parameters.vlanId = 0;       // Default or get from config if available
@@ -803,7 +1080,7 @@ bool SVPublisher_init(SV_SimulationConfig *instances, int number_publishers)
     return SUCCESS;
     LOG_INFO("SV_Publisher", "cleanup happening");
 cleanup_init_failure:
-    // Free all memory allocated so far for thread_data and threads
+    // Free all memory allocated so far for thread_data
     for (int j = 0; j <= i; ++j)
     { // Free up to the current failed instance
         if (thread_data[j].parameters.appId)
@@ -822,130 +1099,202 @@ cleanup_init_failure:
         free(thread_data);
         thread_data = NULL; // Set to NULL to avoid dangling pointer
     }
-    if (threads)
-    {
-        free(threads);
-        threads = NULL;
-    }
     instance_count = 0;
     return FAIL;
 }
 
 bool SVPublisher_start(void)
 {
-    if (threads == NULL || thread_data == NULL || instance_count <= 0)
+    if (thread_data == NULL || instance_count <= 0)
     {
         LOG_ERROR("SV_Publisher", "SV Publisher not initialized. Call SVPublisher_init first.");
         return FAIL;
     }
     signal(SIGINT, sigint_handler);
-    bool all_threads_created = SUCCESS;
+    running = 1;
+
+    if (SUCCESS != SV_Scheduler_init(SV_SCHEDULER_THREADS, SV_SCHEDULER_PRIORITY))
+    {
+        LOG_ERROR("SV_Publisher", "Failed to initialize publishing scheduler");
+        return FAIL;
+    }
+
+    bool all_instances_ready = SUCCESS;
 
     for (int i = 0; i < instance_count; i++)
     {
-        if (pthread_create(&threads[i], NULL, thread_task, &thread_data[i]) != 0)
+        if (SUCCESS != sv_instance_setup(&thread_data[i]))
         {
-            LOG_ERROR("SV_Publisher", "Failed to create thread for instance %d: %s", i, strerror(errno));
-            all_threads_created = FAIL;
+            LOG_ERROR("SV_Publisher", "Failed to set up instance %d", i);
+            all_instances_ready = FAIL;
         }
-        else
+        else if (thread_data[i].launch_lead_ns)
+        {
+            // Launch time frames carry their own transmit time and are sent one by one
+            if (SUCCESS != SV_Scheduler_add(sv_publish_launch_tick, &thread_data[i],
+                                            thread_data[i].period_ns, thread_data[i].offset_ns))
+            {
+                LOG_ERROR("SV_Publisher", "Failed to schedule instance %d", i);
+                all_instances_ready = FAIL;
+            }
+        }
+        else if (SUCCESS != sv_transmit_group_join(&thread_data[i]))
+        {
+            LOG_ERROR("SV_Publisher", "Failed to add instance %d to a transmit group", i);
+            all_instances_ready = FAIL;
+        }
+    }
+
+    for (int g = 0; g < tx_group_count; g++)
+    {
+        SVTransmitGroup *group = &tx_groups[g];
+        ThreadData *first = group->instances[0];
+
+        group->batch = SVPublisher_Batch_create(first->svPublisher, group->count * COM_VDPA_NB_ECH_PAR_SV);
+        if (!group->batch || SUCCESS != SV_Scheduler_add(sv_publish_group_tick, group, first->period_ns, first->offset_ns))
         {
-            LOG_INFO("SV_Publisher", "Created thread for instance %d", i);
+            LOG_ERROR("SV_Publisher", "Failed to schedule the transmit group of instance %d", first->instance);
+            all_instances_ready = FAIL;
+            continue;
         }
+        LOG_INFO("SV_Publisher", "Scheduled %d instance(s) on %s (period %llu ns, offset %llu ns)", group->count,
+                 first->svInterface ? first->svInterface : "default interface", (unsigned long long)first->period_ns, (unsigned long long)first->offset_ns);
+    }
+
+    // Fill the rings before the first deadline, the generator thread keeps them filled from then on
+    for (int i = 0; i < instance_count; i++)
+    {
+        sv_generate_frames(&thread_data[i]);
+    }
+    if (0 != pthread_create(&sv_generator_thread, NULL, sv_generator_loop, NULL))
+    {
+        LOG_ERROR("SV_Publisher", "Failed to create the frame generator thread");
+        return FAIL;
     }
-    // printf("All threads created successfully: %d\n", all_threads_created);
-    LOG_INFO("SV_Publisher", "SV Publisher threads started.");
+    sv_generator_started = true;
 
-    return all_threads_created;
+    if (SUCCESS != SV_Scheduler_start())
+    {
+        LOG_ERROR("SV_Publisher", "Failed to start publishing scheduler");
+        return FAIL;
+    }
+    LOG_INFO("SV_Publisher", "SV Publisher scheduler started.");
+
+    return all_instances_ready;
 }
 
 void SVPublisher_stop()
 {
-    LOG_INFO("SV_Publisher", "Signaling SV Publisher threads to shut down...");
+    LOG_INFO("SV_Publisher", "Stopping SV Publisher scheduler...");
 
-    // Set the running flag to false to signal threads to exit their loops
     running = 0;
-    // Wait for all threads to finish their execution and cleanup
-    if (threads != NULL)
+    // Once the scheduler is joined no job runs anymore and the instances can be released
+    if (SUCCESS != SV_Scheduler_stop())
     {
-        for (int i = 0; i < instance_count; i++)
-        {
-            if (threads[i] != 0)
-            { // Check if thread was successfully created
-                LOG_INFO("SV_Publisher", "Joining thread for instance %d...", i);
-                if (pthread_join(threads[i], NULL) != 0)
-                {
-                    LOG_ERROR("SV_Publisher", "Failed to join thread for instance %d: %s", i, strerror(errno));
-                }
-                // printf("SV_Publisher  Joined thread for instance %d.\n", i);
-                // fflush(stdout);
-            }
-        }
-        free(threads);
-        threads = NULL;
+        LOG_ERROR("SV_Publisher", "Failed to stop publishing scheduler");
+    }
+    if (sv_generator_started)
+    {
+        pthread_join(sv_generator_thread, NULL);
+        sv_generator_started = false;
     }
-    // Now that all threads have exited and performed their local cleanup,
-    // it's safe to free the shared thread_data array.
+
+    sv_transmit_groups_free();
     if (thread_data != NULL)
     {
-        // The strdup'd strings are now freed by each thread_task, so remove their free calls here.
-        // Only free the thread_data array itself.
+        for (int i = 0; i < instance_count; i++)
+        {
+            sv_instance_cleanup(&thread_data[i]);
+        }
         free(thread_data);
         thread_data = NULL;
     }
+    instance_count = 0;
 
-   
-  
     printf("SV_Publisher threads stopped.\n");
 }
 
-void setup_timer(ThreadData *data)
+int SVPublisher_get_pipeline_stats(int instance, SVPipelineStats *stats)
 {
-    struct sigevent sev;
-    struct itimerspec ts;
-    timer_t timerid;
-    int signal_num = SIGRTMIN + (data->parameters.appId % 10); // Unique signal from SIGRTMIN to SIGRTMIN+9
-
-    // Ensure signal number is within valid range
-    if (signal_num > SIGRTMAX)
+    if (!stats || !thread_data || instance < 0 || instance >= instance_count)
     {
-        printf("Signal number %d exceeds SIGRTMAX for appid %u\n", signal_num, data->parameters.appId);
-        return;
+        return FAIL;
     }
+    ThreadData *data = &thread_data[instance];
+
+    stats->ring_capacity = data->ring.capacity;
+    stats->ring_occupancy = SV_FrameRing_occupancy(&data->ring);
+    stats->ring_low_water = SV_FrameRing_low_water(&data->ring);
+    stats->generated = atomic_load_explicit(&data->generated_frames, memory_order_relaxed);
+    stats->sent = atomic_load_explicit(&data->sent_frames, memory_order_relaxed);
+    stats->late_frames = atomic_load_explicit(&data->late_frames, memory_order_relaxed);
+    stats->launch_errors = atomic_load_explicit(&data->launch_errors, memory_order_relaxed);
+    stats->scenario_swaps = atomic_load_explicit(&data->scenario_swaps, memory_order_relaxed);
+    return SUCCESS;
+}
 
-    memset(&sev, 0, sizeof(sev));
-    sev.sigev_notify = SIGEV_SIGNAL; // Deliver signal to process, rely on thread-specific data
-    sev.sigev_signo = signal_num;
-    sev.sigev_value.sival_ptr = data; // Pass ThreadData pointer
-
-    struct sigaction sa;
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = timer_handler;
-    sa.sa_flags = SA_RESTART | SA_SIGINFO; // Use SA_SIGINFO to get sival_ptr
-    if (sigaction(signal_num, &sa, NULL) == -1)
+int SVPublisher_swap_scenario(int instance, const char *scenarioConfigFile)
+{
+    if (!scenarioConfigFile || !thread_data || !sv_generator_started || instance < -1 || instance >= instance_count)
     {
-        perror("sigaction failed");
-        return;
+        LOG_ERROR("SV_Publisher", "Cannot swap the scenario of instance %d: not running or no such instance", instance);
+        return FAIL;
     }
 
-    if (timer_create(CLOCK_REALTIME, &sev, &timerid) == -1)
+    // Loaded (or found in the cache) once, outside the publishing threads: past this point the swap cannot
+    // fail, so either every instance switches or none does
+    const Scenario *scenario = Scenario_acquire(scenarioConfigFile);
+    if (!scenario)
     {
-        perror("timer_create failed");
-        return;
+        LOG_ERROR("SV_Publisher", "Error loading scenario file %s", scenarioConfigFile);
+        return FAIL;
     }
+    for (int i = 0; i < instance_count; i++)
+    {
+        if (-1 != instance && i != instance)
+        {
+            continue;
+        }
+        Scenario_retain(scenario); // one reference per instance, released by the generator
+        Scenario_release(atomic_exchange_explicit(&thread_data[i].pending_scenario, scenario, memory_order_release));
+        LOG_INFO("SV_Publisher", "Instance %d switches to scenario %s", i, scenarioConfigFile);
+    }
+    Scenario_release(scenario);
+    return SUCCESS;
+}
 
-    ts.it_value.tv_sec = 0;
-    ts.it_value.tv_nsec = 416000; // 416 us
-    ts.it_interval.tv_sec = 0;
-    ts.it_interval.tv_nsec = 416000;
-
-    if (timer_settime(timerid, 0, &ts, NULL) == -1)
+int SVPublisher_get_transitions(int instance, SVPhaseTransition *transitions, int max_count)
+{
+    if (!transitions || !thread_data || instance < 0 || instance >= instance_count)
     {
-        perror("timer_settime failed");
-        timer_delete(timerid);
-        return;
+        return FAIL;
     }
+    ThreadData *data = &thread_data[instance];
+
+    for (;;)
+    {
+        uint_fast64_t seq = atomic_load_explicit(&data->transition_seq, memory_order_acquire);
+        int count = 0;
 
-    data->timerid = timerid;
-    printf("Timer started for appid %u with signal %d\n", data->parameters.appId, signal_num);
+        if (seq & 1)
+        {
+            sched_yield(); // the transmit stage is writing an entry
+            continue;
+        }
+        uint64_t total = data->transition_count;
+        uint64_t first = total > SV_TRANSITION_LOG_SIZE ? total - SV_TRANSITION_LOG_SIZE : 0;
+        if (max_count > 0 && total - first > (uint64_t)max_count)
+        {
+            first = total - (uint64_t)max_count; // the most recent ones
+        }
+        for (uint64_t n = first; n < total && count < max_count; n++)
+        {
+            transitions[count++] = data->transitions[n % SV_TRANSITION_LOG_SIZE];
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (seq == atomic_load_explicit(&data->transition_seq, memory_order_relaxed))
+        {
+            return count;
+        }
+    }
 }
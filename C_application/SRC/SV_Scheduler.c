@@ -0,0 +1,365 @@
+#define _GNU_SOURCE
+#include "SV_Scheduler.h"
+#include "logger.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#define NS_PER_SEC 1000000000ULL
+/* Small delay so every worker is created before the first common deadline */
+#define SV_SCHEDULER_START_DELAY_NS 1000000ULL
+
+typedef struct
+{
+    sv_scheduler_job_t job;
+    void *context;
+    uint64_t period_ns;
+    uint64_t offset_ns;
+    uint64_t next_deadline_ns;
+} SchedulerEntry;
+
+/* One worker thread serving a deadline-ordered (min-heap) table of jobs */
+typedef struct
+{
+    pthread_t thread;
+    bool created;
+    int cpu; // -1: not pinned
+    SchedulerEntry *heap;
+    int count;
+    int capacity;
+    atomic_uint_fast64_t overruns; // written by the worker, read by SV_Scheduler_get_overruns()
+} SchedulerWorker;
+
+static SchedulerWorker *workers = NULL;
+static int worker_count = 0;
+static int next_worker = 0;
+static int sched_priority = 0;
+static atomic_bool scheduler_running = false; // read by the worker threads
+
+static uint64_t monotonic_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void heap_swap(SchedulerEntry *a, SchedulerEntry *b)
+{
+    SchedulerEntry tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void heap_sift_down(SchedulerWorker *worker, int index)
+{
+    for (;;)
+    {
+        int left = 2 * index + 1;
+        int right = left + 1;
+        int smallest = index;
+
+        if (left < worker->count && worker->heap[left].next_deadline_ns < worker->heap[smallest].next_deadline_ns)
+        {
+            smallest = left;
+        }
+        if (right < worker->count && worker->heap[right].next_deadline_ns < worker->heap[smallest].next_deadline_ns)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        heap_swap(&worker->heap[smallest], &worker->heap[index]);
+        index = smallest;
+    }
+}
+
+static void *scheduler_worker_thread(void *arg)
+{
+    SchedulerWorker *worker = (SchedulerWorker *)arg;
+    struct timespec ts;
+
+    while (scheduler_running && worker->count > 0)
+    {
+        SchedulerEntry *entry = &worker->heap[0];
+
+        ts.tv_sec = (time_t)(entry->next_deadline_ns / NS_PER_SEC);
+        ts.tv_nsec = (long)(entry->next_deadline_ns % NS_PER_SEC);
+
+        int rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        if (rc != 0 && rc != EINTR)
+        {
+            LOG_ERROR("SV_Scheduler", "clock_nanosleep failed: %s", strerror(rc));
+            break;
+        }
+
+        uint64_t now = monotonic_now_ns();
+
+        /* Serve every job whose deadline has been reached */
+        while (scheduler_running && worker->heap[0].next_deadline_ns <= now)
+        {
+            entry = &worker->heap[0];
+            entry->job(entry->context, entry->next_deadline_ns);
+
+            entry->next_deadline_ns += entry->period_ns;
+            if (entry->next_deadline_ns + entry->period_ns <= now)
+            {
+                /* More than one period late: skip the missed deadlines instead of bursting */
+                uint64_t missed = (now - entry->next_deadline_ns) / entry->period_ns;
+                entry->next_deadline_ns += missed * entry->period_ns;
+                atomic_fetch_add_explicit(&worker->overruns, missed, memory_order_relaxed);
+            }
+            heap_sift_down(worker, 0);
+        }
+    }
+
+    return NULL;
+}
+
+int SV_Scheduler_init(int nb_threads, int priority)
+{
+    if (nb_threads <= 0)
+    {
+        LOG_ERROR("SV_Scheduler", "Invalid number of scheduler threads: %d", nb_threads);
+        return FAIL;
+    }
+    if (scheduler_running)
+    {
+        LOG_ERROR("SV_Scheduler", "Scheduler already running");
+        return FAIL;
+    }
+
+    if (workers != NULL)
+    {
+        SV_Scheduler_stop();
+    }
+
+    workers = (SchedulerWorker *)calloc(nb_threads, sizeof(SchedulerWorker));
+    if (!workers)
+    {
+        LOG_ERROR("SV_Scheduler", "Memory allocation failed for scheduler workers");
+        return FAIL;
+    }
+
+    // Worker i is pinned to the i-th CPU the process may run on (taskset, cpuset cgroup, isolcpus),
+    // a CPU outside the affinity mask would make pthread_create() fail
+    cpu_set_t allowed;
+    int allowed_cpus[CPU_SETSIZE];
+    int nb_cpus = 0;
+
+    if (0 == sched_getaffinity(0, sizeof(allowed), &allowed))
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                allowed_cpus[nb_cpus++] = cpu;
+            }
+        }
+    }
+    else
+    {
+        LOG_WARN("SV_Scheduler", "sched_getaffinity failed (%s), scheduler threads are not pinned", strerror(errno));
+    }
+
+    for (int i = 0; i < nb_threads; i++)
+    {
+        workers[i].cpu = (nb_cpus > 0) ? allowed_cpus[i % nb_cpus] : -1;
+        atomic_init(&workers[i].overruns, 0);
+    }
+
+    worker_count = nb_threads;
+    next_worker = 0;
+    sched_priority = priority;
+    return SUCCESS;
+}
+
+int SV_Scheduler_add(sv_scheduler_job_t job, void *context, uint64_t period_ns, uint64_t offset_ns)
+{
+    if (workers == NULL || job == NULL || period_ns == 0)
+    {
+        LOG_ERROR("SV_Scheduler", "Invalid job registration (scheduler initialized: %d)", workers != NULL);
+        return FAIL;
+    }
+    if (scheduler_running)
+    {
+        LOG_ERROR("SV_Scheduler", "Jobs must be registered before SV_Scheduler_start()");
+        return FAIL;
+    }
+
+    SchedulerWorker *worker = &workers[next_worker];
+
+    if (worker->count == worker->capacity)
+    {
+        int new_capacity = (worker->capacity == 0) ? 16 : worker->capacity * 2;
+        SchedulerEntry *heap = (SchedulerEntry *)realloc(worker->heap, new_capacity * sizeof(SchedulerEntry));
+        if (!heap)
+        {
+            LOG_ERROR("SV_Scheduler", "Memory allocation failed for scheduler table");
+            return FAIL;
+        }
+        worker->heap = heap;
+        worker->capacity = new_capacity;
+    }
+
+    SchedulerEntry *entry = &worker->heap[worker->count];
+    entry->job = job;
+    entry->context = context;
+    entry->period_ns = period_ns;
+    entry->offset_ns = offset_ns;
+    entry->next_deadline_ns = offset_ns;
+    worker->count++;
+
+    next_worker = (next_worker + 1) % worker_count;
+    return SUCCESS;
+}
+
+static int create_worker_thread(SchedulerWorker *worker)
+{
+    pthread_attr_t attr;
+    struct sched_param param;
+    cpu_set_t cpuset;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = sched_priority;
+    pthread_attr_setschedparam(&attr, &param);
+
+    if (worker->cpu >= 0)
+    {
+        CPU_ZERO(&cpuset);
+        CPU_SET(worker->cpu, &cpuset);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+    }
+
+    int rc = pthread_create(&worker->thread, &attr, scheduler_worker_thread, worker);
+    if (EPERM == rc)
+    {
+        LOG_WARN("SV_Scheduler", "No permission for SCHED_FIFO, using default scheduling policy");
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        rc = pthread_create(&worker->thread, &attr, scheduler_worker_thread, worker);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (rc != 0)
+    {
+        LOG_ERROR("SV_Scheduler", "Failed to create scheduler thread: %s", strerror(rc));
+        return FAIL;
+    }
+
+    worker->created = true;
+    return SUCCESS;
+}
+
+int SV_Scheduler_start(void)
+{
+    if (workers == NULL)
+    {
+        LOG_ERROR("SV_Scheduler", "Scheduler not initialized. Call SV_Scheduler_init first.");
+        return FAIL;
+    }
+    if (scheduler_running)
+    {
+        return SUCCESS;
+    }
+
+    uint64_t start_ns = monotonic_now_ns() + SV_SCHEDULER_START_DELAY_NS;
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        SchedulerWorker *worker = &workers[i];
+
+        /* Turn the relative offsets into absolute deadlines and restore the heap order */
+        for (int j = 0; j < worker->count; j++)
+        {
+            worker->heap[j].next_deadline_ns = start_ns + worker->heap[j].offset_ns;
+        }
+        for (int j = worker->count / 2 - 1; j >= 0; j--)
+        {
+            heap_sift_down(worker, j);
+        }
+    }
+
+    scheduler_running = true;
+
+    int retval = SUCCESS;
+    for (int i = 0; i < worker_count; i++)
+    {
+        if (workers[i].count > 0 && SUCCESS != create_worker_thread(&workers[i]))
+        {
+            retval = FAIL;
+        }
+    }
+
+    if (SUCCESS != retval)
+    {
+        SV_Scheduler_stop();
+    }
+    else
+    {
+        LOG_INFO("SV_Scheduler", "Scheduler started with %d thread(s)", worker_count);
+    }
+    return retval;
+}
+
+int SV_Scheduler_stop(void)
+{
+    int retval = SUCCESS;
+
+    scheduler_running = false;
+
+    if (workers == NULL)
+    {
+        return SUCCESS;
+    }
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        if (workers[i].created)
+        {
+            int rc = pthread_join(workers[i].thread, NULL);
+            if (rc != 0)
+            {
+                LOG_ERROR("SV_Scheduler", "Failed to join scheduler thread %d: %s", i, strerror(rc));
+                retval = FAIL;
+            }
+            workers[i].created = false;
+        }
+        uint64_t overruns = atomic_load_explicit(&workers[i].overruns, memory_order_relaxed);
+        if (overruns)
+        {
+            LOG_WARN("SV_Scheduler", "Scheduler thread %d skipped %llu deadlines", i, (unsigned long long)overruns);
+        }
+        free(workers[i].heap);
+    }
+
+    free(workers);
+    workers = NULL;
+    worker_count = 0;
+    next_worker = 0;
+
+    return retval;
+}
+
+uint64_t SV_Scheduler_get_overruns(void)
+{
+    uint64_t overruns = 0;
+
+    if (workers != NULL)
+    {
+        for (int i = 0; i < worker_count; i++)
+        {
+            overruns += atomic_load_explicit(&workers[i].overruns, memory_order_relaxed);
+        }
+    }
+    return overruns;
+}
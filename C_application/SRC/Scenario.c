@@ -0,0 +1,1020 @@
+#include "Scenario.h"
+#include "logger.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+/* Compiler state: the phase table grows as phases are parsed */
+typedef struct
+{
+    ScenarioHeader header;
+    ScenarioPhase *phases;
+    uint32_t capacity;
+} ScenarioBuilder;
+
+/* Shared cache: a compiled image used by any number of instances, found by its content hash */
+typedef struct ScenarioCacheImage
+{
+    Scenario scenario; // must stay first: Scenario_release() gets back to the image from it
+    struct ScenarioCacheImage *next;
+    uint64_t hash;
+    int refs;           // Scenario_acquire() references
+    int keys;           // files known to hold this image
+    uint64_t last_used; // cache clock of the last release
+} ScenarioCacheImage;
+
+/* A file known to hold an image, valid while the file keeps the status it had when it was loaded */
+typedef struct ScenarioCacheKey
+{
+    struct ScenarioCacheKey *next;
+    char *path;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    ScenarioCacheImage *image;
+} ScenarioCacheKey;
+
+static pthread_mutex_t scenario_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static ScenarioCacheImage *scenario_cache_images = NULL;
+static ScenarioCacheKey *scenario_cache_keys = NULL;
+static uint64_t scenario_cache_clock = 0;
+
+static char *scenario_trim(char *text)
+{
+    char *end;
+
+    while (isspace((unsigned char)*text))
+    {
+        text++;
+    }
+    end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1]))
+    {
+        end--;
+    }
+    *end = '\0';
+    return text;
+}
+
+static int scenario_parse_float(const char *text, float *value)
+{
+    char *end;
+
+    errno = 0;
+    *value = strtof(text, &end);
+    return (end != text && '\0' == *end && 0 == errno) ? SUCCESS : FAIL;
+}
+
+static int scenario_parse_int(const char *text, long min, long max, long *value)
+{
+    char *end;
+
+    errno = 0;
+    *value = strtol(text, &end, 10);
+    return (end != text && '\0' == *end && 0 == errno && *value >= min && *value <= max) ? SUCCESS : FAIL;
+}
+
+static int scenario_set_inception_angle(ScenarioPhase *phase, const char *text)
+{
+    float angle;
+
+    if (SUCCESS != scenario_parse_float(text, &angle) || !(angle >= 0.0f && angle < 360.0f))
+    {
+        return FAIL;
+    }
+    phase->inception_angle_deg = angle;
+    phase->flags |= SCENARIO_PHASE_POINT_ON_WAVE;
+    return SUCCESS;
+}
+
+static int scenario_set_frequency(ScenarioPhase *phase, const char *text)
+{
+    float frequency;
+
+    if (SUCCESS != scenario_parse_float(text, &frequency) || !(frequency > 0.0f && frequency <= SCENARIO_MAX_FREQUENCY_HZ))
+    {
+        return FAIL;
+    }
+    phase->frequency_hz = frequency;
+    phase->flags |= SCENARIO_PHASE_FREQUENCY;
+    return SUCCESS;
+}
+
+/* ROCOF or phase jump: any finite value */
+static int scenario_set_finite(float *value, const char *text)
+{
+    return (SUCCESS == scenario_parse_float(text, value) && isfinite(*value)) ? SUCCESS : FAIL;
+}
+
+static ScenarioPhase *scenario_add_phase(ScenarioBuilder *builder)
+{
+    if (builder->header.phase_count == builder->capacity)
+    {
+        uint32_t capacity = builder->capacity ? builder->capacity * 2 : 64;
+        ScenarioPhase *phases;
+
+        if (capacity <= builder->capacity)
+        {
+            return NULL;
+        }
+        phases = (ScenarioPhase *)realloc(builder->phases, (size_t)capacity * sizeof(ScenarioPhase));
+        if (!phases)
+        {
+            return NULL;
+        }
+        builder->phases = phases;
+        builder->capacity = capacity;
+    }
+
+    ScenarioPhase *phase = &builder->phases[builder->header.phase_count++];
+    memset(phase, 0, sizeof(*phase));
+    return phase;
+}
+
+/* Sets "voltage<n>" or "current<n>" (n = 1..3) of a channel (1-based) */
+static int scenario_set_channel_value(ScenarioBuilder *builder, ScenarioPhase *phase, long channel,
+                                      const char *name, const char *text)
+{
+    float *values;
+    float value;
+    long index;
+
+    if (channel < 1 || channel > SCENARIO_MAX_CHANNELS)
+    {
+        return FAIL;
+    }
+    if (0 == strncmp(name, "voltage", 7))
+    {
+        values = phase->voltage[channel - 1];
+        name += 7;
+    }
+    else if (0 == strncmp(name, "current", 7))
+    {
+        values = phase->current[channel - 1];
+        name += 7;
+    }
+    else
+    {
+        return FAIL;
+    }
+    if (SUCCESS != scenario_parse_int(name, 1, 3, &index) || SUCCESS != scenario_parse_float(text, &value))
+    {
+        return FAIL;
+    }
+
+    values[index - 1] = value;
+    builder->header.channel_mask |= (uint16_t)(1u << (channel - 1));
+    return SUCCESS;
+}
+
+/* Applies one "key=value" line of the text format, phase is NULL before the first "# Phase" */
+static int scenario_set_text_key(ScenarioBuilder *builder, ScenarioPhase *phase, const char *key, const char *value)
+{
+    long number;
+
+    if (NULL == phase)
+    {
+        // Header key: number of plays of the whole scenario
+        if (0 == strcmp(key, "repeat") && SUCCESS == scenario_parse_int(value, 0, INT32_MAX, &number))
+        {
+            builder->header.repeat_count = (int32_t)number;
+            return SUCCESS;
+        }
+        return FAIL;
+    }
+    if (0 == strcmp(key, "duration_ms"))
+    {
+        if (SUCCESS != scenario_parse_int(value, 0, INT32_MAX, &number))
+        {
+            return FAIL;
+        }
+        phase->duration_ms = (uint32_t)number;
+        return SUCCESS;
+    }
+    if (0 == strcmp(key, "inception_angle_deg"))
+    {
+        return scenario_set_inception_angle(phase, value);
+    }
+    if (0 == strcmp(key, "frequency_hz"))
+    {
+        return scenario_set_frequency(phase, value);
+    }
+    if (0 == strcmp(key, "rocof_hz_per_s"))
+    {
+        return scenario_set_finite(&phase->rocof_hz_per_s, value);
+    }
+    if (0 == strcmp(key, "phase_jump_deg"))
+    {
+        return scenario_set_finite(&phase->phase_jump_deg, value);
+    }
+    if (0 == strncmp(key, "channel", 7))
+    {
+        char *end;
+        long channel = strtol(key + 7, &end, 10);
+
+        if (end != key + 7 && '_' == *end)
+        {
+            return scenario_set_channel_value(builder, phase, channel, end + 1, value);
+        }
+    }
+    return FAIL;
+}
+
+static int scenario_parse_text(ScenarioBuilder *builder, const char *source)
+{
+    FILE *file = fopen(source, "r");
+    ScenarioPhase *phase = NULL;
+    char buffer[256];
+    int line_number = 0;
+
+    if (!file)
+    {
+        LOG_ERROR("Scenario", "Could not open scenario %s: %s", source, strerror(errno));
+        return FAIL;
+    }
+
+    while (fgets(buffer, sizeof(buffer), file))
+    {
+        char *line = scenario_trim(buffer);
+        char *value;
+
+        line_number++;
+        if ('\0' == *line)
+        {
+            continue;
+        }
+        if ('#' == *line)
+        {
+            if (strstr(line, "# Phase"))
+            {
+                phase = scenario_add_phase(builder);
+                if (!phase)
+                {
+                    LOG_ERROR("Scenario", "Memory allocation failed for phase %u", builder->header.phase_count);
+                    fclose(file);
+                    return FAIL;
+                }
+            }
+            continue;
+        }
+
+        value = strchr(line, '=');
+        if (value)
+        {
+            *value++ = '\0';
+        }
+        if (!value || SUCCESS != scenario_set_text_key(builder, phase, scenario_trim(line), scenario_trim(value)))
+        {
+            LOG_ERROR("Scenario", "%s:%d: invalid entry \"%s\"", source, line_number, line);
+            fclose(file);
+            return FAIL;
+        }
+    }
+
+    fclose(file);
+    return SUCCESS;
+}
+
+static int scenario_parse_xml_channel(ScenarioBuilder *builder, ScenarioPhase *phase, xmlNodePtr node)
+{
+    xmlChar *id = xmlGetProp(node, BAD_CAST "id");
+    long channel;
+    int result = SUCCESS;
+
+    if (!id || SUCCESS != scenario_parse_int((const char *)id, 1, SCENARIO_MAX_CHANNELS, &channel))
+    {
+        xmlFree(id);
+        return FAIL;
+    }
+    xmlFree(id);
+
+    for (xmlAttrPtr attr = node->properties; attr && SUCCESS == result; attr = attr->next)
+    {
+        xmlChar *value;
+
+        if (0 == xmlStrcmp(attr->name, BAD_CAST "id"))
+        {
+            continue;
+        }
+        value = xmlNodeGetContent((xmlNodePtr)attr);
+        result = value ? scenario_set_channel_value(builder, phase, channel, (const char *)attr->name, (const char *)value) : FAIL;
+        xmlFree(value);
+    }
+    return result;
+}
+
+static int scenario_parse_xml_phase(ScenarioBuilder *builder, xmlNodePtr node)
+{
+    ScenarioPhase *phase = scenario_add_phase(builder);
+    long number;
+
+    if (!phase)
+    {
+        return FAIL;
+    }
+    for (xmlAttrPtr attr = node->properties; attr; attr = attr->next)
+    {
+        xmlChar *value = xmlNodeGetContent((xmlNodePtr)attr);
+        int result = FAIL;
+
+        if (value && 0 == xmlStrcmp(attr->name, BAD_CAST "durationMs") &&
+            SUCCESS == scenario_parse_int((const char *)value, 0, INT32_MAX, &number))
+        {
+            phase->duration_ms = (uint32_t)number;
+            result = SUCCESS;
+        }
+        else if (value && 0 == xmlStrcmp(attr->name, BAD_CAST "inceptionAngleDeg"))
+        {
+            result = scenario_set_inception_angle(phase, (const char *)value);
+        }
+        else if (value && 0 == xmlStrcmp(attr->name, BAD_CAST "frequencyHz"))
+        {
+            result = scenario_set_frequency(phase, (const char *)value);
+        }
+        else if (value && 0 == xmlStrcmp(attr->name, BAD_CAST "rocofHzPerS"))
+        {
+            result = scenario_set_finite(&phase->rocof_hz_per_s, (const char *)value);
+        }
+        else if (value && 0 == xmlStrcmp(attr->name, BAD_CAST "phaseJumpDeg"))
+        {
+            result = scenario_set_finite(&phase->phase_jump_deg, (const char *)value);
+        }
+        xmlFree(value);
+        if (SUCCESS != result)
+        {
+            return FAIL;
+        }
+    }
+    for (xmlNodePtr child = node->children; child; child = child->next)
+    {
+        if (XML_ELEMENT_NODE != child->type)
+        {
+            continue;
+        }
+        if (0 != xmlStrcmp(child->name, BAD_CAST "Channel") || SUCCESS != scenario_parse_xml_channel(builder, phase, child))
+        {
+            return FAIL;
+        }
+    }
+    return SUCCESS;
+}
+
+static int scenario_parse_xml(ScenarioBuilder *builder, const char *source)
+{
+    xmlDocPtr doc = xmlReadFile(source, NULL, XML_PARSE_NONET | XML_PARSE_NOBLANKS);
+    xmlNodePtr root;
+    int result = SUCCESS;
+
+    if (!doc)
+    {
+        LOG_ERROR("Scenario", "Could not parse XML scenario %s", source);
+        return FAIL;
+    }
+    root = xmlDocGetRootElement(doc);
+    if (!root || 0 != xmlStrcmp(root->name, BAD_CAST "Scenario"))
+    {
+        LOG_ERROR("Scenario", "%s: root element is not <Scenario>", source);
+        xmlFreeDoc(doc);
+        return FAIL;
+    }
+
+    xmlChar *repeat = xmlGetProp(root, BAD_CAST "repeat");
+    if (repeat)
+    {
+        long number;
+
+        if (SUCCESS != scenario_parse_int((const char *)repeat, 0, INT32_MAX, &number))
+        {
+            LOG_ERROR("Scenario", "%s: invalid repeat \"%s\"", source, (const char *)repeat);
+            result = FAIL;
+        }
+        else
+        {
+            builder->header.repeat_count = (int32_t)number;
+        }
+        xmlFree(repeat);
+    }
+
+    for (xmlNodePtr node = root->children; node && SUCCESS == result; node = node->next)
+    {
+        if (XML_ELEMENT_NODE != node->type)
+        {
+            continue;
+        }
+        if (0 != xmlStrcmp(node->name, BAD_CAST "Phase") || SUCCESS != scenario_parse_xml_phase(builder, node))
+        {
+            LOG_ERROR("Scenario", "%s:%ld: invalid <%s> element", source, (long)xmlGetLineNo(node), (const char *)node->name);
+            result = FAIL;
+        }
+    }
+
+    xmlFreeDoc(doc);
+    return result;
+}
+
+/* XML sources start with '<', anything else is the text format */
+static bool scenario_source_is_xml(const char *source)
+{
+    FILE *file = fopen(source, "r");
+    int c = EOF;
+
+    if (file)
+    {
+        do
+        {
+            c = fgetc(file);
+        } while (EOF != c && isspace(c));
+        fclose(file);
+    }
+    return '<' == c;
+}
+
+/* Parses a text/XML scenario into a heap image (header + phase table) */
+static int scenario_build(const char *source, uint8_t **image, size_t *image_size)
+{
+    ScenarioBuilder builder;
+    int result;
+
+    memset(&builder, 0, sizeof(builder));
+    builder.header.repeat_count = 1;
+
+    if (scenario_source_is_xml(source))
+    {
+        result = scenario_parse_xml(&builder, source);
+    }
+    else
+    {
+        result = scenario_parse_text(&builder, source);
+    }
+    if (SUCCESS == result && 0 == builder.header.phase_count)
+    {
+        LOG_ERROR("Scenario", "%s: no phase", source);
+        result = FAIL;
+    }
+    if (SUCCESS != result)
+    {
+        free(builder.phases);
+        return FAIL;
+    }
+
+    // The publisher plays the lowest channel the scenario sets
+    ScenarioHeader *header = &builder.header;
+    header->magic = SCENARIO_MAGIC;
+    header->version = SCENARIO_VERSION;
+    header->header_size = sizeof(ScenarioHeader);
+    header->phase_stride = sizeof(ScenarioPhase);
+    header->channel = 0;
+    while (header->channel < SCENARIO_MAX_CHANNELS - 1 && !(header->channel_mask & (1u << header->channel)))
+    {
+        header->channel++;
+    }
+    header->duration_ms = 0;
+    float frequency = SCENARIO_NOMINAL_FREQUENCY_HZ; // every play starts at the nominal frequency
+    for (uint32_t i = 0; i < header->phase_count; i++)
+    {
+        const float *current = builder.phases[i].current[header->channel];
+
+        // A phase without frequency_hz continues at the frequency the previous one ended with
+        if (builder.phases[i].flags & SCENARIO_PHASE_FREQUENCY)
+        {
+            frequency = builder.phases[i].frequency_hz;
+        }
+        builder.phases[i].frequency_hz = frequency;
+        frequency += builder.phases[i].rocof_hz_per_s * (float)builder.phases[i].duration_ms / 1000.0f;
+        if (!(frequency > 0.0f && frequency <= SCENARIO_MAX_FREQUENCY_HZ))
+        {
+            LOG_ERROR("Scenario", "%s: phase %u ramps the frequency to %.3f Hz, outside (0, %.0f] Hz", source, i + 1,
+                      (double)frequency, (double)SCENARIO_MAX_FREQUENCY_HZ);
+            free(builder.phases);
+            return FAIL;
+        }
+
+        // Boundaries are kept as absolute times from the start of the play: converting them to
+        // sample indexes one by one never accumulates rounding errors
+        builder.phases[i].start_ms = header->duration_ms;
+        header->duration_ms += builder.phases[i].duration_ms;
+
+        if (current[0] > SV_FAULT_CURRENT_THRESHOLD || current[1] > SV_FAULT_CURRENT_THRESHOLD ||
+            current[2] > SV_FAULT_CURRENT_THRESHOLD)
+        {
+            builder.phases[i].flags |= SCENARIO_PHASE_FAULT;
+        }
+    }
+
+    *image_size = sizeof(ScenarioHeader) + (size_t)header->phase_count * sizeof(ScenarioPhase);
+    *image = (uint8_t *)malloc(*image_size);
+    if (!*image)
+    {
+        LOG_ERROR("Scenario", "Memory allocation failed for %u phases", header->phase_count);
+        free(builder.phases);
+        return FAIL;
+    }
+    memcpy(*image, header, sizeof(ScenarioHeader));
+    memcpy(*image + sizeof(ScenarioHeader), builder.phases, (size_t)header->phase_count * sizeof(ScenarioPhase));
+    free(builder.phases);
+    return SUCCESS;
+}
+
+/* Checks a compiled image and points the scenario at its phase table */
+static int scenario_attach(Scenario *scenario, const uint8_t *image, size_t image_size, bool mapped)
+{
+    const ScenarioHeader *header = (const ScenarioHeader *)image;
+
+    if (image_size < sizeof(ScenarioHeader) || SCENARIO_MAGIC != header->magic || SCENARIO_VERSION != header->version ||
+        header->header_size < sizeof(ScenarioHeader) || header->phase_stride < sizeof(ScenarioPhase) ||
+        0 == header->phase_count || header->channel >= SCENARIO_MAX_CHANNELS ||
+        header->header_size + (uint64_t)header->phase_count * header->phase_stride > image_size)
+    {
+        return FAIL;
+    }
+
+    scenario->image = image;
+    scenario->image_size = image_size;
+    scenario->mapped = mapped;
+    scenario->phases = image + header->header_size;
+    scenario->phase_count = header->phase_count;
+    scenario->phase_stride = header->phase_stride;
+    scenario->repeat_count = header->repeat_count;
+    scenario->channel = header->channel;
+    scenario->duration_ms = header->duration_ms;
+    return SUCCESS;
+}
+
+static int scenario_map(Scenario *scenario, const char *path)
+{
+    struct stat st;
+    void *image;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return FAIL;
+    }
+    if (0 != fstat(fd, &st) || st.st_size < (off_t)sizeof(ScenarioHeader))
+    {
+        close(fd);
+        return FAIL;
+    }
+    image = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == image)
+    {
+        return FAIL;
+    }
+    // Phases are read in order, one at each boundary
+    madvise(image, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    if (SUCCESS != scenario_attach(scenario, (const uint8_t *)image, (size_t)st.st_size, true))
+    {
+        LOG_WARN("Scenario", "%s is not a compiled scenario of version %d", path, SCENARIO_VERSION);
+        munmap(image, (size_t)st.st_size);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+static bool scenario_is_binary(const char *path)
+{
+    uint32_t magic = 0;
+    FILE *file = fopen(path, "rb");
+
+    if (file)
+    {
+        if (1 != fread(&magic, sizeof(magic), 1, file))
+        {
+            magic = 0;
+        }
+        fclose(file);
+    }
+    return SCENARIO_MAGIC == magic;
+}
+
+/* The compiled file is current when it is not older than its source */
+static bool scenario_is_up_to_date(const char *source, const char *compiled)
+{
+    struct stat src, bin;
+
+    if (0 != stat(source, &src) || 0 != stat(compiled, &bin))
+    {
+        return false;
+    }
+    return (bin.st_mtim.tv_sec > src.st_mtim.tv_sec) ||
+           (bin.st_mtim.tv_sec == src.st_mtim.tv_sec && bin.st_mtim.tv_nsec >= src.st_mtim.tv_nsec);
+}
+
+static char *scenario_binary_path(const char *source)
+{
+    size_t size = strlen(source) + sizeof(SCENARIO_BINARY_SUFFIX);
+    char *path = (char *)malloc(size);
+
+    if (path)
+    {
+        snprintf(path, size, "%s%s", source, SCENARIO_BINARY_SUFFIX);
+    }
+    return path;
+}
+
+/* Writes an image under a temporary name then renames it: a reader never maps a partial file */
+static int scenario_write(const char *output, const uint8_t *image, size_t image_size)
+{
+    char tmp[4096];
+    FILE *file;
+    int result = SUCCESS;
+
+    if ((size_t)snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", output, (long)getpid()) >= sizeof(tmp))
+    {
+        return FAIL;
+    }
+    file = fopen(tmp, "wb");
+    if (!file)
+    {
+        return FAIL;
+    }
+    if (1 != fwrite(image, image_size, 1, file))
+    {
+        result = FAIL;
+    }
+    if (0 != fclose(file))
+    {
+        result = FAIL;
+    }
+    if (SUCCESS == result && 0 != rename(tmp, output))
+    {
+        result = FAIL;
+    }
+    if (SUCCESS != result)
+    {
+        unlink(tmp);
+    }
+    return result;
+}
+
+int Scenario_compile(const char *source, const char *output)
+{
+    char *default_output = NULL;
+    uint8_t *image;
+    size_t image_size;
+    int result;
+
+    if (!source)
+    {
+        return FAIL;
+    }
+    if (!output)
+    {
+        default_output = scenario_binary_path(source);
+        if (!default_output)
+        {
+            return FAIL;
+        }
+        output = default_output;
+    }
+
+    result = scenario_build(source, &image, &image_size);
+    if (SUCCESS == result)
+    {
+        result = scenario_write(output, image, image_size);
+        if (SUCCESS == result)
+        {
+            LOG_INFO("Scenario", "Compiled %s into %s (%u phases)", source, output,
+                     ((const ScenarioHeader *)image)->phase_count);
+        }
+        else
+        {
+            LOG_ERROR("Scenario", "Could not write %s: %s", output, strerror(errno));
+        }
+        free(image);
+    }
+    free(default_output);
+    return result;
+}
+
+int Scenario_load(Scenario *scenario, const char *path)
+{
+    char *compiled;
+    uint8_t *image;
+    size_t image_size;
+
+    if (!scenario || !path)
+    {
+        return FAIL;
+    }
+    memset(scenario, 0, sizeof(*scenario));
+
+    if (scenario_is_binary(path))
+    {
+        return scenario_map(scenario, path);
+    }
+
+    compiled = scenario_binary_path(path);
+    if (!compiled)
+    {
+        return FAIL;
+    }
+    if (scenario_is_up_to_date(path, compiled) && SUCCESS == scenario_map(scenario, compiled))
+    {
+        free(compiled);
+        return SUCCESS;
+    }
+
+    if (SUCCESS != scenario_build(path, &image, &image_size))
+    {
+        free(compiled);
+        return FAIL;
+    }
+    if (SUCCESS != scenario_write(compiled, image, image_size))
+    {
+        LOG_WARN("Scenario", "Could not write %s, %s will be parsed at every load", compiled, path);
+    }
+    free(compiled);
+
+    if (SUCCESS != scenario_attach(scenario, image, image_size, false))
+    {
+        free(image);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+void Scenario_unload(Scenario *scenario)
+{
+    if (scenario && scenario->image)
+    {
+        if (scenario->mapped)
+        {
+            munmap((void *)scenario->image, scenario->image_size);
+        }
+        else
+        {
+            free((void *)scenario->image);
+        }
+        memset(scenario, 0, sizeof(*scenario));
+    }
+}
+
+/* FNV-1a over the compiled image */
+static uint64_t scenario_hash(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static bool scenario_key_matches(const ScenarioCacheKey *key, const struct stat *st)
+{
+    return key->dev == st->st_dev && key->ino == st->st_ino && key->size == st->st_size &&
+           key->mtime.tv_sec == st->st_mtim.tv_sec && key->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static ScenarioCacheKey *scenario_cache_find_key(const char *path)
+{
+    for (ScenarioCacheKey *key = scenario_cache_keys; key; key = key->next)
+    {
+        if (0 == strcmp(key->path, path))
+        {
+            return key;
+        }
+    }
+    return NULL;
+}
+
+static void scenario_cache_free_image(ScenarioCacheImage *image)
+{
+    for (ScenarioCacheImage **link = &scenario_cache_images; *link; link = &(*link)->next)
+    {
+        if (*link == image)
+        {
+            *link = image->next;
+            break;
+        }
+    }
+    Scenario_unload(&image->scenario);
+    free(image);
+}
+
+/* Forgets a file, its image goes when nothing else uses it */
+static void scenario_cache_drop_key(ScenarioCacheKey *key)
+{
+    ScenarioCacheImage *image = key->image;
+
+    for (ScenarioCacheKey **link = &scenario_cache_keys; *link; link = &(*link)->next)
+    {
+        if (*link == key)
+        {
+            *link = key->next;
+            break;
+        }
+    }
+    free(key->path);
+    free(key);
+
+    if (0 == --image->keys && 0 == image->refs)
+    {
+        scenario_cache_free_image(image);
+    }
+}
+
+/* Frees an unused image and the keys leading to it */
+static void scenario_cache_evict(ScenarioCacheImage *image)
+{
+    ScenarioCacheKey **link = &scenario_cache_keys;
+
+    while (*link)
+    {
+        ScenarioCacheKey *key = *link;
+
+        if (key->image == image)
+        {
+            *link = key->next;
+            free(key->path);
+            free(key);
+        }
+        else
+        {
+            link = &key->next;
+        }
+    }
+    scenario_cache_free_image(image);
+}
+
+/* Keeps at most max_idle unused images, the least recently used go first */
+static void scenario_cache_trim(int max_idle)
+{
+    for (;;)
+    {
+        ScenarioCacheImage *oldest = NULL;
+        int idle = 0;
+
+        for (ScenarioCacheImage *image = scenario_cache_images; image; image = image->next)
+        {
+            if (0 == image->refs)
+            {
+                idle++;
+                if (!oldest || image->last_used < oldest->last_used)
+                {
+                    oldest = image;
+                }
+            }
+        }
+        if (idle <= max_idle)
+        {
+            return;
+        }
+        scenario_cache_evict(oldest);
+    }
+}
+
+const Scenario *Scenario_acquire(const char *path)
+{
+    ScenarioCacheImage *image = NULL;
+    ScenarioCacheKey *key;
+    Scenario loaded;
+    struct stat st;
+    uint64_t hash;
+
+    if (!path || 0 != stat(path, &st))
+    {
+        LOG_ERROR("Scenario", "Could not access scenario %s", path ? path : "(null)");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&scenario_cache_lock);
+    key = scenario_cache_find_key(path);
+    if (key && scenario_key_matches(key, &st))
+    {
+        key->image->refs++;
+        pthread_mutex_unlock(&scenario_cache_lock);
+        return &key->image->scenario;
+    }
+    pthread_mutex_unlock(&scenario_cache_lock);
+
+    // Loaded without the lock: a compile can take a while. The key is the status seen before
+    // loading, a file modified meanwhile is loaded again by the next call.
+    if (SUCCESS != Scenario_load(&loaded, path))
+    {
+        return NULL;
+    }
+    hash = scenario_hash(loaded.image, loaded.image_size);
+
+    pthread_mutex_lock(&scenario_cache_lock);
+    for (ScenarioCacheImage *cached = scenario_cache_images; cached; cached = cached->next)
+    {
+        if (cached->hash == hash && cached->scenario.image_size == loaded.image_size &&
+            0 == memcmp(cached->scenario.image, loaded.image, loaded.image_size))
+        {
+            image = cached;
+            break;
+        }
+    }
+    if (image)
+    {
+        LOG_INFO("Scenario", "%s: same content as a cached scenario, shared", path);
+        Scenario_unload(&loaded);
+    }
+    else
+    {
+        image = (ScenarioCacheImage *)calloc(1, sizeof(ScenarioCacheImage));
+        if (!image)
+        {
+            pthread_mutex_unlock(&scenario_cache_lock);
+            LOG_ERROR("Scenario", "Memory allocation failed for the cache of %s", path);
+            Scenario_unload(&loaded);
+            return NULL;
+        }
+        image->scenario = loaded;
+        image->hash = hash;
+        image->next = scenario_cache_images;
+        scenario_cache_images = image;
+    }
+    image->refs++;
+
+    // Replaces the key of an older version of the file (or of a concurrent load)
+    key = scenario_cache_find_key(path);
+    if (key)
+    {
+        scenario_cache_drop_key(key);
+    }
+    key = (ScenarioCacheKey *)calloc(1, sizeof(ScenarioCacheKey));
+    if (key)
+    {
+        key->path = strdup(path);
+    }
+    if (key && key->path)
+    {
+        key->dev = st.st_dev;
+        key->ino = st.st_ino;
+        key->size = st.st_size;
+        key->mtime = st.st_mtim;
+        key->image = image;
+        key->next = scenario_cache_keys;
+        scenario_cache_keys = key;
+        image->keys++;
+    }
+    else
+    {
+        // Still usable, only not found by path next time
+        free(key);
+    }
+    pthread_mutex_unlock(&scenario_cache_lock);
+    return &image->scenario;
+}
+
+void Scenario_retain(const Scenario *scenario)
+{
+    ScenarioCacheImage *image = (ScenarioCacheImage *)scenario;
+
+    if (!image)
+    {
+        return;
+    }
+    pthread_mutex_lock(&scenario_cache_lock);
+    image->refs++;
+    pthread_mutex_unlock(&scenario_cache_lock);
+}
+
+void Scenario_release(const Scenario *scenario)
+{
+    ScenarioCacheImage *image = (ScenarioCacheImage *)scenario;
+
+    if (!image)
+    {
+        return;
+    }
+    pthread_mutex_lock(&scenario_cache_lock);
+    image->last_used = ++scenario_cache_clock;
+    if (0 == --image->refs)
+    {
+        if (0 == image->keys)
+        {
+            scenario_cache_free_image(image);
+        }
+        else
+        {
+            scenario_cache_trim(SCENARIO_CACHE_MAX_IDLE);
+        }
+    }
+    pthread_mutex_unlock(&scenario_cache_lock);
+}
+
+void Scenario_cache_clear(void)
+{
+    pthread_mutex_lock(&scenario_cache_lock);
+    scenario_cache_trim(0);
+    pthread_mutex_unlock(&scenario_cache_lock);
+}
@@ -10,11 +10,15 @@
 #include "SV_Publisher.h"
 #include "parser.h"
 #include <errno.h>
+#include <string.h>
 #include <signal.h>
 #include "Goose_Listener.h"
+#include "Latency_Engine.h"
+#include "Goose_LoadGen.h"
 static state_machine_t sm_data_internal;
 static EventQueue event_queue_internal;
 static pthread_t sm_thread_internal;
+#define STATE_MACHINE_EVENT_QUEUE_CAPACITY EVENT_QUEUE_DEFAULT_CAPACITY
 #define FAIL -1
 #define SUCCESS 0
 volatile int global_shutdown_requested = 0;
@@ -33,6 +37,9 @@ static bool state_stop_init(void *data);
 static bool state_stop_enter(void *data, state_e from, state_event_e event, const char *requestId);
 
 static void state_enter(state_machine_t *sm, state_e to, state_e from, state_event_e event, const char *requestId, cJSON *data_obj);
+static void state_report_latency(const char *requestId, cJSON *data_obj);
+static void state_goose_load(const char *requestId, cJSON *data_obj);
+static void state_swap_scenario(state_e current, const char *requestId, cJSON *data_obj);
 
 static void state_machine_free(state_machine_t *sm)
 {
@@ -99,6 +106,24 @@ static int state_machine_run(state_machine_t *sm, state_event_e event, const cha
         retval = SUCCESS;
     }
 
+    // Statistics requests are answered in every state, without a transition
+    if (STATE_EVENT_get_latency == event)
+    {
+        state_report_latency(requestId, data_obj);
+        return retval;
+    }
+    if (STATE_EVENT_send_goose == event)
+    {
+        state_goose_load(requestId, data_obj);
+        return retval;
+    }
+    // Scenario hot swap: the simulation keeps running, no transition
+    if (STATE_EVENT_swap_scenario == event)
+    {
+        state_swap_scenario(sm->current_state, requestId, data_obj);
+        return retval;
+    }
+
     state_e current = sm->current_state;
     state_e next = current;
 
@@ -114,10 +139,6 @@ static int state_machine_run(state_machine_t *sm, state_event_e event, const cha
         {
             next = STATE_STOP;
         }
-        else if (STATE_EVENT_send_goose == event)
-        {
-            LOG_ERROR("State_Machine", "send_goose event received in IDLE state, but not handled");
-        }
         break;
     case STATE_INIT:
         if (STATE_EVENT_init_success == event)
@@ -274,6 +295,10 @@ static bool state_init_enter(void *data, state_e from, state_event_e event, cons
             else
             {
                 LOG_INFO("State_Machine", "SV Publisher initialized successfully ");
+                if (SUCCESS != Latency_init(array_size))
+                {
+                    LOG_ERROR("State_Machine", "Trip latency measurement not available");
+                }
                 // If SVPublisher_init succeeds, it is now responsible for managing svconfig_tab memory
                 // So, we set svconfig_tab to NULL to prevent double freeing in cleanup
 
@@ -318,7 +343,7 @@ static bool state_init_enter(void *data, state_e from, state_event_e event, cons
             char *response_str = cJSON_PrintUnformatted(json_response);
             if (response_str)
             {
-                if (ipc_send_response(response_str) == FAIL)
+                if (ipc_send_reply(requestId, response_str) == FAIL)
                 {
                     LOG_ERROR("State_Machine", "Failed to send response: %s", response_str);
                 }
@@ -408,7 +433,7 @@ static bool state_running_enter(void *data, state_e from, state_event_e event, c
         char *response_str = cJSON_PrintUnformatted(json_response);
         if (response_str)
         {
-            if (ipc_send_response(response_str) == FAIL)
+            if (ipc_send_reply(requestId, response_str) == FAIL)
             {
                 LOG_ERROR("State_Machine", "Failed to send response: %s", response_str);
             }
@@ -441,6 +466,17 @@ static bool state_stop_enter(void *data, state_e from, state_event_e event, cons
     SVPublisher_stop();
 
     LOG_INFO("State_Machine", "SV Publisher stopped in STOP state.");
+    for (int i = 0; i < Latency_get_instance_count(); i++)
+    {
+        LatencyStats stats;
+        if (SUCCESS == Latency_get_stats(i, &stats))
+        {
+            LOG_INFO("State_Machine", "Instance %d trip latency: %llu/%llu faults answered, min %llu p50 %llu p99 %llu p99.9 %llu max %llu ns",
+                     i, (unsigned long long)stats.samples, (unsigned long long)stats.injections,
+                     (unsigned long long)stats.min_ns, (unsigned long long)stats.p50_ns, (unsigned long long)stats.p99_ns,
+                     (unsigned long long)stats.p999_ns, (unsigned long long)stats.max_ns);
+        }
+    }
 // Trigger cleanup of Goose listeners
 
     printf("state_stop_enter ::Goose receiver cleanup started\n");
@@ -471,7 +507,7 @@ static bool state_stop_enter(void *data, state_e from, state_event_e event, cons
     char *response_str = cJSON_PrintUnformatted(json_response);
     if (response_str)
     {
-        if (ipc_send_response(response_str) == FAIL)
+        if (ipc_send_reply(requestId, response_str) == FAIL)
         {
             LOG_ERROR("State_Machine", "Failed to send response: %s", response_str);
         }
@@ -489,6 +525,259 @@ static bool state_stop_enter(void *data, state_e from, state_event_e event, cons
     cJSON_Delete(json_response); // Free the cJSON object
 }
 
+// Reply with the trip latency statistics of every instance, then clear them if "reset" is true
+static void state_report_latency(const char *requestId, cJSON *data_obj)
+{
+    cJSON *json_response = cJSON_CreateObject();
+    if (!json_response)
+    {
+        LOG_ERROR("State_Machine", "Failed to create JSON response object for latency report.");
+        return;
+    }
+    cJSON_AddStringToObject(json_response, "status", "latency");
+    if (requestId)
+    {
+        cJSON_AddStringToObject(json_response, "requestId", requestId);
+    }
+
+    cJSON *instances_json = cJSON_CreateArray();
+    cJSON_AddItemToObject(json_response, "instances", instances_json);
+    for (int i = 0; i < Latency_get_instance_count(); i++)
+    {
+        LatencyStats stats;
+        cJSON *instance_json;
+
+        if (SUCCESS != Latency_get_stats(i, &stats) || NULL == (instance_json = cJSON_CreateObject()))
+        {
+            continue;
+        }
+        cJSON_AddNumberToObject(instance_json, "instance", i);
+        cJSON_AddNumberToObject(instance_json, "injections", (double)stats.injections);
+        cJSON_AddNumberToObject(instance_json, "samples", (double)stats.samples);
+        cJSON_AddNumberToObject(instance_json, "missed", (double)stats.missed);
+        cJSON_AddNumberToObject(instance_json, "spurious", (double)stats.spurious);
+        cJSON_AddNumberToObject(instance_json, "kernelTimestamped", (double)stats.kernel_timestamped);
+        cJSON_AddNumberToObject(instance_json, "lastSmpCnt", stats.last_smp_cnt);
+        cJSON_AddNumberToObject(instance_json, "last_ns", (double)stats.last_ns);
+        cJSON_AddNumberToObject(instance_json, "min_ns", (double)stats.min_ns);
+        cJSON_AddNumberToObject(instance_json, "mean_ns", (double)stats.mean_ns);
+        cJSON_AddNumberToObject(instance_json, "p50_ns", (double)stats.p50_ns);
+        cJSON_AddNumberToObject(instance_json, "p99_ns", (double)stats.p99_ns);
+        cJSON_AddNumberToObject(instance_json, "p999_ns", (double)stats.p999_ns);
+        cJSON_AddNumberToObject(instance_json, "max_ns", (double)stats.max_ns);
+
+        SVPipelineStats pipeline;
+        if (SUCCESS == SVPublisher_get_pipeline_stats(i, &pipeline))
+        {
+            cJSON_AddNumberToObject(instance_json, "ringCapacity", pipeline.ring_capacity);
+            cJSON_AddNumberToObject(instance_json, "ringOccupancy", pipeline.ring_occupancy);
+            cJSON_AddNumberToObject(instance_json, "ringLowWater", pipeline.ring_low_water);
+            cJSON_AddNumberToObject(instance_json, "lateFrames", (double)pipeline.late_frames);
+            cJSON_AddNumberToObject(instance_json, "launchErrors", (double)pipeline.launch_errors);
+            cJSON_AddNumberToObject(instance_json, "scenarioSwaps", (double)pipeline.scenario_swaps);
+        }
+
+        SVPhaseTransition transitions[SV_TRANSITION_LOG_SIZE];
+        int transition_count = SVPublisher_get_transitions(i, transitions, SV_TRANSITION_LOG_SIZE);
+        if (transition_count >= 0)
+        {
+            cJSON *transitions_json = cJSON_CreateArray();
+            cJSON_AddItemToObject(instance_json, "transitions", transitions_json);
+            for (int t = 0; t < transition_count; t++)
+            {
+                cJSON *transition_json = cJSON_CreateObject();
+                cJSON_AddNumberToObject(transition_json, "phase", transitions[t].phase);
+                cJSON_AddNumberToObject(transition_json, "play", transitions[t].play);
+                cJSON_AddNumberToObject(transition_json, "smpCnt", transitions[t].smp_cnt);
+                cJSON_AddNumberToObject(transition_json, "sample", (double)transitions[t].sample_number);
+                cJSON_AddNumberToObject(transition_json, "timestamp_ns", (double)transitions[t].timestamp_ns);
+                cJSON_AddItemToArray(transitions_json, transition_json);
+            }
+        }
+        cJSON_AddItemToArray(instances_json, instance_json);
+    }
+
+    cJSON *reset_obj = data_obj ? cJSON_GetObjectItemCaseSensitive(data_obj, "reset") : NULL;
+    if (cJSON_IsTrue(reset_obj))
+    {
+        Latency_reset();
+    }
+
+    char *response_str = cJSON_PrintUnformatted(json_response);
+    if (response_str)
+    {
+        if (ipc_send_reply(requestId, response_str) == FAIL)
+        {
+            LOG_ERROR("State_Machine", "Failed to send response: %s", response_str);
+        }
+        free(response_str);
+    }
+    else
+    {
+        LOG_ERROR("State_Machine", "Failed to serialize JSON response in latency report.");
+    }
+    cJSON_Delete(json_response);
+}
+
+// Load generator control: data "action" is "start" (default), "stop" or "report"; start takes the
+// GOOSE configuration and the load profile (publishers, eventRate, burstSize, burstIntervalMs,
+// dataSetSize, minTime, maxTime, durationMs)
+static void state_goose_load(const char *requestId, cJSON *data_obj)
+{
+    int result = SUCCESS;
+    cJSON *config_obj = cJSON_IsArray(data_obj) ? cJSON_GetArrayItem(data_obj, 0) : data_obj;
+    cJSON *action_obj = config_obj ? cJSON_GetObjectItemCaseSensitive(config_obj, "action") : NULL;
+    const char *action = cJSON_IsString(action_obj) ? action_obj->valuestring : "start";
+
+    if (strcmp(action, "start") == 0)
+    {
+        GOOSE_SimulationConfig config;
+        GooseLoadProfile profile;
+
+        memset(&config, 0, sizeof(config));
+        Goose_LoadGen_default_profile(&profile);
+        if (!config_obj || SUCCESS != parseGOOSEConfig(&config_obj, &config))
+        {
+            result = FAIL;
+        }
+        else
+        {
+            const char *keys[] = {"publishers", "eventRate", "burstSize", "burstIntervalMs",
+                                  "dataSetSize", "minTime", "maxTime", "durationMs"};
+            for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+            {
+                cJSON *number_obj = cJSON_GetObjectItemCaseSensitive(config_obj, keys[i]);
+                if (!cJSON_IsNumber(number_obj))
+                {
+                    continue;
+                }
+                double value = number_obj->valuedouble < 0 ? 0 : number_obj->valuedouble;
+                switch (i)
+                {
+                case 0: profile.publishers = (int)value; break;
+                case 1: profile.event_rate_hz = value; break;
+                case 2: profile.burst_size = (uint32_t)value; break;
+                case 3: profile.burst_interval_ms = (uint32_t)value; break;
+                case 4: profile.data_set_size = (int)value; break;
+                case 5: profile.min_time_ms = (uint32_t)value; break;
+                case 6: profile.max_time_ms = (uint32_t)value; break;
+                case 7: profile.duration_ms = (uint32_t)value; break;
+                }
+            }
+            result = Goose_LoadGen_start(&config, &profile);
+            freeGOOSEConfig(&config);
+        }
+    }
+    else if (strcmp(action, "stop") == 0)
+    {
+        Goose_LoadGen_stop();
+    }
+    else if (strcmp(action, "report") != 0)
+    {
+        LOG_ERROR("State_Machine", "Unknown GOOSE load action: %s", action);
+        result = FAIL;
+    }
+
+    cJSON *json_response = cJSON_CreateObject();
+    if (!json_response)
+    {
+        LOG_ERROR("State_Machine", "Failed to create JSON response object for GOOSE load report.");
+        return;
+    }
+    cJSON_AddStringToObject(json_response, "status", SUCCESS == result ? "goose_load" : "goose_load_failed");
+    if (requestId)
+    {
+        cJSON_AddStringToObject(json_response, "requestId", requestId);
+    }
+
+    GooseLoadStats stats;
+    if (SUCCESS == Goose_LoadGen_get_stats(&stats))
+    {
+        cJSON_AddBoolToObject(json_response, "running", stats.running);
+        cJSON_AddNumberToObject(json_response, "publishers", stats.publishers);
+        cJSON_AddNumberToObject(json_response, "elapsedMs", (double)stats.elapsed_ms);
+        cJSON_AddNumberToObject(json_response, "sent", (double)stats.sent);
+        cJSON_AddNumberToObject(json_response, "sendErrors", (double)stats.send_errors);
+        cJSON_AddNumberToObject(json_response, "stateChanges", (double)stats.state_changes);
+        cJSON_AddNumberToObject(json_response, "batches", (double)stats.batches);
+        cJSON_AddNumberToObject(json_response, "msgsPerSec", stats.msgs_per_s);
+        cJSON_AddNumberToObject(json_response, "currentMsgsPerSec", stats.current_msgs_per_s);
+        cJSON_AddNumberToObject(json_response, "slipMean_ns", (double)stats.slip_mean_ns);
+        cJSON_AddNumberToObject(json_response, "slipP99_ns", (double)stats.slip_p99_ns);
+        cJSON_AddNumberToObject(json_response, "slipMax_ns", (double)stats.slip_max_ns);
+    }
+
+    char *response_str = cJSON_PrintUnformatted(json_response);
+    if (response_str)
+    {
+        if (ipc_send_reply(requestId, response_str) == FAIL)
+        {
+            LOG_ERROR("State_Machine", "Failed to send response: %s", response_str);
+        }
+        free(response_str);
+    }
+    else
+    {
+        LOG_ERROR("State_Machine", "Failed to serialize JSON response in GOOSE load report.");
+    }
+    cJSON_Delete(json_response);
+}
+
+// Scenario hot swap: data "scenarioConfigFile" is played from its first phase by the instance
+// "instance" (every instance when absent) at its next frame, without stopping the SV stream
+static void state_swap_scenario(state_e current, const char *requestId, cJSON *data_obj)
+{
+    int result = FAIL;
+    int instance = -1;
+    cJSON *config_obj = cJSON_IsArray(data_obj) ? cJSON_GetArrayItem(data_obj, 0) : data_obj;
+    cJSON *file_obj = config_obj ? cJSON_GetObjectItemCaseSensitive(config_obj, "scenarioConfigFile") : NULL;
+    cJSON *instance_obj = config_obj ? cJSON_GetObjectItemCaseSensitive(config_obj, "instance") : NULL;
+
+    if (cJSON_IsNumber(instance_obj))
+    {
+        instance = instance_obj->valueint;
+    }
+    if (STATE_RUNNING != current)
+    {
+        LOG_ERROR("State_Machine", "Scenario swap requested while no simulation is running");
+    }
+    else if (!cJSON_IsString(file_obj))
+    {
+        LOG_ERROR("State_Machine", "Scenario swap without scenarioConfigFile");
+    }
+    else
+    {
+        result = SVPublisher_swap_scenario(instance, file_obj->valuestring);
+    }
+
+    cJSON *json_response = cJSON_CreateObject();
+    if (!json_response)
+    {
+        LOG_ERROR("State_Machine", "Failed to create JSON response object for scenario swap.");
+        return;
+    }
+    cJSON_AddStringToObject(json_response, "status", SUCCESS == result ? "scenario_swapped" : "scenario_swap_failed");
+    if (requestId)
+    {
+        cJSON_AddStringToObject(json_response, "requestId", requestId);
+    }
+    cJSON_AddNumberToObject(json_response, "instance", instance);
+
+    char *response_str = cJSON_PrintUnformatted(json_response);
+    if (response_str)
+    {
+        if (ipc_send_reply(requestId, response_str) == FAIL)
+        {
+            LOG_ERROR("State_Machine", "Failed to send response: %s", response_str);
+        }
+        free(response_str);
+    }
+    else
+    {
+        LOG_ERROR("State_Machine", "Failed to serialize JSON response in scenario swap.");
+    }
+    cJSON_Delete(json_response);
+}
 
 static void *state_machine_thread_internal(void *arg)
 {
@@ -573,7 +862,7 @@ int StateMachine_Launch(int (*shutdown_check_func)(void))
     }
     sm_data_internal.shutdown_check_func = shutdown_check_func;
     // to be modified
-    if (SUCCESS != event_queue_init(&event_queue_internal))
+    if (SUCCESS != event_queue_init(&event_queue_internal, STATE_MACHINE_EVENT_QUEUE_CAPACITY))
     {
 
         LOG_ERROR("State_Machine", "Failed to initialize event queue in module");
@@ -591,54 +880,80 @@ int StateMachine_Launch(int (*shutdown_check_func)(void))
     }
 }
 
-int StateMachine_push_event(state_event_e event, const char *requestId, cJSON *data_obj)
+int StateMachine_post_event(state_event_e event, char *requestId, cJSON *data_obj)
 {
-    int result_event_queue_push = SUCCESS;
     if (event == STATE_EVENT_NONE)
     {
         LOG_ERROR("State_Machine", "Attempted to push an event with STATE_EVENT_NONE");
+        free(requestId);
+        cJSON_Delete(data_obj);
         return EXIT_FAILURE; // Invalid event
     }
 
-    if (event_queue_internal.shutdown)
+    // Logged before the push: once queued, requestId belongs to the state machine thread and can be freed
+    LOG_INFO("State_Machine", "Pushing event: %s, requestId: %s",
+             state_event_to_string(event), requestId ? requestId : "N/A");
+    if (SUCCESS != event_queue_push(event, requestId, &event_queue_internal, data_obj))
     {
-        LOG_ERROR("State_Machine", "Event queue is shutting down, cannot push event: %s", state_event_to_string(event));
-        return EXIT_FAILURE; // Queue is shutting down
+        LOG_ERROR("State_Machine", "Event queue full or shutting down, dropping event: %s, requestId: %s",
+                  state_event_to_string(event), requestId ? requestId : "N/A");
+        free(requestId);
+        cJSON_Delete(data_obj);
+        return FAIL;
     }
+    return SUCCESS;
+}
 
-    if (NULL != data_obj)
-    {
-
-        int result_event_queue_push = event_queue_push(event, requestId, &event_queue_internal, data_obj);
+int StateMachine_push_event(state_event_e event, const char *requestId, cJSON *data_obj)
+{
+    char *requestId_copy = NULL;
+    cJSON *data_copy = NULL;
 
-        LOG_INFO("State_Machine", "Pushing event: %s, requestId: %s",
-                 state_event_to_string(event), requestId ? requestId : "N/A");
-        printf("StateMachine::StateMachine_push_event ::Pushing event: %s, requestId: %s\n",
-               state_event_to_string(event), requestId ? requestId : "N/A");
+    // The caller keeps its objects: hand copies over to the queue
+    if (requestId)
+    {
+        requestId_copy = strdup(requestId);
+        if (!requestId_copy)
+        {
+            LOG_ERROR("State_Machine", "strdup failed for requestId");
+            return FAIL;
+        }
     }
-    else
+    if (data_obj)
     {
-        result_event_queue_push = event_queue_push(event, requestId, &event_queue_internal, data_obj);
-        LOG_INFO("State_Machine", " Pushing event without data: %s, requestId: %s",
-                 state_event_to_string(event), requestId ? requestId : "N/A");
+        data_copy = cJSON_Duplicate(data_obj, 1);
+        if (!data_copy)
+        {
+            LOG_ERROR("State_Machine", "Failed to duplicate JSON data");
+            free(requestId_copy);
+            return FAIL;
+        }
     }
 
-    return result_event_queue_push;
+    return StateMachine_post_event(event, requestId_copy, data_copy);
+}
+
+int StateMachine_signal_event(state_event_e event)
+{
+    // No logging and no allocation here: called from signal handlers
+    return event_queue_push(event, NULL, &event_queue_internal, NULL);
 }
 
 int StateMachine_shutdown(void)
 {
     LOG_INFO("State_Machine", "Shutting down StateMachine module...");
-    event_queue_internal.shutdown = EXIT_FAILURE;                // Set shutdown flag to true
-    int c1 = pthread_cond_signal(&event_queue_internal.cond);    // Signal to wake up the thread
-    int c2 = pthread_join(sm_thread_internal, NULL);             // Wait for the thread to finish
-    int c3 = pthread_mutex_destroy(&event_queue_internal.mutex); // Cleanup mutex
-    int c4 = pthread_cond_destroy(&event_queue_internal.cond);   // Cleanup cond var
+    EventQueueStats stats;
+    int c1 = event_queue_shutdown(&event_queue_internal);    // Wake up the thread
+    int c2 = pthread_join(sm_thread_internal, NULL);         // Wait for the thread to finish
+
+    event_queue_get_stats(&event_queue_internal, &stats);
+    LOG_INFO("State_Machine", "Event queue: capacity %zu, high-water %zu, dropped %llu",
+             stats.capacity, stats.high_water, (unsigned long long)stats.dropped);
+    event_queue_destroy(&event_queue_internal);              // Free the events left in the queue
     LOG_INFO("State_Machine", "StateMachine module shutdown complete.");
-    if (c1 != 0 || c2 != 0 || c3 != 0 || c4 != 0)
+    if (c1 != 0 || c2 != 0)
     {
-        LOG_ERROR("State_Machine", "Error during StateMachine shutdown: cond_signal=%d, join=%d, mutex_destroy=%d, cond_destroy=%d",
-                  c1, c2, c3, c4);
+        LOG_ERROR("State_Machine", "Error during StateMachine shutdown: queue_shutdown=%d, join=%d", c1, c2);
         return EXIT_FAILURE; // Indicate failure
     }
 
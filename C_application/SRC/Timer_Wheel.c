@@ -0,0 +1,174 @@
+#include "Timer_Wheel.h"
+#include "logger.h"
+#include "util.h"
+#include <stdlib.h>
+
+static void timer_wheel_unlink(TimerWheel *wheel, TimerWheelEntry *entry)
+{
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->next = NULL;
+    entry->prev = NULL;
+    entry->scheduled = false;
+    wheel->count--;
+}
+
+int TimerWheel_init(TimerWheel *wheel, uint32_t slot_count, uint64_t tick_ns, uint64_t start_ns)
+{
+    uint32_t size = 1;
+
+    if (wheel == NULL || slot_count == 0 || slot_count > (1u << 30) || tick_ns == 0)
+    {
+        LOG_ERROR("Timer_Wheel", "Invalid wheel parameters (%u slots, tick %llu ns)", slot_count,
+                  (unsigned long long)tick_ns);
+        return FAIL;
+    }
+    while (size < slot_count)
+    {
+        size <<= 1;
+    }
+
+    wheel->slots = (TimerWheelEntry *)calloc(size, sizeof(TimerWheelEntry));
+    if (!wheel->slots)
+    {
+        LOG_ERROR("Timer_Wheel", "Memory allocation failed for %u slots", size);
+        return FAIL;
+    }
+    /* Each slot is the head of a circular doubly linked list */
+    for (uint32_t i = 0; i < size; i++)
+    {
+        wheel->slots[i].next = &wheel->slots[i];
+        wheel->slots[i].prev = &wheel->slots[i];
+    }
+    wheel->slot_mask = size - 1;
+    wheel->tick_ns = tick_ns;
+    wheel->start_ns = start_ns;
+    wheel->current_tick = 0;
+    wheel->count = 0;
+    return SUCCESS;
+}
+
+void TimerWheel_destroy(TimerWheel *wheel)
+{
+    if (wheel)
+    {
+        free(wheel->slots);
+        wheel->slots = NULL;
+        wheel->count = 0;
+    }
+}
+
+void TimerWheel_schedule(TimerWheel *wheel, TimerWheelEntry *entry, uint64_t due_ns)
+{
+    if (entry->scheduled)
+    {
+        timer_wheel_unlink(wheel, entry);
+    }
+
+    /* Round up: a timer never expires before its time */
+    uint64_t tick = 0;
+    if (due_ns > wheel->start_ns)
+    {
+        tick = (due_ns - wheel->start_ns + wheel->tick_ns - 1) / wheel->tick_ns;
+    }
+    if (tick <= wheel->current_tick)
+    {
+        tick = wheel->current_tick + 1;
+    }
+
+    TimerWheelEntry *head = &wheel->slots[tick & wheel->slot_mask];
+    entry->due_ns = due_ns;
+    entry->due_tick = tick;
+    entry->next = head;
+    entry->prev = head->prev;
+    head->prev->next = entry;
+    head->prev = entry;
+    entry->scheduled = true;
+    wheel->count++;
+}
+
+void TimerWheel_cancel(TimerWheel *wheel, TimerWheelEntry *entry)
+{
+    if (entry->scheduled)
+    {
+        timer_wheel_unlink(wheel, entry);
+    }
+}
+
+int TimerWheel_advance(TimerWheel *wheel, uint64_t now_ns, timer_wheel_expiry_t expire, void *context)
+{
+    int expired = 0;
+
+    if (now_ns < wheel->start_ns)
+    {
+        return 0;
+    }
+
+    uint64_t now_tick = (now_ns - wheel->start_ns) / wheel->tick_ns;
+    if (now_tick <= wheel->current_tick)
+    {
+        return 0;
+    }
+
+    /* After a long stall every slot is visited once, not once per elapsed tick: only the last
+       revolution is walked, its slots hold every timer due up to now_tick */
+    uint64_t tick = wheel->current_tick;
+    if (now_tick - tick > (uint64_t)wheel->slot_mask + 1)
+    {
+        tick = now_tick - ((uint64_t)wheel->slot_mask + 1);
+    }
+
+    while (tick < now_tick)
+    {
+        tick++;
+        /* Callbacks see the slot being drained as the current tick: a timer they schedule lands
+           in a later slot, visited by this loop when it is due by now_tick */
+        wheel->current_tick = tick;
+
+        TimerWheelEntry *head = &wheel->slots[tick & wheel->slot_mask];
+        TimerWheelEntry pending;
+
+        if (head->next == head)
+        {
+            continue;
+        }
+        /* Detach the slot: a callback may schedule or cancel any timer, including
+           the ones still pending in this slot */
+        pending.next = head->next;
+        pending.prev = head->prev;
+        pending.next->prev = &pending;
+        pending.prev->next = &pending;
+        head->next = head;
+        head->prev = head;
+
+        while (pending.next != &pending)
+        {
+            TimerWheelEntry *entry = pending.next;
+
+            /* Timers of a later revolution go back to the slot */
+            if (entry->due_tick <= now_tick)
+            {
+                timer_wheel_unlink(wheel, entry);
+                expire(entry, entry->due_ns, context);
+                expired++;
+            }
+            else
+            {
+                entry->prev->next = entry->next;
+                entry->next->prev = entry->prev;
+                entry->next = head;
+                entry->prev = head->prev;
+                head->prev->next = entry;
+                head->prev = entry;
+            }
+        }
+    }
+
+    wheel->current_tick = now_tick;
+    return expired;
+}
+
+uint64_t TimerWheel_next_tick_ns(const TimerWheel *wheel)
+{
+    return wheel->start_ns + (wheel->current_tick + 1) * wheel->tick_ns;
+}
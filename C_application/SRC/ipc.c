@@ -1,3 +1,4 @@
+#define _GNU_SOURCE // accept4
 #include "ipc.h"
 #include "State_Machine.h"
 #include "logger.h"
@@ -6,440 +7,855 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
 #include <cjson/cJSON.h>
 #include <fcntl.h>
 #include <errno.h>
 #include "util.h"
 #include "parser.h"
+#include "IPC_Framing.h"
 #include <cjson/cJSON.h> // For cJSON parsing
+#include <pthread.h>
 #define SOCKET_PATH "/var/run/app.sv_simulator"
-#define BUFFER_SIZE 2048
-#define MAX_JSON_SIZE 65536 // Maximum expected JSON message size
-static int sock_fd = FAIL;
-static struct sockaddr_un server_addr;
-extern volatile bool internal_shutdown_flag;
-int is_complete_json(const char *buffer)
+// Local socket on which additional controllers (CLI, metrics scraper) can connect
+#ifndef IPC_LISTEN_PATH
+#define IPC_LISTEN_PATH "/var/run/app.sv_simulator.ctl"
+#endif
+#define BUFFER_SIZE 16384          // Minimum free space offered to each recv()
+#define MAX_JSON_SIZE (16 * 1024 * 1024) // Maximum accepted JSON message size
+#define IPC_MAX_CONNECTIONS 8      // Node.js backend + accepted controllers
+#define IPC_MAX_EVENTS 16
+#define IPC_OUTBOUND_LIMIT (4 * 1024 * 1024) // Pending output above which a connection is considered stuck
+#define IPC_ROUTE_SLOTS 64         // Remembered requestId -> connection routes
+#define IPC_ROUTE_ID_SIZE 64
+// Framing used on the controller sockets, the Node.js backend sends back-to-back JSON objects
+#ifndef IPC_FRAMING_MODE
+#define IPC_FRAMING_MODE IPC_FRAMING_JSON_STREAM
+#endif
+// Build with -DIPC_DUMP_RECEIVED_JSON to keep a copy of the last received message on disk
+#ifndef IPC_DUMP_FILE
+#define IPC_DUMP_FILE "received_json.txt"
+#endif
+// epoll tags of the non-connection descriptors, connections are tagged with their slot index
+#define IPC_TAG_WAKEUP 0xFFFFFFFFu
+#define IPC_TAG_LISTEN 0xFFFFFFFEu
+
+// Frame waiting in a connection outbound queue
+typedef struct IpcOutChunk {
+    struct IpcOutChunk *next;
+    size_t length;
+    size_t offset; // bytes already written
+    char data[];
+} IpcOutChunk;
+
+typedef struct {
+    int fd;           // FAIL when the slot is free
+    uint32_t id;      // unique for the process lifetime, slots are reused
+    bool primary;     // outgoing connection to the Node.js backend
+    bool want_write;  // EPOLLOUT armed
+    IpcFramer framer; // only used by the reactor thread
+    IpcOutChunk *out_head;
+    IpcOutChunk *out_tail;
+    size_t out_bytes;
+} IpcConnection;
+
+typedef struct {
+    char requestId[IPC_ROUTE_ID_SIZE];
+    uint32_t conn_id;
+} IpcRoute;
+
+// The reactor thread owns the receive side of the connections. The connection table,
+// the outbound queues and the routes are shared with the threads sending responses.
+static pthread_mutex_t ipc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static IpcConnection connections[IPC_MAX_CONNECTIONS];
+static IpcRoute routes[IPC_ROUTE_SLOTS];
+static unsigned int next_route = 0;
+static uint32_t next_conn_id = 1;
+static int epoll_fd = FAIL;
+static int wakeup_fd = FAIL;
+static int listen_fd = FAIL;
+
+static int ipc_release(void);
+#ifdef IPC_DUMP_RECEIVED_JSON
+// Debug dump of the last received message, written by a background thread so that
+// the file I/O never delays the control loop. Only the most recent message is kept.
+static pthread_t dump_thread;
+static bool dump_thread_started = false;
+static bool dump_thread_stop = false;
+static pthread_mutex_t dump_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dump_cond = PTHREAD_COND_INITIALIZER;
+static char *dump_pending = NULL;
+static size_t dump_pending_len = 0;
+
+static void *ipc_dump_thread(void *arg)
 {
-    int brace_count = 0;
-    int in_string = 0;
-    for (int i = 0; buffer[i] != '\0'; i++)
+    (void)arg;
+
+    pthread_mutex_lock(&dump_mutex);
+    while (!dump_thread_stop)
     {
-        if (buffer[i] == '\"')
+        if (!dump_pending)
         {
-            in_string = !in_string;
+            pthread_cond_wait(&dump_cond, &dump_mutex);
+            continue;
         }
-        else if (!in_string)
+
+        char *message = dump_pending;
+        size_t length = dump_pending_len;
+        dump_pending = NULL;
+        pthread_mutex_unlock(&dump_mutex);
+
+        FILE *fp = fopen(IPC_DUMP_FILE, "w");
+        if (fp != NULL)
         {
-            if (buffer[i] == '{')
-            {
-                brace_count++;
-            }
-            else if (buffer[i] == '}')
+            fwrite(message, 1, length, fp);
+            fclose(fp);
+        }
+        else
+        {
+            LOG_ERROR("IPC", "Failed to open %s for writing", IPC_DUMP_FILE);
+        }
+        free(message);
+
+        pthread_mutex_lock(&dump_mutex);
+    }
+    pthread_mutex_unlock(&dump_mutex);
+    return NULL;
+}
+
+static void ipc_dump_message(const char *message, size_t length)
+{
+    char *copy = (char *)malloc(length);
+    if (!copy)
+    {
+        return;
+    }
+    memcpy(copy, message, length);
+
+    pthread_mutex_lock(&dump_mutex);
+    if (!dump_thread_started)
+    {
+        dump_thread_stop = false;
+        dump_thread_started = (0 == pthread_create(&dump_thread, NULL, ipc_dump_thread, NULL));
+    }
+    free(dump_pending); // superseded before it was written
+    dump_pending = copy;
+    dump_pending_len = length;
+    pthread_cond_signal(&dump_cond);
+    pthread_mutex_unlock(&dump_mutex);
+}
+
+static void ipc_dump_stop(void)
+{
+    pthread_mutex_lock(&dump_mutex);
+    bool started = dump_thread_started;
+    dump_thread_stop = true;
+    dump_thread_started = false;
+    pthread_cond_signal(&dump_cond);
+    pthread_mutex_unlock(&dump_mutex);
+
+    if (started)
+    {
+        pthread_join(dump_thread, NULL);
+    }
+    free(dump_pending);
+    dump_pending = NULL;
+}
+#endif
+
+static void ipc_free_outbound(IpcConnection *conn)
+{
+    while (conn->out_head)
+    {
+        IpcOutChunk *next = conn->out_head->next;
+        free(conn->out_head);
+        conn->out_head = next;
+    }
+    conn->out_tail = NULL;
+    conn->out_bytes = 0;
+}
+
+static int ipc_epoll_update(IpcConnection *conn, int op)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | (conn->want_write ? EPOLLOUT : 0);
+    ev.data.u32 = (uint32_t)(conn - connections);
+    if (epoll_ctl(epoll_fd, op, conn->fd, &ev) < 0)
+    {
+        LOG_ERROR("IPC", "epoll_ctl failed on connection %u: %s", conn->id, strerror(errno));
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+// Register a connected socket, returns the connection or NULL when the table is full
+static IpcConnection *ipc_add_connection(int fd, bool primary)
+{
+    IpcConnection *conn = NULL;
+
+    pthread_mutex_lock(&ipc_mutex);
+    for (int i = 0; i < IPC_MAX_CONNECTIONS; i++)
+    {
+        if (connections[i].fd < 0)
+        {
+            conn = &connections[i];
+            break;
+        }
+    }
+
+    if (conn)
+    {
+        if (SUCCESS != ipc_framer_init(&conn->framer, IPC_FRAMING_MODE, MAX_JSON_SIZE))
+        {
+            conn = NULL;
+        }
+        else
+        {
+            conn->fd = fd;
+            conn->id = next_conn_id++;
+            conn->primary = primary;
+            conn->want_write = false;
+            if (SUCCESS != ipc_epoll_update(conn, EPOLL_CTL_ADD))
             {
-                brace_count--;
+                ipc_framer_free(&conn->framer);
+                conn->fd = FAIL;
+                conn = NULL;
             }
         }
     }
-    return brace_count == 0 && strchr(buffer, '{') != NULL && strchr(buffer, '}') != NULL;
+    pthread_mutex_unlock(&ipc_mutex);
+    return conn;
 }
 
-int ipc_init(void)
+// Close a connection, ipc_mutex must be held
+static void ipc_close_connection_locked(IpcConnection *conn)
 {
-    int RetVal = SUCCESS;
+    if (conn->fd < 0)
+    {
+        return;
+    }
 
-    sock_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sock_fd < 0)
+    LOG_INFO("IPC", "Closing connection %u%s", conn->id, conn->primary ? " (Node.js backend)" : "");
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = FAIL;
+    ipc_framer_free(&conn->framer);
+    ipc_free_outbound(conn);
+}
+
+static void ipc_close_connection(IpcConnection *conn)
+{
+    pthread_mutex_lock(&ipc_mutex);
+    ipc_close_connection_locked(conn);
+    pthread_mutex_unlock(&ipc_mutex);
+}
+
+static IpcConnection *ipc_find_connection_locked(uint32_t conn_id)
+{
+    for (int i = 0; i < IPC_MAX_CONNECTIONS; i++)
     {
-        LOG_ERROR("IPC", "Socket creation failed: %s", strerror(errno));
-        RetVal = FAIL;
+        if (connections[i].fd >= 0 && connections[i].id == conn_id)
+        {
+            return &connections[i];
+        }
     }
-    else
+    return NULL;
+}
+
+static IpcConnection *ipc_primary_connection_locked(void)
+{
+    for (int i = 0; i < IPC_MAX_CONNECTIONS; i++)
     {
+        if (connections[i].fd >= 0 && connections[i].primary)
+        {
+            return &connections[i];
+        }
+    }
+    return NULL;
+}
 
-        memset(&server_addr, 0, sizeof(server_addr));
-        server_addr.sun_family = AF_UNIX;
-        strncpy(server_addr.sun_path, SOCKET_PATH, sizeof(server_addr.sun_path) - 1);
+// Remember which connection sent a request so that its response goes back to it
+static void ipc_record_route(const char *requestId, uint32_t conn_id)
+{
+    if (!requestId || strlen(requestId) >= IPC_ROUTE_ID_SIZE)
+    {
+        return; // falls back to the Node.js backend
+    }
 
-        if (connect(sock_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
+    pthread_mutex_lock(&ipc_mutex);
+    IpcRoute *route = &routes[next_route++ % IPC_ROUTE_SLOTS];
+    strcpy(route->requestId, requestId);
+    route->conn_id = conn_id;
+    pthread_mutex_unlock(&ipc_mutex);
+}
+
+static IpcConnection *ipc_route_locked(const char *requestId)
+{
+    if (requestId)
+    {
+        // Most recent route first
+        for (unsigned int i = 1; i <= IPC_ROUTE_SLOTS; i++)
         {
-            if (errno != EINPROGRESS)
+            IpcRoute *route = &routes[(next_route - i) % IPC_ROUTE_SLOTS];
+            if (route->conn_id && strcmp(route->requestId, requestId) == VALID)
             {
-                LOG_ERROR("IPC", "Connection failed: %s", strerror(errno));
-                close(sock_fd);
+                IpcConnection *conn = ipc_find_connection_locked(route->conn_id);
+                if (conn)
+                {
+                    return conn;
+                }
+                break;
+            }
+        }
+    }
+    return ipc_primary_connection_locked();
+}
 
-                sock_fd = FAIL;
-                RetVal = FAIL;
+// Write as much of the outbound queue as the socket accepts, ipc_mutex must be held.
+// EPOLLOUT is armed while data remains. Returns FAIL when the connection is broken.
+static int ipc_flush_locked(IpcConnection *conn)
+{
+    while (conn->out_head)
+    {
+        IpcOutChunk *chunk = conn->out_head;
+        ssize_t n = send(conn->fd, chunk->data + chunk->offset, chunk->length - chunk->offset,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
             }
+            LOG_ERROR("IPC", "Send failed on connection %u: %s", conn->id, strerror(errno));
+            return FAIL;
         }
-        else
+
+        chunk->offset += (size_t)n;
+        conn->out_bytes -= (size_t)n;
+        if (chunk->offset == chunk->length)
         {
-            LOG_INFO("IPC", "Connected to Node.js IPC server (or connection in progress)");
-            RetVal = SUCCESS;
+            conn->out_head = chunk->next;
+            if (!conn->out_head)
+            {
+                conn->out_tail = NULL;
+            }
+            free(chunk);
         }
     }
 
-    return RetVal;
+    bool want_write = (conn->out_head != NULL);
+    if (want_write != conn->want_write)
+    {
+        conn->want_write = want_write;
+        return ipc_epoll_update(conn, EPOLL_CTL_MOD);
+    }
+    return SUCCESS;
 }
 
-int receive_full_json_message(int sock_fd, char *full_buffer, size_t max_size)
+// Parse one framed message and hand the resulting event over to the state machine
+static void ipc_process_message(IpcConnection *conn, const char *message, size_t length)
 {
-    size_t total_received = 0;
-    char temp_buffer[BUFFER_SIZE];
-    int retval = FAIL;
+#ifdef IPC_DUMP_RECEIVED_JSON
+    ipc_dump_message(message, length);
+#endif
+    LOG_INFO("IPC", "Received on connection %u: %.*s", conn->id, (int)length, message);
 
-    // Initialize full_buffer
-    full_buffer[0] = '\0';
+    state_event_e event = STATE_EVENT_NONE;
+    char *requestId = NULL;
+    cJSON *type_obj, *data_obj;
+    cJSON *json_request = NULL; // This will be set in the parse function
 
-    while (total_received < max_size)
+    if (parseRequestConfigWithLength(message, length, &type_obj, &data_obj, &requestId, &json_request) == FAIL)
     {
-        ssize_t n = recv(sock_fd, temp_buffer, BUFFER_SIZE - 1, 0);
+        LOG_ERROR("IPC", "Failed to parse incoming JSON: %s", cJSON_GetErrorPtr());
+        free(requestId);
+        cJSON_Delete(json_request);
+        return;
+    }
 
+    // Process event type
+    char *event_type = type_obj->valuestring;
+    if (strcmp(event_type, "start_simulation") == VALID)
+    {
+        event = STATE_EVENT_start_simulation;
+        LOG_INFO("IPC", "Event: start_simulation");
+    }
+    else if (strcmp(event_type, "pause_simulation") == VALID)
+    {
+        event = STATE_EVENT_pause_simulation;
+        LOG_INFO("IPC", "Event: pause_simulation");
+    }
+    else if (strcmp(event_type, "stop_simulation") == VALID)
+    {
+        event = STATE_EVENT_stop_simulation;
+        LOG_INFO("IPC", "Event: stop_simulation");
+    }
+    else if (strcmp(event_type, "init_success") == VALID)
+    {
+        event = STATE_EVENT_init_success;
+        LOG_INFO("IPC", "Event: init_success");
+    }
+    else if (strcmp(event_type, "init_failed") == VALID)
+    {
+        event = STATE_EVENT_init_failed;
+        LOG_INFO("IPC", "Event: init_failed");
+    }
+    else if (strcmp(event_type, "shutdown") == VALID)
+    {
+        event = STATE_EVENT_shutdown;
+        LOG_INFO("IPC", "Event: shutdown");
+    }
+    else if (strcmp(event_type, "get_latency") == VALID)
+    {
+        event = STATE_EVENT_get_latency;
+        LOG_INFO("IPC", "Event: get_latency");
+    }
+    else if (strcmp(event_type, "send_goose") == VALID)
+    {
+        event = STATE_EVENT_send_goose;
+        LOG_INFO("IPC", "Event: send_goose");
+    }
+    else if (strcmp(event_type, "swap_scenario") == VALID)
+    {
+        event = STATE_EVENT_swap_scenario;
+        LOG_INFO("IPC", "Event: swap_scenario");
+    }
+    else
+    {
+        LOG_WARN("IPC", "Unknown event type: %s", event_type);
+        free(requestId);
+        cJSON_Delete(json_request);
+        return;
+    }
+
+    // Hand requestId and the config array over to the state machine instead of copying them
+    if (data_obj)
+    {
+        // data_obj is either the "data" member itself or a member of it (the config array)
+        cJSON *data_item = cJSON_GetObjectItemCaseSensitive(json_request, "data");
+        cJSON_DetachItemViaPointer((data_item == data_obj) ? json_request : data_item, data_obj);
+    }
+    ipc_record_route(requestId, conn->id);
+    StateMachine_post_event(event, requestId, data_obj);
+    cJSON_Delete(json_request);
+}
+
+// Drain the socket into the framer and process every complete message.
+// Returns SUCCESS while the connection is usable, FAIL on error, and sets *disconnected on EOF.
+static int ipc_receive_messages(IpcConnection *conn, bool *disconnected)
+{
+    IpcFramer *framer = &conn->framer;
+
+    for (;;)
+    {
+        size_t room = 0;
+        char *dst = ipc_framer_write_ptr(framer, BUFFER_SIZE, &room);
+        if (!dst)
+        {
+            LOG_ERROR("IPC", "Receive buffer limit reached, dropping pending data");
+            ipc_framer_reset(framer);
+            continue;
+        }
+
+        ssize_t n = recv(conn->fd, dst, room, MSG_DONTWAIT);
         if (n < 0)
         {
+            if (errno == EINTR)
+            {
+                continue;
+            }
             if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
-                // No data available, try again or break if no data for a while
-                // For simplicity, we'll break here. In a real app, you might want a timeout.
-                break;
+                return SUCCESS; // socket drained
             }
-            LOG_ERROR("IPC", "Receive failed: %s", strerror(errno));
+            LOG_ERROR("IPC", "Receive failed on connection %u: %s", conn->id, strerror(errno));
             return FAIL;
         }
-
         if (n == 0)
         {
-            LOG_INFO("IPC", "Disconnected from server");
-            retval = SUCCESS; // Or handle as an error if an incomplete message was expected
-            break;
+            LOG_INFO("IPC", "Connection %u closed by peer", conn->id);
+            *disconnected = true;
+            return SUCCESS;
         }
+        ipc_framer_commit(framer, (size_t)n);
 
-        temp_buffer[n] = '\0'; // Null-terminate the received chunk
-
-        // Check if adding this chunk would exceed max_size
-        if (total_received + n >= max_size)
+        // Several messages may have arrived in one read
+        const char *message;
+        size_t length;
+        int rc;
+        while ((rc = ipc_framer_next(framer, &message, &length)) > 0)
+        {
+            ipc_process_message(conn, message, length);
+        }
+        if (FAIL == rc)
         {
-            LOG_ERROR("IPC", "Received message exceeds MAX_JSON_SIZE");
-            return FAIL; // Message too large
+            LOG_ERROR("IPC", "Framing error on connection %u, pending data dropped", conn->id);
         }
+    }
+}
 
-        strcat(full_buffer, temp_buffer);
-        total_received += n;
+static void ipc_accept_connections(void)
+{
+    for (;;)
+    {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                LOG_ERROR("IPC", "accept failed: %s", strerror(errno));
+            }
+            return;
+        }
 
-        // Check if we have a complete JSON object
-        if (is_complete_json(full_buffer))
+        IpcConnection *conn = ipc_add_connection(fd, false);
+        if (!conn)
         {
-            // LOG_INFO("IPC", "Received complete JSON: %s", full_buffer);
-            return SUCCESS;
+            LOG_WARN("IPC", "Too many controller connections, rejecting a new one");
+            close(fd);
+            continue;
         }
+        LOG_INFO("IPC", "Controller connected on %s (connection %u)", IPC_LISTEN_PATH, conn->id);
     }
 }
 
-// int ipc_run_loop(int (*shutdown_check_func)(void))
-// {
-//     if (sock_fd < 0) {
-//         LOG_ERROR("IPC", "Socket not initialized");
-//         return FAIL;
-//     }
-
-//     char buffer[BUFFER_SIZE] = {0};
-//     int retval = FAIL;
-
-//     while (!internal_shutdown_flag)
-//     {
-//         // Check for shutdown request
-//         if (shutdown_check_func && shutdown_check_func()) {
-//             LOG_INFO("IPC", "Shutdown requested by application");
-//             retval = SUCCESS;
-//             break;
-//         }
-
-//         // Use select to wait for data with timeout
-//         fd_set read_fds;
-//         FD_ZERO(&read_fds);
-//         FD_SET(sock_fd, &read_fds);
-
-//         struct timeval tv = {
-//             .tv_sec = 0,
-//             .tv_usec = 100000  // 100ms timeout
-//         };
-
-//         int select_result = select(sock_fd + 1, &read_fds, NULL, NULL, &tv);
-
-//         if (select_result == -1) {
-//             if (errno == EINTR) {
-//                 continue;  // Interrupted by signal, try again
-//             }
-//             LOG_ERROR("IPC", "Select failed: %s", strerror(errno));
-//             break;
-//         }
-
-//         if (select_result == 0) {
-//             continue;  // Timeout, no data available
-//         }
-
-//         // Data is available to read
-//         ssize_t n = recv(sock_fd, buffer, BUFFER_SIZE - 1, 0);
-//         //mechanism d erreur handling
-//         if (n < 0) {
-//             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-//                 continue;  // No data available, try again
-//             }
-//             LOG_ERROR("IPC", "Receive failed: %s", strerror(errno));
-//             break;
-//         }
-
-//         if (n == 0) {
-//             LOG_INFO("IPC", "Disconnected from server");
-//             retval = SUCCESS;
-//             break;
-//         }
-
-//         // Ensure null termination
-//         buffer[n] = '\0';
-//         LOG_INFO("IPC", "Received: %s", buffer);
-//         //printf("Received: %s\n", buffer); // For debugging purposes
-//         // Process the received JSON message
-//         state_event_e event = STATE_EVENT_NONE;
-//         char *requestId = NULL;
-//         cJSON *type_obj,*data_obj ;
-//         //SV_SimulationConfig config = {0}; // Initialize the config struct to zero
-//         cJSON *json_request = NULL; // This will be set in the parse function
-
-//         if ( parseRequestConfig(buffer, &type_obj, &data_obj,&requestId,&json_request) == FAIL)
-//         {
-//             LOG_ERROR("IPC", "Failed to parse incoming JSON: %s", cJSON_GetErrorPtr());
-//             continue;
-//         }
-
-//         // Process event type
-//         char *event_type = type_obj->valuestring;
-//         if (strcmp(event_type, "start_simulation") == VALID) {
-//             event = STATE_EVENT_start_simulation;
-//             LOG_INFO("IPC", "Event: start_simulation");
-//         }
-//         else if (strcmp(event_type, "pause_simulation") == VALID) {
-//             event = STATE_EVENT_pause_simulation;
-//             LOG_INFO("IPC", "Event: pause_simulation");
-//         }
-//         else if (strcmp(event_type, "stop_simulation") == VALID) {
-//             event = STATE_EVENT_stop_simulation;
-//             LOG_INFO("IPC", "Event: stop_simulation");
-//         }
-//         else if (strcmp(event_type, "init_success") == VALID) {
-//             event = STATE_EVENT_init_success;
-//             LOG_INFO("IPC", "Event: init_success");
-//         }
-//         else if (strcmp(event_type, "init_failed") == VALID) {
-//             event = STATE_EVENT_init_failed;
-//             LOG_INFO("IPC", "Event: init_failed");
-//         }
-//         else if (strcmp(event_type, "shutdown") == VALID) {
-//             event = STATE_EVENT_shutdown;
-//             LOG_INFO("IPC", "Event: shutdown");
-//         }
-//         else {
-//             LOG_WARN("IPC", "Unknown event type: %s", event_type);
-//             continue;
-//         }
-
-//         StateMachine_push_event(event, requestId, data_obj);
-//         cJSON_Delete(json_request);
-//         // Free allocated memory
-//         if (requestId) {
-//             free(requestId);
-//             requestId = NULL;
-//         }
-//     }
-
-//     return retval;
-// }
+// Local listening socket for the additional controllers, not fatal when unavailable
+static void ipc_listen_init(void)
+{
+    struct sockaddr_un addr;
+    struct epoll_event ev;
 
-int ipc_run_loop(int (*shutdown_check_func)(void))
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0)
+    {
+        LOG_WARN("IPC", "Listening socket creation failed: %s", strerror(errno));
+        return;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, IPC_LISTEN_PATH, sizeof(addr.sun_path) - 1);
+    unlink(IPC_LISTEN_PATH); // stale socket of a previous run
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = IPC_TAG_LISTEN;
+
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, IPC_MAX_CONNECTIONS) < 0 ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) < 0)
+    {
+        LOG_WARN("IPC", "Cannot listen on %s: %s, only the Node.js backend is served", IPC_LISTEN_PATH, strerror(errno));
+        close(listen_fd);
+        listen_fd = FAIL;
+        return;
+    }
+    LOG_INFO("IPC", "Listening for controllers on %s", IPC_LISTEN_PATH);
+}
+
+int ipc_init(void)
 {
-    int retval = FAIL;
+    int RetVal = SUCCESS;
+    struct sockaddr_un server_addr;
+    struct epoll_event ev;
+
+    for (int i = 0; i < IPC_MAX_CONNECTIONS; i++)
+    {
+        connections[i].fd = FAIL;
+    }
+    memset(routes, 0, sizeof(routes));
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = IPC_TAG_WAKEUP;
+    if (epoll_fd < 0 || wakeup_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev) < 0)
+    {
+        LOG_ERROR("IPC", "Reactor creation failed: %s", strerror(errno));
+        ipc_release();
+        return FAIL;
+    }
+
+    int sock_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (sock_fd < 0)
     {
-        LOG_ERROR("IPC", "Socket not initialized");
-        retval = FAIL;
+        LOG_ERROR("IPC", "Socket creation failed: %s", strerror(errno));
+        RetVal = FAIL;
     }
     else
     {
 
-        char full_json_buffer[MAX_JSON_SIZE] = {0}; // Declare a buffer large enough for full JSON messages
+        memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sun_family = AF_UNIX;
+        strncpy(server_addr.sun_path, SOCKET_PATH, sizeof(server_addr.sun_path) - 1);
 
-        while (!internal_shutdown_flag)
+        if (connect(sock_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
         {
-            // Check for shutdown request
-            if (shutdown_check_func && shutdown_check_func())
-            {
-                LOG_INFO("IPC", "Shutdown requested by application");
-                retval = SUCCESS;
-                break;
-            }
+            LOG_ERROR("IPC", "Connection failed: %s", strerror(errno));
+            close(sock_fd);
+            RetVal = FAIL;
+        }
+        else if (NULL == ipc_add_connection(sock_fd, true))
+        {
+            close(sock_fd);
+            RetVal = FAIL;
+        }
+        else
+        {
+            LOG_INFO("IPC", "Connected to Node.js IPC server");
+        }
+    }
 
-            // Use select to wait for data with timeout
-            fd_set read_fds;
-            FD_ZERO(&read_fds);
-            FD_SET(sock_fd, &read_fds);
+    if (SUCCESS == RetVal)
+    {
+        ipc_listen_init();
+    }
+    else
+    {
+        ipc_release();
+    }
+    return RetVal;
+}
 
-            struct timeval tv = {
-                .tv_sec = 0,
-                .tv_usec = 100000 // 100ms timeout
-            };
+int ipc_run_loop(int (*shutdown_check_func)(void))
+{
+    int retval = FAIL;
+    struct epoll_event events[IPC_MAX_EVENTS];
 
-            int select_result = select(sock_fd + 1, &read_fds, NULL, NULL, &tv);
+    if (epoll_fd < 0)
+    {
+        LOG_ERROR("IPC", "Socket not initialized");
+        return FAIL;
+    }
+    LOG_INFO("IPC", "Using %s framing", ipc_framing_to_string(IPC_FRAMING_MODE));
 
-            if (select_result == -1)
-            {
-                if (errno == EINTR)
-                {
-                    continue; // Interrupted by signal, try again
-                }
-                LOG_ERROR("IPC", "Select failed: %s", strerror(errno));
-                break;
-            }
+    bool stop = false;
+    while (!stop && !internal_shutdown_flag)
+    {
+        // Check for shutdown request
+        if (shutdown_check_func && shutdown_check_func())
+        {
+            LOG_INFO("IPC", "Shutdown requested by application");
+            retval = SUCCESS;
+            break;
+        }
 
-            if (select_result == 0)
+        // No timeout: shutdown requests wake the reactor through the eventfd (ipc_wakeup)
+        int nb_events = epoll_wait(epoll_fd, events, IPC_MAX_EVENTS, -1);
+        if (nb_events < 0)
+        {
+            if (errno == EINTR)
             {
-                continue; // Timeout, no data available
+                continue; // Interrupted by signal, check the shutdown flags
             }
+            LOG_ERROR("IPC", "epoll_wait failed: %s", strerror(errno));
+            break;
+        }
 
-            // Data is available to read, call receive_full_json_message
-            if (receive_full_json_message(sock_fd, full_json_buffer, sizeof(full_json_buffer)) == FAIL)
-            {
-                LOG_ERROR("IPC", "Failed to receive full JSON message");
-                // Depending on error, you might want to continue or break
-                continue;
-            }
+        for (int i = 0; i < nb_events; i++)
+        {
+            uint32_t tag = events[i].data.u32;
 
-            // Write the full_json_buffer content to a file for verification
-            FILE *fp = fopen("received_json.txt", "w");
-            if (fp != NULL)
+            if (IPC_TAG_WAKEUP == tag)
             {
-                fprintf(fp, "%s", full_json_buffer);
-                fclose(fp);
-                LOG_INFO("IPC", "Full JSON message written to received_json.txt");
-            }
-            else
-            {
-                LOG_ERROR("IPC", "Failed to open received_json.txt for writing");
+                uint64_t count;
+                ssize_t ret = read(wakeup_fd, &count, sizeof(count));
+                (void)ret;
+                continue;
             }
-          //  printf("ipc :: Received: %s\n", full_json_buffer); // For debugging purposes
-            LOG_INFO("IPC", "Received: %s", full_json_buffer);
-            // Process the received JSON message
-            state_event_e event = STATE_EVENT_NONE;
-            char *requestId = NULL;
-            cJSON *type_obj, *data_obj;
-            // SV_SimulationConfig config = {0}; // Initialize the config struct to zero
-            cJSON *json_request = NULL; // This will be set in the parse function
-
-            if (parseRequestConfig(full_json_buffer, &type_obj, &data_obj, &requestId, &json_request) == FAIL)
+            if (IPC_TAG_LISTEN == tag)
             {
-                LOG_ERROR("IPC", "Failed to parse incoming JSON: %s", cJSON_GetErrorPtr());
+                ipc_accept_connections();
                 continue;
             }
 
-            // Process event type
-            char *event_type = type_obj->valuestring;
-            if (strcmp(event_type, "start_simulation") == VALID)
+            IpcConnection *conn = &connections[tag];
+            if (conn->fd < 0)
             {
-                event = STATE_EVENT_start_simulation;
-                LOG_INFO("IPC", "Event: start_simulation");
+                continue; // closed while handling a previous event of this batch
             }
-            else if (strcmp(event_type, "pause_simulation") == VALID)
-            {
-                event = STATE_EVENT_pause_simulation;
-                LOG_INFO("IPC", "Event: pause_simulation");
-            }
-            else if (strcmp(event_type, "stop_simulation") == VALID)
-            {
-                event = STATE_EVENT_stop_simulation;
-                LOG_INFO("IPC", "Event: stop_simulation");
-            }
-            else if (strcmp(event_type, "init_success") == VALID)
-            {
-                event = STATE_EVENT_init_success;
-                LOG_INFO("IPC", "Event: init_success");
-            }
-            else if (strcmp(event_type, "init_failed") == VALID)
-            {
-                event = STATE_EVENT_init_failed;
-                LOG_INFO("IPC", "Event: init_failed");
-            }
-            else if (strcmp(event_type, "shutdown") == VALID)
+
+            bool primary = conn->primary;
+            int status = SUCCESS;
+            bool disconnected = false;
+
+            if (events[i].events & EPOLLOUT)
             {
-                event = STATE_EVENT_shutdown;
-                LOG_INFO("IPC", "Event: shutdown");
+                pthread_mutex_lock(&ipc_mutex);
+                status = ipc_flush_locked(conn);
+                pthread_mutex_unlock(&ipc_mutex);
             }
-            else
+            if (SUCCESS == status && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
             {
-                LOG_WARN("IPC", "Unknown event type: %s", event_type);
-                continue;
+                status = ipc_receive_messages(conn, &disconnected);
             }
 
-            StateMachine_push_event(event, requestId, data_obj);
-            cJSON_Delete(json_request);
-            // Free allocated memory
-            if (requestId)
+            if (SUCCESS != status || disconnected)
             {
-                free(requestId);
-                requestId = NULL;
+                ipc_close_connection(conn);
+                if (primary)
+                {
+                    // The Node.js backend drives the application: losing it ends the loop
+                    LOG_INFO("IPC", "Disconnected from server");
+                    retval = (SUCCESS == status) ? SUCCESS : FAIL;
+                    stop = true;
+                }
             }
         }
     }
+    if (internal_shutdown_flag)
+    {
+        retval = SUCCESS;
+    }
     return retval;
 }
 
-int ipc_shutdown(void)
+void ipc_wakeup(void)
 {
-    int status = EXIT_SUCCESS;
+    uint64_t one = 1;
+
+    if (wakeup_fd >= 0)
+    {
+        ssize_t ret = write(wakeup_fd, &one, sizeof(one));
+        (void)ret;
+    }
+}
 
+int ipc_shutdown(void)
+{
     LOG_INFO("IPC", "Shutting down...");
     internal_shutdown_flag = EXIT_FAILURE;
+#ifdef IPC_DUMP_RECEIVED_JSON
+    ipc_dump_stop();
+#endif
+    ipc_wakeup();
+
+    return ipc_release();
+}
+
+// Close every connection and the reactor descriptors
+static int ipc_release(void)
+{
+    int status = EXIT_SUCCESS;
+
+    pthread_mutex_lock(&ipc_mutex);
+    for (int i = 0; i < IPC_MAX_CONNECTIONS; i++)
+    {
+        if (connections[i].fd >= 0)
+        {
+            // Give the pending responses a last chance before closing
+            ipc_flush_locked(&connections[i]);
+            ipc_close_connection_locked(&connections[i]);
+        }
+    }
+    pthread_mutex_unlock(&ipc_mutex);
 
-    if (EXIT_SUCCESS <= sock_fd)
-    { // Check if the socket is still open
+    if (EXIT_SUCCESS <= listen_fd)
+    {
+        close(listen_fd);
+        unlink(IPC_LISTEN_PATH);
+        listen_fd = FAIL;
+    }
+    if (EXIT_SUCCESS <= epoll_fd)
+    { // Check if the reactor is still open
 
-        if (FAIL == close(sock_fd))
+        if (FAIL == close(epoll_fd))
         {
             LOG_ERROR("IPC", "Socket close failed: %s", strerror(errno));
             status = FAIL;
         }
-        else
-        {
-            sock_fd = FAIL;
-        }
+        epoll_fd = FAIL;
+    }
+    if (EXIT_SUCCESS <= wakeup_fd)
+    {
+        close(wakeup_fd);
+        wakeup_fd = FAIL;
     }
     return status;
 }
 
-int ipc_send_response(const char *response_json)
+int ipc_send_reply(const char *requestId, const char *response_json)
 {
     int retval = FAIL;
-    if (sock_fd < 0)
+
+    if (!response_json)
+    {
+        LOG_ERROR("IPC", "Cannot send NULL response");
+        return FAIL;
+    }
+
+    // Frame the response the same way as the incoming messages
+    size_t length = strlen(response_json);
+    uint8_t header[IPC_FRAMER_MAX_HEADER];
+    size_t header_len = ipc_framer_header(IPC_FRAMING_MODE, length, header);
+    size_t trailer_len;
+    const char *trailer = ipc_framer_trailer(IPC_FRAMING_MODE, &trailer_len);
+    size_t total = header_len + length + trailer_len;
+
+    IpcOutChunk *chunk = (IpcOutChunk *)malloc(sizeof(IpcOutChunk) + total);
+    if (!chunk)
+    {
+        LOG_ERROR("IPC", "Memory allocation failed for %zu bytes response", total);
+        return FAIL;
+    }
+    memcpy(chunk->data, header, header_len);
+    memcpy(chunk->data + header_len, response_json, length);
+    if (trailer_len)
+    {
+        memcpy(chunk->data + header_len + length, trailer, trailer_len);
+    }
+    chunk->length = total;
+    chunk->offset = 0;
+    chunk->next = NULL;
+
+    pthread_mutex_lock(&ipc_mutex);
+    IpcConnection *conn = ipc_route_locked(requestId);
+    if (!conn)
     {
         LOG_ERROR("IPC", "Socket not initialized for sending response");
-        retval = FAIL;
+        free(chunk);
+    }
+    else if (conn->out_bytes + total > IPC_OUTBOUND_LIMIT)
+    {
+        LOG_ERROR("IPC", "Connection %u does not read its responses, dropping one", conn->id);
+        free(chunk);
     }
     else
     {
-        if (!response_json)
+        bool idle = (conn->out_head == NULL);
+        if (conn->out_tail)
         {
-            LOG_ERROR("IPC", "Cannot send NULL response");
-            retval = FAIL;
+            conn->out_tail->next = chunk;
         }
         else
         {
-            ssize_t sent = send(sock_fd, response_json, strlen(response_json), 0);
-            if (sent < 0)
-            {
-                LOG_ERROR("IPC", "Send failed: %s", strerror(errno));
-                retval = FAIL;
-            }
-
-            LOG_DEBUG("IPC", "Sent response (%zd bytes): %s", sent, response_json);
-            retval = SUCCESS;
+            conn->out_head = chunk;
         }
+        conn->out_tail = chunk;
+        conn->out_bytes += total;
+
+        // Write right away when nothing is pending, the reactor finishes partial writes on EPOLLOUT
+        retval = idle ? ipc_flush_locked(conn) : SUCCESS;
+        LOG_DEBUG("IPC", "Queued response for connection %u (%zu bytes): %s", conn->id, total, response_json);
     }
+    pthread_mutex_unlock(&ipc_mutex);
     return retval;
-}
\ No newline at end of file
+}
+
+int ipc_send_response(const char *response_json)
+{
+    return ipc_send_reply(NULL, response_json);
+}
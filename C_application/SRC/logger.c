@@ -1,216 +1,726 @@
 #include "logger.h"
 
-// Only compile the full logger implementation in DEBUG mode
-#ifdef DEBUG
-
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <pthread.h>
 #include <stdarg.h>
-#include <assert.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Each log call stores one fixed-size binary record in the ring buffer of the calling
+// thread (single producer / single consumer, no lock, no allocation after the first call
+// of a thread). Formatting, time conversion and output are done by the drain thread.
+
+#define LOG_RECORD_SIZE 512      // bytes per record, strings are copied inline
+#define LOG_MAX_ARGS 16          // arguments kept per record, the others print as "<?>"
+#define LOG_RING_MIN_RECORDS 256
+#define LOG_DRAIN_PERIOD_MS 20   // the drain thread also wakes up on threshold / errors
+#define LOG_LINE_SIZE 1024
+#define LOG_SPEC_SIZE 48
+#define LOG_CALIBRATION_NS 2000000ULL
+
+// How a conversion argument is stored and handed back to snprintf
+typedef enum {
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_INTMAX,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_PTR,
+    LOG_ARG_STR,   // copied into the record text area
+    LOG_ARG_ERRNO, // %m, errno captured at log time
+    LOG_ARG_NONE   // %% or unsupported conversion, consumes no argument
+} log_arg_kind_t;
+
+typedef union {
+    uint64_t u;
+    double d;
+    const void *p;
+    struct {
+        uint16_t offset;
+        uint16_t length;
+    } str;
+} log_arg_t;
+
+#define LOG_RECORD_HEADER_SIZE (8 + 3 * sizeof(void*) + 4 + 4 + LOG_MAX_ARGS * (sizeof(log_arg_t) + 1))
+#define LOG_RECORD_TEXT_SIZE (LOG_RECORD_SIZE - LOG_RECORD_HEADER_SIZE)
 
-// Internal buffer structure
 typedef struct {
-    char* data;
-    size_t size;
-    size_t position;
-    uint8_t flush_threshold;
-    pthread_mutex_t mutex;
-    log_level_t current_level;
-    log_output_handler_t output_handler;
-    bool initialized;
-} log_buffer_t;
+    uint64_t timestamp;    // raw TSC (or monotonic ns where there is no TSC)
+    const char *format;    // string literal, not copied
+    const char *module;    // string literal, not copied
+    const char *file;      // __FILE__
+    uint32_t line;
+    uint8_t level;
+    uint8_t nb_args;
+    uint16_t text_used;
+    log_arg_t args[LOG_MAX_ARGS];
+    uint8_t kinds[LOG_MAX_ARGS];
+    char text[LOG_RECORD_TEXT_SIZE];
+} log_record_t;
+
+_Static_assert(sizeof(log_record_t) <= LOG_RECORD_SIZE, "log record larger than LOG_RECORD_SIZE");
+
+typedef struct log_ring {
+    struct log_ring *next;
+    log_record_t *records;
+    size_t capacity; // power of two
+    size_t mask;
+    size_t wake_level; // occupancy at which the producer wakes the drain thread
+    atomic_bool orphaned; // owner thread exited, freed once drained
+    _Alignas(64) atomic_size_t head; // written by the owner thread
+    _Alignas(64) atomic_size_t tail; // written by the drain
+    atomic_uint_fast64_t dropped;
+    uint64_t dropped_reported;
+} log_ring_t;
+
+// Parsed printf conversion specification
+typedef struct {
+    const char *flags;
+    size_t flags_len;
+    int width;      // -1: none, -2: '*'
+    int precision;  // -1: none, -2: '*'
+    char length[3]; // length modifier ("", "l", "ll", ...)
+    char conversion;
+    log_arg_kind_t kind;
+} log_spec_t;
 
-// Global log buffer (only exists in debug mode)
-static log_buffer_t g_log_buffer = {0};
+typedef struct {
+    atomic_bool initialized;
+    atomic_int current_level;
+    _Atomic(log_output_handler_t) output_handler;
+    size_t ring_records;
+    uint8_t flush_threshold;
+    unsigned int generation;
+    // Rings of every thread that logged, protected by rings_mutex
+    log_ring_t *rings;
+    pthread_mutex_t rings_mutex;
+    pthread_key_t ring_key;
+    // One consumer at a time: the drain thread or logger_flush()
+    pthread_mutex_t drain_mutex;
+    pthread_t drain_thread;
+    bool drain_started;
+    atomic_bool stop;
+    int wakeup_fd;
+    // Timestamp calibration (raw timestamp -> CLOCK_REALTIME)
+    uint64_t cal_raw;
+    uint64_t cal_ns;
+    double raw_per_ns;
+} logger_t;
+
+static logger_t g_logger = {0};
+static __thread log_ring_t *tls_ring = NULL;
+static __thread unsigned int tls_generation = 0;
+
+static const char *level_to_string(log_level_t level) {
+    switch (level) {
+        case LOG_LEVEL_ERROR: return "ERROR";
+        case LOG_LEVEL_WARN:  return "WARN";
+        case LOG_LEVEL_INFO:  return "INFO";
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        case LOG_LEVEL_TRACE: return "TRACE";
+        default: return "UNKNOWN";
+    }
+}
 
 // Default log output handler
 static void default_log_handler(const log_entry_t* entry) {
-    const char* level_str = "UNKNOWN";
-    switch (entry->level) {
-        case LOG_LEVEL_ERROR: level_str = "ERROR"; break;
-        case LOG_LEVEL_WARN:  level_str = "WARN";  break;
-        case LOG_LEVEL_INFO:  level_str = "INFO";  break;
-        case LOG_LEVEL_DEBUG: level_str = "DEBUG"; break;
-        case LOG_LEVEL_TRACE: level_str = "TRACE"; break;
-        default: break;
-    }
-
     char time_str[32];
+    struct tm time_info;
     time_t raw_time = entry->timestamp / 1000;
-    struct tm* time_info = localtime(&raw_time);
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", time_info);
+
+    localtime_r(&raw_time, &time_info);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &time_info);
 
     fprintf(stderr, "[%s.%03lu] [%s] [%s] %s (%s:%u)\n",
-            time_str, entry->timestamp % 1000, level_str, entry->module,
-            entry->message, entry->file, entry->line);
-  
+            time_str, (unsigned long)(entry->timestamp % 1000), level_to_string(entry->level),
+            entry->module, entry->message, entry->file, entry->line);
 }
 
-static uint64_t get_timestamp_ms() {
+static uint64_t clock_ns(clockid_t clock) {
     struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    return (uint64_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-// --- Core Functions Implementation ---
+static inline uint64_t raw_timestamp(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return clock_ns(CLOCK_MONOTONIC);
+#endif
+}
 
-bool logger_init(size_t buffer_size, uint8_t flush_threshold) {
-    if (g_log_buffer.initialized) {
-        return true;
+// Refresh the raw timestamp -> wall clock conversion (drain side only)
+static void calibrate(uint64_t *raw_now, uint64_t *ns_now) {
+    *raw_now = raw_timestamp();
+    *ns_now = clock_ns(CLOCK_REALTIME);
+    if (*ns_now >= g_logger.cal_ns + LOG_CALIBRATION_NS && *raw_now > g_logger.cal_raw) {
+        g_logger.raw_per_ns = (double)(*raw_now - g_logger.cal_raw) / (double)(*ns_now - g_logger.cal_ns);
     }
+}
 
-    g_log_buffer.data = (char*)malloc(buffer_size);
-    if (!g_log_buffer.data) {
-        fprintf(stderr, "LOGGER INIT ERROR: Failed to allocate buffer\n");
-        return false;
+static uint64_t raw_to_ms(uint64_t raw, uint64_t raw_now, uint64_t ns_now) {
+    double age_ns = (raw_now > raw) ? (double)(raw_now - raw) / g_logger.raw_per_ns : 0.0;
+    return (ns_now - (uint64_t)age_ns) / 1000000ULL;
+}
+
+static void wakeup_drain(void) {
+    uint64_t one = 1;
+    ssize_t ret = write(g_logger.wakeup_fd, &one, sizeof(one));
+    (void)ret;
+}
+
+// Parse the conversion specification starting after '%', returns the next format character
+static const char *parse_spec(const char *p, log_spec_t *spec) {
+    spec->flags = p;
+    while (*p && strchr("-+ #0'", *p)) {
+        p++;
+    }
+    spec->flags_len = (size_t)(p - spec->flags);
+
+    spec->width = -1;
+    if (*p == '*') {
+        spec->width = -2;
+        p++;
+    } else if (*p >= '0' && *p <= '9') {
+        spec->width = (int)strtol(p, (char **)&p, 10);
     }
 
-    g_log_buffer.size = buffer_size;
-    g_log_buffer.position = 0;
-    g_log_buffer.flush_threshold = (flush_threshold > 100) ? 100 : flush_threshold;
-    g_log_buffer.current_level = LOG_LEVEL_INFO;
-    g_log_buffer.output_handler = default_log_handler;
-    g_log_buffer.initialized = true;
+    spec->precision = -1;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->precision = -2;
+            p++;
+        } else {
+            spec->precision = (int)strtol(p, (char **)&p, 10);
+        }
+    }
 
-    if (pthread_mutex_init(&g_log_buffer.mutex, NULL) != 0) {
-        free(g_log_buffer.data);
-        g_log_buffer.data = NULL;
-        return false;
+    memset(spec->length, 0, sizeof(spec->length));
+    if ((p[0] == 'h' && p[1] == 'h') || (p[0] == 'l' && p[1] == 'l')) {
+        spec->length[0] = p[0];
+        spec->length[1] = p[1];
+        p += 2;
+    } else if (*p && strchr("hlLqjzt", *p)) {
+        spec->length[0] = *p++;
     }
 
-    return true;
-}
+    spec->conversion = *p;
+    if (*p) {
+        p++;
+    }
 
-void logger_set_level(log_level_t level) {
-    if (g_log_buffer.initialized) {
-        pthread_mutex_lock(&g_log_buffer.mutex);
-        g_log_buffer.current_level = level;
-        pthread_mutex_unlock(&g_log_buffer.mutex);
+    switch (spec->conversion) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            switch (spec->length[0]) {
+                case 'l': spec->kind = spec->length[1] ? LOG_ARG_LLONG : LOG_ARG_LONG; break;
+                case 'q': spec->kind = LOG_ARG_LLONG; break;
+                case 'z': spec->kind = LOG_ARG_SIZE; break;
+                case 'j': spec->kind = LOG_ARG_INTMAX; break;
+                case 't': spec->kind = LOG_ARG_PTRDIFF; break;
+                default:  spec->kind = LOG_ARG_INT; break;
+            }
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->kind = (spec->length[0] == 'L') ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+            break;
+        case 'p':
+            spec->kind = LOG_ARG_PTR;
+            break;
+        case 's':
+            spec->kind = LOG_ARG_STR;
+            break;
+        case 'm':
+            spec->kind = LOG_ARG_ERRNO;
+            break;
+        default: // '%%', '%n' and unknown conversions
+            spec->kind = LOG_ARG_NONE;
+            break;
     }
+    return p;
 }
 
-void logger_set_output_handler(log_output_handler_t handler) {
-    if (g_log_buffer.initialized) {
-        pthread_mutex_lock(&g_log_buffer.mutex);
-        g_log_buffer.output_handler = handler ? handler : default_log_handler;
-        pthread_mutex_unlock(&g_log_buffer.mutex);
+// Copy the arguments of one log call into a record (producer side, no formatting)
+static void capture_args(log_record_t *rec, const char *format, va_list args, int saved_errno) {
+    const char *p = format;
+    uint8_t n = 0;
+    uint16_t text_used = 0;
+
+    while ((p = strchr(p, '%')) != NULL && n < LOG_MAX_ARGS) {
+        log_spec_t spec;
+        int width_arg = -1;
+        int precision_arg = -1;
+
+        p = parse_spec(p + 1, &spec);
+
+        // '*' width and precision are stored as ordinary int arguments
+        if (spec.width == -2) {
+            width_arg = va_arg(args, int);
+            rec->kinds[n] = LOG_ARG_INT;
+            rec->args[n++].u = (uint64_t)(int64_t)width_arg;
+        }
+        if (spec.precision == -2 && n < LOG_MAX_ARGS) {
+            precision_arg = va_arg(args, int);
+            rec->kinds[n] = LOG_ARG_INT;
+            rec->args[n++].u = (uint64_t)(int64_t)precision_arg;
+        } else if (spec.precision >= 0) {
+            precision_arg = spec.precision;
+        }
+        if (n >= LOG_MAX_ARGS) {
+            break;
+        }
+
+        log_arg_t *arg = &rec->args[n];
+        switch (spec.kind) {
+            case LOG_ARG_INT:     arg->u = (uint64_t)(int64_t)va_arg(args, int); break;
+            case LOG_ARG_LONG:    arg->u = (uint64_t)va_arg(args, long); break;
+            case LOG_ARG_LLONG:   arg->u = (uint64_t)va_arg(args, long long); break;
+            case LOG_ARG_SIZE:    arg->u = (uint64_t)va_arg(args, size_t); break;
+            case LOG_ARG_INTMAX:  arg->u = (uint64_t)va_arg(args, intmax_t); break;
+            case LOG_ARG_PTRDIFF: arg->u = (uint64_t)va_arg(args, ptrdiff_t); break;
+            case LOG_ARG_DOUBLE:  arg->d = va_arg(args, double); break;
+            case LOG_ARG_LDOUBLE: arg->d = (double)va_arg(args, long double); break;
+            case LOG_ARG_PTR:     arg->p = va_arg(args, void *); break;
+            case LOG_ARG_ERRNO:   arg->u = (uint64_t)saved_errno; break;
+            case LOG_ARG_STR: {
+                // The caller's string may not outlive the call: copy what will be printed
+                const char *s = va_arg(args, const char *);
+                size_t room;
+                size_t len;
+                if (text_used >= sizeof(rec->text)) {
+                    // Text area full: print an empty string, the terminator of the last copy
+                    rec->text[sizeof(rec->text) - 1] = '\0';
+                    arg->str.offset = (uint16_t)(sizeof(rec->text) - 1);
+                    arg->str.length = 0;
+                    break;
+                }
+                room = sizeof(rec->text) - text_used - 1;
+                if (!s) {
+                    s = "(null)";
+                }
+                len = (precision_arg >= 0) ? strnlen(s, (size_t)precision_arg) : strlen(s);
+                if (len > room) {
+                    len = room;
+                }
+                memcpy(rec->text + text_used, s, len);
+                rec->text[text_used + len] = '\0';
+                arg->str.offset = text_used;
+                arg->str.length = (uint16_t)len;
+                text_used += (uint16_t)(len + 1);
+                break;
+            }
+            case LOG_ARG_NONE:
+            default:
+                continue;
+        }
+        rec->kinds[n++] = (uint8_t)spec.kind;
     }
+
+    rec->nb_args = n;
+    rec->text_used = text_used;
 }
 
-void logger_flush(void) {
-    if (!g_log_buffer.initialized || g_log_buffer.position == 0) {
-        return;
+// Rebuild one conversion without '*' and without the length modifier of the stored type
+static void build_spec(char *out, const log_spec_t *spec, int width, int precision, const char *length) {
+    int len = snprintf(out, LOG_SPEC_SIZE, "%%%.*s", (int)spec->flags_len, spec->flags);
+    if (width >= 0) {
+        len += snprintf(out + len, LOG_SPEC_SIZE - len, "%d", width);
     }
+    if (precision >= 0) {
+        len += snprintf(out + len, LOG_SPEC_SIZE - len, ".%d", precision);
+    }
+    snprintf(out + len, LOG_SPEC_SIZE - len, "%s%c", length, spec->conversion);
+}
 
-    pthread_mutex_lock(&g_log_buffer.mutex);
-    
-    char* read_pos = g_log_buffer.data;
-    char* end_pos = g_log_buffer.data + g_log_buffer.position;
+// Format a record into a message (drain side)
+static void format_record(const log_record_t *rec, char *out, size_t size) {
+    const char *p = rec->format;
+    size_t used = 0;
+    uint8_t n = 0;
+
+#define LOG_APPEND(...) do { \
+        if (used < size) { \
+            int _w = snprintf(out + used, size - used, __VA_ARGS__); \
+            if (_w > 0) used += (size_t)_w; \
+        } \
+    } while (0)
+
+    out[0] = '\0';
+    while (*p && used < size - 1) {
+        const char *pct = strchr(p, '%');
+        if (!pct) {
+            LOG_APPEND("%s", p);
+            break;
+        }
+        LOG_APPEND("%.*s", (int)(pct - p), p);
 
-    while (read_pos < end_pos) {
-        log_entry_t* entry = (log_entry_t*)read_pos;
-        if (g_log_buffer.output_handler) {
-            g_log_buffer.output_handler(entry);
+        log_spec_t spec;
+        p = parse_spec(pct + 1, &spec);
+        if (spec.conversion == '%') {
+            LOG_APPEND("%%");
+            continue;
+        }
+        if (spec.kind == LOG_ARG_NONE) {
+            continue;
         }
-        read_pos += sizeof(log_entry_t);
+
+        int width = spec.width;
+        int precision = spec.precision;
+        if (width == -2) {
+            width = (n < rec->nb_args) ? (int)(int64_t)rec->args[n++].u : -1;
+            if (width < 0) {
+                width = -1; // a negative '*' width means left-justify, not kept
+            }
+        }
+        if (precision == -2) {
+            precision = (n < rec->nb_args) ? (int)(int64_t)rec->args[n++].u : -1;
+        }
+        if (n >= rec->nb_args) {
+            LOG_APPEND("<?>");
+            continue;
+        }
+
+        const log_arg_t *arg = &rec->args[n++];
+        char fmt[LOG_SPEC_SIZE];
+        switch ((log_arg_kind_t)rec->kinds[n - 1]) {
+            case LOG_ARG_INT:
+                build_spec(fmt, &spec, width, precision, spec.length);
+                LOG_APPEND(fmt, (int)(int64_t)arg->u);
+                break;
+            case LOG_ARG_LONG:
+                build_spec(fmt, &spec, width, precision, "l");
+                LOG_APPEND(fmt, (long)arg->u);
+                break;
+            case LOG_ARG_LLONG:
+            case LOG_ARG_INTMAX:
+            case LOG_ARG_PTRDIFF:
+            case LOG_ARG_SIZE:
+                build_spec(fmt, &spec, width, precision, "ll");
+                LOG_APPEND(fmt, (long long)arg->u);
+                break;
+            case LOG_ARG_DOUBLE:
+            case LOG_ARG_LDOUBLE:
+                build_spec(fmt, &spec, width, precision, "");
+                LOG_APPEND(fmt, arg->d);
+                break;
+            case LOG_ARG_PTR:
+                build_spec(fmt, &spec, width, precision, "");
+                LOG_APPEND(fmt, arg->p);
+                break;
+            case LOG_ARG_STR:
+                build_spec(fmt, &spec, width, precision, "");
+                LOG_APPEND(fmt, rec->text + arg->str.offset);
+                break;
+            case LOG_ARG_ERRNO:
+                LOG_APPEND("%s", strerror((int)arg->u));
+                break;
+            default:
+                break;
+        }
+    }
+#undef LOG_APPEND
+}
+
+static void emit(log_level_t level, const char *module, const char *file, uint32_t line,
+                 const char *message, uint64_t timestamp_ms) {
+    log_output_handler_t handler = atomic_load_explicit(&g_logger.output_handler, memory_order_acquire);
+    log_entry_t entry = {
+        .level = level,
+        .module = module ? module : "",
+        .message = message,
+        .line = line,
+        .file = file ? file : "",
+        .timestamp = timestamp_ms
+    };
+    if (handler) {
+        handler(&entry);
     }
+}
 
-    g_log_buffer.position = 0;
-    pthread_mutex_unlock(&g_log_buffer.mutex);
+static void free_ring(log_ring_t *ring) {
+    free(ring->records);
+    free(ring);
 }
 
-void logger_shutdown(void) {
-    if (!g_log_buffer.initialized) {
-        return;
+// Output every pending record in timestamp order. drain_mutex must be held.
+static void drain_rings(void) {
+    uint64_t raw_now, ns_now;
+    char message[LOG_LINE_SIZE];
+
+    calibrate(&raw_now, &ns_now);
+
+    pthread_mutex_lock(&g_logger.rings_mutex);
+
+    for (log_ring_t *ring = g_logger.rings; ring; ring = ring->next) {
+        uint64_t dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        if (dropped != ring->dropped_reported) {
+            snprintf(message, sizeof(message), "%llu log records dropped (ring full)",
+                     (unsigned long long)(dropped - ring->dropped_reported));
+            emit(LOG_LEVEL_WARN, "Logger", __FILE__, __LINE__, message, ns_now / 1000000ULL);
+            ring->dropped_reported = dropped;
+        }
     }
 
-    logger_flush();
+    // Merge the per-thread rings on the record timestamps, up to what was published now
+    for (;;) {
+        log_ring_t *oldest = NULL;
+        const log_record_t *oldest_rec = NULL;
+
+        for (log_ring_t *ring = g_logger.rings; ring; ring = ring->next) {
+            size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            if (tail == atomic_load_explicit(&ring->head, memory_order_acquire)) {
+                continue;
+            }
+            const log_record_t *rec = &ring->records[tail & ring->mask];
+            if (!oldest_rec || rec->timestamp < oldest_rec->timestamp) {
+                oldest = ring;
+                oldest_rec = rec;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+
+        format_record(oldest_rec, message, sizeof(message));
+        emit((log_level_t)oldest_rec->level, oldest_rec->module, oldest_rec->file, oldest_rec->line,
+             message, raw_to_ms(oldest_rec->timestamp, raw_now, ns_now));
+        atomic_store_explicit(&oldest->tail, atomic_load_explicit(&oldest->tail, memory_order_relaxed) + 1,
+                              memory_order_release);
+    }
 
-    pthread_mutex_lock(&g_log_buffer.mutex);
-    free(g_log_buffer.data);
-    g_log_buffer.data = NULL;
-    g_log_buffer.initialized = false;
-    pthread_mutex_unlock(&g_log_buffer.mutex);
+    // Release the rings of the threads that exited
+    log_ring_t **link = &g_logger.rings;
+    while (*link) {
+        log_ring_t *ring = *link;
+        if (atomic_load_explicit(&ring->orphaned, memory_order_acquire) &&
+            atomic_load_explicit(&ring->tail, memory_order_relaxed) ==
+            atomic_load_explicit(&ring->head, memory_order_acquire)) {
+            *link = ring->next;
+            free_ring(ring);
+        } else {
+            link = &ring->next;
+        }
+    }
 
-    pthread_mutex_destroy(&g_log_buffer.mutex);
+    pthread_mutex_unlock(&g_logger.rings_mutex);
 }
 
-// --- Variadic Logging Function ---
+static void *drain_thread(void *arg) {
+    struct pollfd pfd = { .fd = g_logger.wakeup_fd, .events = POLLIN };
+    (void)arg;
 
-// In logger.c (debug mode)
-void logger_log(log_level_t level, const char* module, const char* file,
-               uint32_t line, const char* format, ...) {
-    if (!g_log_buffer.initialized || level > g_log_buffer.current_level) {
-        return;
+    while (!atomic_load(&g_logger.stop)) {
+        if (poll(&pfd, 1, LOG_DRAIN_PERIOD_MS) > 0) {
+            uint64_t count;
+            ssize_t ret = read(g_logger.wakeup_fd, &count, sizeof(count));
+            (void)ret;
+        }
+        pthread_mutex_lock(&g_logger.drain_mutex);
+        drain_rings();
+        pthread_mutex_unlock(&g_logger.drain_mutex);
     }
+    return NULL;
+}
 
-    // Temporary buffer for message formatting
-    char msg_buffer[512];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(msg_buffer, sizeof(msg_buffer), format, args); 
-    va_end(args);
-    msg_buffer[sizeof(msg_buffer)-1] = '\0'; // Ensure null-termination
+// pthread key destructor: the ring of an exiting thread is freed by the drain once empty
+static void ring_release(void *value) {
+    log_ring_t *ring = (log_ring_t *)value;
 
-    // Create log entry with string duplication
-    log_entry_t entry = {
-        .level = level,
-        .module = module ? strdup(module) : NULL,
-        .message = strdup(msg_buffer),
-        .line = line,
-        .file = file ? strdup(file) : NULL,
-        .timestamp = get_timestamp_ms()
-    };
+    pthread_mutex_lock(&g_logger.rings_mutex);
+    for (log_ring_t *it = g_logger.rings; it; it = it->next) {
+        if (it == ring) {
+            atomic_store_explicit(&ring->orphaned, true, memory_order_release);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_logger.rings_mutex);
+}
 
-    pthread_mutex_lock(&g_log_buffer.mutex);
-    
-    // Store entry in buffer (ensure proper serialization)
-    size_t needed = sizeof(log_entry_t);
-    if (g_log_buffer.position + needed > g_log_buffer.size) {
-        logger_flush();
+static log_ring_t *thread_ring(void) {
+    if (tls_ring && tls_generation == g_logger.generation) {
+        return tls_ring;
     }
-    
-    if (g_log_buffer.position + needed <= g_log_buffer.size) {
-        memcpy(g_log_buffer.data + g_log_buffer.position, &entry, needed);
-        g_log_buffer.position += needed;
-    } else {
-        fprintf(stderr, "LOGGER: Entry too large for buffer\n");
+
+    log_ring_t *ring = (log_ring_t *)calloc(1, sizeof(log_ring_t));
+    if (!ring) {
+        return NULL;
+    }
+    if (posix_memalign((void **)&ring->records, 64, g_logger.ring_records * sizeof(log_record_t)) != 0) {
+        free(ring);
+        return NULL;
     }
-    
-    pthread_mutex_unlock(&g_log_buffer.mutex);
+    ring->capacity = g_logger.ring_records;
+    ring->mask = ring->capacity - 1;
+    ring->wake_level = (ring->capacity * g_logger.flush_threshold) / 100;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    atomic_init(&ring->orphaned, false);
+
+    pthread_mutex_lock(&g_logger.rings_mutex);
+    ring->next = g_logger.rings;
+    g_logger.rings = ring;
+    pthread_mutex_unlock(&g_logger.rings_mutex);
+
+    pthread_setspecific(g_logger.ring_key, ring);
+    tls_ring = ring;
+    tls_generation = g_logger.generation;
+    return ring;
 }
 
-#else // Release Mode Stubs
+// --- Core Functions Implementation ---
 
 bool logger_init(size_t buffer_size, uint8_t flush_threshold) {
-    (void)buffer_size;
-    (void)flush_threshold;
+    if (atomic_load(&g_logger.initialized)) {
+        return true;
+    }
+
+    // buffer_size is the size in bytes of the ring of each logging thread
+    size_t records = LOG_RING_MIN_RECORDS;
+    while (records * sizeof(log_record_t) < buffer_size) {
+        records <<= 1;
+    }
+    g_logger.ring_records = records;
+    g_logger.flush_threshold = (flush_threshold > 100) ? 100 : flush_threshold;
+    g_logger.generation++;
+    g_logger.rings = NULL;
+    atomic_store(&g_logger.stop, false);
+    atomic_store(&g_logger.current_level, LOGGER_DEFAULT_LEVEL);
+    atomic_store(&g_logger.output_handler, default_log_handler);
+
+    g_logger.wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_logger.wakeup_fd < 0) {
+        fprintf(stderr, "LOGGER INIT ERROR: eventfd failed: %s\n", strerror(errno));
+        return false;
+    }
+    if (pthread_mutex_init(&g_logger.rings_mutex, NULL) != 0 ||
+        pthread_mutex_init(&g_logger.drain_mutex, NULL) != 0 ||
+        pthread_key_create(&g_logger.ring_key, ring_release) != 0) {
+        fprintf(stderr, "LOGGER INIT ERROR: Failed to create synchronization objects\n");
+        close(g_logger.wakeup_fd);
+        return false;
+    }
+
+    // First calibration point, the rate is refined at every drain
+    g_logger.cal_raw = raw_timestamp();
+    g_logger.cal_ns = clock_ns(CLOCK_REALTIME);
+    g_logger.raw_per_ns = 1.0;
+    while (clock_ns(CLOCK_REALTIME) < g_logger.cal_ns + LOG_CALIBRATION_NS) {
+    }
+    uint64_t raw_now, ns_now;
+    calibrate(&raw_now, &ns_now);
+
+    atomic_store(&g_logger.initialized, true);
+
+    g_logger.drain_started = (pthread_create(&g_logger.drain_thread, NULL, drain_thread, NULL) == 0);
+    if (!g_logger.drain_started) {
+        fprintf(stderr, "LOGGER INIT WARNING: no drain thread, records are written on logger_flush()\n");
+    }
     return true;
-    
 }
 
 void logger_set_level(log_level_t level) {
-    (void)level;
+    atomic_store(&g_logger.current_level, (int)level);
 }
 
 void logger_set_output_handler(log_output_handler_t handler) {
-    (void)handler;
+    atomic_store(&g_logger.output_handler, handler ? handler : default_log_handler);
 }
 
-void logger_flush(void) {}
+void logger_flush(void) {
+    if (!atomic_load(&g_logger.initialized)) {
+        return;
+    }
 
-void logger_shutdown(void) {}
+    pthread_mutex_lock(&g_logger.drain_mutex);
+    drain_rings();
+    pthread_mutex_unlock(&g_logger.drain_mutex);
+}
+
+void logger_shutdown(void) {
+    if (!atomic_load(&g_logger.initialized)) {
+        return;
+    }
+
+    atomic_store(&g_logger.stop, true);
+    if (g_logger.drain_started) {
+        wakeup_drain();
+        pthread_join(g_logger.drain_thread, NULL);
+        g_logger.drain_started = false;
+    }
+
+    logger_flush();
+    atomic_store(&g_logger.initialized, false);
+
+    pthread_mutex_lock(&g_logger.rings_mutex);
+    while (g_logger.rings) {
+        log_ring_t *next = g_logger.rings->next;
+        free_ring(g_logger.rings);
+        g_logger.rings = next;
+    }
+    pthread_mutex_unlock(&g_logger.rings_mutex);
+
+    pthread_key_delete(g_logger.ring_key);
+    pthread_mutex_destroy(&g_logger.rings_mutex);
+    pthread_mutex_destroy(&g_logger.drain_mutex);
+    close(g_logger.wakeup_fd);
+    g_logger.wakeup_fd = -1;
+}
+
+// --- Variadic Logging Function ---
 
 void logger_log(log_level_t level, const char* module, const char* file,
                uint32_t line, const char* format, ...) {
-    (void)level;
-    (void)module;
-    (void)file;
-    (void)line;
-    (void)format;
-}
+    if (!atomic_load_explicit(&g_logger.initialized, memory_order_acquire) ||
+        (int)level > atomic_load_explicit(&g_logger.current_level, memory_order_relaxed) || !format) {
+        return;
+    }
+
+    int saved_errno = errno;
+    uint64_t timestamp = raw_timestamp();
+    log_ring_t *ring = thread_ring();
+    if (!ring) {
+        return;
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t used = head - atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (used >= ring->capacity) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
 
-#endif // DEBUG
\ No newline at end of file
+    log_record_t *rec = &ring->records[head & ring->mask];
+    rec->timestamp = timestamp;
+    rec->format = format;
+    rec->module = module;
+    rec->file = file;
+    rec->line = line;
+    rec->level = (uint8_t)level;
+
+    va_list args;
+    va_start(args, format);
+    capture_args(rec, format, args, saved_errno);
+    va_end(args);
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    // Errors are written out right away, the rest when the ring fills up or periodically
+    if (level <= LOG_LEVEL_WARN || used + 1 == ring->wake_level) {
+        wakeup_drain();
+    }
+    errno = saved_errno;
+}
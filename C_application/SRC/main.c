@@ -3,6 +3,9 @@
 #include <signal.h>
 #include <stdlib.h>
 #include "util.h"
+#include "ipc.h"
+#include "Scenario.h"
+#include <string.h>
 
 // Define a module name for logging
 #define MODULE_NAME "Main"
@@ -13,6 +16,7 @@ volatile int main_application_running = 1;
 void handle_sigint(int sig) {
     LOG_INFO(MODULE_NAME, "SIGINT received, initiating graceful shutdown...");
     main_application_running = 0; // Set the flag to stop main loop
+    ipc_wakeup();                 // The IPC reactor waits without timeout
 }
 
 // Shutdown check callback for the module manager
@@ -20,12 +24,20 @@ int check_app_shutdown_status(void) {
     return !main_application_running;
 }
 
-int main(void) {
+int main(int argc, char *argv[]) {
     if (!logger_init(8192, 80)) {
    
         fprintf(stderr, "Failed to initialize logger. Exiting.\n");
         return EXIT_FAILURE;
     }
+
+    // Offline scenario compiler: sv_simulator --compile-scenario <source> [<output>]
+    if (argc >= 3 && 0 == strcmp(argv[1], "--compile-scenario")) {
+        int result = Scenario_compile(argv[2], (argc >= 4) ? argv[3] : NULL);
+        logger_flush();
+        logger_shutdown();
+        return (SUCCESS == result) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     
     // Set up signal handler
     signal(SIGINT, handle_sigint);
@@ -102,6 +102,23 @@ int parseRequestConfig(
     char **requestId_out,
     cJSON **json_request_out // Output parameter for the root cJSON object
 )
+{
+    return parseRequestConfigWithLength(buffer, strlen(buffer), type_obj_out, data_obj_out, requestId_out, json_request_out);
+}
+
+/**
+ * @brief Same as parseRequestConfig() for a buffer that is not NUL-terminated.
+ *
+ * @param buffer The JSON message, parsed in place.
+ * @param length Length of the JSON message in bytes.
+ */
+int parseRequestConfigWithLength(
+    const char *buffer,
+    size_t length,
+    cJSON **type_obj_out,
+    cJSON **data_obj_out,
+    char **requestId_out,
+    cJSON **json_request_out)
 {
     // Initialize output pointers to NULL for safety
     *type_obj_out = NULL;
@@ -110,7 +127,7 @@ int parseRequestConfig(
 
     *json_request_out = NULL; // Initialize root JSON pointer
 
-    cJSON *json_request = cJSON_Parse(buffer);
+    cJSON *json_request = cJSON_ParseWithLength(buffer, length);
     if (!json_request)
     {
         LOG_ERROR("Parser", "Failed to parse incoming JSON: %s", cJSON_GetErrorPtr());
@@ -233,6 +250,28 @@ int parseGOOSEConfig(
         freeGOOSEConfig(config); // Free already allocated memory
         return FAIL;
     }
+
+    // Extract MACAddress, AppID and Interface
+    const char *keys[] = {"MACAddress", "AppID", "Interface"};
+    char **fields[] = {&config->MACAddress, &config->AppID, &config->Interface};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+    {
+        cJSON *field_obj = cJSON_GetObjectItemCaseSensitive(goose_data, keys[i]);
+        if (!field_obj || !cJSON_IsString(field_obj))
+        {
+            LOG_ERROR("Parser", "Missing or invalid '%s' field in GOOSE data", keys[i]);
+            freeGOOSEConfig(config);
+            return FAIL;
+        }
+        *fields[i] = strdup(field_obj->valuestring);
+        if (!*fields[i])
+        {
+            LOG_ERROR("Parser", "Failed to duplicate %s string: Out of memory", keys[i]);
+            freeGOOSEConfig(config);
+            return FAIL;
+        }
+    }
+    return SUCCESS;
 }
 
 int parseSVconfig(cJSON *instance_json_obj, SV_SimulationConfig *config_out)
@@ -288,6 +327,13 @@ int parseSVconfig(cJSON *instance_json_obj, SV_SimulationConfig *config_out)
 
 #undef PARSE_STRING_FIELD
 
+    // Optional launch time mode, needs an ETF qdisc on svInterface to take effect
+    cJSON *lead_item = cJSON_GetObjectItemCaseSensitive(instance_json_obj, "txTimeLeadUs");
+    if (cJSON_IsNumber(lead_item) && lead_item->valueint > 0)
+    {
+        config_out->txTimeLeadUs = lead_item->valueint;
+    }
+
     return SUCCESS; // Success case
 
 cleanup:
@@ -35,6 +35,12 @@ const char *state_event_to_string(state_event_e event)
         return "pause_simulation";
     case STATE_EVENT_init_failed:
         return "init_failed";
+    case STATE_EVENT_get_latency:
+        return "get_latency";
+    case STATE_EVENT_send_goose:
+        return "send_goose";
+    case STATE_EVENT_swap_scenario:
+        return "swap_scenario";
     case STATE_EVENT_NONE:
         return "NONE";
     }
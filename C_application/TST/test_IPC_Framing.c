@@ -0,0 +1,233 @@
+#include "IPC_Framing.h"
+#include "util.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_MESSAGE 16384
+
+/* Receives bytes into the framer as a socket read would */
+static void feed(IpcFramer *framer, const void *data, size_t length)
+{
+    size_t room = 0;
+    char *dest = ipc_framer_write_ptr(framer, length, &room);
+
+    CHECK(NULL != dest);
+    CHECK(room >= length);
+    if (dest)
+    {
+        memcpy(dest, data, length);
+        ipc_framer_commit(framer, length);
+    }
+}
+
+static void feed_string(IpcFramer *framer, const char *text)
+{
+    feed(framer, text, strlen(text));
+}
+
+/* Extracts the next message and compares it with the expected one */
+static bool next_is(IpcFramer *framer, const char *expected)
+{
+    const char *message = NULL;
+    size_t length = 0;
+
+    return 1 == ipc_framer_next(framer, &message, &length) && strlen(expected) == length &&
+           0 == memcmp(message, expected, length);
+}
+
+static bool nothing_pending(IpcFramer *framer)
+{
+    const char *message;
+    size_t length;
+
+    return 0 == ipc_framer_next(framer, &message, &length);
+}
+
+static void test_json_stream(void)
+{
+    IpcFramer framer;
+    static const char third[] = "{\"data\":{\"text\":\"} \\\" {\"}}";
+
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_JSON_STREAM, TEST_MAX_MESSAGE));
+    feed_string(&framer, " {\"a\":1}\r\n{\"b\":{\"c\":2}}");
+    CHECK(next_is(&framer, "{\"a\":1}"));
+    CHECK(next_is(&framer, "{\"b\":{\"c\":2}}"));
+    CHECK(nothing_pending(&framer));
+
+    // Partial message received one byte at a time, braces and quotes inside strings are not counted
+    for (size_t i = 0; i < sizeof(third) - 2; i++)
+    {
+        feed(&framer, &third[i], 1);
+        CHECK(nothing_pending(&framer));
+    }
+    feed(&framer, &third[sizeof(third) - 2], 1);
+    CHECK(next_is(&framer, third));
+    CHECK(nothing_pending(&framer));
+    ipc_framer_free(&framer);
+}
+
+static void test_newline(void)
+{
+    IpcFramer framer;
+
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_NEWLINE, TEST_MAX_MESSAGE));
+    feed_string(&framer, "{\"a\":1}\r\n\n\r\n{\"b\":2}\n{\"c\"");
+    CHECK(next_is(&framer, "{\"a\":1}"));
+    CHECK(next_is(&framer, "{\"b\":2}")); // empty keep-alive lines are skipped
+    CHECK(nothing_pending(&framer));
+    feed_string(&framer, ":3}");
+    CHECK(nothing_pending(&framer));
+    feed_string(&framer, "\r\n");
+    CHECK(next_is(&framer, "{\"c\":3}"));
+    CHECK(nothing_pending(&framer));
+    ipc_framer_free(&framer);
+}
+
+static void test_length_prefix(void)
+{
+    IpcFramer framer;
+    uint8_t header[IPC_FRAMER_MAX_HEADER];
+    size_t header_size = ipc_framer_header(IPC_FRAMING_LENGTH_PREFIX, 7, header);
+
+    CHECK(IPC_FRAMER_MAX_HEADER == header_size);
+    CHECK(0 == header[0] && 0 == header[1] && 0 == header[2] && 7 == header[3]);
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_LENGTH_PREFIX, TEST_MAX_MESSAGE));
+
+    // Header split across two receives, then the payload in two parts
+    feed(&framer, header, 2);
+    CHECK(nothing_pending(&framer));
+    feed(&framer, header + 2, 2);
+    CHECK(nothing_pending(&framer));
+    feed_string(&framer, "{\"a\"");
+    CHECK(nothing_pending(&framer));
+    feed_string(&framer, ":1}");
+    CHECK(next_is(&framer, "{\"a\":1}"));
+
+    // Empty payload, then a payload of exactly the size limit
+    ipc_framer_header(IPC_FRAMING_LENGTH_PREFIX, 0, header);
+    feed(&framer, header, sizeof(header));
+    CHECK(next_is(&framer, ""));
+    char *payload = (char *)malloc(TEST_MAX_MESSAGE + 1);
+    memset(payload, 'x', TEST_MAX_MESSAGE);
+    payload[TEST_MAX_MESSAGE] = '\0';
+    ipc_framer_header(IPC_FRAMING_LENGTH_PREFIX, TEST_MAX_MESSAGE, header);
+    feed(&framer, header, sizeof(header));
+    feed(&framer, payload, TEST_MAX_MESSAGE);
+    CHECK(next_is(&framer, payload));
+    CHECK(nothing_pending(&framer));
+    free(payload);
+    ipc_framer_free(&framer);
+}
+
+static void test_oversized_messages(void)
+{
+    IpcFramer framer;
+    uint8_t header[IPC_FRAMER_MAX_HEADER];
+    const char *message;
+    size_t length;
+    char *junk = (char *)malloc(TEST_MAX_MESSAGE + 2);
+
+    memset(junk, 'x', TEST_MAX_MESSAGE + 2);
+
+    // Announced size over the limit: rejected as soon as the header is complete
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_LENGTH_PREFIX, TEST_MAX_MESSAGE));
+    ipc_framer_header(IPC_FRAMING_LENGTH_PREFIX, TEST_MAX_MESSAGE + 1, header);
+    feed(&framer, header, sizeof(header));
+    CHECK(FAIL == ipc_framer_next(&framer, &message, &length));
+    CHECK(framer.read_pos == framer.write_pos); // reset: the pending bytes are dropped
+    ipc_framer_header(IPC_FRAMING_LENGTH_PREFIX, 2, header);
+    feed(&framer, header, sizeof(header));
+    feed_string(&framer, "{}");
+    CHECK(next_is(&framer, "{}"));
+    ipc_framer_free(&framer);
+
+    // Line without end over the limit
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_NEWLINE, TEST_MAX_MESSAGE));
+    feed(&framer, junk, TEST_MAX_MESSAGE);
+    CHECK(nothing_pending(&framer));
+    feed(&framer, junk, 1);
+    CHECK(FAIL == ipc_framer_next(&framer, &message, &length));
+    feed_string(&framer, "{}\n");
+    CHECK(next_is(&framer, "{}"));
+    ipc_framer_free(&framer);
+
+    // Unterminated JSON object over the limit
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_JSON_STREAM, TEST_MAX_MESSAGE));
+    feed_string(&framer, "{\"a\":\"");
+    feed(&framer, junk, TEST_MAX_MESSAGE);
+    CHECK(FAIL == ipc_framer_next(&framer, &message, &length));
+    feed_string(&framer, "{\"b\":2}");
+    CHECK(next_is(&framer, "{\"b\":2}"));
+    ipc_framer_free(&framer);
+    free(junk);
+}
+
+static void test_buffer_growth_and_reuse(void)
+{
+    IpcFramer framer;
+    char line[IPC_FRAMER_INITIAL_CAPACITY * 2 + 2];
+    char expected[32];
+
+    // A message bigger than the initial buffer received in small parts stays contiguous
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_NEWLINE, TEST_MAX_MESSAGE));
+    memset(line, 'y', sizeof(line) - 2);
+    line[sizeof(line) - 2] = '\n';
+    line[sizeof(line) - 1] = '\0';
+    for (size_t i = 0; i < sizeof(line) - 1; i += 1000)
+    {
+        size_t part = (sizeof(line) - 1 - i < 1000) ? sizeof(line) - 1 - i : 1000;
+        feed(&framer, line + i, part);
+    }
+    line[sizeof(line) - 2] = '\0';
+    CHECK(next_is(&framer, line));
+    CHECK(framer.capacity <= TEST_MAX_MESSAGE + IPC_FRAMER_MAX_HEADER + 1000);
+    ipc_framer_free(&framer);
+
+    // Messages straddling the end of the buffer: the pending bytes are moved back to the start
+    CHECK(SUCCESS == ipc_framer_init(&framer, IPC_FRAMING_NEWLINE, TEST_MAX_MESSAGE));
+    for (int i = 0; i < 2000; i++)
+    {
+        char message[32];
+        int size = snprintf(message, sizeof(message), "{\"n\":%d}\n", i);
+
+        // Split every message in two receives
+        feed(&framer, message, 3);
+        if (i > 0)
+        {
+            snprintf(expected, sizeof(expected), "{\"n\":%d}", i - 1);
+            CHECK(next_is(&framer, expected));
+        }
+        feed(&framer, message + 3, (size_t)size - 3);
+    }
+    CHECK(next_is(&framer, "{\"n\":1999}"));
+    CHECK(nothing_pending(&framer));
+    CHECK(IPC_FRAMER_INITIAL_CAPACITY == framer.capacity);
+    ipc_framer_free(&framer);
+}
+
+static void test_send_side(void)
+{
+    uint8_t header[IPC_FRAMER_MAX_HEADER];
+    size_t length = 99;
+
+    CHECK(0 == ipc_framer_header(IPC_FRAMING_JSON_STREAM, 10, header));
+    CHECK(0 == ipc_framer_header(IPC_FRAMING_NEWLINE, 10, header));
+    CHECK(4 == ipc_framer_header(IPC_FRAMING_LENGTH_PREFIX, 0x01020304, header));
+    CHECK(1 == header[0] && 2 == header[1] && 3 == header[2] && 4 == header[3]);
+    CHECK(0 == strcmp("\n", ipc_framer_trailer(IPC_FRAMING_NEWLINE, &length)) && 1 == length);
+    CHECK(NULL == ipc_framer_trailer(IPC_FRAMING_LENGTH_PREFIX, &length) && 0 == length);
+    CHECK(0 == strcmp("length-prefix", ipc_framing_to_string(IPC_FRAMING_LENGTH_PREFIX)));
+}
+
+int main(void)
+{
+    RUN_TEST(test_json_stream);
+    RUN_TEST(test_newline);
+    RUN_TEST(test_length_prefix);
+    RUN_TEST(test_oversized_messages);
+    RUN_TEST(test_buffer_growth_and_reuse);
+    RUN_TEST(test_send_side);
+    return TEST_RESULT();
+}
@@ -0,0 +1,185 @@
+#include "Latency_Engine.h"
+#include "util.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define US 1000ULL
+#define MS 1000000ULL
+
+/* Deterministic generator for the random values */
+static uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+static void test_index_exact_below_sub_count(void)
+{
+    for (uint64_t value = 0; value < LATENCY_HISTOGRAM_SUB_COUNT; value++)
+    {
+        CHECK(value == Latency_histogram_index(value));
+        CHECK(value == Latency_histogram_bucket_value((unsigned int)value));
+    }
+    CHECK(LATENCY_HISTOGRAM_SUB_COUNT == Latency_histogram_index(LATENCY_HISTOGRAM_SUB_COUNT));
+}
+
+static void test_index_bounds_and_error(void)
+{
+    unsigned int previous = 0;
+
+    // Every bucket holds the values up to its upper value, the next one starts right after
+    for (unsigned int index = 0; index < LATENCY_HISTOGRAM_BUCKETS; index++)
+    {
+        uint64_t upper = Latency_histogram_bucket_value(index);
+
+        CHECK(index == Latency_histogram_index(upper));
+        if (index + 1 < LATENCY_HISTOGRAM_BUCKETS)
+        {
+            CHECK(index + 1 == Latency_histogram_index(upper + 1));
+        }
+    }
+    CHECK((1ULL << LATENCY_HISTOGRAM_MAX_BITS) - 1 == Latency_histogram_bucket_value(LATENCY_HISTOGRAM_BUCKETS - 1));
+
+    // Monotonic, and the upper value of the bucket is within 1/128 of the value
+    for (int i = 0; i < 200000; i++)
+    {
+        uint64_t value = next_random() >> (next_random() % 64);
+        unsigned int index = Latency_histogram_index(value);
+
+        CHECK(index < LATENCY_HISTOGRAM_BUCKETS);
+        if (value < (1ULL << LATENCY_HISTOGRAM_MAX_BITS))
+        {
+            uint64_t upper = Latency_histogram_bucket_value(index);
+            CHECK(upper >= value);
+            CHECK((upper - value) * LATENCY_HISTOGRAM_HALF_COUNT <= value);
+        }
+        else
+        {
+            CHECK(LATENCY_HISTOGRAM_BUCKETS - 1 == index);
+        }
+    }
+    for (uint64_t value = 0; value < (1ULL << 20); value += 7)
+    {
+        unsigned int index = Latency_histogram_index(value);
+        CHECK(index >= previous);
+        previous = index;
+    }
+    CHECK(LATENCY_HISTOGRAM_BUCKETS - 1 == Latency_histogram_index(UINT64_MAX));
+}
+
+static void test_quantile(void)
+{
+    uint64_t *histogram = (uint64_t *)calloc(LATENCY_HISTOGRAM_BUCKETS, sizeof(uint64_t));
+    unsigned int bucket_count;
+
+    // 1..1000 ns, one sample each: exact below 256, within a bucket above
+    for (uint64_t value = 1; value <= 1000; value++)
+    {
+        histogram[Latency_histogram_index(value)]++;
+    }
+    bucket_count = Latency_histogram_index(1000) + 1;
+    CHECK(1 == Latency_histogram_quantile(histogram, bucket_count, 1000, 1, 1000, 0, 1000));
+    CHECK(100 == Latency_histogram_quantile(histogram, bucket_count, 1000, 1, 1000, 100, 1000));
+    uint64_t p50 = Latency_histogram_quantile(histogram, bucket_count, 1000, 1, 1000, 500, 1000);
+    CHECK(p50 >= 500 && p50 <= 503);
+    uint64_t p99 = Latency_histogram_quantile(histogram, bucket_count, 1000, 1, 1000, 990, 1000);
+    CHECK(p99 >= 990 && p99 <= 997);
+    CHECK(1000 == Latency_histogram_quantile(histogram, bucket_count, 1000, 1, 1000, 1000, 1000)); // clamped to max
+    memset(histogram, 0, LATENCY_HISTOGRAM_BUCKETS * sizeof(uint64_t));
+
+    // 999 samples at 2 ms and one at 40 ms: p99.9 still at 2 ms, the maximum only above it
+    histogram[Latency_histogram_index(2 * MS)] = 999;
+    histogram[Latency_histogram_index(40 * MS)] = 1;
+    bucket_count = Latency_histogram_index(40 * MS) + 1;
+    p50 = Latency_histogram_quantile(histogram, bucket_count, 1000, 2 * MS, 40 * MS, 500, 1000);
+    CHECK(p50 >= 2 * MS && (p50 - 2 * MS) * LATENCY_HISTOGRAM_HALF_COUNT <= 2 * MS);
+    CHECK(p50 == Latency_histogram_quantile(histogram, bucket_count, 1000, 2 * MS, 40 * MS, 999, 1000));
+    CHECK(40 * MS == Latency_histogram_quantile(histogram, bucket_count, 1000, 2 * MS, 40 * MS, 9999, 10000));
+
+    // A single sample: every quantile is that sample, clamped by min and max
+    memset(histogram, 0, LATENCY_HISTOGRAM_BUCKETS * sizeof(uint64_t));
+    histogram[Latency_histogram_index(123456)] = 1;
+    bucket_count = Latency_histogram_index(123456) + 1;
+    CHECK(123456 == Latency_histogram_quantile(histogram, bucket_count, 1, 123456, 123456, 500, 1000));
+    CHECK(123456 == Latency_histogram_quantile(histogram, bucket_count, 1, 123456, 123456, 999, 1000));
+    free(histogram);
+}
+
+static void test_stats(void)
+{
+    LatencyStats stats;
+    uint32_t st_num = 1;
+
+    CHECK(SUCCESS == Latency_init(2));
+    CHECK(2 == Latency_get_instance_count());
+    CHECK(FAIL == Latency_get_stats(2, &stats));
+
+    // The first GOOSE message only sets the stNum reference
+    Latency_goose_received(0, st_num, 0, 0);
+    CHECK(SUCCESS == Latency_get_stats(0, &stats));
+    CHECK(0 == stats.samples && 0 == stats.spurious && 0 == stats.p50_ns);
+
+    // 100 faults answered 1..100 us later, monotonic clock on both ends
+    for (uint64_t i = 1; i <= 100; i++)
+    {
+        uint64_t tx_ns = i * 1000 * MS;
+        Latency_fault_started(0, (uint32_t)i, tx_ns, false);
+        Latency_goose_received(0, ++st_num, 0, tx_ns + i * US);
+        Latency_fault_cleared(0);
+    }
+    // A fault nobody answers and a state change nobody asked for
+    Latency_fault_started(0, 4000, 200000 * MS, false);
+    Latency_fault_cleared(0);
+    Latency_goose_received(0, ++st_num, 0, 200001 * MS);
+
+    CHECK(SUCCESS == Latency_get_stats(0, &stats));
+    CHECK(101 == stats.injections);
+    CHECK(100 == stats.samples);
+    CHECK(1 == stats.missed);
+    CHECK(1 == stats.spurious);
+    CHECK(0 == stats.kernel_timestamped);
+    CHECK(4000 == stats.last_smp_cnt);
+    CHECK(US == stats.min_ns && 100 * US == stats.max_ns && 100 * US == stats.last_ns);
+    CHECK(50500 == stats.mean_ns);
+    CHECK(stats.p50_ns >= 50 * US && (stats.p50_ns - 50 * US) * LATENCY_HISTOGRAM_HALF_COUNT <= 50 * US);
+    CHECK(stats.p99_ns >= 99 * US && stats.p99_ns <= 100 * US);
+    CHECK(100 * US == stats.p999_ns);
+
+    // Kernel timestamps win over the monotonic clock, the transmit one may come after the GOOSE
+    Latency_fault_started(1, 7, 5 * MS, true);
+    Latency_goose_received(1, 1, 0, 0);
+    Latency_goose_received(1, 2, 1000 * MS + 350 * US, 9 * MS);
+    CHECK(SUCCESS == Latency_get_stats(1, &stats));
+    CHECK(0 == stats.samples);
+    Latency_tx_timestamp(1, 1000 * MS);
+    CHECK(SUCCESS == Latency_get_stats(1, &stats));
+    CHECK(1 == stats.samples && 1 == stats.kernel_timestamped);
+    CHECK(350 * US == stats.min_ns && 350 * US == stats.p50_ns && 350 * US == stats.p999_ns);
+
+    // A reset clears the statistics, new samples start from scratch
+    Latency_reset();
+    CHECK(SUCCESS == Latency_get_stats(0, &stats));
+    CHECK(0 == stats.samples && 0 == stats.injections && 0 == stats.max_ns && 0 == stats.p99_ns);
+    Latency_fault_started(0, 1, 10 * MS, false);
+    Latency_goose_received(0, ++st_num, 0, 10 * MS + 3 * US);
+    CHECK(SUCCESS == Latency_get_stats(0, &stats));
+    CHECK(1 == stats.samples && 3 * US == stats.p50_ns && 3 * US == stats.p999_ns);
+
+    Latency_cleanup();
+    CHECK(0 == Latency_get_instance_count());
+}
+
+int main(void)
+{
+    RUN_TEST(test_index_exact_below_sub_count);
+    RUN_TEST(test_index_bounds_and_error);
+    RUN_TEST(test_quantile);
+    RUN_TEST(test_stats);
+    return TEST_RESULT();
+}
@@ -0,0 +1,198 @@
+#include "Ring_Buffer.h"
+#include "util.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sched.h>
+
+#define PRODUCER_COUNT 4
+#define PRODUCER_EVENTS 20000
+
+/* Only the debug log of event_queue_pop() needs the event names of util.c */
+const char *state_event_to_string(state_event_e event)
+{
+    (void)event;
+    return "event";
+}
+
+static char *request_id(int producer, int sequence)
+{
+    char text[32];
+
+    snprintf(text, sizeof(text), "%d:%d", producer, sequence);
+    return strdup(text);
+}
+
+static bool readable(int fd)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+
+    return 1 == poll(&pfd, 1, 0);
+}
+
+static void test_fifo_and_ownership(void)
+{
+    EventQueue queue;
+    state_event_e event;
+    const char *requestId;
+    cJSON *data_obj;
+    cJSON *data = cJSON_CreateObject();
+
+    CHECK(SUCCESS == event_queue_init(&queue, 5));
+    CHECK(8 == queue.capacity);
+    CHECK(!readable(event_queue_get_fd(&queue)));
+
+    CHECK(SUCCESS == event_queue_push(STATE_EVENT_start_simulation, request_id(0, 1), &queue, data));
+    CHECK(SUCCESS == event_queue_push(STATE_EVENT_get_latency, NULL, &queue, NULL));
+    CHECK(readable(event_queue_get_fd(&queue)));
+
+    CHECK(SUCCESS == event_queue_pop(&queue, &event, &requestId, &data_obj));
+    CHECK(STATE_EVENT_start_simulation == event);
+    CHECK(NULL != requestId && 0 == strcmp("0:1", requestId));
+    CHECK(data == data_obj); // handed over, not copied
+    free((char *)requestId);
+    cJSON_Delete(data_obj);
+
+    // NULL out pointers: the queue frees what it owned
+    CHECK(SUCCESS == event_queue_push(STATE_EVENT_stop_simulation, request_id(0, 2), &queue, cJSON_CreateObject()));
+    CHECK(SUCCESS == event_queue_pop(&queue, &event, &requestId, &data_obj));
+    CHECK(STATE_EVENT_get_latency == event && NULL == requestId && NULL == data_obj);
+    CHECK(SUCCESS == event_queue_pop(&queue, &event, NULL, NULL));
+    CHECK(STATE_EVENT_stop_simulation == event);
+    event_queue_destroy(&queue);
+}
+
+static void test_full_queue(void)
+{
+    EventQueue queue;
+    EventQueueStats stats;
+    state_event_e event;
+    const char *requestId;
+    char *rejected = request_id(0, 99);
+
+    CHECK(SUCCESS == event_queue_init(&queue, 4));
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(SUCCESS == event_queue_push(STATE_EVENT_NONE, request_id(0, i), &queue, NULL));
+    }
+    // Full: rejected and still owned by the caller
+    CHECK(FAIL == event_queue_push(STATE_EVENT_NONE, rejected, &queue, NULL));
+    free(rejected);
+    event_queue_get_stats(&queue, &stats);
+    CHECK(1 == stats.dropped);
+    CHECK(4 == stats.high_water);
+    CHECK(4 == stats.capacity);
+
+    // Slots come back once popped, across many rounds
+    for (int i = 4; i < 1000; i++)
+    {
+        CHECK(SUCCESS == event_queue_pop(&queue, &event, &requestId, NULL));
+        CHECK(NULL != requestId && atoi(strchr(requestId, ':') + 1) == i - 4);
+        free((char *)requestId);
+        CHECK(SUCCESS == event_queue_push(STATE_EVENT_NONE, request_id(0, i), &queue, NULL));
+    }
+    // Destroy releases the events still queued
+    event_queue_destroy(&queue);
+    event_queue_destroy(&queue); // already destroyed: nothing happens
+}
+
+static void test_shutdown(void)
+{
+    EventQueue queue;
+    state_event_e event = STATE_EVENT_NONE;
+
+    CHECK(SUCCESS == event_queue_init(&queue, 8));
+    CHECK(SUCCESS == event_queue_push(STATE_EVENT_init_success, NULL, &queue, NULL));
+    CHECK(SUCCESS == event_queue_shutdown(&queue));
+    CHECK(FAIL == event_queue_push(STATE_EVENT_init_failed, NULL, &queue, NULL));
+
+    // Events queued before the shutdown are still delivered, then pop fails instead of blocking
+    CHECK(SUCCESS == event_queue_pop(&queue, &event, NULL, NULL));
+    CHECK(STATE_EVENT_init_success == event);
+    CHECK(FAIL == event_queue_pop(&queue, &event, NULL, NULL));
+    CHECK(STATE_EVENT_shutdown == event);
+    event_queue_destroy(&queue);
+}
+
+typedef struct
+{
+    EventQueue *queue;
+    int producer;
+} ProducerData;
+
+static void *producer_thread(void *arg)
+{
+    ProducerData *data = (ProducerData *)arg;
+
+    for (int i = 0; i < PRODUCER_EVENTS; i++)
+    {
+        char *requestId = request_id(data->producer, i);
+
+        // Full queue: the event stays ours, retry once the consumer caught up
+        while (SUCCESS != event_queue_push(STATE_EVENT_NONE, requestId, data->queue, NULL))
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_producers_and_consumer(void)
+{
+    EventQueue queue;
+    pthread_t threads[PRODUCER_COUNT];
+    ProducerData producers[PRODUCER_COUNT];
+    int next[PRODUCER_COUNT] = {0};
+    int received = 0;
+    bool in_order = true;
+    state_event_e event;
+    const char *requestId;
+
+    CHECK(SUCCESS == event_queue_init(&queue, 64));
+    for (int i = 0; i < PRODUCER_COUNT; i++)
+    {
+        producers[i].queue = &queue;
+        producers[i].producer = i;
+        CHECK(0 == pthread_create(&threads[i], NULL, producer_thread, &producers[i]));
+    }
+
+    // Every event is received once, in order within its producer
+    while (received < PRODUCER_COUNT * PRODUCER_EVENTS &&
+           SUCCESS == event_queue_pop(&queue, &event, &requestId, NULL))
+    {
+        int producer;
+        int sequence;
+
+        if (!requestId || 2 != sscanf(requestId, "%d:%d", &producer, &sequence) || producer < 0 ||
+            producer >= PRODUCER_COUNT || sequence != next[producer])
+        {
+            in_order = false;
+        }
+        else
+        {
+            next[producer]++;
+        }
+        free((char *)requestId);
+        received++;
+    }
+    for (int i = 0; i < PRODUCER_COUNT; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    CHECK(PRODUCER_COUNT * PRODUCER_EVENTS == received);
+    CHECK(in_order);
+
+    event_queue_destroy(&queue);
+}
+
+int main(void)
+{
+    RUN_TEST(test_fifo_and_ownership);
+    RUN_TEST(test_full_queue);
+    RUN_TEST(test_shutdown);
+    RUN_TEST(test_producers_and_consumer);
+    return TEST_RESULT();
+}
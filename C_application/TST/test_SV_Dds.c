@@ -0,0 +1,119 @@
+#include "SV_Dds.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SAMPLE_RATE_HZ 4800.0
+#define TURN 18446744073709551616.0 // 2^64
+
+/* Sine of a phase in double precision, the reference of the batch computation */
+static double sine_of(uint64_t phase)
+{
+    return sin(2.0 * M_PI * ((double)phase / TURN));
+}
+
+static void test_step(void)
+{
+    // 1200 Hz at 4800 samples per second: a quarter turn per sample, exactly
+    CHECK(1ULL << 62 == SV_Dds_step(1200.0, SAMPLE_RATE_HZ));
+    CHECK(0 == SV_Dds_step(0.0, SAMPLE_RATE_HZ));
+    CHECK(0 == SV_Dds_step(-50.0, SAMPLE_RATE_HZ));
+    CHECK(SV_Dds_step(1200.0, SAMPLE_RATE_HZ) == SV_Dds_step(1200.0 + SAMPLE_RATE_HZ, SAMPLE_RATE_HZ)); // aliased
+
+    // 50 Hz: one turn every 96 samples, back at the start up to the double rounding of the step,
+    // far below the 24 bits of phase used by the sine computation
+    uint64_t step = SV_Dds_step(50.0, SAMPLE_RATE_HZ);
+    uint64_t phase = 0;
+    for (int i = 0; i < 96; i++)
+    {
+        phase += step;
+    }
+    CHECK(llabs((long long)(int64_t)phase) < (1LL << 16));
+
+    // Resolution far below a microhertz
+    CHECK(SV_Dds_step(50.000001, SAMPLE_RATE_HZ) - step > 1000);
+}
+
+static void test_step_delta(void)
+{
+    // -1 Hz/s: after one second of samples the frequency is 1 Hz lower
+    int64_t delta = SV_Dds_step_delta(-1.0, SAMPLE_RATE_HZ);
+    uint64_t step = SV_Dds_step(50.0, SAMPLE_RATE_HZ);
+
+    CHECK(delta < 0);
+    CHECK(0 == SV_Dds_step_delta(0.0, SAMPLE_RATE_HZ));
+    CHECK(-delta == SV_Dds_step_delta(1.0, SAMPLE_RATE_HZ));
+    for (int i = 0; i < (int)SAMPLE_RATE_HZ; i++)
+    {
+        step += (uint64_t)delta;
+    }
+    CHECK(fabs((double)step / TURN * SAMPLE_RATE_HZ - 49.0) < 1e-9);
+}
+
+static void test_angle(void)
+{
+    CHECK(0 == SV_Dds_angle(0.0));
+    CHECK(1ULL << 62 == SV_Dds_angle(90.0));
+    CHECK(1ULL << 63 == SV_Dds_angle(180.0));
+    CHECK(3ULL << 62 == SV_Dds_angle(-90.0));
+    CHECK(0 == SV_Dds_angle(360.0));
+    CHECK(0 == SV_Dds_angle(-360.0));
+    CHECK(1ULL << 61 == SV_Dds_angle(765.0)); // 2 turns + 45 degrees
+    CHECK(SV_Dds_angle(-1e-12) > UINT64_MAX - (1ULL << 32)); // just below a turn, not wrapped to 0 early
+}
+
+static void test_compute(void)
+{
+    SVDdsChannel channels[3] = {
+        {SV_Dds_angle(0.0), SV_Dds_step(50.0, SAMPLE_RATE_HZ), 0, 100.0f},
+        {SV_Dds_angle(240.0), SV_Dds_step(50.0, SAMPLE_RATE_HZ), 0, 2.0f},
+        {SV_Dds_angle(120.0), SV_Dds_step(60.0, SAMPLE_RATE_HZ), SV_Dds_step_delta(-5.0, SAMPLE_RATE_HZ), 1.0f},
+    };
+    const SVDdsChannel *pointers[3] = {&channels[0], &channels[1], &channels[2]};
+    float values[SV_DDS_BATCH_MAX];
+    double worst = 0.0;
+
+    // The channels are not advanced by the batch, SV_Dds_advance() steps them the same way
+    for (int block = 0; block < 2000; block++)
+    {
+        const uint64_t phase = channels[2].phase;
+
+        SV_Dds_compute(pointers, 3, 16, values);
+        CHECK(phase == channels[2].phase);
+        for (int n = 0; n < 16; n++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                double error = fabs(values[n * 3 + c] / channels[c].amplitude - sine_of(channels[c].phase));
+
+                worst = (error > worst) ? error : worst;
+                SV_Dds_advance(&channels[c]);
+            }
+        }
+    }
+    CHECK(worst < 4e-7);
+
+    // Quarter turns land on the table points: exact values
+    SVDdsChannel quarter = {0, 1ULL << 62, 0, 10.0f};
+    const SVDdsChannel *single[1] = {&quarter};
+    SV_Dds_compute(single, 1, 4, values);
+    CHECK(fabsf(values[0]) < 1e-6f && fabsf(values[1] - 10.0f) < 1e-5f);
+    CHECK(fabsf(values[2]) < 1e-5f && fabsf(values[3] + 10.0f) < 1e-5f);
+
+    // A batch larger than SV_DDS_BATCH_MAX is refused, the output is left untouched
+    memset(values, 0, sizeof(values));
+    values[0] = 42.0f;
+    SV_Dds_compute(pointers, 3, SV_DDS_BATCH_MAX, values);
+    CHECK(42.0f == values[0]);
+}
+
+int main(void)
+{
+    RUN_TEST(test_step);
+    RUN_TEST(test_step_delta);
+    RUN_TEST(test_angle);
+    RUN_TEST(test_compute);
+    return TEST_RESULT();
+}
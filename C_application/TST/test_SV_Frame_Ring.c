@@ -0,0 +1,210 @@
+#include "SV_Frame_Ring.h"
+#include "util.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define STREAM_FRAMES 200000
+
+/* Frame content derived from its number, checked by the consumer */
+static void fill_slot(SVFrameSlot *slot, uint32_t number)
+{
+    slot->smp_cnt = number;
+    slot->size = 64 + (int)(number % 64);
+    for (int i = 0; i < slot->size; i++)
+    {
+        slot->frame[i] = (uint8_t)(number + (uint32_t)i);
+    }
+}
+
+static bool slot_matches(const SVFrameSlot *slot, uint32_t number)
+{
+    if (slot->smp_cnt != number || slot->size != 64 + (int)(number % 64))
+    {
+        return false;
+    }
+    for (int i = 0; i < slot->size; i++)
+    {
+        if (slot->frame[i] != (uint8_t)(number + (uint32_t)i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_init(void)
+{
+    SVFrameRing ring;
+
+    CHECK(SUCCESS == SV_FrameRing_init(&ring, 20));
+    CHECK(32 == ring.capacity && 31 == ring.mask);
+    CHECK(32 == SV_FrameRing_low_water(&ring));
+    CHECK(0 == SV_FrameRing_occupancy(&ring));
+    SV_FrameRing_destroy(&ring);
+    CHECK(NULL == ring.slots);
+    CHECK(FAIL == SV_FrameRing_init(&ring, 0));
+    CHECK(FAIL == SV_FrameRing_init(&ring, (1u << 16) + 1));
+    CHECK(FAIL == SV_FrameRing_init(NULL, 8));
+}
+
+static void test_fill_and_drain(void)
+{
+    SVFrameRing ring;
+
+    CHECK(SUCCESS == SV_FrameRing_init(&ring, 8));
+
+    // A reserved slot is not visible to the consumer before it is committed
+    SVFrameSlot *slot = SV_FrameRing_reserve(&ring);
+    CHECK(NULL != slot);
+    fill_slot(slot, 0);
+    CHECK(0 == SV_FrameRing_occupancy(&ring));
+    SV_FrameRing_commit(&ring);
+    for (uint32_t i = 1; i < 8; i++)
+    {
+        slot = SV_FrameRing_reserve(&ring);
+        CHECK(NULL != slot);
+        if (slot)
+        {
+            fill_slot(slot, i);
+            SV_FrameRing_commit(&ring);
+        }
+    }
+    CHECK(8 == SV_FrameRing_occupancy(&ring));
+    CHECK(NULL == SV_FrameRing_reserve(&ring)); // full
+
+    // Frames are read in place, in order, and peekAt() looks ahead without consuming
+    CHECK(slot_matches(SV_FrameRing_peekAt(&ring, 3), 3));
+    CHECK(NULL == SV_FrameRing_peekAt(&ring, 8));
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        slot = SV_FrameRing_peek(&ring);
+        CHECK(NULL != slot && slot_matches(slot, i));
+        SV_FrameRing_release(&ring);
+    }
+    CHECK(3 == SV_FrameRing_occupancy(&ring));
+    CHECK(4 == SV_FrameRing_low_water(&ring)); // lowest occupancy seen by peek(): 8, 7, 6, 5 then 4
+
+    // The released slots are reused
+    for (uint32_t i = 8; i < 13; i++)
+    {
+        slot = SV_FrameRing_reserve(&ring);
+        CHECK(NULL != slot);
+        if (slot)
+        {
+            fill_slot(slot, i);
+            SV_FrameRing_commit(&ring);
+        }
+    }
+    for (uint32_t i = 5; i < 13; i++)
+    {
+        CHECK(slot_matches(SV_FrameRing_peek(&ring), i));
+        SV_FrameRing_release(&ring);
+    }
+    CHECK(NULL == SV_FrameRing_peek(&ring));
+    CHECK(0 == SV_FrameRing_low_water(&ring));
+    SV_FrameRing_destroy(&ring);
+}
+
+static void test_index_wrap(void)
+{
+    SVFrameRing ring;
+    bool ordered = true;
+
+    // Indexes close to the 32-bit wrap: occupancy and slot selection stay right across it
+    CHECK(SUCCESS == SV_FrameRing_init(&ring, 4));
+    atomic_store(&ring.tail, UINT32_MAX - 5);
+    atomic_store(&ring.head, UINT32_MAX - 5);
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        SVFrameSlot *slot = SV_FrameRing_reserve(&ring);
+
+        if (!slot)
+        {
+            ordered = false;
+            break;
+        }
+        fill_slot(slot, i);
+        SV_FrameRing_commit(&ring);
+        if (1 != SV_FrameRing_occupancy(&ring) || !slot_matches(SV_FrameRing_peek(&ring), i))
+        {
+            ordered = false;
+        }
+        SV_FrameRing_release(&ring);
+    }
+    CHECK(ordered);
+    CHECK(0 == SV_FrameRing_occupancy(&ring));
+    SV_FrameRing_destroy(&ring);
+}
+
+static bool low_water_in_range = true;
+
+static void *producer_thread(void *arg)
+{
+    SVFrameRing *ring = (SVFrameRing *)arg;
+
+    for (uint32_t i = 0; i < STREAM_FRAMES; i++)
+    {
+        SVFrameSlot *slot;
+
+        // Read while the consumer updates it, as the statistics request does
+        if (SV_FrameRing_low_water(ring) > ring->capacity)
+        {
+            low_water_in_range = false;
+        }
+
+        while (NULL == (slot = SV_FrameRing_reserve(ring)))
+        {
+            sched_yield();
+        }
+        fill_slot(slot, i);
+        SV_FrameRing_commit(ring);
+    }
+    return NULL;
+}
+
+static void test_producer_and_consumer(void)
+{
+    SVFrameRing ring;
+    pthread_t producer;
+    uint32_t received = 0;
+    bool intact = true;
+
+    CHECK(SUCCESS == SV_FrameRing_init(&ring, 16));
+    CHECK(0 == pthread_create(&producer, NULL, producer_thread, &ring));
+
+    // Every frame is received once, in order and complete
+    while (received < STREAM_FRAMES)
+    {
+        SVFrameSlot *slot = SV_FrameRing_peek(&ring);
+
+        if (!slot)
+        {
+            sched_yield();
+            continue;
+        }
+        if (!slot_matches(slot, received))
+        {
+            intact = false;
+        }
+        SV_FrameRing_release(&ring);
+        received++;
+    }
+    pthread_join(producer, NULL);
+    CHECK(intact);
+    CHECK(low_water_in_range);
+    CHECK(0 == SV_FrameRing_occupancy(&ring));
+    SV_FrameRing_destroy(&ring);
+}
+
+int main(void)
+{
+    RUN_TEST(test_init);
+    RUN_TEST(test_fill_and_drain);
+    RUN_TEST(test_index_wrap);
+    RUN_TEST(test_producer_and_consumer);
+    return TEST_RESULT();
+}
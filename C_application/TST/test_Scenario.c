@@ -0,0 +1,364 @@
+#include "Scenario.h"
+#include "util.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+static char test_dir[] = "/tmp/test_Scenario.XXXXXX";
+
+static const char *text_scenario =
+    "repeat=2\n"
+    "# Phase 1: load\n"
+    "duration_ms=100\n"
+    "channel1_voltage1=230\n"
+    "channel1_voltage2=230\n"
+    "channel1_voltage3=230\n"
+    "channel1_current1=0.5\n"
+    "# Phase 2: fault with a frequency ramp\n"
+    "duration_ms=50\n"
+    "channel1_current1=10\n"
+    "frequency_hz=49.5\n"
+    "rocof_hz_per_s=-1\n"
+    "# Phase 3: recovery\n"
+    "duration_ms=20\n"
+    "inception_angle_deg=90\n";
+
+/* Path of a file of the test directory, valid for the next three calls (two paths per call at most) */
+static const char *path_of(const char *name)
+{
+    static char paths[3][256];
+    static int next = 0;
+    char *path = paths[next];
+
+    next = (next + 1) % 3;
+    snprintf(path, sizeof(paths[0]), "%s/%s", test_dir, name);
+    return path;
+}
+
+static void write_file(const char *path, const void *data, size_t size)
+{
+    FILE *file = fopen(path, "wb");
+
+    CHECK(NULL != file);
+    if (file)
+    {
+        CHECK(1 == fwrite(data, size, 1, file));
+        fclose(file);
+    }
+}
+
+/* Reads a compiled scenario into a heap buffer */
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    uint8_t *data = NULL;
+    long length;
+
+    if (!file)
+    {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    rewind(file);
+    data = (uint8_t *)malloc((size_t)length);
+    if (data && 1 != fread(data, (size_t)length, 1, file))
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
+
+/* Writes a copy of a valid compiled scenario with a damaged header and checks that it is rejected */
+static void check_rejected(const uint8_t *image, size_t size, size_t damaged_size, void (*damage)(ScenarioHeader *))
+{
+    uint8_t *copy = (uint8_t *)malloc(size);
+    Scenario scenario;
+
+    memcpy(copy, image, size);
+    damage((ScenarioHeader *)copy);
+    write_file(path_of("damaged.scnb"), copy, damaged_size);
+    CHECK(FAIL == Scenario_load(&scenario, path_of("damaged.scnb")));
+    CHECK(NULL == scenario.image);
+    Scenario_unload(&scenario);
+    free(copy);
+}
+
+static void damage_none(ScenarioHeader *header) { (void)header; }
+static void damage_magic(ScenarioHeader *header) { header->magic = __builtin_bswap32(SCENARIO_MAGIC); }
+static void damage_version(ScenarioHeader *header) { header->version = SCENARIO_VERSION - 1; }
+static void damage_newer_version(ScenarioHeader *header) { header->version = SCENARIO_VERSION + 1; }
+static void damage_header_size(ScenarioHeader *header) { header->header_size = sizeof(ScenarioHeader) - 8; }
+static void damage_stride(ScenarioHeader *header) { header->phase_stride = sizeof(ScenarioPhase) - 4; }
+static void damage_no_phase(ScenarioHeader *header) { header->phase_count = 0; }
+static void damage_phase_count(ScenarioHeader *header) { header->phase_count += 1; }
+static void damage_huge_phase_count(ScenarioHeader *header) { header->phase_count = UINT32_MAX; }
+static void damage_channel(ScenarioHeader *header) { header->channel = SCENARIO_MAX_CHANNELS; }
+
+static void test_compile_text(void)
+{
+    Scenario scenario;
+
+    write_file(path_of("text.txt"), text_scenario, strlen(text_scenario));
+    CHECK(SUCCESS == Scenario_compile(path_of("text.txt"), path_of("text.scnb")));
+    CHECK(SUCCESS == Scenario_load(&scenario, path_of("text.scnb")));
+    CHECK(scenario.mapped);
+    CHECK(3 == scenario.phase_count);
+    CHECK(2 == scenario.repeat_count);
+    CHECK(0 == scenario.channel);
+    CHECK(170 == scenario.duration_ms);
+    if (3 == scenario.phase_count)
+    {
+        const ScenarioPhase *load = Scenario_phase(&scenario, 0);
+        const ScenarioPhase *fault = Scenario_phase(&scenario, 1);
+        const ScenarioPhase *recovery = Scenario_phase(&scenario, 2);
+
+        CHECK(0 == load->start_ms && 100 == load->duration_ms);
+        CHECK(230.0f == load->voltage[0][2]);
+        CHECK(0 == (load->flags & SCENARIO_PHASE_FAULT));
+        CHECK(SCENARIO_NOMINAL_FREQUENCY_HZ == load->frequency_hz);
+        CHECK(100 == fault->start_ms);
+        CHECK(fault->flags & SCENARIO_PHASE_FAULT);
+        CHECK(fault->flags & SCENARIO_PHASE_FREQUENCY);
+        CHECK(49.5f == fault->frequency_hz);
+        CHECK(150 == recovery->start_ms);
+        CHECK(recovery->flags & SCENARIO_PHASE_POINT_ON_WAVE);
+        CHECK(90.0f == recovery->inception_angle_deg);
+        // Continues at the frequency the ramp of the fault phase ended with
+        CHECK(fabsf(recovery->frequency_hz - 49.45f) < 1e-4f);
+    }
+    Scenario_unload(&scenario);
+}
+
+static void test_compile_xml(void)
+{
+    static const char xml[] =
+        "<?xml version=\"1.0\"?>\n"
+        "<Scenario repeat=\"0\">\n"
+        "  <Phase durationMs=\"40\" frequencyHz=\"60\">\n"
+        "    <Channel id=\"2\" voltage1=\"100\" current2=\"5\"/>\n"
+        "  </Phase>\n"
+        "</Scenario>\n";
+    Scenario scenario;
+
+    write_file(path_of("xml.xml"), xml, strlen(xml));
+    CHECK(SUCCESS == Scenario_compile(path_of("xml.xml"), NULL));
+    CHECK(0 == access(path_of("xml.xml" SCENARIO_BINARY_SUFFIX), R_OK));
+    CHECK(SUCCESS == Scenario_load(&scenario, path_of("xml.xml" SCENARIO_BINARY_SUFFIX)));
+    CHECK(1 == scenario.phase_count);
+    CHECK(0 == scenario.repeat_count);
+    CHECK(1 == scenario.channel); // the only channel set is channel 2
+    if (1 == scenario.phase_count)
+    {
+        CHECK(Scenario_phase(&scenario, 0)->flags & SCENARIO_PHASE_FAULT);
+        CHECK(60.0f == Scenario_phase(&scenario, 0)->frequency_hz);
+        CHECK(5.0f == Scenario_phase(&scenario, 0)->current[1][1]);
+    }
+    Scenario_unload(&scenario);
+}
+
+static void test_invalid_sources(void)
+{
+    static const char *sources[] = {
+        "# Phase 1\nduration_ms=10\nchannel1_power=3\n", // unknown key
+        "# Phase 1\nduration_ms=-10\n",                  // negative duration
+        "duration_ms=10\n",                              // phase key before the first phase
+        "repeat=1\n",                                    // no phase
+        "# Phase 1\nduration_ms=10\nchannel3_voltage1=1\n",
+        "# Phase 1\nduration_ms=10\ninception_angle_deg=360\n",
+        "# Phase 1\nduration_ms=1000\nrocof_hz_per_s=-60\n", // ramps the frequency below 0 Hz
+        "<Scenario><Phase durationMs=\"10\" speed=\"1\"/></Scenario>",
+    };
+
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++)
+    {
+        write_file(path_of("invalid.txt"), sources[i], strlen(sources[i]));
+        CHECK(FAIL == Scenario_compile(path_of("invalid.txt"), path_of("invalid.scnb")));
+    }
+    CHECK(0 != access(path_of("invalid.scnb"), F_OK));
+    CHECK(FAIL == Scenario_compile(path_of("missing.txt"), NULL));
+}
+
+static void test_reject_corrupt_binary(void)
+{
+    size_t size = 0;
+    uint8_t *image = read_file(path_of("text.scnb"), &size);
+
+    CHECK(NULL != image);
+    if (!image)
+    {
+        return;
+    }
+    check_rejected(image, size, size, damage_magic); // other byte order: not taken for a compiled scenario
+    check_rejected(image, size, size, damage_version);
+    check_rejected(image, size, size, damage_newer_version);
+    check_rejected(image, size, size, damage_header_size);
+    check_rejected(image, size, size, damage_stride);
+    check_rejected(image, size, size, damage_no_phase);
+    check_rejected(image, size, size, damage_phase_count);
+    check_rejected(image, size, size, damage_huge_phase_count);
+    check_rejected(image, size, size, damage_channel);
+    // Truncated in the phase table, then in the header
+    check_rejected(image, size, size - 1, damage_none);
+    check_rejected(image, size, sizeof(ScenarioHeader) - 1, damage_none);
+    free(image);
+}
+
+static void test_load_source_with_stale_binary(void)
+{
+    Scenario scenario;
+    size_t size = 0;
+    uint8_t *image;
+
+    // A compiled file of another version next to the source, newer than it: compiled again
+    write_file(path_of("stale.txt"), text_scenario, strlen(text_scenario));
+    image = read_file(path_of("text.scnb"), &size);
+    CHECK(NULL != image);
+    if (!image)
+    {
+        return;
+    }
+    damage_version((ScenarioHeader *)image);
+    write_file(path_of("stale.txt" SCENARIO_BINARY_SUFFIX), image, size);
+    free(image);
+
+    CHECK(SUCCESS == Scenario_load(&scenario, path_of("stale.txt")));
+    CHECK(!scenario.mapped);
+    CHECK(3 == scenario.phase_count);
+    Scenario_unload(&scenario);
+
+    // The compiled file was rewritten: the next load maps it
+    CHECK(SUCCESS == Scenario_load(&scenario, path_of("stale.txt")));
+    CHECK(scenario.mapped);
+    CHECK(3 == scenario.phase_count);
+    Scenario_unload(&scenario);
+}
+
+static void test_acquire_shares_identical_scenarios(void)
+{
+    const Scenario *first;
+    const Scenario *again;
+    const Scenario *copy;
+
+    write_file(path_of("copy.txt"), text_scenario, strlen(text_scenario));
+    first = Scenario_acquire(path_of("text.txt"));
+    again = Scenario_acquire(path_of("text.txt"));
+    copy = Scenario_acquire(path_of("copy.txt"));
+    CHECK(NULL != first);
+    CHECK(first == again);
+    CHECK(first == copy); // same compiled content
+    CHECK(NULL == Scenario_acquire(path_of("missing.txt")));
+    Scenario_release(first);
+    Scenario_release(again);
+    Scenario_release(copy);
+    Scenario_cache_clear();
+}
+
+static void test_retain_keeps_the_scenario(void)
+{
+    const Scenario *scenario = Scenario_acquire(path_of("text.txt"));
+
+    CHECK(NULL != scenario);
+    if (!scenario)
+    {
+        return;
+    }
+    // The retained reference outlives the acquired one: the cache does not free the scenario
+    Scenario_retain(scenario);
+    Scenario_release(scenario);
+    Scenario_cache_clear();
+    CHECK(3 == scenario->phase_count);
+    CHECK(50 == Scenario_phase(scenario, 1)->duration_ms);
+    Scenario_release(scenario);
+    Scenario_cache_clear();
+}
+
+/* Scenario_time_to_sample() is the first sample at or after the time: checked with 128-bit arithmetic */
+static bool is_first_sample_at_or_after(uint64_t ms, uint32_t samples_per_period, uint64_t period_ns)
+{
+    const unsigned __int128 time = (unsigned __int128)ms * 1000000u * samples_per_period; // in period_ns / samples units
+    const unsigned __int128 sample = Scenario_time_to_sample(ms, samples_per_period, period_ns);
+
+    return sample * period_ns >= time && (0 == sample || (sample - 1) * period_ns < time);
+}
+
+static void test_time_to_sample(void)
+{
+    bool exact = true;
+    uint64_t previous = 0;
+    bool steady = true;
+
+    // 2 samples per 416667 ns (4799.996 Hz): 1 ms is 4.8 samples, 1 s is 4799.996 samples
+    CHECK(0 == Scenario_time_to_sample(0, 2, 416667));
+    CHECK(5 == Scenario_time_to_sample(1, 2, 416667));
+    CHECK(4800 == Scenario_time_to_sample(1000, 2, 416667));
+    CHECK(4 == Scenario_time_to_sample(1, 1, 250000)); // on a sample: that sample
+
+    // Boundaries of a long run of 33 ms phases, computed from their absolute time: 158 or 159 samples
+    // apart, never accumulating the rounding of the previous phases
+    for (uint64_t phase = 1; phase <= 1000000; phase++)
+    {
+        uint64_t boundary = Scenario_time_to_sample(phase * 33, 2, 416667);
+
+        if (!is_first_sample_at_or_after(phase * 33, 2, 416667))
+        {
+            exact = false;
+        }
+        if (boundary - previous != 158 && boundary - previous != 159)
+        {
+            steady = false;
+        }
+        previous = boundary;
+    }
+    CHECK(exact);
+    CHECK(steady);
+
+    // Far times: ten years of stream
+    srand(2024);
+    exact = true;
+    for (int i = 0; i < 100000; i++)
+    {
+        uint64_t ms = ((uint64_t)rand() << 16 ^ (uint64_t)rand()) % (10ULL * 365 * 24 * 3600 * 1000);
+
+        if (!is_first_sample_at_or_after(ms, 2, 416667) || !is_first_sample_at_or_after(ms, 1, 208333))
+        {
+            exact = false;
+        }
+    }
+    CHECK(exact);
+}
+
+int main(void)
+{
+    char command[64];
+    int result;
+
+    if (!mkdtemp(test_dir))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    RUN_TEST(test_compile_text);
+    RUN_TEST(test_compile_xml);
+    RUN_TEST(test_invalid_sources);
+    RUN_TEST(test_reject_corrupt_binary);
+    RUN_TEST(test_load_source_with_stale_binary);
+    RUN_TEST(test_acquire_shares_identical_scenarios);
+    RUN_TEST(test_retain_keeps_the_scenario);
+    RUN_TEST(test_time_to_sample);
+    result = TEST_RESULT();
+
+    snprintf(command, sizeof(command), "rm -rf %s", test_dir);
+    if (0 != system(command))
+    {
+        fprintf(stderr, "Could not remove %s\n", test_dir);
+    }
+    return result;
+}
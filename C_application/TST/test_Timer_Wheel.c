@@ -0,0 +1,292 @@
+#include "Timer_Wheel.h"
+#include "util.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#define TICK_NS 100000ULL // 100 us
+#define START_NS 5000000ULL
+
+/* A test timer: what the callback saw and how it reschedules the timer */
+typedef struct
+{
+    TimerWheelEntry entry; // must stay first
+    TimerWheel *wheel;
+    uint64_t now_ns;       // time given to the TimerWheel_advance() call under test
+    uint64_t period_ns;    // 0: one shot
+    int expirations;
+    int reschedules_left;  // reschedules at the same (already due) time
+    uint64_t last_due_ns;
+    bool early;            // expired before its due time
+} TestTimer;
+
+static uint64_t at_tick(uint64_t tick)
+{
+    return START_NS + tick * TICK_NS;
+}
+
+static void on_expiry(TimerWheelEntry *entry, uint64_t due_ns, void *context)
+{
+    TestTimer *timer = (TestTimer *)entry;
+
+    (void)context;
+    timer->expirations++;
+    timer->last_due_ns = due_ns;
+    if (due_ns > timer->now_ns)
+    {
+        timer->early = true;
+    }
+    if (timer->reschedules_left > 0)
+    {
+        timer->reschedules_left--;
+        TimerWheel_schedule(timer->wheel, entry, due_ns);
+    }
+    else if (timer->period_ns)
+    {
+        TimerWheel_schedule(timer->wheel, entry, due_ns + timer->period_ns);
+    }
+}
+
+static int advance(TimerWheel *wheel, TestTimer *timers, int count, uint64_t now_ns)
+{
+    for (int i = 0; i < count; i++)
+    {
+        timers[i].now_ns = now_ns;
+    }
+    return TimerWheel_advance(wheel, now_ns, on_expiry, NULL);
+}
+
+static void test_one_shot(void)
+{
+    TimerWheel wheel;
+    TestTimer timer = {0};
+
+    CHECK(SUCCESS == TimerWheel_init(&wheel, 6, TICK_NS, START_NS));
+    CHECK(7 == wheel.slot_mask); // rounded up to 8 slots
+    timer.wheel = &wheel;
+
+    // 2.5 ticks: rounded up to tick 3, never expires early
+    TimerWheel_schedule(&wheel, &timer.entry, START_NS + 250000);
+    CHECK(1 == wheel.count);
+    CHECK(0 == advance(&wheel, &timer, 1, at_tick(3) - 1));
+    CHECK(1 == advance(&wheel, &timer, 1, at_tick(3)));
+    CHECK(START_NS + 250000 == timer.last_due_ns);
+    CHECK(!timer.entry.scheduled);
+    CHECK(0 == wheel.count);
+    CHECK(0 == advance(&wheel, &timer, 1, at_tick(20)));
+    CHECK(1 == timer.expirations);
+
+    // Due in the past: expires at the next tick
+    TimerWheel_schedule(&wheel, &timer.entry, START_NS);
+    CHECK(at_tick(21) == TimerWheel_next_tick_ns(&wheel));
+    CHECK(1 == advance(&wheel, &timer, 1, at_tick(21)));
+    CHECK(!timer.early);
+    TimerWheel_destroy(&wheel);
+}
+
+static void test_cancel_and_move(void)
+{
+    TimerWheel wheel;
+    TestTimer timer = {0};
+
+    CHECK(SUCCESS == TimerWheel_init(&wheel, 8, TICK_NS, START_NS));
+    timer.wheel = &wheel;
+    TimerWheel_schedule(&wheel, &timer.entry, at_tick(2));
+    TimerWheel_schedule(&wheel, &timer.entry, at_tick(5)); // moved, not added twice
+    CHECK(1 == wheel.count);
+    CHECK(0 == advance(&wheel, &timer, 1, at_tick(4)));
+    CHECK(1 == advance(&wheel, &timer, 1, at_tick(5)));
+
+    TimerWheel_schedule(&wheel, &timer.entry, at_tick(7));
+    TimerWheel_cancel(&wheel, &timer.entry);
+    TimerWheel_cancel(&wheel, &timer.entry); // not scheduled anymore: nothing happens
+    CHECK(0 == wheel.count);
+    CHECK(0 == advance(&wheel, &timer, 1, at_tick(10)));
+    CHECK(1 == timer.expirations);
+    TimerWheel_destroy(&wheel);
+}
+
+static void test_later_revolution(void)
+{
+    TimerWheel wheel;
+    TestTimer timer = {0};
+
+    // 8 slots: tick 43 shares its slot with ticks 3, 11, ... which must not expire it
+    CHECK(SUCCESS == TimerWheel_init(&wheel, 8, TICK_NS, START_NS));
+    timer.wheel = &wheel;
+    TimerWheel_schedule(&wheel, &timer.entry, at_tick(43));
+    for (uint64_t tick = 1; tick < 43; tick++)
+    {
+        CHECK(0 == advance(&wheel, &timer, 1, at_tick(tick)));
+    }
+    CHECK(timer.entry.scheduled);
+    CHECK(1 == advance(&wheel, &timer, 1, at_tick(43)));
+    TimerWheel_destroy(&wheel);
+}
+
+static void test_reschedule_under_slip(void)
+{
+    TimerWheel wheel;
+    TestTimer timer = {0};
+
+    CHECK(SUCCESS == TimerWheel_init(&wheel, 64, TICK_NS, START_NS));
+    timer.wheel = &wheel;
+    timer.period_ns = 3 * TICK_NS;
+
+    // One advance 20 ticks late: the periodic timer catches up at ticks 3, 6, .., 18 in the same
+    // call instead of waiting for a revolution of the wheel
+    TimerWheel_schedule(&wheel, &timer.entry, at_tick(3));
+    CHECK(6 == advance(&wheel, &timer, 1, at_tick(20)));
+    CHECK(at_tick(18) == timer.last_due_ns);
+    CHECK(at_tick(21) == timer.entry.due_ns);
+    CHECK(20 == wheel.current_tick);
+    CHECK(1 == advance(&wheel, &timer, 1, at_tick(21)));
+    CHECK(!timer.early);
+
+    // Rescheduled at a time already due: expires again later in the same call, at the next tick
+    timer.period_ns = 0;
+    timer.reschedules_left = 4;
+    TimerWheel_schedule(&wheel, &timer.entry, at_tick(22));
+    CHECK(5 == advance(&wheel, &timer, 1, at_tick(30)));
+    CHECK(!timer.entry.scheduled);
+    TimerWheel_destroy(&wheel);
+}
+
+/* Expiry of the first timer of test_callback_changes_other_timers(): cancels the second one and moves the
+   third one, which share its tick */
+static void on_expiry_change_others(TimerWheelEntry *entry, uint64_t due_ns, void *context)
+{
+    TestTimer *timers = (TestTimer *)context;
+
+    if (entry == &timers[0].entry)
+    {
+        TimerWheel_cancel(timers[0].wheel, &timers[1].entry);
+        TimerWheel_schedule(timers[0].wheel, &timers[2].entry, at_tick(12));
+        TimerWheel_schedule(timers[0].wheel, &timers[3].entry, due_ns); // already due
+    }
+    ((TestTimer *)entry)->expirations++;
+    ((TestTimer *)entry)->last_due_ns = due_ns;
+}
+
+static void test_callback_changes_other_timers(void)
+{
+    TimerWheel wheel;
+    TestTimer timers[4];
+
+    memset(timers, 0, sizeof(timers));
+    CHECK(SUCCESS == TimerWheel_init(&wheel, 16, TICK_NS, START_NS));
+    for (int i = 0; i < 4; i++)
+    {
+        timers[i].wheel = &wheel;
+    }
+    TimerWheel_schedule(&wheel, &timers[0].entry, at_tick(5));
+    TimerWheel_schedule(&wheel, &timers[1].entry, at_tick(5));
+    TimerWheel_schedule(&wheel, &timers[2].entry, at_tick(5));
+
+    // The cancelled and the moved timers are still pending in the slot being drained
+    CHECK(2 == TimerWheel_advance(&wheel, at_tick(10), on_expiry_change_others, timers));
+    CHECK(1 == timers[0].expirations && 0 == timers[1].expirations && 0 == timers[2].expirations);
+    CHECK(1 == timers[3].expirations && at_tick(5) == timers[3].last_due_ns);
+    CHECK(!timers[1].entry.scheduled && timers[2].entry.scheduled);
+    CHECK(1 == wheel.count);
+    CHECK(1 == TimerWheel_advance(&wheel, at_tick(12), on_expiry_change_others, timers));
+    CHECK(1 == timers[2].expirations && at_tick(12) == timers[2].last_due_ns);
+    CHECK(0 == wheel.count);
+    TimerWheel_destroy(&wheel);
+}
+
+static void test_stall_longer_than_a_revolution(void)
+{
+    TimerWheel wheel;
+    TestTimer timers[3];
+
+    memset(timers, 0, sizeof(timers));
+    CHECK(SUCCESS == TimerWheel_init(&wheel, 8, TICK_NS, START_NS));
+    for (int i = 0; i < 3; i++)
+    {
+        timers[i].wheel = &wheel;
+    }
+    timers[0].period_ns = 3 * TICK_NS;
+    TimerWheel_schedule(&wheel, &timers[0].entry, at_tick(3));
+    TimerWheel_schedule(&wheel, &timers[1].entry, at_tick(50));
+    TimerWheel_schedule(&wheel, &timers[2].entry, at_tick(101));
+
+    // 100 ticks late: only the last revolution is walked, the periodic timer expires when its slot is
+    // reached (tick 99), then once more at tick 100 where its overdue next time lands; the timer of a
+    // later tick stays scheduled
+    CHECK(3 == advance(&wheel, timers, 3, at_tick(100)));
+    CHECK(2 == timers[0].expirations && 1 == timers[1].expirations && 0 == timers[2].expirations);
+    CHECK(at_tick(6) == timers[0].last_due_ns);
+    CHECK(101 == timers[0].entry.due_tick);
+    CHECK(100 == wheel.current_tick);
+    CHECK(2 == advance(&wheel, timers, 3, at_tick(101)));
+    CHECK(3 == timers[0].expirations && 1 == timers[2].expirations);
+    CHECK(!timers[0].early && !timers[1].early && !timers[2].early);
+    TimerWheel_destroy(&wheel);
+}
+
+static void test_many_timers_random_steps(void)
+{
+    enum { TIMER_COUNT = 2000 };
+    TimerWheel wheel;
+    TestTimer *timers = (TestTimer *)calloc(TIMER_COUNT, sizeof(TestTimer));
+    uint64_t now_ns = START_NS;
+    int expired = 0;
+    bool late = false;
+
+    srand(61850);
+    CHECK(SUCCESS == TimerWheel_init(&wheel, 256, TICK_NS, START_NS));
+    for (int i = 0; i < TIMER_COUNT; i++)
+    {
+        timers[i].wheel = &wheel;
+        TimerWheel_schedule(&wheel, &timers[i].entry, START_NS + (uint64_t)(rand() % 2000000) * 1000);
+    }
+    CHECK(TIMER_COUNT == wheel.count);
+    while (now_ns < START_NS + 2100000000ULL)
+    {
+        now_ns += (uint64_t)(rand() % 50000) * 1000; // steps up to 500 ticks
+        expired += advance(&wheel, timers, TIMER_COUNT, now_ns);
+        for (int i = 0; i < TIMER_COUNT; i++)
+        {
+            // The tick of a timer is at most one tick after its due time: it must have expired
+            if (timers[i].entry.scheduled && timers[i].entry.due_ns + TICK_NS <= now_ns)
+            {
+                late = true;
+            }
+        }
+    }
+    CHECK(TIMER_COUNT == expired);
+    CHECK(0 == wheel.count);
+    CHECK(!late);
+    for (int i = 0; i < TIMER_COUNT; i++)
+    {
+        CHECK(1 == timers[i].expirations);
+        CHECK(!timers[i].early);
+    }
+    TimerWheel_destroy(&wheel);
+    free(timers);
+}
+
+static void test_invalid_parameters(void)
+{
+    TimerWheel wheel;
+
+    CHECK(FAIL == TimerWheel_init(&wheel, 0, TICK_NS, 0));
+    CHECK(FAIL == TimerWheel_init(&wheel, 8, 0, 0));
+    CHECK(FAIL == TimerWheel_init(NULL, 8, TICK_NS, 0));
+}
+
+int main(void)
+{
+    RUN_TEST(test_one_shot);
+    RUN_TEST(test_cancel_and_move);
+    RUN_TEST(test_later_revolution);
+    RUN_TEST(test_reschedule_under_slip);
+    RUN_TEST(test_callback_changes_other_timers);
+    RUN_TEST(test_stall_longer_than_a_revolution);
+    RUN_TEST(test_many_timers_random_steps);
+    RUN_TEST(test_invalid_parameters);
+    return TEST_RESULT();
+}
@@ -0,0 +1,211 @@
+#include "logger.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define CAPTURE_MAX 8192
+#define LONG_STRING 2000 // longer than the text area of a record
+#define THREAD_COUNT 4
+#define THREAD_RECORDS 1000
+
+/* Messages received by the output handler, in output order */
+static pthread_mutex_t capture_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *captured[CAPTURE_MAX];
+static log_level_t captured_levels[CAPTURE_MAX];
+static int captured_count = 0;
+
+static void capture_handler(const log_entry_t *entry)
+{
+    pthread_mutex_lock(&capture_lock);
+    if (captured_count < CAPTURE_MAX)
+    {
+        captured_levels[captured_count] = entry->level;
+        captured[captured_count++] = strdup(entry->message);
+    }
+    pthread_mutex_unlock(&capture_lock);
+}
+
+static void capture_reset(void)
+{
+    logger_flush();
+    pthread_mutex_lock(&capture_lock);
+    for (int i = 0; i < captured_count; i++)
+    {
+        free(captured[i]);
+    }
+    captured_count = 0;
+    pthread_mutex_unlock(&capture_lock);
+}
+
+/* Message of the index-th record since the last reset, "" if there is none */
+static const char *message_at(int index)
+{
+    logger_flush();
+    return (index < captured_count) ? captured[index] : "";
+}
+
+/* Length of the run of c at the start of text */
+static size_t run_length(const char *text, char c)
+{
+    size_t length = 0;
+
+    while (text[length] == c)
+    {
+        length++;
+    }
+    return length;
+}
+
+static void test_formats(void)
+{
+    char expected[256];
+    int value = 42;
+
+    capture_reset();
+    LOG_ERROR("Test", "int %d %5d %-4d| hex %#x long %ld %llu size %zu", -7, 12, 3, 255, -123456789L,
+              18446744073709551615ULL, (size_t)99);
+    LOG_ERROR("Test", "double %.3f %e %g, pointer %p, %% sign, char %c", 3.14159, 1e-9, 0.5, (void *)&value, 'x');
+    LOG_ERROR("Test", "width %*d precision %.*f", 6, 42, 2, 2.71828);
+    LOG_ERROR("Test", "strings [%s] [%.3s] [%8s] [%s]", "abc", "abcdef", "right", (const char *)NULL);
+
+    CHECK(0 == strcmp(message_at(0), "int -7    12 3   | hex 0xff long -123456789 18446744073709551615 size 99"));
+    snprintf(expected, sizeof(expected), "double %.3f %e %g, pointer %p, %% sign, char %c", 3.14159, 1e-9, 0.5,
+             (void *)&value, 'x');
+    CHECK(0 == strcmp(message_at(1), expected));
+    CHECK(0 == strcmp(message_at(2), "width     42 precision 2.72"));
+    CHECK(0 == strcmp(message_at(3), "strings [abc] [abc] [   right] [(null)]"));
+}
+
+static void test_strings_are_copied(void)
+{
+    char buffer[32];
+
+    capture_reset();
+    strcpy(buffer, "before");
+    LOG_WARN("Test", "value %s", buffer);
+    strcpy(buffer, "after");
+    CHECK(0 == strcmp(message_at(0), "value before"));
+}
+
+static void test_truncated_strings(void)
+{
+    static char a[LONG_STRING + 1], b[LONG_STRING + 1], c[LONG_STRING + 1];
+    size_t first;
+
+    memset(a, 'a', LONG_STRING);
+    memset(b, 'b', LONG_STRING);
+    memset(c, 'c', LONG_STRING);
+    capture_reset();
+
+    // The first string fills the text area of the record, the next ones print empty
+    LOG_ERROR("Test", "%s|%s|%s|%d", a, b, c, 7);
+    const char *message = message_at(0);
+    first = run_length(message, 'a');
+    CHECK(first > 0 && first < LONG_STRING);
+    CHECK(0 == strcmp(message + first, "|||7"));
+
+    // Short strings first (5 bytes with their terminators): the long ones get what is left
+    LOG_ERROR("Test", "%s %s %s %s %s", "x", "yz", a, b, c);
+    message = message_at(1);
+    CHECK(0 == strncmp(message, "x yz ", 5));
+    CHECK(run_length(message + 5, 'a') + 5 == first);
+    CHECK(0 == strcmp(message + first, "  "));
+
+    // Many truncated strings in a row, more than the arguments kept in a record
+    LOG_ERROR("Test", "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s", a, b, c, a, b, c, a, b, c, a, b, c, a, b, c, a, b,
+              c, a, b);
+    message = message_at(2);
+    CHECK(first == run_length(message, 'a'));
+    CHECK(0 == strcmp(message + first, "<?><?><?><?>"));
+
+    // The records after them are intact
+    LOG_ERROR("Test", "after %d %s", 1, "ok");
+    CHECK(0 == strcmp(message_at(3), "after 1 ok"));
+}
+
+static void test_level_filter(void)
+{
+    capture_reset();
+    logger_set_level(LOG_LEVEL_WARN);
+    logger_log(LOG_LEVEL_INFO, "Test", __FILE__, __LINE__, "hidden");
+    LOG_WARN("Test", "shown");
+    logger_set_level(LOG_LEVEL_TRACE);
+    logger_log(LOG_LEVEL_TRACE, "Test", __FILE__, __LINE__, "trace");
+    CHECK(0 == strcmp(message_at(0), "shown"));
+    CHECK(LOG_LEVEL_WARN == captured_levels[0]);
+    CHECK(0 == strcmp(message_at(1), "trace"));
+    CHECK(2 == captured_count);
+}
+
+static void *logging_thread(void *arg)
+{
+    long id = (long)arg;
+
+    for (int i = 0; i < THREAD_RECORDS; i++)
+    {
+        LOG_ERROR("Test", "thread %ld record %d %s", id, i, "payload");
+    }
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    pthread_t threads[THREAD_COUNT];
+    int next[THREAD_COUNT] = {0};
+    bool in_order = true;
+
+    capture_reset();
+    for (long i = 0; i < THREAD_COUNT; i++)
+    {
+        CHECK(0 == pthread_create(&threads[i], NULL, logging_thread, (void *)i));
+    }
+    for (int i = 0; i < THREAD_COUNT; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    logger_flush();
+
+    // Every record arrives once, in order within its thread (the rings hold them all)
+    CHECK(THREAD_COUNT * THREAD_RECORDS == captured_count);
+    for (int i = 0; i < captured_count; i++)
+    {
+        long id;
+        int record;
+
+        if (2 != sscanf(captured[i], "thread %ld record %d", &id, &record) || id < 0 || id >= THREAD_COUNT ||
+            record != next[id])
+        {
+            in_order = false;
+            break;
+        }
+        next[id]++;
+    }
+    CHECK(in_order);
+}
+
+int main(void)
+{
+    int result;
+
+    // Rings of 2048 records per thread
+    if (!logger_init(2048 * 512, 50))
+    {
+        fprintf(stderr, "logger_init failed\n");
+        return 1;
+    }
+    logger_set_output_handler(capture_handler);
+    logger_set_level(LOG_LEVEL_TRACE);
+
+    RUN_TEST(test_formats);
+    RUN_TEST(test_strings_are_copied);
+    RUN_TEST(test_truncated_strings);
+    RUN_TEST(test_level_filter);
+    RUN_TEST(test_threads);
+    result = TEST_RESULT();
+
+    capture_reset();
+    logger_shutdown();
+    return result;
+}
@@ -0,0 +1,33 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+
+/* Minimal checks for the unit tests built by the "test" target of MAKE/Makefile: a failed check is
+   reported and counted, main() returns TEST_RESULT() (non-zero when a check failed) */
+
+static int test_failures = 0;
+static int test_checks = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        test_checks++; \
+        if (!(condition)) \
+        { \
+            test_failures++; \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#define RUN_TEST(test) \
+    do \
+    { \
+        int failures_before = test_failures; \
+        test(); \
+        printf("%-56s %s\n", #test, (failures_before == test_failures) ? "ok" : "FAILED"); \
+    } while (0)
+
+#define TEST_RESULT() (printf("%d checks, %d failed\n", test_checks, test_failures), (0 == test_failures) ? 0 : 1)
+
+#endif